@@ -0,0 +1,177 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_BENCHMARK_HPP
+#define RESULTSVIEWER_BENCHMARK_HPP
+
+#include "Json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace resultsviewer{
+
+// Keep the optimizer from discarding a result that is never used
+template <typename T> inline void keep(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+#endif
+}
+
+/**
+BenchmarkSuite times a set of named cases and reports them as JSON. A case is calibrated first: it is run in a loop
+whose count doubles until one pass takes at least the minimum sample time. Then that many iterations are timed
+repetition times, and the minimum, median, mean and maximum time per iteration over those samples are kept. The
+minimum and median are the numbers to track, the mean and maximum mostly show how noisy the machine was.
+*/
+class BenchmarkSuite
+{
+public:
+  struct Result
+  {
+    std::string name;
+    // micro cases time one operation on data in memory, macro cases a whole user visible step
+    std::string kind;
+    // what one iteration processes (values, rows, pixels), 0 if that does not apply
+    size_t items;
+    size_t iterations;
+    size_t repetitions;
+    double minimum;
+    double median;
+    double mean;
+    double maximum;
+  };
+
+  BenchmarkSuite(size_t repetitions = 10, double minimumSampleSeconds = 0.05) : m_repetitions(std::max<size_t>(repetitions, 1)),
+    m_minimumSampleSeconds(minimumSampleSeconds)
+  {}
+
+  // Only run the cases whose name passes filter
+  void setFilter(std::function<bool(const std::string &)> filter)
+  {
+    m_filter = filter;
+  }
+
+  // Time f(), which does one iteration of the case
+  template <typename F> void run(const std::string &name, const std::string &kind, size_t items, F f)
+  {
+    if (m_filter && !m_filter(name)) {
+      return;
+    }
+    f();
+    size_t iterations = 1;
+    while (true) {
+      double seconds = time(f, iterations);
+      if (seconds >= m_minimumSampleSeconds || iterations >= (size_t(1) << 30)) {
+        break;
+      }
+      iterations *= 2;
+    }
+    std::vector<double> samples;
+    for (size_t i = 0; i < m_repetitions; ++i) {
+      samples.push_back(time(f, iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double sample : samples) {
+      sum += sample;
+    }
+    size_t middle = samples.size() / 2;
+    double median = samples.size() % 2 == 1 ? samples[middle] : 0.5 * (samples[middle - 1] + samples[middle]);
+    m_results.push_back(Result{ name, kind, items, iterations, samples.size(), samples.front(), median,
+      sum / samples.size(), samples.back() });
+    if (m_progress) {
+      m_progress(m_results.back());
+    }
+  }
+
+  // Called after each case, to show progress
+  void setProgress(std::function<void(const Result &)> progress)
+  {
+    m_progress = progress;
+  }
+
+  const std::vector<Result> &results() const
+  {
+    return m_results;
+  }
+
+  // Times are in nanoseconds per iteration. context is written as is, as string members of a "context" object.
+  void writeJson(std::ostream &out, const std::vector<std::pair<std::string, std::string>> &context) const
+  {
+    out << "{\n  \"context\": {";
+    for (size_t i = 0; i < context.size(); ++i) {
+      out << (i == 0 ? "\n" : ",\n") << "    " << jsonString(context[i].first) << ": " << jsonString(context[i].second);
+    }
+    out << "\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < m_results.size(); ++i) {
+      const Result &r = m_results[i];
+      out << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(r.name) << ", \"kind\": " << jsonString(r.kind)
+        << ", \"items\": " << r.items << ", \"iterations\": " << r.iterations << ", \"repetitions\": " << r.repetitions
+        << ", \"time_unit\": \"ns\", \"min\": " << number(r.minimum) << ", \"median\": " << number(r.median)
+        << ", \"mean\": " << number(r.mean) << ", \"max\": " << number(r.maximum);
+      if (r.items > 0) {
+        out << ", \"items_per_second\": " << number(r.items * 1e9 / r.median);
+      }
+      out << "}";
+    }
+    out << "\n  ]\n}\n";
+  }
+
+private:
+  template <typename F> static double time(F &f, size_t iterations)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      f();
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  static std::string number(double value)
+  {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+    return buffer;
+  }
+
+  size_t m_repetitions;
+  double m_minimumSampleSeconds;
+  std::function<bool(const std::string &)> m_filter;
+  std::function<void(const Result &)> m_progress;
+  std::vector<Result> m_results;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_BENCHMARK_HPP
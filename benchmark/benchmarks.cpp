@@ -0,0 +1,360 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "Benchmark.hpp"
+#include "SqlFile.hpp"
+#include "ColumnarCache.hpp"
+#include "Statistics.hpp"
+#include "MinMaxPyramid.hpp"
+#include "RangeMinMax.hpp"
+#include "FloodGrid.hpp"
+#include "DictionaryStore.hpp"
+#include "DictionaryTree.hpp"
+#include "NgramIndex.hpp"
+#include "FloodPlot.hpp"
+
+#include <qwt/qwt_scale_map.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef RESULTSVIEWER_VERSION
+#define RESULTSVIEWER_VERSION "unknown"
+#endif
+
+/*
+The benchmarks run against the reference results file copied next to the executable, and against synthetic data
+sized like the long runs that are slow in practice: a year of one minute values, and a half million row dictionary.
+
+  benchmarks [--filter PATTERN] [--json FILE] [--repetitions N] [--min-time SECONDS]
+
+PATTERN is a wildcard pattern matched against the case names. The JSON report goes to FILE, or to standard output.
+*/
+
+namespace {
+
+const std::string referenceFile("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+const std::string referenceEnvPeriod("CHICAGO IL USA TMY2-94846 WMO#=725300");
+
+// A year of one minute values, a daily cycle plus some noise, always the same
+resultsviewer::TimeSeries syntheticYear()
+{
+  const size_t count = 365 * 24 * 60;
+  resultsviewer::TimeSeriesArray<double>::storage_type values(count);
+  uint32_t state = 12345;
+  for (size_t i = 0; i < count; ++i) {
+    state = state * 1664525u + 1013904223u;
+    double noise = static_cast<double>(state >> 8) / (1 << 24) - 0.5;
+    values[i] = 20.0 + 5.0 * std::sin(2.0 * 3.14159265358979 * static_cast<double>(i % 1440) / 1440.0) + noise;
+  }
+  return resultsviewer::TimeSeries(QDateTime(QDate(2009, 1, 1), QTime(0, 0)), 60,
+    resultsviewer::TimeSeriesArray<double>(std::move(values)), "C");
+}
+
+// Values read by a batch, the number of points in all of its series
+size_t points(const resultsviewer::TimeSeriesColumns &columns)
+{
+  size_t count = 0;
+  for (const auto &values : columns.values) {
+    count += values.size();
+  }
+  return count;
+}
+
+// The flood plot item with the image rendering a replot calls made public
+class Spectrogram : public resultsviewer::FloodPlotSpectrogram
+{
+public:
+  using resultsviewer::FloodPlotSpectrogram::renderImage;
+};
+
+// A large multi file dictionary, 100 files of 5000 rows
+void fillStore(resultsviewer::DictionaryStore &store)
+{
+  const char *variables[] = { "Zone Mean Air Temperature", "Zone Air Relative Humidity", "Zone Lights Electric Power",
+    "Surface Inside Face Temperature", "Fan Electric Power" };
+  const char *frequencies[] = { "Hourly", "Timestep", "Daily" };
+  for (int file = 0; file < 100; ++file) {
+    std::string filename = "/runs/case" + std::to_string(file) + "/eplusout.sql";
+    store.addFile(filename, "case" + std::to_string(file));
+    for (int row = 0; row < 5000; ++row) {
+      store.addRow(variables[row % 5], "ZONE " + std::to_string(row / 5), frequencies[row % 3], "RUN PERIOD 1", 0);
+    }
+  }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  std::string filter;
+  std::string jsonFile;
+  size_t repetitions = 10;
+  double minimumSampleSeconds = 0.05;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 == argc) {
+      std::cerr << "benchmarks: unknown or incomplete argument " << arg << std::endl;
+      return 2;
+    }
+    std::string value = argv[++i];
+    if (arg == "--filter") {
+      filter = value;
+    } else if (arg == "--json") {
+      jsonFile = value;
+    } else if (arg == "--repetitions") {
+      repetitions = std::strtoul(value.c_str(), nullptr, 10);
+    } else if (arg == "--min-time") {
+      minimumSampleSeconds = std::strtod(value.c_str(), nullptr);
+    } else {
+      std::cerr << "benchmarks: unknown argument " << arg << std::endl;
+      return 2;
+    }
+  }
+
+  resultsviewer::BenchmarkSuite suite(repetitions, minimumSampleSeconds);
+  if (!filter.empty()) {
+    suite.setFilter([filter](const std::string &name) { return resultsviewer::NgramIndex::wildcardMatch(filter, name); });
+  }
+  suite.setProgress([](const resultsviewer::BenchmarkSuite::Result &r) {
+    std::fprintf(stderr, "%-32s %14.0f ns median %14.0f ns min\n", r.name.c_str(), r.median, r.minimum);
+  });
+
+  {
+    resultsviewer::SqlFile probe(referenceFile, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    if (!probe.connectionOpen()) {
+      std::cerr << "benchmarks: cannot open " << referenceFile << std::endl;
+      return 1;
+    }
+  }
+
+  // opening includes reading the data dictionary
+  suite.run("sqlfile/open", "macro", 0, [] {
+    resultsviewer::SqlFile sqlFile(referenceFile, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    resultsviewer::keep(sqlFile.dataDictionary().size());
+  });
+  suite.run("sqlfile/open_immutable", "macro", 0, [] {
+    resultsviewer::SqlFile sqlFile(referenceFile, resultsviewer::SqlFile::OpenMode::Immutable);
+    resultsviewer::keep(sqlFile.dataDictionary().size());
+  });
+
+  resultsviewer::SqlFile sqlFile(referenceFile, resultsviewer::SqlFile::OpenMode::ReadOnly);
+  const std::vector<resultsviewer::DataDictionaryItem> &dictionary = sqlFile.dataDictionary();
+  suite.run("dictionary/tree", "micro", dictionary.size(), [&] {
+    resultsviewer::DictionaryTree tree(referenceFile, dictionary, sqlFile.illuminanceMaps());
+    resultsviewer::keep(tree.size());
+  });
+  suite.run("dictionary/store", "micro", dictionary.size(), [&] {
+    resultsviewer::DictionaryStore store;
+    store.addFile(referenceFile, "ref");
+    for (const auto &item : dictionary) {
+      store.addRow(item.name, item.keyValue, item.reportingFrequency, item.envPeriod, 0);
+    }
+    resultsviewer::keep(store.size());
+  });
+
+  // every series of the reference environment period
+  int envPeriodIndex = -1;
+  std::vector<int> dictionaryIndices;
+  for (const auto &item : dictionary) {
+    if (item.envPeriod == referenceEnvPeriod) {
+      envPeriodIndex = item.envPeriodIndex;
+      dictionaryIndices.push_back(item.index);
+    }
+  }
+  if (dictionaryIndices.empty()) {
+    std::cerr << "benchmarks: no series for " << referenceEnvPeriod << " in " << referenceFile << std::endl;
+    return 1;
+  }
+  const size_t batchPoints = points(sqlFile.timeSeriesColumns(envPeriodIndex, dictionaryIndices));
+  suite.run("series/single", "macro", 8760, [&] {
+    auto ts = sqlFile.timeSeries(referenceEnvPeriod, "Hourly", "InteriorLights:Electricity", "");
+    resultsviewer::keep(ts);
+  });
+  suite.run("series/batched", "macro", batchPoints, [&] {
+    resultsviewer::TimeSeriesColumns columns = sqlFile.timeSeriesColumns(envPeriodIndex, dictionaryIndices);
+    resultsviewer::keep(columns);
+  });
+
+  {
+    // a private copy, so the cache is not left next to the reference file
+    const std::string copy("benchmark_columnar_cache.sql");
+    {
+      std::ifstream source(referenceFile, std::ios::binary);
+      std::ofstream destination(copy, std::ios::binary);
+      destination << source.rdbuf();
+    }
+    const std::string cachePath = resultsviewer::ColumnarCache::pathFor(copy);
+    resultsviewer::SqlFile cached(copy, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    suite.run("series/cache_build", "macro", batchPoints, [&] {
+      resultsviewer::keep(cached.writeColumnarCache(cachePath));
+    });
+    if (cached.writeColumnarCache(cachePath)) {
+      cached.setColumnarCache(resultsviewer::ColumnarCache::open(cachePath, copy));
+      suite.run("series/cached_batched", "macro", batchPoints, [&] {
+        resultsviewer::TimeSeriesColumns columns = cached.timeSeriesColumns(envPeriodIndex, dictionaryIndices);
+        resultsviewer::keep(columns);
+      });
+    }
+    cached.setColumnarCache(nullptr);
+    std::remove(cachePath.c_str());
+    std::remove(copy.c_str());
+  }
+
+  resultsviewer::TimeSeries year = syntheticYear();
+  const size_t n = year.values().size();
+  suite.run("statistics/vector", "micro", n, [&] {
+    resultsviewer::keep(resultsviewer::computeStatistics(year.values().data(), n));
+  });
+  suite.run("statistics/scalar", "micro", n, [&] {
+    resultsviewer::keep(resultsviewer::computeStatistics(year.values().data(), n, true));
+  });
+
+  // differences on the same grid and against an hourly series merged onto the minute grid
+  resultsviewer::TimeSeries shiftedYear(year.startDateTime(), year.seconds(), year.values());
+  resultsviewer::TimeSeries hourlyYear = year.slice(0, n / 60);
+  hourlyYear = resultsviewer::TimeSeries(year.startDateTime(), 3600, hourlyYear.values(), "C");
+  suite.run("arithmetic/aligned", "micro", n, [&] {
+    resultsviewer::keep(year - shiftedYear);
+  });
+  suite.run("arithmetic/merged", "micro", n + n / 60, [&] {
+    resultsviewer::keep(year - hourlyYear);
+  });
+
+  // calendar rollups of the minute series, straight from the reports and from a finer rollup
+  suite.run("rollup/hourly", "micro", n, [&] {
+    resultsviewer::keep(resultsviewer::Rollup(year.startDateTime(), year.seconds().data(), year.values().data(), n,
+      resultsviewer::RollupPeriod::Hourly));
+  });
+  resultsviewer::Rollup hourlyRollup(year.startDateTime(), year.seconds().data(), year.values().data(), n,
+    resultsviewer::RollupPeriod::Hourly);
+  suite.run("rollup/monthly_from_hourly", "micro", hourlyRollup.size(), [&] {
+    resultsviewer::keep(hourlyRollup.coarsen(resultsviewer::RollupPeriod::Monthly));
+  });
+
+  // what a line plot builds for a series: its bounds and the level of detail structures used to draw and zoom it
+  suite.run("lineplot/data", "micro", n, [&] {
+    double bounds[2] = { year.minimum(), year.maximum() };
+    resultsviewer::MinMaxPyramid pyramid(year.values().data(), n);
+    resultsviewer::RangeMinMax range(year.values().data(), n);
+    resultsviewer::keep(bounds);
+    resultsviewer::keep(pyramid);
+    resultsviewer::keep(range);
+  });
+  resultsviewer::MinMaxPyramid pyramid(year.values().data(), n);
+  suite.run("lineplot/decimate", "micro", n, [&] {
+    size_t level = pyramid.levelFor(n, 1920);
+    resultsviewer::keep(pyramid.indices(level, 0, n));
+  });
+
+  suite.run("floodplot/grid", "micro", n, [&] {
+    resultsviewer::FloodGrid grid(year);
+    resultsviewer::keep(grid);
+  });
+
+  // the flood plot item drawing the whole year into a full HD image, from its cached grid image and with the grid
+  // colored again first, as after the data or color map changes
+  const int width = 1920;
+  const int height = 1080;
+  Spectrogram spectrogram;
+  spectrogram.setColorMap(new resultsviewer::FloodPlotColorMap(std::vector<double>{ year.minimum(), year.maximum() },
+    resultsviewer::FloodPlotColorMap::Jet));
+  auto floodPlotData = new resultsviewer::TimeSeriesFloodPlotData(year);
+  spectrogram.setData(floodPlotData);
+  QwtScaleMap xMap;
+  xMap.setScaleInterval(floodPlotData->minX(), floodPlotData->maxX());
+  xMap.setPaintInterval(0, width);
+  QwtScaleMap yMap;
+  yMap.setScaleInterval(floodPlotData->minY(), floodPlotData->maxY());
+  yMap.setPaintInterval(height, 0);
+  const QRectF area(floodPlotData->minX(), floodPlotData->minY(), floodPlotData->maxX() - floodPlotData->minX(),
+    floodPlotData->maxY() - floodPlotData->minY());
+  const QSize imageSize(width, height);
+  suite.run("floodplot/render", "micro", static_cast<size_t>(width) * height, [&] {
+    resultsviewer::keep(spectrogram.renderImage(xMap, yMap, area, imageSize));
+  });
+  suite.run("floodplot/render_recolor", "micro", static_cast<size_t>(width) * height, [&] {
+    spectrogram.invalidateImageCache();
+    resultsviewer::keep(spectrogram.renderImage(xMap, yMap, area, imageSize));
+  });
+
+  resultsviewer::DictionaryStore store;
+  fillStore(store);
+  // alternate patterns, neither refines the other, so every run is a full match
+  bool flip = false;
+  suite.run("filter/store", "micro", store.size(), [&] {
+    flip = !flip;
+    resultsviewer::keep(store.matchRows(flip ? "*zone 12*" : "*air temp*"));
+  });
+  std::vector<resultsviewer::DataDictionaryItem> bigDictionary;
+  for (int i = 0; i < 50000; ++i) {
+    bigDictionary.emplace_back(i, 1, i % 2 ? "Zone Mean Air Temperature" : "Zone Lights Electric Power",
+      "ZONE " + std::to_string(i), "RUN PERIOD 1", "Hourly", "C", "ReportData");
+  }
+  resultsviewer::DictionaryTree tree(referenceFile, bigDictionary);
+  suite.run("filter/tree", "micro", tree.size(), [&] {
+    resultsviewer::keep(tree.filter("*zone 12*"));
+  });
+
+  char date[32];
+  std::time_t now = std::time(nullptr);
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+  std::vector<std::pair<std::string, std::string>> context = {
+    { "version", RESULTSVIEWER_VERSION },
+    { "date", date },
+    { "threads", std::to_string(std::thread::hardware_concurrency()) },
+#if defined(RESULTSVIEWER_STATISTICS_AVX2)
+    { "vector", "avx2" },
+#elif defined(RESULTSVIEWER_STATISTICS_SSE2)
+    { "vector", "sse2" },
+#else
+    { "vector", "none" },
+#endif
+#ifdef NDEBUG
+    { "build", "release" },
+#else
+    { "build", "debug" },
+#endif
+    { "sqlite", sqlite3_libversion() }
+  };
+  if (jsonFile.empty()) {
+    suite.writeJson(std::cout, context);
+  } else {
+    std::ofstream out(jsonFile);
+    suite.writeJson(out, context);
+    if (!out) {
+      std::cerr << "benchmarks: cannot write " << jsonFile << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,388 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_BATCHJOB_HPP
+#define RESULTSVIEWER_BATCHJOB_HPP
+
+#include "SqlFile.hpp"
+#include "NgramIndex.hpp"
+#include "Statistics.hpp"
+#include "Rollup.hpp"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <tuple>
+#include <optional>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+#include <cstdlib>
+
+namespace resultsviewer{
+
+enum class BatchPlot { Line, Flood, Illuminance };
+
+/**
+BatchSelection picks the plots of a headless run. It is written plot|environment|frequency|variable|key, where plot
+is line, flood or illuminance and the rest are wildcard patterns (as in the tree and table filters) matched without
+regard to case. Trailing fields may be left off and then match anything. For illuminance maps the variable is the
+map name and the key is the zone; the frequency is always Hourly.
+*/
+struct BatchSelection
+{
+  BatchPlot plot = BatchPlot::Line;
+  std::string envPeriod = "*";
+  std::string reportingFrequency = "*";
+  std::string name = "*";
+  std::string keyValue = "*";
+
+  static std::optional<BatchSelection> parse(const std::string &spec)
+  {
+    std::vector<std::string> fields;
+    std::string::size_type start = 0;
+    while (true) {
+      std::string::size_type end = spec.find('|', start);
+      fields.push_back(trim(spec.substr(start, end == std::string::npos ? std::string::npos : end - start)));
+      if (end == std::string::npos) {
+        break;
+      }
+      start = end + 1;
+    }
+    if (fields.size() > 5) {
+      return std::nullopt;
+    }
+    BatchSelection result;
+    std::string plot = NgramIndex::foldCase(fields[0]);
+    if (plot == "line") {
+      result.plot = BatchPlot::Line;
+    } else if (plot == "flood") {
+      result.plot = BatchPlot::Flood;
+    } else if (plot == "illuminance") {
+      result.plot = BatchPlot::Illuminance;
+    } else {
+      return std::nullopt;
+    }
+    std::string *patterns[] = { &result.envPeriod, &result.reportingFrequency, &result.name, &result.keyValue };
+    for (size_t i = 1; i < fields.size(); ++i) {
+      if (!fields[i].empty()) {
+        *patterns[i - 1] = fields[i];
+      }
+    }
+    return result;
+  }
+
+  static std::string trim(const std::string &s)
+  {
+    std::string::size_type first = s.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+      return std::string();
+    }
+    return s.substr(first, s.find_last_not_of(" \t\r\n") - first + 1);
+  }
+};
+
+/**
+BatchOptions is the command line of a headless run:
+
+  --batch [options] file.sql...
+  --select SPEC        a BatchSelection, may be repeated
+  --select-file FILE   one BatchSelection per line, blank lines and lines starting with # are skipped
+  --output DIR         where images and statistics are written (default .)
+  --format png|svg     image format (default png)
+  --size WxH           image size in pixels (default 800x600)
+  --statistics FILE    summary statistics CSV, - for standard output (default statistics.csv in the output directory)
+  --no-plots           write the statistics only
+  --threads N          threads reading series and computing statistics (default one per core); images are drawn
+                       one after another on the main thread
+  --cache              read through columnar caches next to the files, building them if needed
+  --rollup PERIOD[:STATISTIC]
+                       plot finer reports rolled up to hourly, daily or monthly values, the statistic being sum,
+                       mean (the default), minimum, maximum or integral; the statistics file stays on the reports
+*/
+struct BatchOptions
+{
+  std::vector<std::string> files;
+  std::vector<BatchSelection> selections;
+  std::string outputDirectory = ".";
+  std::string format = "png";
+  int width = 800;
+  int height = 600;
+  std::string statisticsFile = "statistics.csv";
+  bool plots = true;
+  unsigned threads = 0;
+  bool columnarCache = false;
+  std::optional<RollupPeriod> rollupPeriod;
+  RollupStatistic rollupStatistic = RollupStatistic::Mean;
+
+  // True if the command line asks for a headless run
+  static bool requested(int argc, char *argv[])
+  {
+    return argc > 1 && std::string(argv[1]) == "--batch";
+  }
+
+  // Parse the arguments after --batch; on failure error says what was wrong
+  static std::optional<BatchOptions> parse(const std::vector<std::string> &args, std::string &error)
+  {
+    BatchOptions result;
+    for (size_t i = 0; i < args.size(); ++i) {
+      const std::string &arg = args[i];
+      if (arg.size() < 2 || arg.compare(0, 2, "--") != 0) {
+        result.files.push_back(arg);
+        continue;
+      }
+      if (arg == "--no-plots") {
+        result.plots = false;
+        continue;
+      }
+      if (arg == "--cache") {
+        result.columnarCache = true;
+        continue;
+      }
+      if (i + 1 == args.size()) {
+        error = arg + " needs a value";
+        return std::nullopt;
+      }
+      const std::string &value = args[++i];
+      if (arg == "--select") {
+        std::optional<BatchSelection> selection = BatchSelection::parse(value);
+        if (!selection) {
+          error = "bad selection '" + value + "'";
+          return std::nullopt;
+        }
+        result.selections.push_back(*selection);
+      } else if (arg == "--select-file") {
+        std::ifstream file(value);
+        if (!file) {
+          error = "cannot read " + value;
+          return std::nullopt;
+        }
+        std::string line;
+        for (int number = 1; std::getline(file, line); ++number) {
+          line = BatchSelection::trim(line);
+          if (line.empty() || line[0] == '#') {
+            continue;
+          }
+          std::optional<BatchSelection> selection = BatchSelection::parse(line);
+          if (!selection) {
+            error = value + ":" + std::to_string(number) + ": bad selection '" + line + "'";
+            return std::nullopt;
+          }
+          result.selections.push_back(*selection);
+        }
+      } else if (arg == "--output") {
+        result.outputDirectory = value;
+      } else if (arg == "--format") {
+        result.format = NgramIndex::foldCase(value);
+        if (result.format != "png" && result.format != "svg") {
+          error = "unsupported format '" + value + "'";
+          return std::nullopt;
+        }
+      } else if (arg == "--size") {
+        char *end = nullptr;
+        long width = std::strtol(value.c_str(), &end, 10);
+        long height = (*end == 'x' || *end == 'X') ? std::strtol(end + 1, &end, 10) : 0;
+        if (*end != '\0' || width <= 0 || height <= 0 || width > 32768 || height > 32768) {
+          error = "bad size '" + value + "'";
+          return std::nullopt;
+        }
+        result.width = static_cast<int>(width);
+        result.height = static_cast<int>(height);
+      } else if (arg == "--statistics") {
+        result.statisticsFile = value;
+      } else if (arg == "--rollup") {
+        size_t colon = value.find(':');
+        result.rollupPeriod = Rollup::periodFromName(value.substr(0, colon));
+        std::optional<RollupStatistic> statistic = RollupStatistic::Mean;
+        if (colon != std::string::npos) {
+          statistic = Rollup::statisticFromName(value.substr(colon + 1));
+        }
+        if (!result.rollupPeriod || !statistic) {
+          error = "bad rollup '" + value + "'";
+          return std::nullopt;
+        }
+        result.rollupStatistic = *statistic;
+      } else if (arg == "--threads") {
+        char *end = nullptr;
+        long threads = std::strtol(value.c_str(), &end, 10);
+        if (*end != '\0' || threads <= 0) {
+          error = "bad thread count '" + value + "'";
+          return std::nullopt;
+        }
+        result.threads = static_cast<unsigned>(threads);
+      } else {
+        error = "unknown option " + arg;
+        return std::nullopt;
+      }
+    }
+    if (result.files.empty()) {
+      error = "no input files";
+      return std::nullopt;
+    }
+    if (result.selections.empty()) {
+      error = "nothing selected, use --select or --select-file";
+      return std::nullopt;
+    }
+    return result;
+  }
+};
+
+/**
+BatchJob is one plot of a headless run, the selections matched against the dictionary of one file.
+*/
+struct BatchJob
+{
+  BatchPlot plot;
+  std::string path;
+  std::string envPeriod;
+  std::string reportingFrequency;
+  // the variable and key, or the map name and zone of an illuminance map
+  std::string name;
+  std::string keyValue;
+  std::string units;
+  // file name of the image, without the directory
+  std::string image;
+
+  bool isTimeSeries() const
+  {
+    return plot != BatchPlot::Illuminance;
+  }
+};
+
+/**
+BatchNames hands out file names that are safe on every platform and unique within a run.
+*/
+class BatchNames
+{
+public:
+  // base with anything but letters, digits, '.', '-' and '_' replaced by '_', and a number added if it was taken
+  std::string name(const std::string &base, const std::string &extension)
+  {
+    std::string clean;
+    for (char c : base) {
+      bool keep = std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' || c == '_';
+      if (keep) {
+        clean += c;
+      } else if (!clean.empty() && clean.back() != '_') {
+        clean += '_';
+      }
+    }
+    while (!clean.empty() && clean.back() == '_') {
+      clean.pop_back();
+    }
+    std::string result = clean + extension;
+    for (int n = 2; !m_taken.insert(NgramIndex::foldCase(result)).second; ++n) {
+      result = clean + "_" + std::to_string(n) + extension;
+    }
+    return result;
+  }
+
+private:
+  std::set<std::string> m_taken;
+};
+
+// The plots the selections pick from one file, in dictionary order, each once. Image names start with fileTag.
+inline std::vector<BatchJob> expandBatchSelections(const std::vector<BatchSelection> &selections, const std::string &path,
+  const std::string &fileTag, const SqlFile &sqlFile, const std::string &format, BatchNames &names)
+{
+  std::vector<BatchJob> result;
+  std::set<std::tuple<BatchPlot, std::string, std::string, std::string, std::string>> seen;
+  auto add = [&](BatchPlot plot, const std::string &envPeriod, const std::string &reportingFrequency,
+    const std::string &name, const std::string &keyValue, const std::string &units) {
+    if (!seen.emplace(plot, envPeriod, reportingFrequency, name, keyValue).second) {
+      return;
+    }
+    static const char *plotNames[] = { "line", "flood", "illuminance" };
+    BatchJob job{ plot, path, envPeriod, reportingFrequency, name, keyValue, units, std::string() };
+    std::string base = fileTag + "_" + plotNames[static_cast<int>(plot)] + "_" + envPeriod + "_" + reportingFrequency + "_" + name;
+    if (!keyValue.empty()) {
+      base += "_" + keyValue;
+    }
+    job.image = names.name(base, "." + format);
+    result.push_back(job);
+  };
+
+  for (const auto &selection : selections) {
+    if (selection.plot == BatchPlot::Illuminance) {
+      for (const auto &map : sqlFile.illuminanceMaps()) {
+        if (NgramIndex::wildcardMatch(selection.envPeriod, map.envPeriod) && NgramIndex::wildcardMatch(selection.reportingFrequency, "Hourly")
+          && NgramIndex::wildcardMatch(selection.name, map.name) && NgramIndex::wildcardMatch(selection.keyValue, map.zoneName)) {
+          add(BatchPlot::Illuminance, map.envPeriod, "Hourly", map.name, map.zoneName, "lux");
+        }
+      }
+      continue;
+    }
+    for (const auto &item : sqlFile.dataDictionary()) {
+      // a single value per period makes neither a line nor a flood plot
+      if (SqlFile::reportingFrequencyFromDB(item.reportingFrequency) == ReportingFrequency::RunPeriod) {
+        continue;
+      }
+      if (NgramIndex::wildcardMatch(selection.envPeriod, item.envPeriod) && NgramIndex::wildcardMatch(selection.reportingFrequency, item.reportingFrequency)
+        && NgramIndex::wildcardMatch(selection.name, item.name) && NgramIndex::wildcardMatch(selection.keyValue, item.keyValue)) {
+        add(selection.plot, item.envPeriod, item.reportingFrequency, item.name, item.keyValue, item.units);
+      }
+    }
+  }
+  return result;
+}
+
+// One field of a CSV row, quoted if it needs to be
+inline std::string csvField(const std::string &s)
+{
+  if (s.find_first_of(",\"\r\n") == std::string::npos) {
+    return s;
+  }
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"') {
+      result += '"';
+    }
+    result += c;
+  }
+  return result + "\"";
+}
+
+inline std::string batchStatisticsHeader()
+{
+  return "File,Environment,Frequency,Variable,Key,Units,Count,Minimum,Maximum,Mean,Standard Deviation,Sum";
+}
+
+inline std::string batchStatisticsRow(const BatchJob &job, const Statistics &statistics)
+{
+  std::ostringstream s;
+  s.precision(17);
+  s << csvField(job.path) << ',' << csvField(job.envPeriod) << ',' << csvField(job.reportingFrequency) << ','
+    << csvField(job.name) << ',' << csvField(job.keyValue) << ',' << csvField(job.units) << ',' << statistics.count;
+  if (statistics.count > 0) {
+    s << ',' << statistics.minimum << ',' << statistics.maximum << ',' << statistics.mean << ',' << statistics.stdev()
+      << ',' << statistics.sum;
+  } else {
+    s << ",,,,,";
+  }
+  return s.str();
+}
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_BATCHJOB_HPP
@@ -0,0 +1,636 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_COLUMNARCACHE_HPP
+#define RESULTSVIEWER_COLUMNARCACHE_HPP
+
+#include "TimeSeries.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace resultsviewer{
+
+/**
+ColumnarCache is a read only view of a sidecar file that holds the data dictionary and report data of a results file
+in columns, so that reopening a large file does not have to scan ReportData again. The file is memory mapped and the
+arrays it hands out point straight into the mapping, which stays mapped until the last of them is gone.
+
+The file has a fixed header, an interned string table, one record per dictionary entry (for each environment period)
+and the column data, each column starting on a 64 byte boundary. An entry's values hold only the times at which its
+variable reported; the seconds of those times are stored once per distinct set of times (a grid), so all the hourly
+variables of a period share one seconds column. The header records the size, modification time and a hash of the
+results file the cache was built from, and open refuses a cache that does not match the file as it is now.
+*/
+class ColumnarCache
+{
+public:
+  /// What a cache knows about the file it was built from
+  struct SourceStamp
+  {
+    uint64_t size = 0;
+    int64_t modified = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const SourceStamp &other) const
+    {
+      return size == other.size && modified == other.modified && hash == other.hash;
+    }
+
+    bool operator!=(const SourceStamp &other) const
+    {
+      return !(*this == other);
+    }
+
+    // Stamp the file at path, nullopt if it cannot be read. The hash covers the first and last 64 KiB, which is enough
+    // for sqlite files: every committed write bumps the change counter in the first page.
+    static std::optional<SourceStamp> of(const std::string &path)
+    {
+      std::error_code ec;
+      SourceStamp result;
+      result.size = std::filesystem::file_size(path, ec);
+      if (ec) {
+        return std::nullopt;
+      }
+      result.modified = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+      if (ec) {
+        return std::nullopt;
+      }
+      std::ifstream file(path, std::ios::binary);
+      if (!file) {
+        return std::nullopt;
+      }
+      const uint64_t window = 65536;
+      std::vector<char> buffer(static_cast<size_t>(std::min(result.size, 2 * window)));
+      uint64_t head = std::min(result.size, window);
+      file.read(buffer.data(), head);
+      if (result.size > head) {
+        uint64_t tailStart = std::max(head, result.size - window);
+        file.seekg(tailStart);
+        file.read(buffer.data() + head, result.size - tailStart);
+      }
+      if (!file) {
+        return std::nullopt;
+      }
+      // FNV-1a
+      uint64_t hash = 14695981039346656037ull;
+      for (char c : buffer) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+      }
+      result.hash = hash;
+      return result;
+    }
+  };
+
+  /// One dictionary entry for one environment period. The strings point into the mapping and are valid for the
+  /// lifetime of the cache.
+  struct Entry
+  {
+    int index = 0;
+    int envPeriodIndex = 0;
+    std::string_view name;
+    std::string_view keyValue;
+    std::string_view envPeriod;
+    std::string_view reportingFrequency;
+    std::string_view units;
+    std::string_view table;
+    // calendar day of the first report of the period, seconds are measured from midnight of that day
+    int startMonth = 1;
+    int startDay = 1;
+  };
+
+  static constexpr uint32_t noGrid = std::numeric_limits<uint32_t>::max();
+
+  /// The cache file that goes with a results file
+  static std::string pathFor(const std::string &sourcePath)
+  {
+    return sourcePath + ".rvcache";
+  }
+
+  /// Map the cache at path, or return nullptr if it is missing, damaged, or was not built from the current contents
+  /// of sourcePath
+  static std::shared_ptr<const ColumnarCache> open(const std::string &path, const std::string &sourcePath)
+  {
+    std::optional<SourceStamp> source = SourceStamp::of(sourcePath);
+    if (!source) {
+      return nullptr;
+    }
+    std::shared_ptr<const Mapping> mapping = Mapping::map(path);
+    if (!mapping) {
+      return nullptr;
+    }
+    std::shared_ptr<ColumnarCache> result(new ColumnarCache(mapping));
+    if (!result->validate() || result->source() != *source) {
+      return nullptr;
+    }
+    return result;
+  }
+
+  const SourceStamp &source() const
+  {
+    return m_source;
+  }
+
+  /// Number of entries
+  size_t size() const
+  {
+    return static_cast<size_t>(header().entryCount);
+  }
+
+  Entry entry(size_t i) const
+  {
+    const EntryRecord &record = entries()[i];
+    Entry result;
+    result.index = record.index;
+    result.envPeriodIndex = record.envPeriodIndex;
+    result.name = string(record.strings[0]);
+    result.keyValue = string(record.strings[1]);
+    result.envPeriod = string(record.strings[2]);
+    result.reportingFrequency = string(record.strings[3]);
+    result.units = string(record.strings[4]);
+    result.table = string(record.strings[5]);
+    result.startMonth = record.startMonth;
+    result.startDay = record.startDay;
+    return result;
+  }
+
+  /// The entry of a dictionary index in an environment period
+  std::optional<size_t> find(int dictionaryIndex, int envPeriodIndex) const
+  {
+    auto iter = m_entryOf.find(key(dictionaryIndex, envPeriodIndex));
+    if (iter == m_entryOf.end()) {
+      return std::nullopt;
+    }
+    return iter->second;
+  }
+
+  /// Entries with the same grid reported at the same times and share one seconds array; noGrid if there is no data
+  uint32_t grid(size_t i) const
+  {
+    return entries()[i].grid;
+  }
+
+  /// The report times of an entry, in seconds from midnight of its start day
+  TimeSeriesArray<long long> seconds(size_t i) const
+  {
+    uint32_t id = grid(i);
+    if (id == noGrid) {
+      return TimeSeriesArray<long long>();
+    }
+    const GridRecord &record = grids()[id];
+    return TimeSeriesArray<long long>::view(m_mapping, at<long long>(record.secondsOffset), static_cast<size_t>(record.count));
+  }
+
+  /// The values of an entry, one for each of its report times
+  TimeSeriesArray<double> values(size_t i) const
+  {
+    const EntryRecord &record = entries()[i];
+    if (record.grid == noGrid) {
+      return TimeSeriesArray<double>();
+    }
+    return TimeSeriesArray<double>::view(m_mapping, at<double>(record.valuesOffset), static_cast<size_t>(grids()[record.grid].count));
+  }
+
+private:
+  friend class ColumnarCacheWriter;
+
+  static constexpr char magic[8] = { 'R', 'V', 'C', 'A', 'C', 'H', 'E', '\0' };
+  static constexpr uint32_t version = 1;
+  // written in native order, a file from a machine of the other endianness reads back as 0x04030201
+  static constexpr uint32_t byteOrder = 0x01020304;
+  static constexpr uint64_t alignment = 64;
+
+  struct Header
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t sourceHash;
+    // stringCount + 1 offsets into the string data, string i is [offsets[i], offsets[i + 1])
+    uint64_t stringCount;
+    uint64_t stringOffsetsOffset;
+    uint64_t stringDataOffset;
+    uint64_t entryCount;
+    uint64_t entriesOffset;
+    uint64_t gridCount;
+    uint64_t gridsOffset;
+  };
+
+  struct EntryRecord
+  {
+    int32_t index;
+    int32_t envPeriodIndex;
+    // name, key value, environment period, reporting frequency, units and table
+    uint32_t strings[6];
+    int32_t startMonth;
+    int32_t startDay;
+    uint32_t grid;
+    uint32_t reserved;
+    uint64_t valuesOffset;
+  };
+
+  struct GridRecord
+  {
+    uint64_t secondsOffset;
+    uint64_t count;
+  };
+
+  /// A read only mapping of a whole file, unmapped when the last array pointing into it is gone
+  class Mapping
+  {
+  public:
+    ~Mapping()
+    {
+#ifndef _WIN32
+      if (m_data) {
+        munmap(const_cast<char*>(m_data), m_size);
+      }
+#endif
+    }
+
+    Mapping(const Mapping &) = delete;
+    Mapping &operator=(const Mapping &) = delete;
+
+    static std::shared_ptr<const Mapping> map(const std::string &path)
+    {
+#ifdef _WIN32
+      // no mmap here, read the file into memory instead (the views still share it)
+      std::ifstream file(path, std::ios::binary);
+      if (!file) {
+        return nullptr;
+      }
+      std::shared_ptr<Mapping> result(new Mapping());
+      std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+      if (bytes.size() < sizeof(Header)) {
+        return nullptr;
+      }
+      result->m_buffer = TimeSeriesArray<double>::storage_type((bytes.size() + sizeof(double) - 1) / sizeof(double));
+      std::memcpy(result->m_buffer.data(), bytes.data(), bytes.size());
+      result->m_data = reinterpret_cast<const char*>(result->m_buffer.data());
+      result->m_size = bytes.size();
+      return result;
+#else
+      int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return nullptr;
+      }
+      struct stat info;
+      if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        return nullptr;
+      }
+      void *data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+      // the mapping holds its own reference to the file
+      ::close(fd);
+      if (data == MAP_FAILED) {
+        return nullptr;
+      }
+      std::shared_ptr<Mapping> result(new Mapping());
+      result->m_data = static_cast<const char*>(data);
+      result->m_size = static_cast<size_t>(info.st_size);
+      return result;
+#endif
+    }
+
+    const char *data() const
+    {
+      return m_data;
+    }
+
+    size_t size() const
+    {
+      return m_size;
+    }
+
+  private:
+    Mapping()
+    {}
+
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+#ifdef _WIN32
+    TimeSeriesArray<double>::storage_type m_buffer;
+#endif
+  };
+
+  explicit ColumnarCache(std::shared_ptr<const Mapping> mapping) : m_mapping(mapping)
+  {}
+
+  static uint64_t key(int dictionaryIndex, int envPeriodIndex)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(dictionaryIndex)) << 32) | static_cast<uint32_t>(envPeriodIndex);
+  }
+
+  const Header &header() const
+  {
+    return *at<Header>(0);
+  }
+
+  const EntryRecord *entries() const
+  {
+    return at<EntryRecord>(header().entriesOffset);
+  }
+
+  const GridRecord *grids() const
+  {
+    return at<GridRecord>(header().gridsOffset);
+  }
+
+  std::string_view string(uint32_t id) const
+  {
+    const uint64_t *offsets = at<uint64_t>(header().stringOffsetsOffset);
+    const char *data = at<char>(header().stringDataOffset);
+    return std::string_view(data + offsets[id], static_cast<size_t>(offsets[id + 1] - offsets[id]));
+  }
+
+  template <typename T> const T *at(uint64_t offset) const
+  {
+    return reinterpret_cast<const T*>(m_mapping->data() + offset);
+  }
+
+  // True if count records of size bytes at offset lie within the file and are aligned for 8 byte reads
+  bool fits(uint64_t offset, uint64_t count, uint64_t size) const
+  {
+    uint64_t fileSize = m_mapping->size();
+    return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / size;
+  }
+
+  // Check everything open hands out points inside the file, then index the entries
+  bool validate()
+  {
+    const Header &h = header();
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0 || h.version != version || h.byteOrder != byteOrder
+      || h.fileSize != m_mapping->size()) {
+      return false;
+    }
+    if (h.stringCount == 0 || h.stringCount >= noGrid || !fits(h.stringOffsetsOffset, h.stringCount + 1, sizeof(uint64_t))
+      || !fits(h.entriesOffset, h.entryCount, sizeof(EntryRecord)) || h.gridCount >= noGrid
+      || !fits(h.gridsOffset, h.gridCount, sizeof(GridRecord)) || h.stringDataOffset > m_mapping->size()) {
+      return false;
+    }
+    const uint64_t *offsets = at<uint64_t>(h.stringOffsetsOffset);
+    if (offsets[0] != 0 || offsets[h.stringCount] > m_mapping->size() - h.stringDataOffset) {
+      return false;
+    }
+    for (uint64_t i = 0; i < h.stringCount; ++i) {
+      if (offsets[i] > offsets[i + 1]) {
+        return false;
+      }
+    }
+    const GridRecord *gridRecords = grids();
+    for (uint64_t i = 0; i < h.gridCount; ++i) {
+      if (!fits(gridRecords[i].secondsOffset, gridRecords[i].count, sizeof(long long))) {
+        return false;
+      }
+    }
+    const EntryRecord *entryRecords = entries();
+    m_entryOf.reserve(static_cast<size_t>(h.entryCount));
+    for (uint64_t i = 0; i < h.entryCount; ++i) {
+      const EntryRecord &record = entryRecords[i];
+      for (uint32_t id : record.strings) {
+        if (id >= h.stringCount) {
+          return false;
+        }
+      }
+      if (record.grid != noGrid && (record.grid >= h.gridCount
+        || !fits(record.valuesOffset, gridRecords[record.grid].count, sizeof(double)))) {
+        return false;
+      }
+      m_entryOf.emplace(key(record.index, record.envPeriodIndex), static_cast<size_t>(i));
+    }
+    m_source.size = h.sourceSize;
+    m_source.modified = h.sourceModified;
+    m_source.hash = h.sourceHash;
+    return true;
+  }
+
+  std::shared_ptr<const Mapping> m_mapping;
+  SourceStamp m_source;
+  std::unordered_map<uint64_t, size_t> m_entryOf;
+};
+
+/**
+ColumnarCacheWriter builds a cache file one entry at a time. Values are streamed to disk as they are added, so only
+the strings, the entry records and the distinct grids are held in memory. Everything is written to a temporary file
+that replaces the cache only when finish succeeds, so a reader never maps a half written cache.
+*/
+class ColumnarCacheWriter
+{
+public:
+  ColumnarCacheWriter(const std::string &path, const ColumnarCache::SourceStamp &source) : m_path(path),
+    m_temporaryPath(path + ".tmp"), m_source(source), m_offset(0), m_finished(false)
+  {
+    m_file.open(m_temporaryPath, std::ios::binary | std::ios::trunc);
+    // room for the header, written last
+    ColumnarCache::Header header{};
+    write(&header, sizeof(header));
+    intern("");
+  }
+
+  ~ColumnarCacheWriter()
+  {
+    if (!m_finished) {
+      m_file.close();
+      std::error_code ec;
+      std::filesystem::remove(m_temporaryPath, ec);
+    }
+  }
+
+  ColumnarCacheWriter(const ColumnarCacheWriter &) = delete;
+  ColumnarCacheWriter &operator=(const ColumnarCacheWriter &) = delete;
+
+  bool isOpen() const
+  {
+    return m_file.is_open() && m_file.good();
+  }
+
+  // Add an entry and its count values, reported at the given seconds from midnight of the entry's start day
+  void add(const ColumnarCache::Entry &entry, const long long *seconds, const double *values, size_t count)
+  {
+    ColumnarCache::EntryRecord record{};
+    record.index = entry.index;
+    record.envPeriodIndex = entry.envPeriodIndex;
+    std::string_view strings[] = { entry.name, entry.keyValue, entry.envPeriod, entry.reportingFrequency, entry.units, entry.table };
+    for (size_t i = 0; i < 6; ++i) {
+      record.strings[i] = intern(strings[i]);
+    }
+    record.startMonth = entry.startMonth;
+    record.startDay = entry.startDay;
+    record.grid = ColumnarCache::noGrid;
+    if (count > 0) {
+      record.grid = grid(seconds, count);
+      pad();
+      record.valuesOffset = m_offset;
+      write(values, count * sizeof(double));
+    }
+    m_entries.push_back(record);
+  }
+
+  // Write the tables and the header and move the file into place
+  bool finish()
+  {
+    std::vector<ColumnarCache::GridRecord> gridRecords;
+    for (const auto &seconds : m_grids) {
+      pad();
+      gridRecords.push_back(ColumnarCache::GridRecord{ m_offset, seconds.size() });
+      write(seconds.data(), seconds.size() * sizeof(long long));
+    }
+
+    ColumnarCache::Header header{};
+    std::memcpy(header.magic, ColumnarCache::magic, sizeof(header.magic));
+    header.version = ColumnarCache::version;
+    header.byteOrder = ColumnarCache::byteOrder;
+    header.sourceSize = m_source.size;
+    header.sourceModified = m_source.modified;
+    header.sourceHash = m_source.hash;
+
+    pad();
+    header.gridCount = gridRecords.size();
+    header.gridsOffset = m_offset;
+    write(gridRecords.data(), gridRecords.size() * sizeof(ColumnarCache::GridRecord));
+
+    pad();
+    header.entryCount = m_entries.size();
+    header.entriesOffset = m_offset;
+    write(m_entries.data(), m_entries.size() * sizeof(ColumnarCache::EntryRecord));
+
+    pad();
+    std::vector<uint64_t> offsets;
+    offsets.reserve(m_strings.size() + 1);
+    uint64_t length = 0;
+    for (const auto &s : m_strings) {
+      offsets.push_back(length);
+      length += s.size();
+    }
+    offsets.push_back(length);
+    header.stringCount = m_strings.size();
+    header.stringOffsetsOffset = m_offset;
+    write(offsets.data(), offsets.size() * sizeof(uint64_t));
+    header.stringDataOffset = m_offset;
+    for (const auto &s : m_strings) {
+      write(s.data(), s.size());
+    }
+    header.fileSize = m_offset;
+
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_file.close();
+    if (m_file.fail()) {
+      return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(m_temporaryPath, m_path, ec);
+    if (ec) {
+      return false;
+    }
+    m_finished = true;
+    return true;
+  }
+
+private:
+  void write(const void *data, size_t size)
+  {
+    m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    m_offset += size;
+  }
+
+  void pad()
+  {
+    static const char zeros[ColumnarCache::alignment] = {};
+    uint64_t over = m_offset % ColumnarCache::alignment;
+    if (over != 0) {
+      write(zeros, static_cast<size_t>(ColumnarCache::alignment - over));
+    }
+  }
+
+  uint32_t intern(std::string_view s)
+  {
+    auto iter = m_stringIds.find(std::string(s));
+    if (iter != m_stringIds.end()) {
+      return iter->second;
+    }
+    uint32_t id = static_cast<uint32_t>(m_strings.size());
+    m_strings.emplace_back(s);
+    m_stringIds.emplace(m_strings.back(), id);
+    return id;
+  }
+
+  // The id of the grid with these seconds, adding it if it is new
+  uint32_t grid(const long long *seconds, size_t count)
+  {
+    uint64_t hash = 14695981039346656037ull ^ count;
+    for (size_t i = 0; i < count; ++i) {
+      hash = (hash ^ static_cast<uint64_t>(seconds[i])) * 1099511628211ull;
+    }
+    auto range = m_gridsByHash.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter) {
+      const auto &candidate = m_grids[iter->second];
+      if (candidate.size() == count && std::equal(candidate.begin(), candidate.end(), seconds)) {
+        return iter->second;
+      }
+    }
+    uint32_t id = static_cast<uint32_t>(m_grids.size());
+    m_grids.emplace_back(seconds, seconds + count);
+    m_gridsByHash.emplace(hash, id);
+    return id;
+  }
+
+  std::string m_path;
+  std::string m_temporaryPath;
+  ColumnarCache::SourceStamp m_source;
+  std::ofstream m_file;
+  uint64_t m_offset;
+  bool m_finished;
+  std::vector<std::string> m_strings;
+  std::unordered_map<std::string, uint32_t> m_stringIds;
+  std::vector<ColumnarCache::EntryRecord> m_entries;
+  std::vector<std::vector<long long>> m_grids;
+  std::unordered_multimap<uint64_t, uint32_t> m_gridsByHash;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_COLUMNARCACHE_HPP
@@ -0,0 +1,362 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_DICTIONARYSTORE_HPP
+#define RESULTSVIEWER_DICTIONARYSTORE_HPP
+
+#include "NgramIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+StringPool interns strings, handing out a small integer id per distinct string so that repeated names are stored
+once and compared by id. Id 0 is always the empty string. Strings stay at a fixed address until the pool is cleared.
+*/
+class StringPool
+{
+public:
+  typedef uint32_t Id;
+
+  StringPool()
+  {
+    intern(std::string());
+  }
+
+  Id intern(const std::string &s)
+  {
+    auto iter = m_ids.find(s);
+    if (iter != m_ids.end()) {
+      return iter->second;
+    }
+    Id id = static_cast<Id>(m_strings.size());
+    m_strings.push_back(s);
+    m_ids.emplace(m_strings.back(), id);
+    return id;
+  }
+
+  const std::string &str(Id id) const
+  {
+    return m_strings[id];
+  }
+
+  size_t size() const
+  {
+    return m_strings.size();
+  }
+
+  void clear()
+  {
+    m_ids.clear();
+    m_strings.clear();
+    intern(std::string());
+  }
+
+private:
+  std::deque<std::string> m_strings; // a deque never moves its elements, so the views in m_ids stay valid
+  std::unordered_map<std::string_view, Id> m_ids;
+};
+
+// Columns of the data dictionary table, in display order
+enum class DictionaryColumn { VariableName, KeyValue, ReportingFrequency, Alias, EnvironmentPeriod, File };
+static const int dictionaryColumnCount = 6;
+
+/**
+DictionaryStore holds the data dictionary rows of every open file in columns of interned string ids, a few dozen bytes
+per row however long the names are. The alias and file name are held once per file rather than per row, so renaming
+a file is constant time. Rows of one file are contiguous and in the order they were added.
+*/
+class DictionaryStore
+{
+public:
+  typedef StringPool::Id Id;
+
+  // Start a file's rows, returns false if filename (compared case insensitively) already has rows
+  bool addFile(const std::string &filename, const std::string &alias)
+  {
+    if (fileIndex(filename) != npos) {
+      return false;
+    }
+    m_files.push_back(FileEntry{ m_strings.intern(filename), m_strings.intern(alias), foldCase(filename) });
+    return true;
+  }
+
+  // Add a row to the file most recently added
+  void addRow(const std::string &variableName, const std::string &keyValue, const std::string &reportingFrequency,
+    const std::string &envPeriod, int dataType, const std::string &dbIdentifier = std::string())
+  {
+    m_variableName.push_back(m_strings.intern(variableName));
+    m_keyValue.push_back(m_strings.intern(keyValue));
+    m_reportingFrequency.push_back(m_strings.intern(reportingFrequency));
+    m_envPeriod.push_back(m_strings.intern(envPeriod));
+    m_dbIdentifier.push_back(m_strings.intern(dbIdentifier));
+    m_file.push_back(static_cast<uint32_t>(m_files.size() - 1));
+    m_dataType.push_back(static_cast<int8_t>(dataType));
+    m_ranks.clear();
+  }
+
+  // Remove a file and its rows, returns the number of rows removed
+  size_t removeFile(const std::string &filename)
+  {
+    size_t file = fileIndex(filename);
+    if (file == npos) {
+      return 0;
+    }
+    size_t kept = 0;
+    for (size_t row = 0; row < size(); ++row) {
+      if (m_file[row] == file) {
+        continue;
+      }
+      m_variableName[kept] = m_variableName[row];
+      m_keyValue[kept] = m_keyValue[row];
+      m_reportingFrequency[kept] = m_reportingFrequency[row];
+      m_envPeriod[kept] = m_envPeriod[row];
+      m_dbIdentifier[kept] = m_dbIdentifier[row];
+      m_file[kept] = m_file[row] > file ? m_file[row] - 1 : m_file[row];
+      m_dataType[kept] = m_dataType[row];
+      ++kept;
+    }
+    size_t removed = size() - kept;
+    resize(kept);
+    m_files.erase(m_files.begin() + file);
+    if (m_files.empty()) {
+      // nothing refers to the strings any more
+      m_strings.clear();
+      m_index.clear();
+      m_lastMatchStrings = 0;
+    }
+    m_ranks.clear();
+    return removed;
+  }
+
+  // Rename a file's alias, returns false if the file has no rows
+  bool setAlias(const std::string &filename, const std::string &alias)
+  {
+    size_t file = fileIndex(filename);
+    if (file == npos) {
+      return false;
+    }
+    m_files[file].alias = m_strings.intern(alias);
+    m_ranks.clear();
+    return true;
+  }
+
+  size_t size() const
+  {
+    return m_file.size();
+  }
+
+  size_t fileCount() const
+  {
+    return m_files.size();
+  }
+
+  Id id(size_t row, DictionaryColumn column) const
+  {
+    switch (column) {
+    case DictionaryColumn::VariableName:
+      return m_variableName[row];
+    case DictionaryColumn::KeyValue:
+      return m_keyValue[row];
+    case DictionaryColumn::ReportingFrequency:
+      return m_reportingFrequency[row];
+    case DictionaryColumn::Alias:
+      return m_files[m_file[row]].alias;
+    case DictionaryColumn::EnvironmentPeriod:
+      return m_envPeriod[row];
+    case DictionaryColumn::File:
+      return m_files[m_file[row]].filename;
+    }
+    return 0;
+  }
+
+  const std::string &text(size_t row, DictionaryColumn column) const
+  {
+    return m_strings.str(id(row, column));
+  }
+
+  // RVD_TIMESERIES or RVD_ILLUMINANCEMAP
+  int dataType(size_t row) const
+  {
+    return m_dataType[row];
+  }
+
+  // Additional name to retrieve the row's data with, e.g. the illuminance map name
+  const std::string &dbIdentifier(size_t row) const
+  {
+    return m_strings.str(m_dbIdentifier[row]);
+  }
+
+  // The first row of a file, npos if the file has no rows
+  size_t firstRow(const std::string &filename) const
+  {
+    size_t file = fileIndex(filename);
+    if (file == npos) {
+      return npos;
+    }
+    auto iter = std::find(m_file.begin(), m_file.end(), static_cast<uint32_t>(file));
+    return iter == m_file.end() ? npos : static_cast<size_t>(iter - m_file.begin());
+  }
+
+  const StringPool &strings() const
+  {
+    return m_strings;
+  }
+
+  // Stable sort of rows by the text in column. Strings are ranked once, so rows compare as integers.
+  void sortRows(std::vector<size_t> &rows, DictionaryColumn column, bool ascending) const
+  {
+    const std::vector<uint32_t> &rank = ranks();
+    std::vector<uint32_t> keys(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      keys[i] = rank[id(rows[i], column)];
+    }
+    std::vector<size_t> order(rows.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (ascending) {
+      std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+    } else {
+      std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+    }
+    std::vector<size_t> sorted(rows.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      sorted[i] = rows[order[i]];
+    }
+    rows.swap(sorted);
+  }
+
+  // Rows where the text of any column but File matches a wildcard pattern (see NgramIndex). The distinct strings are
+  // looked up in a trigram index, brought up to date here; a pattern that narrows the previous one, as when typing
+  // more of a substring filter, is checked only against the strings the previous one matched.
+  std::vector<size_t> matchRows(const std::string &pattern) const
+  {
+    for (size_t id = m_index.size(); id < m_strings.size(); ++id) {
+      m_index.add(static_cast<Id>(id), m_strings.str(static_cast<Id>(id)));
+    }
+    if (m_lastMatchStrings == m_strings.size() && NgramIndex::refines(pattern, m_lastPattern)) {
+      m_lastMatch = m_index.match(pattern, m_lastMatch);
+    } else {
+      m_lastMatch = m_index.match(pattern);
+    }
+    m_lastPattern = pattern;
+    m_lastMatchStrings = m_strings.size();
+
+    std::vector<char> matched(m_strings.size(), 0);
+    for (Id id : m_lastMatch) {
+      matched[id] = 1;
+    }
+    std::vector<size_t> result;
+    for (size_t row = 0; row < size(); ++row) {
+      if (matched[m_variableName[row]] || matched[m_keyValue[row]] || matched[m_reportingFrequency[row]]
+        || matched[m_envPeriod[row]] || matched[m_files[m_file[row]].alias]) {
+        result.push_back(row);
+      }
+    }
+    return result;
+  }
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+  struct FileEntry
+  {
+    Id filename;
+    Id alias;
+    std::string key; // case folded filename
+  };
+
+  static std::string foldCase(std::string s)
+  {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return s;
+  }
+
+  size_t fileIndex(const std::string &filename) const
+  {
+    std::string key = foldCase(filename);
+    for (size_t i = 0; i < m_files.size(); ++i) {
+      if (m_files[i].key == key) {
+        return i;
+      }
+    }
+    return npos;
+  }
+
+  void resize(size_t n)
+  {
+    m_variableName.resize(n);
+    m_keyValue.resize(n);
+    m_reportingFrequency.resize(n);
+    m_envPeriod.resize(n);
+    m_dbIdentifier.resize(n);
+    m_file.resize(n);
+    m_dataType.resize(n);
+  }
+
+  // Position of each string in sorted order, rebuilt after the strings change
+  const std::vector<uint32_t> &ranks() const
+  {
+    if (m_ranks.size() != m_strings.size()) {
+      std::vector<Id> ids(m_strings.size());
+      std::iota(ids.begin(), ids.end(), 0);
+      std::sort(ids.begin(), ids.end(), [this](Id a, Id b) { return m_strings.str(a) < m_strings.str(b); });
+      m_ranks.assign(ids.size(), 0);
+      for (size_t i = 0; i < ids.size(); ++i) {
+        m_ranks[ids[i]] = static_cast<uint32_t>(i);
+      }
+    }
+    return m_ranks;
+  }
+
+  StringPool m_strings;
+  std::vector<FileEntry> m_files;
+  // one entry per row
+  std::vector<Id> m_variableName;
+  std::vector<Id> m_keyValue;
+  std::vector<Id> m_reportingFrequency;
+  std::vector<Id> m_envPeriod;
+  std::vector<Id> m_dbIdentifier;
+  std::vector<uint32_t> m_file;
+  std::vector<int8_t> m_dataType;
+  mutable std::vector<uint32_t> m_ranks;
+  // filtering
+  mutable NgramIndex m_index;
+  mutable std::string m_lastPattern;
+  mutable std::vector<Id> m_lastMatch;
+  mutable size_t m_lastMatchStrings = 0;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_DICTIONARYSTORE_HPP
@@ -0,0 +1,229 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_DICTIONARYTREE_HPP
+#define RESULTSVIEWER_DICTIONARYTREE_HPP
+
+#include "SqlFile.hpp"
+#include "DictionaryStore.hpp"
+#include "NgramIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+DictionaryTree is the environment period, reporting frequency, variable and key value hierarchy of one file, grouped
+in memory from a single pass over the data dictionary so that a view can build its branches as they are expanded.
+Node 0 is the file. Frequencies are in ReportingFrequency order and names are sorted. Keys of Run Period variables
+are single values rather than series, so they are folded into the variable ("KEY Variable") and keep the dictionary
+index to read the value with; empty keys (meters) leave the variable without children. Illuminance maps are listed
+under the Hourly frequency of their environment period as an "Illuminance Map" variable keyed by zone.
+*/
+class DictionaryTree
+{
+public:
+  enum class Level { File, EnvironmentPeriod, ReportingFrequency, VariableName, KeyValue };
+
+  struct Node
+  {
+    Level level;
+    std::string name;
+    size_t parent;
+    std::vector<size_t> children;
+    // set on Run Period variables
+    int dictionaryIndex = -1;
+    int envPeriodIndex = -1;
+    // set on the Illuminance Map variable and its keys
+    bool illuminanceMap = false;
+    std::string mapName;
+  };
+
+  DictionaryTree(const std::string &filename, const std::vector<DataDictionaryItem> &dictionary,
+    const std::vector<IlluminanceMapInfo> &illuminanceMaps = std::vector<IlluminanceMapInfo>())
+  {
+    // env period -> frequency -> variable -> dictionary entries, periods by their upper case name (maps name them in
+    // a different case) and shown as the dictionary names them
+    typedef std::map<std::string, std::vector<const DataDictionaryItem *>> Variables;
+    typedef std::map<std::tuple<int, std::string>, Variables> Frequencies;
+    std::map<std::string, Frequencies> groups;
+    std::map<std::string, int> envPeriodIndices;
+    std::map<std::string, std::string> envPeriodNames;
+    for (const DataDictionaryItem &item : dictionary) {
+      std::optional<ReportingFrequency> frequency = SqlFile::reportingFrequencyFromDB(item.reportingFrequency);
+      int order = frequency ? static_cast<int>(*frequency) : static_cast<int>(ReportingFrequency::RunPeriod) + 1;
+      std::string env = toUpper(item.envPeriod);
+      groups[env][std::make_tuple(order, item.reportingFrequency)][item.name].push_back(&item);
+      envPeriodIndices[env] = item.envPeriodIndex;
+      envPeriodNames.emplace(env, item.envPeriod);
+    }
+    std::map<std::string, std::vector<const IlluminanceMapInfo *>> mapsByEnv;
+    for (const IlluminanceMapInfo &map : illuminanceMaps) {
+      std::string env = toUpper(map.envPeriod);
+      mapsByEnv[env].push_back(&map);
+      envPeriodNames.emplace(env, map.envPeriod);
+    }
+
+    m_nodes.push_back(Node{ Level::File, filename, 0, {}, -1, -1, false, std::string() });
+    // environment periods in index order
+    std::vector<std::pair<int, std::string>> envPeriods;
+    for (const auto &env : groups) {
+      envPeriods.push_back(std::make_pair(envPeriodIndices[env.first], env.first));
+    }
+    for (const auto &env : mapsByEnv) {
+      if (groups.count(env.first) == 0) {
+        envPeriods.push_back(std::make_pair(std::numeric_limits<int>::max(), env.first));
+      }
+    }
+    std::sort(envPeriods.begin(), envPeriods.end());
+
+    for (const auto &env : envPeriods) {
+      size_t envNode = addNode(0, Level::EnvironmentPeriod, envPeriodNames[env.second]);
+      size_t hourlyNode = npos;
+      for (const auto &frequency : groups[env.second]) {
+        bool runPeriod = std::get<0>(frequency.first) == static_cast<int>(ReportingFrequency::RunPeriod);
+        size_t frequencyNode = addNode(envNode, Level::ReportingFrequency, std::get<1>(frequency.first));
+        if (std::get<0>(frequency.first) == static_cast<int>(ReportingFrequency::Hourly)) {
+          hourlyNode = frequencyNode;
+        }
+        for (const auto &variable : frequency.second) {
+          std::vector<const DataDictionaryItem *> keys = variable.second;
+          std::sort(keys.begin(), keys.end(), [](const DataDictionaryItem *a, const DataDictionaryItem *b) {
+            return a->keyValue < b->keyValue;
+          });
+          if (runPeriod) {
+            for (const DataDictionaryItem *key : keys) {
+              size_t variableNode = addNode(frequencyNode, Level::VariableName,
+                key->keyValue.empty() ? variable.first : key->keyValue + " " + variable.first);
+              m_nodes[variableNode].dictionaryIndex = key->index;
+              m_nodes[variableNode].envPeriodIndex = key->envPeriodIndex;
+            }
+          } else {
+            size_t variableNode = addNode(frequencyNode, Level::VariableName, variable.first);
+            for (const DataDictionaryItem *key : keys) {
+              if (!key->keyValue.empty()) {
+                addNode(variableNode, Level::KeyValue, key->keyValue);
+              }
+            }
+          }
+        }
+      }
+
+      auto maps = mapsByEnv.find(env.second);
+      if (maps != mapsByEnv.end()) {
+        if (hourlyNode == npos) {
+          hourlyNode = addNode(envNode, Level::ReportingFrequency, "Hourly");
+        }
+        size_t variableNode = addNode(hourlyNode, Level::VariableName, "Illuminance Map");
+        m_nodes[variableNode].illuminanceMap = true;
+        for (const IlluminanceMapInfo *map : maps->second) {
+          if (!map->zoneName.empty()) {
+            size_t keyNode = addNode(variableNode, Level::KeyValue, map->zoneName);
+            m_nodes[keyNode].illuminanceMap = true;
+            m_nodes[keyNode].mapName = map->name;
+          }
+        }
+      }
+    }
+  }
+
+  size_t size() const
+  {
+    return m_nodes.size();
+  }
+
+  const Node &node(size_t index) const
+  {
+    return m_nodes[index];
+  }
+
+  // Nodes shown by a wildcard filter (see NgramIndex): those where the node or an ancestor matches, or which lead to
+  // such a node. Names are looked up in a trigram index built on the first filter.
+  std::vector<bool> filter(const std::string &pattern) const
+  {
+    if (m_nameIds.empty()) {
+      for (const Node &node : m_nodes) {
+        m_nameIds.push_back(m_names.intern(node.name));
+      }
+      for (size_t id = 0; id < m_names.size(); ++id) {
+        m_index.add(static_cast<NgramIndex::Id>(id), m_names.str(static_cast<StringPool::Id>(id)));
+      }
+    }
+    std::vector<char> matchedName(m_names.size(), 0);
+    for (NgramIndex::Id id : m_index.match(pattern)) {
+      matchedName[id] = 1;
+    }
+
+    // parents come before their children, so one forward pass finds matching ancestors and one backward pass marks
+    // the paths to them
+    std::vector<bool> matched(m_nodes.size(), false);
+    for (size_t i = 0; i < m_nodes.size(); ++i) {
+      matched[i] = matchedName[m_nameIds[i]] || (i > 0 && matched[m_nodes[i].parent]);
+    }
+    std::vector<bool> shown(m_nodes.size(), false);
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+      if ((m_nodes[i].children.empty() && matched[i]) || shown[i]) {
+        shown[i] = true;
+        if (i > 0) {
+          shown[m_nodes[i].parent] = true;
+        }
+      }
+    }
+    return shown;
+  }
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+  size_t addNode(size_t parent, Level level, const std::string &name)
+  {
+    Node node{ level, name, parent, {}, -1, -1, false, std::string() };
+    m_nodes.push_back(node);
+    m_nodes[parent].children.push_back(m_nodes.size() - 1);
+    return m_nodes.size() - 1;
+  }
+
+  static std::string toUpper(std::string s)
+  {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return s;
+  }
+
+  std::vector<Node> m_nodes; // parents before children
+  // filtering
+  mutable StringPool m_names;
+  mutable std::vector<StringPool::Id> m_nameIds; // by node
+  mutable NgramIndex m_index;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_DICTIONARYTREE_HPP
@@ -0,0 +1,266 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+
+#ifndef RESULTSVIEWER_FILEOPENER_HPP
+#define RESULTSVIEWER_FILEOPENER_HPP
+
+#include "SqlFilePool.hpp"
+#include "DictionaryTree.hpp"
+#include "Snapshot.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+FileOpener opens a list of results files on a thread pool, one task per file: any snapshot and copies are made, the
+connection pool is opened (which checks the version and reads the data dictionary, from the columnar cache if one is
+asked for and current), the dictionary tree is grouped and any report beside the file is read, all off the calling
+thread. A columnar cache that is missing or stale is built by a task of its own once the file is handed over, so the
+file does not wait for the scan of its report data. Files finish in any order and are collected until taken, so a view
+that takes them when notified adds them in batches rather than one at a time. The status of each file can be read at
+any time for a progress display.
+*/
+class FileOpener
+{
+public:
+  enum class Status { Queued, Opening, Opened, Failed, Canceled };
+
+  struct Request
+  {
+    std::string path;
+    SqlFile::OpenMode mode = SqlFile::OpenMode::ReadOnly;
+    bool columnarCache = false;
+    // a database snapshot to path before it is opened, for a private copy that nothing else writes
+    std::string snapshotOf;
+    // (from, to) pairs of other files copied before the file is opened, as for the files beside a snapshot
+    std::vector<std::pair<std::string, std::string>> copies;
+    // a text file read once the file is open, such as the html tables beside it; missing files are skipped
+    std::string report;
+  };
+
+  struct Result
+  {
+    size_t index; // of the request
+    Status status; // Opened or Failed
+    std::shared_ptr<SqlFilePool> connections; // null unless opened
+    std::shared_ptr<const DictionaryTree> tree;
+    Snapshot::Method snapshot; // how the snapshot was made, None if there was none
+    std::optional<std::string> report; // the contents of the request's report, if it was read
+  };
+
+  // Called on a worker thread when there is something new to take (a result, or the last file finishing), once
+  // until the next take. It must not throw.
+  typedef std::function<void()> Notify;
+
+  FileOpener(ThreadPool &pool, const std::vector<Request> &requests, Notify notify = Notify())
+    : m_state(std::make_shared<State>(pool, requests, notify))
+  {
+    for (size_t i = 0; i < requests.size(); ++i) {
+      std::shared_ptr<State> state = m_state;
+      pool.submit([state, i]() { open(*state, i); });
+    }
+  }
+
+  FileOpener(const FileOpener &) = delete;
+  FileOpener &operator=(const FileOpener &) = delete;
+
+  size_t size() const
+  {
+    return m_state->requests.size();
+  }
+
+  const Request &request(size_t index) const
+  {
+    return m_state->requests[index];
+  }
+
+  std::vector<Status> statuses() const
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->statuses;
+  }
+
+  size_t finished() const
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->finished;
+  }
+
+  // True once every file is opened, failed or canceled. Read it before a take: once it holds, every result is ready,
+  // so that take collects the last of them, while a file finishing after the take would be missed by reading it after
+  bool done() const
+  {
+    return finished() == size();
+  }
+
+  // The files that finished since the last take, in request order
+  std::vector<Result> take()
+  {
+    std::vector<Result> results;
+    {
+      std::lock_guard<std::mutex> lock(m_state->mutex);
+      results.swap(m_state->ready);
+      m_state->notified = false;
+    }
+    std::sort(results.begin(), results.end(), [](const Result &a, const Result &b) { return a.index < b.index; });
+    return results;
+  }
+
+  // Files still queued are canceled now, files being opened when they are
+  void cancel()
+  {
+    m_state->token.cancel();
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    for (Status &status : m_state->statuses) {
+      if (status == Status::Queued) {
+        status = Status::Canceled;
+        ++m_state->finished;
+      }
+    }
+    m_state->notifyLocked(lock);
+  }
+
+  bool isCanceled() const
+  {
+    return m_state->token.isCanceled();
+  }
+
+private:
+  struct State
+  {
+    State(ThreadPool &pool, const std::vector<Request> &requests, Notify notify) : pool(pool), requests(requests),
+      notify(notify), statuses(requests.size(), Status::Queued), finished(0), notified(false)
+    {}
+
+    // Call notify unless a take is already due, with the lock released
+    void notifyLocked(std::unique_lock<std::mutex> &lock)
+    {
+      if (notified || !notify) {
+        return;
+      }
+      notified = true;
+      lock.unlock();
+      notify();
+    }
+
+    ThreadPool &pool;
+    const std::vector<Request> requests;
+    const Notify notify;
+    CancellationToken token;
+    std::mutex mutex;
+    std::vector<Status> statuses;
+    std::vector<Result> ready;
+    size_t finished;
+    bool notified;
+  };
+
+  static void open(State &state, size_t index)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (state.statuses[index] != Status::Queued) {
+        return;
+      }
+      state.statuses[index] = Status::Opening;
+    }
+    RESULTSVIEWER_TRACE_SCOPE("FileOpener::open", "load");
+    const Request &request = state.requests[index];
+    Result result{ index, Status::Failed, nullptr, nullptr, Snapshot::Method::None, std::nullopt };
+    // a snapshot that fails leaves nothing to open, which the open reports
+    if (!request.snapshotOf.empty()) {
+      result.snapshot = Snapshot::copyDatabase(request.snapshotOf, request.path, state.token);
+    }
+    for (const auto &copy : request.copies) {
+      if (state.token.isCanceled()) {
+        break;
+      }
+      Snapshot::copyFile(copy.first, copy.second);
+    }
+    std::string cachePath;
+    if (request.columnarCache && request.mode != SqlFile::OpenMode::ReadWrite) {
+      cachePath = ColumnarCache::pathFor(request.path);
+    }
+    if (!state.token.isCanceled()) {
+      auto connections = std::make_shared<SqlFilePool>(request.path, request.mode, SqlFilePool::defaultMaxConnections(),
+        cachePath);
+      if (connections->connectionOpen()) {
+        SqlFilePool::Lease sqlFile = connections->acquire(SqlFilePool::Priority::Worker);
+        if (sqlFile->connectionOpen()) {
+          result.tree = std::make_shared<const DictionaryTree>(sqlFile->energyPlusSqliteFile(),
+            sqlFile->dataDictionary(), sqlFile->illuminanceMaps());
+          result.connections = connections;
+          result.status = Status::Opened;
+        }
+      }
+      if (result.status == Status::Opened && !request.report.empty()) {
+        std::ifstream report(request.report, std::ios::binary);
+        if (report) {
+          result.report = std::string(std::istreambuf_iterator<char>(report), std::istreambuf_iterator<char>());
+        }
+      }
+    }
+
+    // the file is usable without its cache, which is built after it is handed over
+    std::shared_ptr<SqlFilePool> building;
+    if (result.status == Status::Opened && !cachePath.empty() && !result.connections->columnarCache()) {
+      building = result.connections;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(state.mutex);
+      ++state.finished;
+      if (state.token.isCanceled()) {
+        state.statuses[index] = Status::Canceled;
+        building.reset();
+      } else {
+        state.statuses[index] = result.status;
+        state.ready.push_back(std::move(result));
+      }
+      state.notifyLocked(lock);
+    }
+    if (building) {
+      state.pool.submit([building, cachePath]() { building->useColumnarCache(cachePath); });
+    }
+  }
+
+  std::shared_ptr<State> m_state;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_FILEOPENER_HPP
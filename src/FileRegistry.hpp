@@ -0,0 +1,220 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_FILEREGISTRY_HPP
+#define RESULTSVIEWER_FILEREGISTRY_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+FileRegistry maps open files to a shared handle and an alias, with hash indexes on the file path and the alias so
+that lookups do not scan the open files. Paths are compared by their canonical form, case folded, so the same file
+reached through a relative path, a symbolic link or with different capitalization is found once; aliases are
+compared case folded. The canonical form is resolved once, when a file is added; a lookup by an absolute path is
+matched lexically against the path each file was added with and its canonical form first, so only other spellings
+of a path touch the file system. The registry folds ASCII only, which leaves UTF-8 encoded names intact, unless it is
+given a fold for aliases (a caller with Unicode case rules at hand passes those). Aliases need not be unique. The
+registry does no locking and is meant to be used from the GUI thread.
+*/
+template <typename Handle> class FileRegistry
+{
+public:
+  typedef std::function<std::string(const std::string &)> Fold;
+
+  explicit FileRegistry(Fold foldAlias = Fold()) : m_foldAlias(foldAlias)
+  {}
+
+  // Register path with alias, returns false if the file is already registered
+  bool add(const std::string &path, const std::string &alias, std::shared_ptr<Handle> handle)
+  {
+    std::string key = pathKey(path);
+    if (m_files.count(key) > 0) {
+      return false;
+    }
+    std::string spelling = lexicalKey(path);
+    if (!spelling.empty() && spelling != key) {
+      m_spellings[spelling] = key;
+    }
+    m_files.emplace(key, Entry{ path, alias, std::move(handle), spelling });
+    ++m_aliases[aliasKey(alias)];
+    return true;
+  }
+
+  // Unregister path, returns false if it was not registered
+  bool remove(const std::string &path)
+  {
+    auto iter = m_files.find(fileKey(path));
+    if (iter == m_files.end()) {
+      return false;
+    }
+    releaseAlias(iter->second.alias);
+    auto spelling = m_spellings.find(iter->second.spelling);
+    if (spelling != m_spellings.end() && spelling->second == iter->first) {
+      m_spellings.erase(spelling);
+    }
+    m_files.erase(iter);
+    return true;
+  }
+
+  bool contains(const std::string &path) const
+  {
+    return m_files.count(fileKey(path)) > 0;
+  }
+
+  // The handle registered for path, null if there is none
+  std::shared_ptr<Handle> handle(const std::string &path) const
+  {
+    auto iter = m_files.find(fileKey(path));
+    if (iter == m_files.end()) {
+      return std::shared_ptr<Handle>();
+    }
+    return iter->second.handle;
+  }
+
+  std::optional<std::string> alias(const std::string &path) const
+  {
+    auto iter = m_files.find(fileKey(path));
+    if (iter == m_files.end()) {
+      return std::nullopt;
+    }
+    return iter->second.alias;
+  }
+
+  bool aliasExists(const std::string &alias) const
+  {
+    return m_aliases.count(aliasKey(alias)) > 0;
+  }
+
+  // Change the alias of path, returns false if it is not registered
+  bool setAlias(const std::string &path, const std::string &alias)
+  {
+    auto iter = m_files.find(fileKey(path));
+    if (iter == m_files.end()) {
+      return false;
+    }
+    releaseAlias(iter->second.alias);
+    iter->second.alias = alias;
+    ++m_aliases[aliasKey(alias)];
+    return true;
+  }
+
+  size_t size() const
+  {
+    return m_files.size();
+  }
+
+  void clear()
+  {
+    m_files.clear();
+    m_spellings.clear();
+    m_aliases.clear();
+  }
+
+  // The key a path is indexed by: its absolute canonical form as far as it exists, case folded
+  static std::string pathKey(const std::string &path)
+  {
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::absolute(path, ec);
+    if (ec) {
+      p = path;
+    }
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(p, ec);
+    return foldCase((ec ? p.lexically_normal() : canonical).generic_string());
+  }
+
+  // The key an absolute path is matched by without resolving it: its lexically normal form, case folded. Empty for
+  // relative paths, which depend on the working directory.
+  static std::string lexicalKey(const std::string &path)
+  {
+    std::filesystem::path p(path);
+    if (!p.is_absolute()) {
+      return std::string();
+    }
+    return foldCase(p.lexically_normal().generic_string());
+  }
+
+  static std::string foldCase(std::string s)
+  {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+  }
+
+private:
+  struct Entry
+  {
+    std::string path;
+    std::string alias;
+    std::shared_ptr<Handle> handle;
+    std::string spelling; // lexicalKey of path
+  };
+
+  // The key path is registered under, if it is: a spelling matched lexically, or else the path resolved
+  std::string fileKey(const std::string &path) const
+  {
+    std::string spelling = lexicalKey(path);
+    if (!spelling.empty()) {
+      if (m_files.count(spelling) > 0) {
+        return spelling;
+      }
+      auto iter = m_spellings.find(spelling);
+      if (iter != m_spellings.end()) {
+        return iter->second;
+      }
+    }
+    return pathKey(path);
+  }
+
+  std::string aliasKey(const std::string &alias) const
+  {
+    return m_foldAlias ? m_foldAlias(alias) : foldCase(alias);
+  }
+
+  void releaseAlias(const std::string &alias)
+  {
+    auto iter = m_aliases.find(aliasKey(alias));
+    if (iter != m_aliases.end() && --iter->second == 0) {
+      m_aliases.erase(iter);
+    }
+  }
+
+  std::unordered_map<std::string, Entry> m_files; // by pathKey
+  std::unordered_map<std::string, std::string> m_spellings; // lexicalKey of an added path to its pathKey
+  Fold m_foldAlias;
+  std::unordered_map<std::string, size_t> m_aliases; // case folded alias to the number of files using it
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_FILEREGISTRY_HPP
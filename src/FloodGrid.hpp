@@ -0,0 +1,269 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_FLOODGRID_HPP
+#define RESULTSVIEWER_FLOODGRID_HPP
+
+#include "TimeSeries.hpp"
+#include "Tracer.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+FloodGrid rasterizes a time series once into a dense day by interval grid of floats, so that a flood plot can look up
+the value at any point with two divisions and an array index. Each report fills the cells of the interval it ends,
+(previous report, this report], and cells without a report hold NaN. Columns are days of the year counted from the
+start date, rows are the intervals of the day. Reports appended to the series later can be added to the grid without
+rasterizing it again; rows keep room for more days so that costs time proportional to the new reports.
+*/
+class FloodGrid
+{
+public:
+  FloodGrid() : m_firstDay(0), m_days(0), m_dayCapacity(0), m_intervalsPerDay(0), m_cellSeconds(0), m_spacing(0),
+    m_offset(0), m_cellBase(0), m_generation(0)
+  {}
+
+  explicit FloodGrid(const TimeSeries &timeSeries) : FloodGrid()
+  {
+    RESULTSVIEWER_TRACE_SCOPE("FloodGrid", "render");
+    const size_t n = timeSeries.values().size();
+    if (n == 0) {
+      return;
+    }
+    m_spacing = spacing(timeSeries, 0);
+    m_cellSeconds = cellSize(m_spacing);
+    m_intervalsPerDay = static_cast<size_t>(86400 / m_cellSeconds);
+
+    // seconds are counted from the start of the first day rather than the start date and time
+    m_offset = timeSeries.startDateTime().time().msecsSinceStartOfDay() / 1000;
+
+    const long long firstDayOffset = floorDivide(std::min(firstCell(timeSeries, 0), lastCell(timeSeries, 0)),
+      m_intervalsPerDay);
+    const long long lastDayOffset = floorDivide(lastCell(timeSeries, n - 1), m_intervalsPerDay);
+    m_firstDay = timeSeries.startDateTime().date().dayOfYear() + static_cast<int>(firstDayOffset);
+    m_days = static_cast<size_t>(lastDayOffset - firstDayOffset + 1);
+    m_dayCapacity = m_days;
+    m_values.assign(m_days * m_intervalsPerDay, std::numeric_limits<float>::quiet_NaN());
+    m_cellBase = firstDayOffset * static_cast<long long>(m_intervalsPerDay);
+    fill(timeSeries, 0);
+  }
+
+  // Add the reports [from, end) of timeSeries, whose first from reports are the ones the grid holds. The grid is
+  // rasterized again only if the new reports are closer together than its cells.
+  void append(const TimeSeries &timeSeries, size_t from)
+  {
+    const size_t n = timeSeries.values().size();
+    if (from >= n) {
+      return;
+    }
+    long long newSpacing = spacing(timeSeries, std::max<size_t>(from, 1));
+    if (from == 0 || m_values.empty() || (newSpacing > 0 && (m_spacing == 0 || newSpacing < m_spacing)
+      && cellSize(newSpacing) != m_cellSeconds)) {
+      unsigned generation = m_generation;
+      *this = FloodGrid(timeSeries);
+      m_generation = generation + 1;
+      return;
+    }
+    if (newSpacing > 0 && (m_spacing == 0 || newSpacing < m_spacing)) {
+      m_spacing = newSpacing;
+    }
+
+    const long long lastDayOffset = floorDivide(lastCell(timeSeries, n - 1), m_intervalsPerDay);
+    const size_t days = static_cast<size_t>(std::max(lastDayOffset - floorDivide(m_cellBase, m_intervalsPerDay) + 1,
+      static_cast<long long>(m_days)));
+    if (days > m_dayCapacity) {
+      // move each row to a wider stride, leaving room to grow
+      size_t capacity = std::max(2 * m_dayCapacity, days);
+      std::vector<float> values(capacity * m_intervalsPerDay, std::numeric_limits<float>::quiet_NaN());
+      for (size_t interval = 0; interval < m_intervalsPerDay; ++interval) {
+        std::copy(row(interval), row(interval) + m_days, values.data() + interval * capacity);
+      }
+      m_values.swap(values);
+      m_dayCapacity = capacity;
+    }
+    m_days = days;
+    fill(timeSeries, from);
+    ++m_generation;
+  }
+
+  bool empty() const
+  {
+    return m_values.empty();
+  }
+
+  // day of the year of the first column
+  int firstDay() const
+  {
+    return m_firstDay;
+  }
+
+  size_t days() const
+  {
+    return m_days;
+  }
+
+  size_t intervalsPerDay() const
+  {
+    return m_intervalsPerDay;
+  }
+
+  // the value of a cell, NaN if nothing was reported in it
+  float at(size_t day, size_t interval) const
+  {
+    return m_values[interval * m_dayCapacity + day];
+  }
+
+  // the cells of one interval of the day for all days, contiguous
+  const float *row(size_t interval) const
+  {
+    return m_values.data() + interval * m_dayCapacity;
+  }
+
+  // Number of times reports have been appended, so that anything drawn from the grid can tell it is stale. New
+  // reports only fill cells after the last report, so an append changes only the last column and the columns it adds,
+  // unless the grid is rasterized again with smaller cells.
+  unsigned generation() const
+  {
+    return m_generation;
+  }
+
+  // column of a (fractional) day of the year, -1 outside the grid
+  long dayIndex(double dayOfYear) const
+  {
+    double day = std::floor(dayOfYear) - m_firstDay;
+    return (day >= 0 && day < m_days) ? static_cast<long>(day) : -1;
+  }
+
+  // row of an hour of the day, -1 outside the grid
+  long intervalIndex(double hourOfDay) const
+  {
+    double interval = std::floor(hourOfDay * m_intervalsPerDay / 24.0);
+    if (hourOfDay == 24.0) {
+      interval = m_intervalsPerDay - 1.0;
+    }
+    return (interval >= 0 && interval < m_intervalsPerDay) ? static_cast<long>(interval) : -1;
+  }
+
+  // value at a day of the year and hour of the day, NaN outside the grid
+  double value(double dayOfYear, double hourOfDay) const
+  {
+    long day = dayIndex(dayOfYear);
+    long interval = intervalIndex(hourOfDay);
+    if (day < 0 || interval < 0) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    return at(static_cast<size_t>(day), static_cast<size_t>(interval));
+  }
+
+  // length of a cell in seconds: the reporting interval, or the closest spacing of the reports if there is none,
+  // reduced to a divisor of a day
+  static long long cellSeconds(const TimeSeries &timeSeries)
+  {
+    return cellSize(spacing(timeSeries, 1));
+  }
+
+private:
+  static long long floorDivide(long long a, long long b)
+  {
+    long long q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+  }
+
+  // the reporting interval, or the closest spacing of the reports [from - 1, end), 0 if there is neither
+  static long long spacing(const TimeSeries &timeSeries, size_t from)
+  {
+    if (timeSeries.interval() && *timeSeries.interval() > 0) {
+      return *timeSeries.interval();
+    }
+    long long result = 0;
+    for (size_t i = std::max<size_t>(from, 1); i < timeSeries.seconds().size(); ++i) {
+      long long difference = timeSeries.seconds()[i] - timeSeries.seconds()[i - 1];
+      if (difference > 0 && (result == 0 || difference < result)) {
+        result = difference;
+      }
+    }
+    return result;
+  }
+
+  static long long cellSize(long long spacing)
+  {
+    return std::gcd(spacing > 0 ? spacing : 3600, 86400LL);
+  }
+
+  // cell c covers the seconds (c*cellSeconds, (c+1)*cellSeconds], counted from the start of the first day
+  long long firstCell(const TimeSeries &timeSeries, size_t i) const
+  {
+    const long long *seconds = timeSeries.seconds().data();
+    long long previous = i > 0 ? seconds[i - 1] : seconds[0] - (timeSeries.interval() ? *timeSeries.interval() : m_cellSeconds);
+    if (timeSeries.interval()) {
+      previous = std::max(previous, seconds[i] - *timeSeries.interval());
+    }
+    return floorDivide(previous + m_offset, m_cellSeconds);
+  }
+
+  long long lastCell(const TimeSeries &timeSeries, size_t i) const
+  {
+    return floorDivide(timeSeries.seconds()[i] + m_offset - 1, m_cellSeconds);
+  }
+
+  // fill the cells of the reports [from, end)
+  void fill(const TimeSeries &timeSeries, size_t from)
+  {
+    for (size_t i = from; i < timeSeries.values().size(); ++i) {
+      long long last = lastCell(timeSeries, i);
+      const float value = static_cast<float>(timeSeries.values()[i]);
+      for (long long cell = std::max(firstCell(timeSeries, i), m_cellBase); cell <= last; ++cell) {
+        size_t index = static_cast<size_t>(cell - m_cellBase);
+        // store day major, one row of days per interval
+        m_values[(index % m_intervalsPerDay) * m_dayCapacity + index / m_intervalsPerDay] = value;
+      }
+    }
+  }
+
+  int m_firstDay;
+  size_t m_days;
+  // days each row has room for
+  size_t m_dayCapacity;
+  size_t m_intervalsPerDay;
+  long long m_cellSeconds;
+  // closest spacing of the reports so far, 0 if unknown
+  long long m_spacing;
+  // seconds from the start of the first day to the start date and time
+  long long m_offset;
+  // the cell in the first row of the first column
+  long long m_cellBase;
+  unsigned m_generation;
+  std::vector<float> m_values;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_FLOODGRID_HPP
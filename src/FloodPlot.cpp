@@ -28,8 +28,11 @@
 
 #include "FloodPlot.hpp"
 #include "Utilities.hpp"
+#include "TileRenderer.hpp"
+#include "Tracer.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 namespace resultsviewer{
 
@@ -182,39 +185,26 @@ FloodPlotData::~FloodPlotData()
 }
 
 TimeSeriesFloodPlotData::TimeSeriesFloodPlotData(TimeSeries timeSeries)
-: FloodPlotData(),
-  m_timeSeries(timeSeries),
-  m_minValue(timeSeries.minimum()),
-  m_maxValue(timeSeries.maximum()),
-  m_minX(timeSeries.firstReportDateTime().date().dayOfYear()),
-  m_maxX(ceil(timeSeries.daysFromFirstReport()[timeSeries.daysFromFirstReport().size()-1]+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time()))), // end day
-  m_minY(0), // start hour
-  m_maxY(24), // end hour
-  m_startFractionalDay(timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())),
-  m_colorMapRange(QwtInterval(m_minValue, m_maxValue))
+: TimeSeriesFloodPlotData(timeSeries, std::make_shared<FloodGrid>(timeSeries),
+    QwtInterval(timeSeries.minimum(), timeSeries.maximum()))
 {
-  if (m_colorMapRange.minValue() == m_colorMapRange.maxValue())
-  {
-    m_colorMapRange = QwtInterval(m_colorMapRange.minValue(), m_colorMapRange.minValue() + 1.0);
-  }
-
-  // data range
-  setInterval(Qt::XAxis, QwtInterval(m_minX, m_maxX));
-  setInterval(Qt::YAxis, QwtInterval(m_minY, m_maxY));
-  setInterval(Qt::ZAxis, m_colorMapRange);
-  m_units = timeSeries.units;
 }
 
 TimeSeriesFloodPlotData::TimeSeriesFloodPlotData(TimeSeries timeSeries,  QwtInterval colorMapRange)
+: TimeSeriesFloodPlotData(timeSeries, std::make_shared<FloodGrid>(timeSeries), colorMapRange)
+{
+}
+
+TimeSeriesFloodPlotData::TimeSeriesFloodPlotData(TimeSeries timeSeries, std::shared_ptr<FloodGrid> grid, QwtInterval colorMapRange)
 : FloodPlotData(),
   m_timeSeries(timeSeries),
+  m_grid(grid),
   m_minValue(timeSeries.minimum()),
   m_maxValue(timeSeries.maximum()),
-  m_minX(timeSeries.firstReportDateTime().date().dayOfYear()),
-  m_maxX(ceil(timeSeries.daysFromFirstReport()[timeSeries.daysFromFirstReport().size()-1]+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time()))), // end day
+  m_minX(grid->firstDay()), // start day
+  m_maxX(grid->firstDay() + grid->days()), // end day
   m_minY(0), // start hour
   m_maxY(24), // end hour
-  m_startFractionalDay(timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())),
   m_colorMapRange(colorMapRange)
 {
   if (m_colorMapRange.minValue() == m_colorMapRange.maxValue())
@@ -226,12 +216,13 @@ TimeSeriesFloodPlotData::TimeSeriesFloodPlotData(TimeSeries timeSeries,  QwtInte
   setInterval(Qt::XAxis, QwtInterval(m_minX, m_maxX));
   setInterval(Qt::YAxis, QwtInterval(m_minY, m_maxY));
   setInterval(Qt::ZAxis, m_colorMapRange);
-  m_units = timeSeries.units;
+  m_units = timeSeries.units();
 }
 
 TimeSeriesFloodPlotData* TimeSeriesFloodPlotData::copy() const
 {
-  TimeSeriesFloodPlotData* result = new TimeSeriesFloodPlotData(m_timeSeries, m_colorMapRange);
+  // copies share the grid, which changes only when reports are appended
+  TimeSeriesFloodPlotData* result = new TimeSeriesFloodPlotData(m_timeSeries, m_grid, m_colorMapRange);
   return result;
 }
 
@@ -255,10 +246,9 @@ QRectF TimeSeriesFloodPlotData::pixelHint(const QRectF& area) const
 {
 
   double dx = 1.0; // one day
-  double dy = 1.0 / 24.0; // default hourly
-  std::optional<long long> intervalsecs = m_timeSeries.interval;
-  if (intervalsecs){
-    dy = intervalsecs.value() / 86400.0;
+  double dy = 24.0; // one cell of the grid, in hours
+  if (m_grid->intervalsPerDay() > 0){
+    dy = 24.0 / m_grid->intervalsPerDay();
   }
   QRectF rect(m_minX, m_minY, dx, dy);
 
@@ -268,8 +258,7 @@ QRectF TimeSeriesFloodPlotData::pixelHint(const QRectF& area) const
 double TimeSeriesFloodPlotData::value(double fractionalDay, double hourOfDay) const
 {
   // DLM: we are flooring the day because we want to plot day vs hour in flood plot
-  double fracDays = floor(fractionalDay) + hourOfDay/24.0;
-  return m_timeSeries.value(fracDays-m_startFractionalDay);
+  return m_grid->value(fractionalDay, hourOfDay);
 }
 
 /// minX
@@ -305,7 +294,7 @@ double TimeSeriesFloodPlotData::sumValue() const
 /// meanValue
 double TimeSeriesFloodPlotData::meanValue() const
 {
-  return m_timeSeries.sum()/static_cast<double>(m_timeSeries.values.size());
+  return m_timeSeries.sum()/static_cast<double>(m_timeSeries.values().size());
 }
 
 /// stdDevValue
@@ -329,6 +318,179 @@ std::string TimeSeriesFloodPlotData::units() const
   return m_units; 
 };
 
+const FloodGrid* TimeSeriesFloodPlotData::floodGrid() const
+{
+  return m_grid.get();
+}
+
+void TimeSeriesFloodPlotData::append(const TimeSeries &timeSeries, size_t from)
+{
+  RESULTSVIEWER_TRACE_SCOPE("TimeSeriesFloodPlotData::append", "plot");
+  m_grid->append(timeSeries, from);
+  m_timeSeries = timeSeries;
+  // the statistics of an appended series are carried over, so these do not scan the whole series
+  m_minValue = timeSeries.minimum();
+  m_maxValue = timeSeries.maximum();
+  m_minX = m_grid->firstDay();
+  m_maxX = m_grid->firstDay() + m_grid->days();
+  setInterval(Qt::XAxis, QwtInterval(m_minX, m_maxX));
+}
+
+FloodPlotSpectrogram::FloodPlotSpectrogram()
+  : QwtPlotSpectrogram(),
+    m_gridImageGrid(nullptr),
+    m_gridImageGeneration(0),
+    m_gridImageFirstDay(0)
+{
+}
+
+FloodPlotSpectrogram::~FloodPlotSpectrogram()
+{
+}
+
+void FloodPlotSpectrogram::setColorMap(QwtColorMap *colorMap)
+{
+  invalidateImageCache();
+  QwtPlotSpectrogram::setColorMap(colorMap);
+}
+
+void FloodPlotSpectrogram::setData(QwtRasterData *data)
+{
+  invalidateImageCache();
+  QwtPlotSpectrogram::setData(data);
+}
+
+void FloodPlotSpectrogram::invalidateImageCache()
+{
+  m_gridImage = QImage();
+  m_gridImageGrid = nullptr;
+  m_gridImageRange = QwtInterval();
+}
+
+const QImage& FloodPlotSpectrogram::gridImage(const FloodGrid &grid, const QwtInterval &range) const
+{
+  RESULTSVIEWER_TRACE_SCOPE("FloodPlotSpectrogram::gridImage", "render");
+  bool cached = m_gridImageGrid == &grid && m_gridImageRange == range && !m_gridImage.isNull();
+  if (cached && m_gridImageGeneration == grid.generation())
+  {
+    return m_gridImage;
+  }
+
+  // one pixel per cell, days across and intervals down, NaN cells are transparent
+  const int width = static_cast<int>(grid.days());
+  const int height = static_cast<int>(grid.intervalsPerDay());
+  size_t firstDay = 0;
+  QImage image;
+  if (cached && m_gridImageFirstDay == grid.firstDay() && m_gridImage.height() == height && m_gridImage.width() <= width)
+  {
+    // reports were appended: they fill the image's last column and the columns after it, keep the rest
+    firstDay = static_cast<size_t>(std::max(m_gridImage.width() - 1, 0));
+    image = (m_gridImage.width() == width) ? std::move(m_gridImage) : m_gridImage.copy(0, 0, width, height);
+  }
+  else
+  {
+    image = QImage(width, height, QImage::Format_ARGB32);
+  }
+  for (size_t interval = 0; interval < grid.intervalsPerDay(); ++interval)
+  {
+    const float *cells = grid.row(interval);
+    QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(static_cast<int>(interval)));
+    for (size_t day = firstDay; day < grid.days(); ++day)
+    {
+      line[day] = std::isnan(cells[day]) ? 0u : colorMap()->rgb(range, cells[day]);
+    }
+  }
+
+  m_gridImage = std::move(image);
+  m_gridImageGrid = &grid;
+  m_gridImageGeneration = grid.generation();
+  m_gridImageFirstDay = grid.firstDay();
+  m_gridImageRange = range;
+  return m_gridImage;
+}
+
+QImage FloodPlotSpectrogram::renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+  const QRectF &area, const QSize &imageSize) const
+{
+  RESULTSVIEWER_TRACE_SCOPE("FloodPlotSpectrogram::renderImage", "render");
+  if (imageSize.isEmpty() || !data() || !colorMap() || colorMap()->format() != QwtColorMap::RGB)
+  {
+    return QwtPlotSpectrogram::renderImage(xMap, yMap, area, imageSize);
+  }
+
+  const QwtInterval range = data()->interval(Qt::ZAxis);
+  if (!range.isValid())
+  {
+    return QImage();
+  }
+
+  const FloodPlotData *floodPlotData = dynamic_cast<const FloodPlotData *>(data());
+  const FloodGrid *grid = floodPlotData ? floodPlotData->floodGrid() : nullptr;
+  if (grid && grid->empty())
+  {
+    grid = nullptr;
+  }
+
+  // with a grid, sample the cached image: each column and each row of pixels maps to one column or row of cells
+  const QImage *cells = nullptr;
+  std::vector<long> days;
+  if (grid)
+  {
+    cells = &gridImage(*grid, range);
+    days.resize(imageSize.width());
+    for (int x = 0; x < imageSize.width(); ++x)
+    {
+      days[x] = grid->dayIndex(xMap.invTransform(x));
+    }
+  }
+
+  // tiles are rendered concurrently, each into an image of its own
+  const QwtRasterData *rasterData = data();
+  const QwtColorMap *rasterColorMap = colorMap();
+  const std::vector<Tile> imageTiles = tiles(imageSize.width(), imageSize.height(), renderTileSize);
+  std::vector<QImage> tileImages(imageTiles.size());
+  renderTiles(renderThreadPool(), imageSize.width(), imageSize.height(), renderTileSize, [&](size_t index, const Tile &tile)
+  {
+    QImage tileImage(tile.width, tile.height, QImage::Format_ARGB32);
+    for (int y = 0; y < tile.height; ++y)
+    {
+      QRgb *line = reinterpret_cast<QRgb *>(tileImage.scanLine(y));
+      const double ty = yMap.invTransform(tile.y + y);
+      if (cells)
+      {
+        long interval = grid->intervalIndex(ty);
+        const QRgb *source = interval < 0 ? nullptr : reinterpret_cast<const QRgb *>(cells->constScanLine(static_cast<int>(interval)));
+        for (int x = 0; x < tile.width; ++x)
+        {
+          long day = days[tile.x + x];
+          line[x] = (source && day >= 0) ? source[day] : 0u;
+        }
+      }
+      else
+      {
+        for (int x = 0; x < tile.width; ++x)
+        {
+          line[x] = rasterColorMap->rgb(range, rasterData->value(xMap.invTransform(tile.x + x), ty));
+        }
+      }
+    }
+    tileImages[index] = tileImage;
+  });
+
+  // composite the tiles
+  QImage image(imageSize, QImage::Format_ARGB32);
+  for (size_t i = 0; i < imageTiles.size(); ++i)
+  {
+    const Tile &tile = imageTiles[i];
+    for (int y = 0; y < tile.height; ++y)
+    {
+      std::copy_n(reinterpret_cast<const QRgb *>(tileImages[i].constScanLine(y)), tile.width,
+        reinterpret_cast<QRgb *>(image.scanLine(tile.y + y)) + tile.x);
+    }
+  }
+  return image;
+}
+
 MatrixFloodPlotData::MatrixFloodPlotData(const Matrix& matrix)
 : FloodPlotData(),
   m_xVector(linspace(0.0, static_cast<double>(matrix.size1()-1), matrix.size1())),
@@ -456,7 +618,7 @@ QRectF MatrixFloodPlotData::pixelHint(const QRectF& area) const
 
 double MatrixFloodPlotData::value(double x, double y) const
 {
-  return interp(m_xVector, m_yVector, m_matrix, x, y, m_interpMethod, NearestExtrap);
+  return interp(m_xVector, m_yVector, m_matrix, x, y, m_interpMethod, ExtrapMethod::NearestExtrap);
 }
 
 /// set the interp method, defaults to Nearest
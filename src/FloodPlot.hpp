@@ -30,6 +30,7 @@
 #define RESULTSVIEWER_FLOODPLOT_HPP
 
 #include "TimeSeries.hpp"
+#include "FloodGrid.hpp"
 #include "Utilities.hpp"
 #include "Matrix.hpp"
 
@@ -45,7 +46,10 @@
 #include <qwt/qwt_plot_zoomer.h>
 #include <qwt/qwt_plot_layout.h>
 
+#include <QImage>
+
 #include <vector>
+#include <memory>
 
 namespace resultsviewer{
 
@@ -139,6 +143,9 @@ namespace resultsviewer{
       /// units for plotting on axes or scaling
       virtual std::string units() const = 0;
 
+      /// day by interval grid of the data if it has one, used to render the plot from a cached image
+      virtual const FloodGrid* floodGrid() const { return nullptr; }
+
     protected:
 
       FloodPlotData();
@@ -217,19 +224,74 @@ namespace resultsviewer{
       /// units for plotting on axes or scaling
       std::string units() const override;
 
+      /// the rasterized time series
+      const FloodGrid* floodGrid() const override;
+
+      /// replace the time series with one that has more reports, the first from of which are the current ones; only
+      /// the new reports are added to the grid
+      void append(const TimeSeries &timeSeries, size_t from);
+
     private:
+      TimeSeriesFloodPlotData(TimeSeries timeSeries, std::shared_ptr<FloodGrid> grid, QwtInterval colorMapRange);
+
       TimeSeries m_timeSeries;
+      std::shared_ptr<FloodGrid> m_grid; // shared by copies
       double m_minValue;
       double m_maxValue;
       double m_minX;
       double m_maxX;
       double m_minY;
       double m_maxY;
-      double m_startFractionalDay;
       QwtInterval m_colorMapRange;
       std::string m_units;
   };
 
+  /** FloodPlotSpectrogram colors the grid of its data once into an image with one pixel per cell and renders the
+  *   plot by sampling that image, so replots after zooming, panning or resizing do not evaluate the data or the color
+  *   map again. The image is rebuilt when the data, the color map or the color map range changes, and when reports are
+  *   appended to the grid only the columns they touch are colored. Data without a grid
+  *   is evaluated per pixel. Either way the image is split into tiles that are rendered concurrently on the render
+  *   thread pool and composited at the end; data and color maps must be safe to read from several threads.
+  *   \deprecated { Qwt drawing widgets are deprecated in favor of Javascript }
+  */
+  class  FloodPlotSpectrogram: public QwtPlotSpectrogram
+  {
+    public:
+
+      /// constructor
+      FloodPlotSpectrogram();
+
+      /// virtual destructor
+      virtual ~FloodPlotSpectrogram();
+
+      /// set the color map, the cached image is discarded
+      void setColorMap(QwtColorMap *colorMap);
+
+      /// set the data, the cached image is discarded
+      void setData(QwtRasterData *data);
+
+      /// discard the cached image
+      void invalidateImageCache();
+
+    protected:
+
+      virtual QImage renderImage(const QwtScaleMap &xMap, const QwtScaleMap &yMap,
+        const QRectF &area, const QSize &imageSize) const override;
+
+    private:
+      // the image of the whole grid, colored for the current color map and range
+      const QImage& gridImage(const FloodGrid &grid, const QwtInterval &range) const;
+
+      // tiles are this many pixels square
+      static const int renderTileSize = 128;
+
+      mutable QImage m_gridImage;
+      mutable const FloodGrid* m_gridImageGrid;
+      mutable unsigned m_gridImageGeneration;
+      mutable int m_gridImageFirstDay;
+      mutable QwtInterval m_gridImageRange;
+  };
+
   /** MatrixFloodPlotData converts a Matrix into flood plot data
   *   \deprecated { Qwt drawing widgets are deprecated in favor of Javascript }
   */
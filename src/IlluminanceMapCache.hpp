@@ -0,0 +1,191 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_ILLUMINANCEMAPCACHE_HPP
+#define RESULTSVIEWER_ILLUMINANCEMAPCACHE_HPP
+
+#include "LruCache.hpp"
+#include "ThreadPool.hpp"
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+IlluminanceMapCache holds the illuminance values of the frames (hourly reports) of an illuminance map that were viewed
+recently, within a budget of bytes, and reads ahead of and behind the frame being viewed on a background thread so
+that stepping through the map does not wait on the database. Only the values are cached; the grid is the same for
+every frame and is kept once by the caller.
+*/
+class IlluminanceMapCache
+{
+public:
+  typedef std::shared_ptr<const std::vector<double>> Frame;
+  // Reads the values of a frame. Calls are never concurrent, so the reader may use a single database connection.
+  typedef std::function<std::vector<double> (size_t)> FrameReader;
+
+  static const size_t defaultByteBudget = 64 * 1024 * 1024;
+  static const size_t defaultReadAhead = 24;
+  static const size_t defaultReadBehind = 8;
+
+  IlluminanceMapCache(size_t frameCount, FrameReader reader, size_t byteBudget = defaultByteBudget,
+    size_t readAhead = defaultReadAhead, size_t readBehind = defaultReadBehind)
+    : m_frameCount(frameCount), m_reader(reader), m_cache(byteBudget), m_readAhead(readAhead), m_readBehind(readBehind),
+    m_frameBytes(0), m_generation(0), m_pool(1)
+  {}
+
+  ~IlluminanceMapCache()
+  {
+    // queued prefetches see the new generation and return, then the pool joins
+    ++m_generation;
+  }
+
+  IlluminanceMapCache(const IlluminanceMapCache &) = delete;
+  IlluminanceMapCache &operator=(const IlluminanceMapCache &) = delete;
+
+  size_t frameCount() const
+  {
+    return m_frameCount;
+  }
+
+  // The values of a frame, read now if they are not cached, then start reading the frames around it
+  Frame frame(size_t index)
+  {
+    Frame result = load(index);
+    prefetch(index);
+    return result;
+  }
+
+  bool isCached(size_t index) const
+  {
+    return m_cache.contains(index);
+  }
+
+  size_t cachedBytes() const
+  {
+    return m_cache.bytes();
+  }
+
+  // Block until the reads started by earlier calls to frame are done or abandoned
+  void waitForPrefetch()
+  {
+    m_pool.submit([]() {}).wait();
+  }
+
+  // The frames to read around center, nearest first, alternating ahead and behind, at most count of them
+  static std::vector<size_t> prefetchOrder(size_t center, size_t frameCount, size_t readAhead, size_t readBehind,
+    size_t count)
+  {
+    std::vector<size_t> result;
+    for (size_t distance = 1; distance <= std::max(readAhead, readBehind) && result.size() < count; ++distance) {
+      if (distance <= readAhead && center + distance < frameCount) {
+        result.push_back(center + distance);
+      }
+      if (distance <= readBehind && distance <= center && result.size() < count) {
+        result.push_back(center - distance);
+      }
+    }
+    return result;
+  }
+
+private:
+  static size_t frameBytes(const std::vector<double> &values)
+  {
+    return sizeof(values) + values.size() * sizeof(double);
+  }
+
+  Frame load(size_t index)
+  {
+    if (auto cached = m_cache.get(index)) {
+      return *cached;
+    }
+    std::lock_guard<std::mutex> lock(m_readMutex);
+    // the prefetcher may have read it while this waited
+    if (auto cached = m_cache.get(index)) {
+      return *cached;
+    }
+    Frame result = std::make_shared<const std::vector<double>>(m_reader(index));
+    m_frameBytes = frameBytes(*result);
+    m_cache.put(index, result, m_frameBytes);
+    return result;
+  }
+
+  void prefetch(size_t center)
+  {
+    size_t generation = ++m_generation;
+    // keep room for the frame being viewed, reading more than fits would evict what was just read
+    size_t fits = m_cache.budget() / std::max<size_t>(m_frameBytes, 1);
+    size_t count = fits > 1 ? fits - 1 : 0;
+    std::vector<size_t> order = prefetchOrder(center, m_frameCount, m_readAhead, m_readBehind, count);
+    m_pool.submit([this, generation, center, order]() {
+      for (size_t index : order) {
+        if (m_generation != generation) {
+          return;
+        }
+        if (m_cache.contains(index)) {
+          continue;
+        }
+        std::lock_guard<std::mutex> lock(m_readMutex);
+        if (m_cache.contains(index)) {
+          continue;
+        }
+        try {
+          Frame values = std::make_shared<const std::vector<double>>(m_reader(index));
+          m_cache.put(index, values, frameBytes(*values));
+        } catch (...) {
+          // a frame that cannot be read is reported when it is viewed
+          return;
+        }
+      }
+      // touch the frames farthest first, so the nearest are the last to be evicted
+      for (auto iter = order.rbegin(); iter != order.rend() && m_generation == generation; ++iter) {
+        m_cache.get(*iter);
+      }
+      if (m_generation == generation) {
+        m_cache.get(center);
+      }
+    });
+  }
+
+  size_t m_frameCount;
+  FrameReader m_reader;
+  LruCache<size_t, Frame> m_cache;
+  size_t m_readAhead;
+  size_t m_readBehind;
+  std::atomic<size_t> m_frameBytes;
+  std::atomic<size_t> m_generation;
+  std::mutex m_readMutex;
+  // last, so the worker is joined before the members it uses are destroyed
+  ThreadPool m_pool;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_ILLUMINANCEMAPCACHE_HPP
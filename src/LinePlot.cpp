@@ -37,35 +37,35 @@ namespace resultsviewer{
 TimeSeriesLinePlotData::TimeSeriesLinePlotData(TimeSeries timeSeries)
 : m_timeSeries(timeSeries),
   m_minX(timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())),
-  m_maxX(timeSeries.daysFromFirstReport()[timeSeries.daysFromFirstReport().size()-1]+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())), // end day
+  m_maxX(static_cast<double>(timeSeries.seconds().back() - timeSeries.seconds().front())/86400.0+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())), // end day
   m_minY(timeSeries.minimum()),
   m_maxY(timeSeries.maximum()),
-  m_size(timeSeries.values.size())
+  m_size(timeSeries.values().size())
 {
   m_boundingRect = QRectF(m_minX, m_minY, (m_maxX - m_minX), (m_maxY - m_minY));
   m_minValue = m_minY;
   m_maxValue = m_maxY;
-  m_units = QString::fromStdString(timeSeries.units);
+  m_units = QString::fromStdString(timeSeries.units());
   m_fracDaysOffset = 0.0;
-  m_x = m_timeSeries.daysFromFirstReport();
-  m_y = m_timeSeries.values;
+  m_seconds = m_timeSeries.seconds();
+  m_y = m_timeSeries.values();
 }
 
 TimeSeriesLinePlotData::TimeSeriesLinePlotData(TimeSeries timeSeries, double fracDaysOffset)
 : m_timeSeries(timeSeries),
   m_minX(timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())),
-  m_maxX(timeSeries.daysFromFirstReport()[timeSeries.daysFromFirstReport().size()-1]+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())), // end day
+  m_maxX(static_cast<double>(timeSeries.seconds().back() - timeSeries.seconds().front())/86400.0+timeSeries.firstReportDateTime().date().dayOfYear()+totalDays(timeSeries.firstReportDateTime().time())), // end day
   m_minY(timeSeries.minimum()),
   m_maxY(timeSeries.maximum()),
-  m_size(timeSeries.values.size())
+  m_size(timeSeries.values().size())
 {
   m_boundingRect = QRectF(m_minX, m_minY, (m_maxX - m_minX), (m_maxY - m_minY));
   m_minValue = m_minY;
   m_maxValue = m_maxY;
-  m_units = QString::fromStdString(timeSeries.units);
+  m_units = QString::fromStdString(timeSeries.units());
   m_fracDaysOffset = fracDaysOffset; // note updating in xValue does not affect scaled axis
-  m_x = m_timeSeries.daysFromFirstReport();
-  m_y = m_timeSeries.values;
+  m_seconds = m_timeSeries.seconds();
+  m_y = m_timeSeries.values();
 }
 
 TimeSeriesLinePlotData::~TimeSeriesLinePlotData()
@@ -80,7 +80,7 @@ TimeSeriesLinePlotData* TimeSeriesLinePlotData::copy() const
 
 double TimeSeriesLinePlotData::x(size_t pos) const
 {
-  return m_x[pos] + m_fracDaysOffset + m_minX; // hourly
+  return static_cast<double>(m_seconds[pos] - m_seconds[0])/86400.0 + m_fracDaysOffset + m_minX; // hourly
 }
 
 double TimeSeriesLinePlotData::y(size_t pos) const
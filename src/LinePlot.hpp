@@ -196,9 +196,9 @@ private:
   QRectF m_boundingRect;
   QString m_units;
   double m_fracDaysOffset;
-  // testing Vector class
-  std::vector<double> m_x;
-  std::vector<double> m_y;
+  // views of the time series data, shared rather than copied
+  TimeSeriesArray<long long> m_seconds;
+  TimeSeriesArray<double> m_y;
 };
 
 /** VectorLinePlotData converts two Vectors into Line plot data
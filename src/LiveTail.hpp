@@ -0,0 +1,213 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_LIVETAIL_HPP
+#define RESULTSVIEWER_LIVETAIL_HPP
+
+#include "SqlFile.hpp"
+#include "TimeSeriesLoader.hpp"
+#include "Tracer.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <optional>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include <cstdint>
+
+namespace resultsviewer{
+
+/**
+LiveTail follows time series in a results file that a running simulation is still writing. Each poll first checks
+whether anything has been committed since the last one, from sqlite's data version and the sizes and modification
+times of the file and its write-ahead log, and only then reads the report data written since: one query per
+environment period for all the series followed in it, by rowid range, so following many series costs time
+proportional to the new rows rather than to the lengths of the series. The new reports are appended to the series
+without copying them where the series' storage has room. A LiveTail is not thread safe; use it from one thread.
+*/
+class LiveTail
+{
+public:
+  // A followed series that grew: the whole series, of which the reports [from, end) are new
+  struct Update
+  {
+    size_t id;
+    TimeSeries series;
+    size_t from;
+  };
+
+  explicit LiveTail(const std::string &path) : m_path(path), m_file(path, SqlFile::OpenMode::ReadOnly),
+    m_dataVersion(-1), m_pending(false)
+  {}
+
+  bool isValid() const
+  {
+    return m_file.connectionOpen();
+  }
+
+  const std::string &path() const
+  {
+    return m_path;
+  }
+
+  // Follow series, read from the file for request, under id. Reports after the series' last one are appended by the
+  // next poll, including any written between reading the series and following it. Returns false if the variable is
+  // not in the file or the series is empty.
+  bool follow(size_t id, const TimeSeriesRequest &request, const TimeSeries &series)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("LiveTail::follow", "sql");
+    const DataDictionaryItem *item = m_file.dataDictionaryItem(request.envPeriod, request.reportingFrequency,
+      request.name, request.keyValue);
+    if (!item || series.values().empty()) {
+      return false;
+    }
+    std::optional<TailPosition> position = m_file.tailPosition(item->envPeriodIndex, series.seconds().back());
+    if (!position) {
+      return false;
+    }
+    unfollow(id);
+    auto period = m_periods.find(item->envPeriodIndex);
+    if (period == m_periods.end()) {
+      period = m_periods.emplace(item->envPeriodIndex, Period{ *position, {} }).first;
+    } else if (position->lastReportDataIndex < period->second.position.lastReportDataIndex) {
+      // read from the earlier of the two, reports the other series already has are skipped
+      period->second.position = *position;
+    }
+    period->second.series.push_back(Followed{ id, item->index, item->units, series });
+    m_pending = true;
+    return true;
+  }
+
+  void unfollow(size_t id)
+  {
+    for (auto period = m_periods.begin(); period != m_periods.end();) {
+      auto &series = period->second.series;
+      series.erase(std::remove_if(series.begin(), series.end(), [id](const Followed &followed) {
+        return followed.id == id; }), series.end());
+      period = series.empty() ? m_periods.erase(period) : std::next(period);
+    }
+  }
+
+  // Number of series followed
+  size_t size() const
+  {
+    size_t result = 0;
+    for (const auto &period : m_periods) {
+      result += period.second.series.size();
+    }
+    return result;
+  }
+
+  // Append the reports written since the last poll to the followed series, returning the series that grew
+  std::vector<Update> poll()
+  {
+    std::vector<Update> result;
+    if (m_periods.empty() || !changed()) {
+      return result;
+    }
+    RESULTSVIEWER_TRACE_SCOPE("LiveTail::poll", "sql");
+    for (auto &period : m_periods) {
+      std::vector<int> indices;
+      for (const auto &followed : period.second.series) {
+        indices.push_back(followed.dictionaryIndex);
+      }
+      // a variable followed by more than one series is read once
+      std::sort(indices.begin(), indices.end());
+      indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+      TimeSeriesColumns columns = m_file.timeSeriesColumnsAfter(period.second.position, indices);
+      for (auto &followed : period.second.series) {
+        size_t column = std::lower_bound(indices.begin(), indices.end(), followed.dictionaryIndex) - indices.begin();
+        std::optional<TimeSeries> added = m_file.timeSeries(columns, column, followed.units);
+        if (!added) {
+          continue;
+        }
+        const TimeSeriesArray<long long> &seconds = added->seconds();
+        size_t skip = std::upper_bound(seconds.begin(), seconds.end(), followed.series.seconds().back()) - seconds.begin();
+        if (skip == seconds.size()) {
+          continue;
+        }
+        size_t from = followed.series.values().size();
+        followed.series = followed.series.appended(seconds.data() + skip, added->values().data() + skip,
+          seconds.size() - skip);
+        result.push_back(Update{ followed.id, followed.series, from });
+      }
+    }
+    return result;
+  }
+
+private:
+  struct Followed
+  {
+    size_t id;
+    int dictionaryIndex;
+    std::string units;
+    TimeSeries series;
+  };
+
+  struct Period
+  {
+    TailPosition position;
+    std::vector<Followed> series;
+  };
+
+  // Size and modification time of a file, zero if it does not exist
+  static std::pair<uintmax_t, long long> stamp(const std::string &path)
+  {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+      return std::make_pair(0, 0);
+    }
+    long long modified = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    return std::make_pair(size, ec ? 0 : modified);
+  }
+
+  // True if anything may have been written since the last call. Either check alone can miss a change: the data
+  // version cannot be read while a writer holds an exclusive lock, and a commit can leave both size and time as they
+  // were when the clock is coarse.
+  bool changed()
+  {
+    long long version = m_file.dataVersion();
+    std::vector<std::pair<uintmax_t, long long>> stamps{ stamp(m_path), stamp(m_path + "-wal") };
+    bool result = m_pending || version != m_dataVersion || stamps != m_stamps;
+    m_pending = false;
+    m_dataVersion = version;
+    m_stamps = stamps;
+    return result;
+  }
+
+  std::string m_path;
+  SqlFile m_file;
+  long long m_dataVersion;
+  std::vector<std::pair<uintmax_t, long long>> m_stamps;
+  // a series was followed since the last poll, so read whatever is new for it regardless
+  bool m_pending;
+  std::map<int, Period> m_periods;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_LIVETAIL_HPP
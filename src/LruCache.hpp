@@ -0,0 +1,158 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_LRUCACHE_HPP
+#define RESULTSVIEWER_LRUCACHE_HPP
+
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+LruCache holds values up to a budget of bytes, evicting the least recently used values when it goes over. The size
+of each value is given when it is added. The most recently added value is always kept, even if it alone is over the
+budget. All members lock, so one cache can be shared between threads; values should be cheap to copy (shared
+pointers) since lookups return copies.
+*/
+template <typename Key, typename Value> class LruCache
+{
+public:
+  explicit LruCache(size_t budget) : m_budget(budget), m_bytes(0)
+  {}
+
+  // The value for key, which becomes the most recently used, if it is cached
+  std::optional<Value> get(const Key &key)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter == m_index.end()) {
+      return std::nullopt;
+    }
+    m_entries.splice(m_entries.begin(), m_entries, iter->second);
+    return iter->second->value;
+  }
+
+  bool contains(const Key &key) const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.count(key) > 0;
+  }
+
+  // Add or replace the value for key as the most recently used, then evict down to the budget
+  void put(const Key &key, const Value &value, size_t bytes)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_index.find(key);
+    if (iter != m_index.end()) {
+      m_bytes -= iter->second->bytes;
+      m_entries.erase(iter->second);
+      m_index.erase(iter);
+    }
+    m_entries.push_front(Entry{ key, value, bytes });
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+    evict();
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+  }
+
+  // Drop every value whose key satisfies pred
+  template <typename Pred> void removeIf(Pred pred)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+      if (pred(iter->key)) {
+        m_bytes -= iter->bytes;
+        m_index.erase(iter->key);
+        iter = m_entries.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+  }
+
+  // Bytes held, as given to put
+  size_t bytes() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+  }
+
+  size_t budget() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+  }
+
+  void setBudget(size_t budget)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budget;
+    evict();
+  }
+
+private:
+  struct Entry
+  {
+    Key key;
+    Value value;
+    size_t bytes;
+  };
+
+  void evict()
+  {
+    while (m_bytes > m_budget && m_entries.size() > 1) {
+      m_bytes -= m_entries.back().bytes;
+      m_index.erase(m_entries.back().key);
+      m_entries.pop_back();
+    }
+  }
+
+  size_t m_budget;
+  size_t m_bytes;
+  std::list<Entry> m_entries; // most recently used first
+  std::unordered_map<Key, typename std::list<Entry>::iterator> m_index;
+  mutable std::mutex m_mutex;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_LRUCACHE_HPP
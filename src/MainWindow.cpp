@@ -30,6 +30,8 @@
 #include <AboutBox.hpp>
 #include "ChangeAliasDialog.hpp"
 #include "TimeSeries.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
 #include <optional>
 
 //#include "../utilities/core/String.hpp"
@@ -40,9 +42,12 @@
 #include <QDesktopServices>
 #include <QDrag>
 #include <QProcess>
+#include <QPointer>
 #include <QProgressDialog>
 #include <QSplitter>
 #include <QTemporaryFile>
+#include <QTextCodec>
+#include <QTextDocument>
 #include <QTimer>
 #include <QToolBar>
 #include <QUrl>
@@ -54,7 +59,7 @@ using openstudio::ReportingFrequency;
 namespace resultsviewer{
 
   MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
-    : QMainWindow(parent, flags)
+    : QMainWindow(parent, flags), m_loader(m_threadPool), m_rollupStatistic(RollupStatistic::Mean)
   {
     // plot number used when plots are created - keeps track of max number created
     m_plotTitleNumber = 0;
@@ -109,8 +114,15 @@ namespace resultsviewer{
     connect(exitAction, &QAction::triggered, this, &MainWindow::close);
     ui.menuFile->addAction(exitAction);
 
+    // rollups of finer reports, made from series already loaded where possible
+    createRollupMenu();
+    m_loader.setCacheBudget(256 * 1024 * 1024);
+
     // Data manager
     m_data = new resultsviewer::ResultsViewerData();
+    m_data->setWorkers(&m_threadPool);
+    // series are read on connections leased from the open file, with its columnar cache
+    m_loader.setConnections([this](const std::string &path) { return m_data->connectionPool(QString::fromStdString(path)); });
 
     // File toolbar
     createFileToolBar();
@@ -196,6 +208,8 @@ namespace resultsviewer{
 
   MainWindow::~MainWindow()
   {
+    // queued loads return early, the pool joins when it is destroyed
+    for (const auto &token : m_loadTokens) token.cancel();
   }
 
 
@@ -277,52 +291,6 @@ namespace resultsviewer{
     openFileList(fileList, false);
   }
 
-  void MainWindow::loadFile(const QString& alias, const QString& filename)
-  {
-    int index;
-    switch(m_data->addFile( alias, filename))
-    {
-    case RVD_UNSUPPORTEDFILEFORMAT:
-      QMessageBox::information(this, tr("File Open"), tr("Unsupported file format."));
-      break;
-    case RVD_FILEALREADYOPENED:
-      QMessageBox::information(this, tr("File Open"), tr("File already opened."));
-      break;
-    case RVD_FILEDOESNOTEXIST:
-      QMessageBox::information(this, tr("File Open"), tr("File not found:\n" + filename.toUtf8()));
-      break;
-    case RVD_UNSUPPORTEDVERSION:
-      QMessageBox::information(this, tr("File Open"), tr("Unsupported EnergyPlus version. Continuing, unknown errors may occur."));
-    case RVD_SUCCESS:
-      m_treeView->displayFile(alias,  m_data->sqlFile(filename), resultsviewer::TreeView::tvdtVariableName);
-
-      index = m_fileComboBox->count();
-      m_fileComboBox->addItem(alias);
-      m_fileComboBox->setItemData(index,filename,Qt::ToolTipRole);
-      m_fileComboBox->setCurrentIndex(index);
-
-      m_tableView->addFile(alias, m_data->sqlFile(filename));
-
-      m_lastPathOpened = QFileInfo(filename).absoluteFilePath();
-
-      index = m_recentFiles.indexOf(filename);
-      if (index>-1)
-      {
-        m_recentFiles.removeAt(index);
-        m_recentAliases.removeAt(index);
-      }
-      m_recentFiles.prepend(filename);
-      m_recentAliases.prepend(alias);
-      updateRecentFileActions();
-
-      addEPlusHTML(filename);
-
-      break;
-    default:
-      QMessageBox::information(this, tr("File Open"), tr("File open failed."));
-    }
-  }
-
   void MainWindow::slotCloseTab(int index)
   {
     m_mainTabDock->widget(index)->close();
@@ -346,25 +314,23 @@ namespace resultsviewer{
   }
 
 
-  void MainWindow::addEPlusHTML(const QString& filename)
+  void MainWindow::addEPlusHTML(const QString& filename, const QByteArray& html)
   {
-    QFileInfo filePath(filename);
     QString folder = QFileInfo(filename).absolutePath();
     QString abups = folder + "/eplustbl.htm";
-    if (QFile::exists(abups))
-    {
-      // text browser for ABUPS
-      auto browser = new BrowserView(this);
-      connect(browser, &BrowserView::signalClose, this, &MainWindow::slotCloseBrowser);
-      connect(browser, &BrowserView::signalFloatOrDockMe, this, &MainWindow::floatOrDockBrowser);
-      browser->setSource(QUrl::fromLocalFile(abups));
-      browser->setFilename(filename);
-      browser->setAlias(m_data->alias(filename));
-      browser->scrollToAnchor("AnnualBuildingUtilityPerformanceSummary::EntireFacility");
-      m_mainTabDock->addTab(browser, browser->windowTitle());
-      m_mainTabDock->setCurrentIndex(m_mainTabDock->count()-1);
-      m_browserList.push_back(browser);
-    }
+    // text browser for ABUPS, shown from the tables read by the worker that opened the file and resolving relative
+    // links against the file they came from
+    auto browser = new BrowserView(this);
+    connect(browser, &BrowserView::signalClose, this, &MainWindow::slotCloseBrowser);
+    connect(browser, &BrowserView::signalFloatOrDockMe, this, &MainWindow::floatOrDockBrowser);
+    browser->document()->setBaseUrl(QUrl::fromLocalFile(abups));
+    browser->setHtml(QTextCodec::codecForHtml(html)->toUnicode(html));
+    browser->setFilename(filename);
+    browser->setAlias(m_data->alias(filename));
+    browser->scrollToAnchor("AnnualBuildingUtilityPerformanceSummary::EntireFacility");
+    m_mainTabDock->addTab(browser, browser->windowTitle());
+    m_mainTabDock->setCurrentIndex(m_mainTabDock->count()-1);
+    m_browserList.push_back(browser);
   }
 
 
@@ -408,7 +374,7 @@ namespace resultsviewer{
       if (aliasFilename.count() != 2)
         return false;
       else
-        loadFile(aliasFilename[0],aliasFilename[1]);
+        openFileList(QStringList() << aliasFilename[1], false); // the alias is found again in the recent files
     }
     return true;
   }
@@ -423,6 +389,14 @@ namespace resultsviewer{
     m_recentAliases = settings.value("recentAliasesSL").toStringList();
     m_lastPathOpened = settings.value("lastPathOpened").toString();
     m_lastImageSavedPath = settings.value("lastImageSavedPath").toString();
+    m_data->setColumnarCacheEnabled(settings.value("columnarCache", false).toBool());
+    int rollupPeriod = settings.value("rollupPeriod", -1).toInt();
+    m_rollupPeriod.reset();
+    if ((rollupPeriod >= 0) && (rollupPeriod <= static_cast<int>(RollupPeriod::Monthly))) m_rollupPeriod = static_cast<RollupPeriod>(rollupPeriod);
+    int rollupStatistic = settings.value("rollupStatistic", static_cast<int>(RollupStatistic::Mean)).toInt();
+    if ((rollupStatistic < 0) || (rollupStatistic > static_cast<int>(RollupStatistic::Integral))) rollupStatistic = static_cast<int>(RollupStatistic::Mean);
+    m_rollupStatistic = static_cast<RollupStatistic>(rollupStatistic);
+    updateRollupMenu();
     updateRecentFileActions();
   }
 
@@ -431,6 +405,9 @@ namespace resultsviewer{
     int i;
     evt->accept();
     writeSettings();
+    // files still being opened are dropped, an add already scheduled finds nothing to add
+    for (auto &opening : m_openingFiles) opening.opener->cancel();
+    m_openingFiles.clear();
     delete m_data;
 
     for (i=m_plotViewList.size() -1; i>-1; i--)
@@ -461,17 +438,15 @@ namespace resultsviewer{
     settings.setValue("recentAliasesSL", m_recentAliases);
     settings.setValue("lastPathOpened", m_lastPathOpened);
     settings.setValue("lastImageSavedPath", m_lastImageSavedPath);
+    settings.setValue("columnarCache", m_data->columnarCacheEnabled());
+    settings.setValue("rollupPeriod", m_rollupPeriod ? static_cast<int>(*m_rollupPeriod) : -1);
+    settings.setValue("rollupStatistic", static_cast<int>(m_rollupStatistic));
   }
 
   void MainWindow::slotDragPlotViewData(const std::vector<resultsviewer::ResultsViewerPlotData> &rvplotData)
   {
     QApplication::setOverrideCursor(Qt::WaitCursor);
-    std::vector<PlotViewData> plotViewDataVec;
-    std::vector<resultsviewer::ResultsViewerPlotData>::const_iterator rvPlotDataVecIt;
-    for(rvPlotDataVecIt = rvplotData.begin(); rvPlotDataVecIt != rvplotData.end(); ++rvPlotDataVecIt)
-    {
-      plotViewDataVec.push_back(plotViewDataFromResultsViewerPlotData(*rvPlotDataVecIt));
-    }
+    std::vector<PlotViewData> plotViewDataVec = plotViewDataFromResultsViewerPlotData(rvplotData);
 
     if (plotViewDataVec.size() > 0)
     {
@@ -484,6 +459,51 @@ namespace resultsviewer{
   }
 
   resultsviewer::PlotViewData MainWindow::plotViewDataFromResultsViewerPlotData(const resultsviewer::ResultsViewerPlotData &rvplotData)
+  {
+    return plotViewDataFromResultsViewerPlotData(std::vector<resultsviewer::ResultsViewerPlotData>(1, rvplotData)).front();
+  }
+
+  std::vector<resultsviewer::PlotViewData> MainWindow::plotViewDataFromResultsViewerPlotData(const std::vector<resultsviewer::ResultsViewerPlotData> &rvplotDataVec)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::plotViewDataFromResultsViewerPlotData", "ui");
+    // time series are read in one pass over ReportData per (file, environment period) rather than one query per variable
+    std::vector<std::optional<TimeSeries> > timeSeriesVec(rvplotDataVec.size());
+    std::map<std::pair<QString, int>, std::vector<std::pair<size_t, const DataDictionaryItem *> > > batches;
+    for (size_t i = 0; i < rvplotDataVec.size(); ++i)
+    {
+      const resultsviewer::ResultsViewerPlotData &rvplotData = rvplotDataVec[i];
+      if (rvplotData.dataType != RVD_TIMESERIES) continue;
+      SqlFilePool::Lease sqlFile = m_data->sqlFile(rvplotData.filename);
+      if (!sqlFile || !sqlFile->connectionOpen()) continue;
+      const DataDictionaryItem *item = sqlFile->dataDictionaryItem(rvplotData.envPeriod.toStdString(), rvplotData.reportFreq.toStdString(),
+        rvplotData.variableName.toStdString(), rvplotData.keyName.toStdString());
+      if (item) batches[std::make_pair(rvplotData.filename, item->envPeriodIndex)].push_back(std::make_pair(i, item));
+    }
+
+    for (const auto &batch : batches)
+    {
+      std::vector<int> dictionaryIndices;
+      for (const auto &request : batch.second) dictionaryIndices.push_back(request.second->index);
+      SqlFilePool::Lease sqlFile = m_data->sqlFile(batch.first.first);
+      TimeSeriesColumns columns = sqlFile->timeSeriesColumns(batch.first.second, dictionaryIndices);
+      for (size_t column = 0; column < batch.second.size(); ++column)
+      {
+        timeSeriesVec[batch.second[column].first] = sqlFile->timeSeries(columns, column, batch.second[column].second->units);
+      }
+    }
+
+    std::vector<resultsviewer::PlotViewData> plotViewDataVec;
+    QStringList missing;
+    for (size_t i = 0; i < rvplotDataVec.size(); ++i)
+    {
+      plotViewDataVec.push_back(plotViewDataFromResultsViewerPlotData(rvplotDataVec[i], timeSeriesVec[i], missing));
+    }
+    showMissingSeries(missing);
+    return plotViewDataVec;
+  }
+
+  resultsviewer::PlotViewData MainWindow::plotViewDataFromResultsViewerPlotData(const resultsviewer::ResultsViewerPlotData &rvplotData, const std::optional<TimeSeries> &ts,
+    QStringList &missing)
   {
 
     resultsviewer::PlotViewData plotViewData;
@@ -500,6 +520,7 @@ namespace resultsviewer{
       if (!rvplotData.keyName.isEmpty()) plotViewData.legendName = "(%1) " + rvplotData.variableName + "," + rvplotData.keyName;
       plotViewData.alias.append(m_data->alias(rvplotData.filename));
       plotViewData.plotSource.append(rvplotData.filename);
+      plotViewData.connections.push_back(m_data->connectionPool(rvplotData.filename));
       plotViewData.plotTitle = rvplotData.reportFreq + "," + rvplotData.variableName;
       plotViewData.windowTitle = rvplotData.filename + " : " + rvplotData.variableName;
       break;
@@ -512,21 +533,36 @@ namespace resultsviewer{
       plotViewData.windowTitle = rvplotData.filename + " : " + rvplotData.variableName;
 
 
-      if (m_data->sqlFile(rvplotData.filename).connectionOpen())
+      if (std::shared_ptr<SqlFilePool> connections = m_data->connectionPool(rvplotData.filename))
       {
         plotViewData.alias.append(m_data->alias(rvplotData.filename));
         plotViewData.plotSource.append(rvplotData.filename);
-        std::optional<TimeSeries> ts = m_data->sqlFile(rvplotData.filename).timeSeries(openstudio::toString(rvplotData.envPeriod), openstudio::toString(rvplotData.reportFreq), openstudio::toString(rvplotData.variableName), openstudio::toString(rvplotData.keyName));
+        plotViewData.connections.push_back(connections);
         if (ts)
         {
           if (ts->values().size() > 0) {
             plotViewData.ts = ts;
+            if (m_rollupPeriod && Rollup::appliesTo(*m_rollupPeriod, rvplotData.reportFreq.toStdString()))
+            {
+              // the rollup is made once per loaded series and derived from the finer rollups already made of it
+              plotViewData.ts = ts->rolledUp(*m_rollupPeriod, m_rollupStatistic);
+              plotViewData.interval = QString::fromStdString(Rollup::intervalName(*m_rollupPeriod));
+              QString rollupName = QString::fromStdString(Rollup::periodName(*m_rollupPeriod) + " " + Rollup::statisticName(m_rollupStatistic));
+              plotViewData.plotTitle = rollupName + "," + rvplotData.variableName;
+              plotViewData.legendName = plotViewData.legendName + " [" + rollupName + "]";
+            }
+            else if (!isTemporaryCopy(rvplotData.filename))
+            {
+              // the reports as written, which the plot can follow while a simulation is still writing the file
+              plotViewData.request = TimeSeriesRequest{ rvplotData.filename.toStdString(), rvplotData.envPeriod.toStdString(),
+                rvplotData.reportFreq.toStdString(), rvplotData.variableName.toStdString(), rvplotData.keyName.toStdString() };
+            }
           } else {
-            QMessageBox::information(this, tr("No Time Data"), "No time to plot for " + rvplotData.variableName + ".\nCheck the input file for environment period:\n" + rvplotData.envPeriod + ".");
+            missing << "No time to plot for " + rvplotData.variableName + ".\nCheck the input file for environment period:\n" + rvplotData.envPeriod + ".";
           }
         }
         else { // ticket 174
-          QMessageBox::information(this, tr("No Plot Data"), "No data to plot for " + rvplotData.variableName + ".\nThe input file likely scheduled off reporting for environment period:\n" + rvplotData.envPeriod + ".");
+          missing << "No data to plot for " + rvplotData.variableName + ".\nThe input file likely scheduled off reporting for environment period:\n" + rvplotData.envPeriod + ".";
         }
       }
       break;
@@ -537,6 +573,12 @@ namespace resultsviewer{
     return plotViewData;
   }
 
+  void MainWindow::showMissingSeries(const QStringList &missing)
+  {
+    if (missing.isEmpty()) return;
+    QMessageBox::information(this, tr("No Plot Data"), missing.join("\n\n"));
+  }
+
   resultsviewer::PlotViewData MainWindow::plotViewDataDifference(const resultsviewer::PlotViewData &plotViewData1, const resultsviewer::PlotViewData &plotViewData2)
   {
     resultsviewer::PlotViewData plotViewData;
@@ -547,168 +589,270 @@ namespace resultsviewer{
     plotViewData.plotTitle = plotViewData1.plotTitle + " - " + plotViewData2.plotTitle;
     plotViewData.windowTitle = plotViewData1.windowTitle + " - " + plotViewData2.windowTitle;
 
-    // TODO - handle different intervals
-    plotViewData.interval = plotViewData1.interval;
-
     plotViewData.alias.append(plotViewData1.alias);
     plotViewData.alias.append(plotViewData2.alias);
     plotViewData.plotSource.append(plotViewData1.plotSource);
     plotViewData.plotSource.append(plotViewData2.plotSource);
 
-    plotViewData.ts = *plotViewData1.ts - *plotViewData2.ts;
+    plotViewData.interval = plotViewData1.interval;
+    if (!plotViewData1.ts || !plotViewData2.ts) return plotViewData;
+
+    // series at different intervals are merged onto the finer of the two, interpolating the coarser one
+    if ((plotViewData1.interval != plotViewData2.interval) && (plotViewData2.ts->seconds().size() > plotViewData1.ts->seconds().size()))
+    {
+      plotViewData.interval = plotViewData2.interval;
+    }
 
-    // TODO - check timeseries ptr and report issues if any
+    resultsviewer::TimeSeries difference = *plotViewData1.ts - *plotViewData2.ts;
+    if (difference.values().empty())
+    {
+      QMessageBox::warning(this, tr("Difference"), tr("The two series do not overlap in time."));
+      return plotViewData;
+    }
+    plotViewData.ts = difference;
 
     return plotViewData;
   }
 
-  void MainWindow::slotAddFloodPlot(const std::vector<resultsviewer::ResultsViewerPlotData> &fpVec)
+  QPointer<QProgressDialog> MainWindow::beginLoad(const CancellationToken &token, const QString &label, int count,
+    const std::function<void ()> &onCanceled)
   {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    std::vector<resultsviewer::ResultsViewerPlotData>::const_iterator fpVecIt;
-    for(fpVecIt = fpVec.begin(); fpVecIt != fpVec.end(); ++fpVecIt)
+    m_loadTokens.push_back(token);
+    QPointer<QProgressDialog> progressdialog = new QProgressDialog(label, "Cancel", 0, count, this);
+    progressdialog->setMinimumDuration(1000);
+    progressdialog->setValue(0);
+    connect(progressdialog, &QProgressDialog::canceled, this, [this, token, progressdialog, onCanceled]() {
+      token.cancel();
+      endLoad(token, progressdialog);
+      if (onCanceled) onCanceled();
+    });
+    return progressdialog;
+  }
+
+  void MainWindow::endLoad(const CancellationToken &token, const QPointer<QProgressDialog> &progressdialog)
+  {
+    m_loadTokens.erase(std::remove_if(m_loadTokens.begin(), m_loadTokens.end(),
+      [&token](const CancellationToken &t) { return t.flag() == token.flag(); }), m_loadTokens.end());
+    if (progressdialog) progressdialog->deleteLater();
+  }
+
+  void MainWindow::loadPlotViewData(const std::vector<resultsviewer::ResultsViewerPlotData> &rvplotDataVec, const QString &label,
+    const std::function<void (const PlotViewData &)> &onLoaded,
+    const std::function<void (const std::vector<PlotViewData> &)> &onFinished,
+    const std::function<void ()> &onCanceled)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::loadPlotViewData", "ui");
+    if (rvplotDataVec.empty()) return;
+
+    CancellationToken token;
+    QPointer<QProgressDialog> progressdialog = beginLoad(token, label, rvplotDataVec.size(), onCanceled);
+
+    auto results = std::make_shared<std::vector<PlotViewData> >(rvplotDataVec.size());
+    auto remaining = std::make_shared<size_t>(rvplotDataVec.size());
+    // the series with nothing to plot are reported together once all have arrived, rather than in a modal box each
+    auto missing = std::make_shared<QStringList>();
+    // items arrive on worker threads, build and show them on the GUI thread
+    auto arrived = [=](size_t index, const std::optional<TimeSeries> &ts, const std::shared_ptr<IlluminanceMapLoad> &illuminanceMap) {
+      QMetaObject::invokeMethod(this, [=]() {
+        if (token.isCanceled()) return;
+        const resultsviewer::ResultsViewerPlotData &rvplotData = rvplotDataVec[index];
+        PlotViewData pd = plotViewDataFromResultsViewerPlotData(rvplotData, ts, *missing);
+        if (rvplotData.dataType == RVD_ILLUMINANCEMAP)
+        {
+          if (illuminanceMap && illuminanceMap->cache) pd.illuminanceMap = illuminanceMap;
+          else *missing << "No illuminance map data to plot for " + rvplotData.keyName + ".";
+        }
+        (*results)[index] = pd;
+        if (onLoaded) onLoaded(pd);
+        --(*remaining);
+        if (progressdialog) progressdialog->setValue(rvplotDataVec.size() - *remaining);
+        if (*remaining == 0)
+        {
+          endLoad(token, progressdialog);
+          if (onFinished) onFinished(*results);
+          showMissingSeries(*missing);
+        }
+      }, Qt::QueuedConnection);
+    };
+
+    std::vector<TimeSeriesRequest> requests;
+    std::vector<size_t> requestIndices;
+    for (size_t i = 0; i < rvplotDataVec.size(); ++i)
     {
-      resultsviewer::PlotViewData pd = plotViewDataFromResultsViewerPlotData(*fpVecIt);
-      if (pd.ts) // create plot widget only if timeseries data available
+      const resultsviewer::ResultsViewerPlotData &rvplotData = rvplotDataVec[i];
+      if (rvplotData.dataType == RVD_ILLUMINANCEMAP)
       {
-        auto fp = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_FLOODPLOT);
-        fp->plotViewData(pd, std::function<bool ()>());
-        fp->show();
-        emit (signalAddPlot(fp));
+        // a map is read whole, with its first frame, on the same pool as the series
+        std::shared_ptr<SqlFilePool> connections = m_data->connectionPool(rvplotData.filename);
+        std::string mapName = rvplotData.dbIdentifier.toStdString();
+        m_threadPool.submit([=]() {
+          std::shared_ptr<IlluminanceMapLoad> illuminanceMap;
+          if (connections && !token.isCanceled())
+          {
+            try
+            {
+              illuminanceMap = PlotView::readIlluminanceMap(connections, mapName);
+            }
+            catch (...)
+            {
+              // reported with the series that have nothing to plot
+            }
+          }
+          arrived(i, std::nullopt, illuminanceMap);
+        });
+        continue;
       }
+      requests.push_back({ rvplotData.filename.toStdString(), rvplotData.envPeriod.toStdString(), rvplotData.reportFreq.toStdString(),
+        rvplotData.variableName.toStdString(), rvplotData.keyName.toStdString() });
+      requestIndices.push_back(i);
+    }
+    if (!requests.empty())
+    {
+      m_loader.load(requests, token, [=](size_t index, const std::optional<TimeSeries> &ts) {
+        arrived(requestIndices[index], ts, nullptr);
+      });
     }
-    QApplication::restoreOverrideCursor();
+  }
+
+  void MainWindow::slotAddFloodPlot(const std::vector<resultsviewer::ResultsViewerPlotData> &fpVec)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddFloodPlot", "ui");
+    // each flood plot opens as soon as its data arrives
+    loadPlotViewData(fpVec, tr("Generating Flood Plot"), [this](const PlotViewData &data) {
+      if (!data.ts) return; // create plot widget only if timeseries data available
+      resultsviewer::PlotViewData pd = data;
+      auto fp = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_FLOODPLOT);
+      fp->plotViewData(pd, std::function<bool ()>());
+      fp->show();
+      emit (signalAddPlot(fp));
+    });
   }
 
   void MainWindow::slotAddIlluminancePlot(const std::vector<resultsviewer::ResultsViewerPlotData> &ipVec)
   {
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    std::vector<resultsviewer::ResultsViewerPlotData>::const_iterator ipVecIt;
-    for(ipVecIt = ipVec.begin(); ipVecIt != ipVec.end(); ++ipVecIt)
-    {
-      resultsviewer::PlotViewData pd = plotViewDataFromResultsViewerPlotData(*ipVecIt);
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddIlluminancePlot", "ui");
+    // each map opens as soon as it has been read
+    loadPlotViewData(ipVec, tr("Generating Illuminance Map"), [this](const PlotViewData &data) {
+      if (!data.illuminanceMap) return; // create plot widget only if the map has reports
+      resultsviewer::PlotViewData pd = data;
       auto ip = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_ILLUMINANCEPLOT);
       ip->plotViewData(pd, std::function<bool ()>());
       ip->show();
       emit (signalAddPlot(ip));
-    }
-    QApplication::restoreOverrideCursor();
+    });
   }
 
   void MainWindow::slotAddIlluminancePlotComparison(const std::vector<resultsviewer::ResultsViewerPlotData> &ipVec)
   {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddIlluminancePlotComparison", "ui");
     if (ipVec.size() != 2) return;
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    resultsviewer::PlotViewData pd0 = plotViewDataFromResultsViewerPlotData(ipVec[0]);
-    resultsviewer::PlotViewData pd1 = plotViewDataFromResultsViewerPlotData(ipVec[1]);
-    auto ip = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_ILLUMINANCEPLOT);
-    ip->plotViewDataDifference(pd0,pd1);
-    ip->show();
-    emit (signalAddPlot(ip));
-    QApplication::restoreOverrideCursor();
+    // the two maps are read and matched by date on the worker pool
+    QStringList missing;
+    auto pd0 = std::make_shared<PlotViewData>(plotViewDataFromResultsViewerPlotData(ipVec[0], std::nullopt, missing));
+    auto pd1 = std::make_shared<PlotViewData>(plotViewDataFromResultsViewerPlotData(ipVec[1], std::nullopt, missing));
+    std::shared_ptr<SqlFilePool> connections0 = m_data->connectionPool(ipVec[0].filename);
+    std::shared_ptr<SqlFilePool> connections1 = m_data->connectionPool(ipVec[1].filename);
+    if (!connections0 || !connections1) return;
+    std::string mapName0 = ipVec[0].dbIdentifier.toStdString();
+    std::string mapName1 = ipVec[1].dbIdentifier.toStdString();
+    QString names = ipVec[0].keyName + " and " + ipVec[1].keyName;
+
+    CancellationToken token;
+    QPointer<QProgressDialog> progressdialog = beginLoad(token, tr("Generating Illuminance Map"), 1, std::function<void ()>());
+    m_threadPool.submit([=]() {
+      std::shared_ptr<IlluminanceMapLoad> difference;
+      if (!token.isCanceled())
+      {
+        try
+        {
+          difference = PlotView::readIlluminanceMapDifference(connections0, mapName0, connections1, mapName1);
+        }
+        catch (...)
+        {
+          // reported below as nothing to plot
+        }
+      }
+      QMetaObject::invokeMethod(this, [=]() {
+        if (token.isCanceled()) return;
+        endLoad(token, progressdialog);
+        if (!difference || !difference->cache)
+        {
+          showMissingSeries(QStringList() << "No illuminance map data in common to plot for " + names + ".");
+          return;
+        }
+        auto ip = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_ILLUMINANCEPLOT);
+        ip->plotViewDataDifference(*pd0, *pd1, difference);
+        ip->show();
+        emit (signalAddPlot(ip));
+      }, Qt::QueuedConnection);
+    });
   }
 
 
 
   void MainWindow::slotAddLinePlot(const std::vector<resultsviewer::ResultsViewerPlotData> &lpVec)
   {
-    QProgressDialog *progressdialog = new QProgressDialog("Generating Line Plot", "Cancel", 0, lpVec.size() * 2, this);
-    progressdialog->setMinimumDuration(1000);
-    progressdialog->open();
-    int progress = 0;
-
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddLinePlot", "ui");
     if (lpVec.size() < 1) return;
 
-    std::vector<resultsviewer::PlotViewData> pdVec;
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    std::vector<resultsviewer::ResultsViewerPlotData>::const_iterator lpVecIt;
-    for (lpVecIt = lpVec.begin(); lpVecIt != lpVec.end() && !progressdialog->wasCanceled(); ++lpVecIt)
-    {
-      resultsviewer::PlotViewData pd = plotViewDataFromResultsViewerPlotData(*lpVecIt);
-      if (pd.ts) pdVec.push_back(pd);
-      ++progress;
-
-      progressdialog->setValue(progress);
-      QApplication::processEvents();
-    }
-
-    progressdialog->setMaximum(pdVec.size() + lpVec.size());
-
-    if (progressdialog->wasCanceled())
-    {
-      QApplication::restoreOverrideCursor();
-      return;
-    }
-
-    if (pdVec.size() > 0)
-    {
-      std::function<bool ()> canceledfunc = std::bind(&QProgressDialog::wasCanceled, progressdialog);
-      auto lp = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_LINEPLOT);
-      std::vector<resultsviewer::PlotViewData>::iterator pdVecIt;
-      for (pdVecIt = pdVec.begin(); pdVecIt != pdVec.end() && !progressdialog->wasCanceled(); ++pdVecIt)
+    // the plot opens with the first curve to arrive and the rest are added as they come in
+    auto lp = std::make_shared<QPointer<resultsviewer::PlotView> >();
+    loadPlotViewData(lpVec, tr("Generating Line Plot"), [this, lp](const PlotViewData &data) {
+      if (!data.ts) return;
+      resultsviewer::PlotViewData pd = data;
+      if (!*lp)
       {
-        lp->plotViewData(*pdVecIt, canceledfunc);
-        if (!progressdialog->wasCanceled())
-        {
-          ++progress;
-          progressdialog->setValue(progress);
-        }
+        *lp = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_LINEPLOT);
+        (*lp)->plotViewData(pd, std::function<bool ()>());
+        (*lp)->show();
+        emit (signalAddPlot(*lp));
       }
-
-      if (progressdialog->wasCanceled())
+      else
       {
-        QApplication::restoreOverrideCursor();
-        return;
+        (*lp)->plotViewData(pd, std::function<bool ()>());
       }
-
-      lp->show();
-      emit (signalAddPlot(lp));
-    }
-    QApplication::restoreOverrideCursor();
+    }, std::function<void (const std::vector<PlotViewData> &)>(), [lp]() {
+      // canceling discards the partial plot
+      if (*lp) (*lp)->close();
+    });
   }
 
 
   void MainWindow::slotAddFloodPlotComparison(const std::vector<resultsviewer::ResultsViewerPlotData> &fpVec)
   {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddFloodPlotComparison", "ui");
     if (fpVec.size() != 2) return;
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    resultsviewer::PlotViewData pd0 = plotViewDataFromResultsViewerPlotData(fpVec[0]);
-    resultsviewer::PlotViewData pd1 = plotViewDataFromResultsViewerPlotData(fpVec[1]);
-
-    if ( (pd0.ts) && (pd1.ts) ) // create plot widget only if timeseries data available
-    {
-      resultsviewer::PlotViewData plotViewData = plotViewDataDifference(pd0, pd1);
-      auto fp0minus1 = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_FLOODPLOT);
-      fp0minus1->plotViewData(plotViewData, std::function<bool ()>());
-      fp0minus1->show();
-      emit (signalAddPlot(fp0minus1));
-
-    }
-    QApplication::restoreOverrideCursor();
+    loadPlotViewData(fpVec, tr("Generating Flood Plot"), std::function<void (const PlotViewData &)>(), [this](const std::vector<PlotViewData> &pdVec) {
+      if ( (pdVec[0].ts) && (pdVec[1].ts) ) // create plot widget only if timeseries data available
+      {
+        resultsviewer::PlotViewData plotViewData = plotViewDataDifference(pdVec[0], pdVec[1]);
+        if (!plotViewData.ts) return;
+        auto fp0minus1 = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_FLOODPLOT);
+        fp0minus1->plotViewData(plotViewData, std::function<bool ()>());
+        fp0minus1->show();
+        emit (signalAddPlot(fp0minus1));
+      }
+    });
   }
 
   void MainWindow::slotAddLinePlotComparison(const std::vector<resultsviewer::ResultsViewerPlotData> &lpVec)
   {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotAddLinePlotComparison", "ui");
     if (lpVec.size() != 2) return;
 
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-
-    resultsviewer::PlotViewData pd0 = plotViewDataFromResultsViewerPlotData(lpVec[0]);
-    resultsviewer::PlotViewData pd1 = plotViewDataFromResultsViewerPlotData(lpVec[1]);
-
-    if ( (pd0.ts) && (pd1.ts) ) // create plot widget only if timeseries data available
-    {
-      resultsviewer::PlotViewData plotViewData = plotViewDataDifference(pd0, pd1);
-      auto lp0minus1 = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_LINEPLOT);
-      lp0minus1->plotViewData(plotViewData, std::function<bool ()>());
-      lp0minus1->show();
-      emit (signalAddPlot(lp0minus1));
-
-    }
-    QApplication::restoreOverrideCursor();
+    loadPlotViewData(lpVec, tr("Generating Line Plot"), std::function<void (const PlotViewData &)>(), [this](const std::vector<PlotViewData> &pdVec) {
+      if ( (pdVec[0].ts) && (pdVec[1].ts) ) // create plot widget only if timeseries data available
+      {
+        resultsviewer::PlotViewData plotViewData = plotViewDataDifference(pdVec[0], pdVec[1]);
+        if (!plotViewData.ts) return;
+        auto lp0minus1 = new resultsviewer::PlotView(m_lastImageSavedPath, RVPV_LINEPLOT);
+        lp0minus1->plotViewData(plotViewData, std::function<bool ()>());
+        lp0minus1->show();
+        emit (signalAddPlot(lp0minus1));
+      }
+    });
   }
 
   /*
@@ -817,6 +961,9 @@ namespace resultsviewer{
     }
     else
       menu.addAction(singleLinePlotAction);
+
+    menu.addSeparator();
+    menu.addMenu(m_rollupMenu);
   }
 
   void MainWindow::illuminanceMapTreeViewMenu(QMenu& menu)
@@ -847,13 +994,12 @@ namespace resultsviewer{
     {
       if ( item->type() != ddtKeyValue )
       {
-        if ((item->type() == ddtVariableName) && (item->childCount() == 0))
+        // branches are filled in when expanded, so a variable with keys may not have its children yet
+        if ((item->type() == ddtVariableName) && (item->childCount() == 0) && !m_treeView->canFetchMore(item))
         {// exclude RunPeriod
-          //        if (ReportingFrequency(openstudio::toString(item->parent()->text(0))) == ReportingFrequency::RunPeriod)
-          openstudio::SqlFile sqlFile = m_data->sqlFile(m_treeView->filenameFromTreeItem(item));
-          if (sqlFile.reportingFrequencyFromDB(openstudio::toString(item->parent()->text(0))))
-            if (*(sqlFile.reportingFrequencyFromDB(openstudio::toString(item->parent()->text(0)))) == ReportingFrequency::RunPeriod)
-              item->setSelected(false);
+          // the frequency is the branch name, so no connection to the file is needed
+          if (SqlFile::reportingFrequencyFromDB(item->parent()->text(0).toStdString()) == resultsviewer::ReportingFrequency::RunPeriod)
+            item->setSelected(false);
         }
         else
           item->setSelected(false);
@@ -896,6 +1042,9 @@ namespace resultsviewer{
     }
     else
       menu.addAction(singleLinePlotAction);
+
+    menu.addSeparator();
+    menu.addMenu(m_rollupMenu);
   }
 
   void MainWindow::illuminanceMapTableViewMenu(QMenu& menu)
@@ -967,9 +1116,7 @@ namespace resultsviewer{
 
   bool MainWindow::tableViewSelectedItemsCanBePlotted(int &timeseriesItemCount, int &illuminanceMapItemCount)
   {
-    QList<QTableWidgetItem *> selectedTableItems = m_tableView->selectedItems();
-
-    if (selectedTableItems.count() < 1) return false;
+    if (m_tableView->selectedRowCount() < 1) return false;
 
     // determine plot item types selected
     std::vector<int> selectedRows = m_tableView->selectedRows();
@@ -978,8 +1125,8 @@ namespace resultsviewer{
     timeseriesItemCount = 0;
     for (rowIter = selectedRows.begin(); rowIter != selectedRows.end(); ++rowIter)
     {
-      if (m_tableView->item(*rowIter, m_tableView->headerNames().indexOf("File"))->data(Qt::UserRole) == RVD_TIMESERIES) timeseriesItemCount++;
-      if (m_tableView->item(*rowIter, m_tableView->headerNames().indexOf("File"))->data(Qt::UserRole) == RVD_ILLUMINANCEMAP) illuminanceMapItemCount++;
+      if (m_tableView->dataType(*rowIter) == RVD_TIMESERIES) timeseriesItemCount++;
+      if (m_tableView->dataType(*rowIter) == RVD_ILLUMINANCEMAP) illuminanceMapItemCount++;
     }
 
     if ((timeseriesItemCount > 0) && (illuminanceMapItemCount > 0))
@@ -1071,6 +1218,62 @@ namespace resultsviewer{
     }
   }
 
+  void MainWindow::createRollupMenu()
+  {
+    m_rollupMenu = new QMenu(tr("&Roll Up Time Series"), this);
+    m_rollupMenu->setToolTip("Plot time series reported more often than the selected period as one value per period.");
+
+    m_rollupPeriodGroup = new QActionGroup(this);
+    QAction *asReported = m_rollupMenu->addAction(tr("As Reported"));
+    asReported->setData(-1);
+    m_rollupPeriodGroup->addAction(asReported);
+    for (RollupPeriod period : { RollupPeriod::Hourly, RollupPeriod::Daily, RollupPeriod::Monthly })
+    {
+      QAction *action = m_rollupMenu->addAction(QString::fromStdString(Rollup::periodName(period)));
+      action->setData(static_cast<int>(period));
+      m_rollupPeriodGroup->addAction(action);
+    }
+
+    m_rollupMenu->addSeparator();
+    m_rollupStatisticGroup = new QActionGroup(this);
+    for (RollupStatistic statistic : { RollupStatistic::Sum, RollupStatistic::Mean, RollupStatistic::Minimum, RollupStatistic::Maximum, RollupStatistic::Integral })
+    {
+      QAction *action = m_rollupMenu->addAction(QString::fromStdString(Rollup::statisticName(statistic)));
+      action->setData(static_cast<int>(statistic));
+      m_rollupStatisticGroup->addAction(action);
+    }
+
+    for (QAction *action : m_rollupMenu->actions())
+    {
+      action->setCheckable(!action->isSeparator());
+    }
+
+    connect(m_rollupPeriodGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+      int period = action->data().toInt();
+      if (period < 0) m_rollupPeriod.reset();
+      else m_rollupPeriod = static_cast<RollupPeriod>(period);
+    });
+    connect(m_rollupStatisticGroup, &QActionGroup::triggered, this, [this](QAction *action) {
+      m_rollupStatistic = static_cast<RollupStatistic>(action->data().toInt());
+    });
+
+    ui.menuPreferences->addMenu(m_rollupMenu);
+    updateRollupMenu();
+  }
+
+  void MainWindow::updateRollupMenu()
+  {
+    int period = m_rollupPeriod ? static_cast<int>(*m_rollupPeriod) : -1;
+    for (QAction *action : m_rollupPeriodGroup->actions())
+    {
+      action->setChecked(action->data().toInt() == period);
+    }
+    for (QAction *action : m_rollupStatisticGroup->actions())
+    {
+      action->setChecked(action->data().toInt() == static_cast<int>(m_rollupStatistic));
+    }
+  }
+
   void MainWindow::closeFile(const QString& filename)
   {
     // delete from resultViewerData (delete sqlFile)
@@ -1079,6 +1282,7 @@ namespace resultsviewer{
     m_fileComboBox->removeItem(m_fileComboBox->currentIndex());
     m_treeView->removeFile(filename);
     m_data->removeFile(filename);
+    m_loader.clearCache(filename.toStdString());
     // close ABUPS if present
     int index = currentEPlusHTML(filename);
     if (index > -1)
@@ -1390,49 +1594,178 @@ namespace resultsviewer{
 
   void MainWindow::openFileList(const QStringList& fileList, bool t_makeTempCopies)
   {
-    if (!fileList.isEmpty()) {
-      for (QString file : fileList) {
-        if (!QFile::exists(file)) {
-          QMessageBox::information(this, tr("File Open"), tr("File not found:\n" + file.toUtf8()));
-          continue;
-        }
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::openFileList", "ui");
+    if (fileList.isEmpty()) return;
+
+    std::vector<FileOpener::Request> requests;
+    QStringList names;
+    QStringList missing;
+    QStringList alreadyOpened;
+    for (QString file : fileList) {
+      if (!QFile::exists(file)) {
+        missing << file;
+        continue;
+      }
 
-        // Removed a dependency on OS's TemporaryDirectoy class here, code is a little suspect
-        QFileInfo info(file);
+      // Removed a dependency on OS's TemporaryDirectoy class here, code is a little suspect
+      QFileInfo info(file);
 
-        file = info.canonicalFilePath();
+      file = info.canonicalFilePath();
+      if (!t_makeTempCopies && m_data->isFileOpen(file)) {
+        alreadyOpened << file;
+        continue;
+      }
 
-        if (t_makeTempCopies) {
-          QString filename = info.fileName(); // This was baseName...
-          //openstudio::path basename = openstudio::toPath(QFileInfo(file).baseName());
-          //openstudio::path fullpath = openstudio::toPath(file);
-          //std::shared_ptr<openstudio::TemporaryDirectory> temporaryDirectory(new openstudio::TemporaryDirectory());
-          std::shared_ptr<QTemporaryDir> temporaryDirectory(new QTemporaryDir());
-          if(!temporaryDirectory->isValid()) {
-            throw std::runtime_error("Unable to create a temporary folder for temporary copies");
-          }
-          m_temporaryDirectories.push_back(temporaryDirectory);
-          QString temporaryPath = temporaryDirectory->path();
-          QString newpath = QDir(temporaryPath).filePath(filename);
-          QFile::copy(file, newpath);
-
-          QString eplustbl = QDir(info.canonicalPath()).filePath("eplustbl.htm");
-          if (QFile::exists(eplustbl)) {
-            QFile::copy(eplustbl, QDir(temporaryPath).filePath("eplustbl.htm"));
-          }
+      FileOpener::Request request;
+      // a temporary copy is opened once and thrown away, and its original may still be changing, so a cache of it
+      // would only be rebuilt on every open
+      request.columnarCache = m_data->columnarCacheEnabled() && !t_makeTempCopies;
+      if (t_makeTempCopies) {
+        QString filename = info.fileName(); // This was baseName...
+        std::shared_ptr<QTemporaryDir> temporaryDirectory(new QTemporaryDir());
+        if(!temporaryDirectory->isValid()) {
+          throw std::runtime_error("Unable to create a temporary folder for temporary copies");
+        }
+        m_temporaryDirectories.push_back(temporaryDirectory);
+        QString temporaryPath = temporaryDirectory->path();
+        QString newpath = QDir(temporaryPath).filePath(filename);
+
+        // a snapshot made on the worker before it opens it, a clone where the file system can; the snapshot is
+        // private and can skip all locking
+        request.snapshotOf = file.toStdString();
+        QString eplustbl = QDir(info.canonicalPath()).filePath("eplustbl.htm");
+        if (QFile::exists(eplustbl)) {
+          request.copies.emplace_back(eplustbl.toStdString(), QDir(temporaryPath).filePath("eplustbl.htm").toStdString());
+        }
+        request.mode = SqlFile::OpenMode::Immutable;
+        request.path = QFileInfo(newpath).absoluteFilePath().toStdString();
+        request.report = QDir(temporaryPath).filePath("eplustbl.htm").toStdString();
+      } else {
+        request.path = info.absoluteFilePath().toStdString();
+        request.report = QDir(info.absolutePath()).filePath("eplustbl.htm").toStdString();
+      }
+      requests.push_back(request);
+      names << file;
+    }
 
-          file = newpath;
-          info = QFileInfo(file);
+    if (!missing.isEmpty()) {
+      QMessageBox::information(this, tr("File Open"), tr("File not found:\n") + missing.join("\n"));
+    }
+    if (!alreadyOpened.isEmpty()) {
+      QMessageBox::information(this, tr("File Open"), tr("File already opened:\n") + alreadyOpened.join("\n"));
+    }
+    if (requests.empty()) return;
+
+    // files are opened and indexed on the workers, then handed over in batches: a notification only schedules an
+    // add, and whatever has arrived by the time it runs is added at once
+    auto pending = std::make_shared<std::weak_ptr<FileOpener> >();
+    auto opener = std::make_shared<FileOpener>(m_threadPool, requests, [this, pending]() {
+      QMetaObject::invokeMethod(this, [this, pending]() {
+        std::shared_ptr<FileOpener> opener = pending->lock();
+        for (auto &opening : m_openingFiles) {
+          if ((opening.opener != opener) || opening.addPending) continue;
+          opening.addPending = true;
+          const FileOpener *openerPtr = opener.get();
+          QTimer::singleShot(100, this, [this, openerPtr]() { addOpenedFiles(openerPtr); });
         }
+      }, Qt::QueuedConnection);
+    });
+    *pending = opener;
+
+    // the dialog shows only if opening takes a while
+    QPointer<OpenFilesDialog> dialog = new OpenFilesDialog(opener, names, this);
+    QTimer::singleShot(1000, dialog, [dialog]() { dialog->show(); });
+    m_openingFiles.push_back(OpeningFiles{ opener, dialog, names, false });
+  }
+
+  void MainWindow::addOpenedFiles(const FileOpener *opener)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::addOpenedFiles", "ui");
+    auto opening = std::find_if(m_openingFiles.begin(), m_openingFiles.end(),
+      [opener](const OpeningFiles &files) { return files.opener.get() == opener; });
+    if (opening == m_openingFiles.end()) return;
+    opening->addPending = false;
+
+    // read before the take, so a file that finishes after it is left for the next notification rather than lost
+    bool done = opening->opener->done();
+    std::vector<FileOpener::Result> results = opening->opener->take();
+    std::vector<SqlFilePool::Lease> leases;
+    std::vector<std::pair<QString, const SqlFile *> > tableFiles;
+    QStringList failed;
+    QStringList alreadyOpened;
+    for (const FileOpener::Result &result : results) {
+      const QString &name = opening->names[static_cast<int>(result.index)];
+      if (result.status != FileOpener::Status::Opened) {
+        failed << name;
+        continue;
+      }
+      QString filename = QString::fromStdString(opening->opener->request(result.index).path);
+      QString alias = recentFilesAlias(filename);
+      if (alias.isEmpty()) alias = m_data->defaultAlias(filename);
+      int status = m_data->addFile(alias, filename, result.connections);
+      if (status == RVD_FILEALREADYOPENED) {
+        alreadyOpened << name;
+        continue;
+      }
+      if (status != RVD_SUCCESS) {
+        failed << name;
+        continue;
+      }
+
+      m_treeView->displayFile(alias, result.connections, result.tree);
+
+      int index = m_fileComboBox->count();
+      m_fileComboBox->addItem(alias);
+      m_fileComboBox->setItemData(index,filename,Qt::ToolTipRole);
+      m_fileComboBox->setCurrentIndex(index);
+
+      // the connection the worker opened is idle and already has the dictionary
+      leases.push_back(result.connections->acquire());
+      tableFiles.emplace_back(alias, &*leases.back());
+
+      m_lastPathOpened = QFileInfo(filename).absoluteFilePath();
 
-        //QFileInfo info(file); // handles windows links and "\"
-        // End of changes to remove TemporaryDirectoy
-        QString filename = info.absoluteFilePath();
-        QString alias = recentFilesAlias(filename);
-        if (alias.isEmpty()) alias = m_data->defaultAlias(filename);
-        emit (loadFile(alias, filename));
+      index = m_recentFiles.indexOf(filename);
+      if (index>-1)
+      {
+        m_recentFiles.removeAt(index);
+        m_recentAliases.removeAt(index);
       }
+      m_recentFiles.prepend(filename);
+      m_recentAliases.prepend(alias);
+
+      if (result.report) addEPlusHTML(filename, QByteArray::fromStdString(*result.report));
+    }
+
+    if (!tableFiles.empty()) {
+      m_tableView->addFiles(tableFiles);
+      updateRecentFileActions();
+    }
+    leases.clear();
+
+    if (opening->dialog) opening->dialog->refresh();
+    if (done) {
+      if (opening->dialog) opening->dialog->deleteLater();
+      m_openingFiles.erase(opening);
     }
+
+    if (!failed.isEmpty()) {
+      QMessageBox::information(this, tr("File Open"), tr("File open failed:\n") + failed.join("\n"));
+    }
+    if (!alreadyOpened.isEmpty()) {
+      QMessageBox::information(this, tr("File Open"), tr("File already opened:\n") + alreadyOpened.join("\n"));
+    }
+  }
+
+  bool MainWindow::isTemporaryCopy(const QString& filename) const
+  {
+    QString path = QFileInfo(filename).absoluteFilePath();
+    for (const auto &temporaryDirectory : m_temporaryDirectories) {
+      if (path.startsWith(QDir(temporaryDirectory->path()).absolutePath() + "/")) {
+        return true;
+      }
+    }
+    return false;
   }
 
   const QString MainWindow::recentFilesAlias(const QString& filename)
@@ -1512,7 +1845,7 @@ namespace resultsviewer{
     m_tableView->setAlternatingRowColors(true);
     connect(m_tableView, &TableView::customContextMenuRequested, this, &MainWindow::showTableViewContextMenu);
     //    connect(m_tableView, &TableView::itemDoubleClicked, m_tableView, &TableView::generateLinePlotData);
-    connect(m_tableView, &TableView::itemDoubleClicked, this, &MainWindow::slotTableViewDoubleClick);
+    connect(m_tableView, &TableView::doubleClicked, this, &MainWindow::slotTableViewDoubleClick);
     connect(m_tableView, &TableView::signalAddLinePlot, this, &MainWindow::slotAddLinePlot);
     connect(m_tableView, &TableView::signalAddFloodPlot, this, &MainWindow::slotAddFloodPlot);
     connect(m_tableView, &TableView::signalAddLinePlotComparison, this, &MainWindow::slotAddLinePlotComparison);
@@ -1522,12 +1855,11 @@ namespace resultsviewer{
     connect(m_tableView, &TableView::signalAddIlluminancePlotComparison, this, &MainWindow::slotAddIlluminancePlotComparison);
   }
 
-  void MainWindow::slotTableViewDoubleClick(QTableWidgetItem *item)
+  void MainWindow::slotTableViewDoubleClick(const QModelIndex &index)
   {
-    if (!item) return;
+    if (!index.isValid()) return;
 
-    // if (m_tableView->item(item->row(),1)->data(Qt::UserRole) == RVD_ILLUMINANCEMAP)
-    if (m_tableView->item(item->row(),m_tableView->headerNames().indexOf("File"))->data(Qt::UserRole) == RVD_ILLUMINANCEMAP)
+    if (m_tableView->dataType(index.row()) == RVD_ILLUMINANCEMAP)
       m_tableView->generateIlluminancePlotData();
     else
       m_tableView->generateLinePlotData();
@@ -1569,7 +1901,15 @@ namespace resultsviewer{
 
   void MainWindow::slotApplyFilter(const QString& text)
   {
+    RESULTSVIEWER_TRACE_SCOPE("MainWindow::slotApplyFilter", "ui");
     QString filterText = text.trimmed();
+    if (filterText.isEmpty())
+    {
+      // an emptied box shows everything again without matching it
+      m_tableView->clearFilter();
+      m_treeView->clearFilter();
+      return;
+    }
     // trac 1380 exact match (case insensitive) if double quotes - wildcard front and back if not - single words/phrases only
     // no AND, OR searching and searches all fields
     if (!(filterText.startsWith("\"") && filterText.endsWith("\"")))
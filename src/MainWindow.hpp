@@ -40,6 +40,10 @@
 
 #include "SqlFile.hpp"
 #include "TimeSeries.hpp"
+#include "ThreadPool.hpp"
+#include "TimeSeriesLoader.hpp"
+#include "FileOpener.hpp"
+#include "OpenFilesDialog.hpp"
 
 #include <QMainWindow>
 #include <QTabWidget>
@@ -49,9 +53,12 @@
 #include <QSettings>
 #include <QMessageBox>
 #include <QAction>
+#include <QActionGroup>
 #include <QMenu>
 #include <QDockWidget>
 #include <QTemporaryDir>
+#include <QPointer>
+#include <QProgressDialog>
 #include <string>
 #include <memory>
 #include <ui_MainWindow.h>
@@ -82,6 +89,7 @@ private:
 
   // list of files to be auto cleaned up when the process exits
   std::list<std::shared_ptr<QTemporaryDir> > m_temporaryDirectories;
+  bool isTemporaryCopy(const QString& filename) const;
 
   Ui::MainWindowClass ui;
 
@@ -93,8 +101,40 @@ private:
 
   int m_plotTitleNumber;
   PlotViewData plotViewDataFromResultsViewerPlotData(const resultsviewer::ResultsViewerPlotData &rvplotData);
+  std::vector<PlotViewData> plotViewDataFromResultsViewerPlotData(const std::vector<resultsviewer::ResultsViewerPlotData> &rvplotDataVec);
+  // a series with nothing to plot is described in missing rather than reported at once, see showMissingSeries
+  PlotViewData plotViewDataFromResultsViewerPlotData(const resultsviewer::ResultsViewerPlotData &rvplotData, const std::optional<TimeSeries> &ts,
+    QStringList &missing);
+  // report the series that had nothing to plot in a single message
+  void showMissingSeries(const QStringList &missing);
+
+  // background loading of plot data
+  ThreadPool m_threadPool;
+  TimeSeriesLoader m_loader;
+  std::vector<CancellationToken> m_loadTokens;
+  // load the time series and illuminance maps of rvplotDataVec on the worker pool; onLoaded runs on the GUI thread as
+  // each one arrives and onFinished once all of them have, or onCanceled instead if the user cancels
+  void loadPlotViewData(const std::vector<resultsviewer::ResultsViewerPlotData> &rvplotDataVec, const QString &label,
+    const std::function<void (const PlotViewData &)> &onLoaded,
+    const std::function<void (const std::vector<PlotViewData> &)> &onFinished = std::function<void (const std::vector<PlotViewData> &)>(),
+    const std::function<void ()> &onCanceled = std::function<void ()>());
+  // register a load with token and open a progress dialog of count steps whose Cancel cancels it, then runs onCanceled
+  QPointer<QProgressDialog> beginLoad(const CancellationToken &token, const QString &label, int count,
+    const std::function<void ()> &onCanceled);
+  // forget the token of a load that finished or was canceled and close its progress dialog
+  void endLoad(const CancellationToken &token, const QPointer<QProgressDialog> &progressdialog);
   PlotViewData plotViewDataDifference(const resultsviewer::PlotViewData &plotViewData1, const resultsviewer::PlotViewData &plotViewData2);
 
+  // time series rolled up to a coarser reporting frequency wherever plot data is made from a selection; nullopt plots
+  // them as reported
+  std::optional<RollupPeriod> m_rollupPeriod;
+  RollupStatistic m_rollupStatistic;
+  QMenu *m_rollupMenu;
+  QActionGroup *m_rollupPeriodGroup;
+  QActionGroup *m_rollupStatisticGroup;
+  void createRollupMenu();
+  void updateRollupMenu();
+
   // recent file list
   QStringList m_recentFiles;
   QStringList m_recentAliases;
@@ -147,7 +187,8 @@ private:
   const QString recentFilesAlias(const QString& filename);
 
   // ABUPS
-  void addEPlusHTML(const QString& filename);
+  // add a browser tab showing html, the tables read from beside filename
+  void addEPlusHTML(const QString& filename, const QByteArray& html);
   QList<resultsviewer::BrowserView *> m_browserList;
   int currentEPlusHTML(const QString& filename);
   void showEPlusHTML(const QString& filename);
@@ -162,10 +203,22 @@ private:
   void createWelcomePage();
 
   // open a list of files from dialog or command line
-  // \param[in] t_makeTempCopies if true, copy the files into a new temp
+  // \param[in] t_makeTempCopies if true, snapshot the files into a new temp
   //            location before opening and delete them when the process exits.
   void openFileList(const QStringList& fileList, bool t_makeTempCopies);
 
+  // files being opened on the worker pool, added to the views in batches as they arrive
+  struct OpeningFiles
+  {
+    std::shared_ptr<FileOpener> opener;
+    QPointer<OpenFilesDialog> dialog;
+    QStringList names; // as asked for, before any copy was made
+    bool addPending;
+  };
+  std::vector<OpeningFiles> m_openingFiles;
+  // add the files opener has finished since the last call, all to each view at once
+  void addOpenedFiles(const FileOpener *opener);
+
   // timeseries specific context menus
   void timeseriesTableViewMenu( QMenu& menu);
   void timeseriesTreeViewMenu( QMenu& menu);
@@ -181,7 +234,6 @@ private:
 
 signals:
   // to repopulate tree when file closed
-  void tableWidgetItemClicked(QTableWidgetItem *item);
   // add plot
   void signalAddPlot(resultsviewer::PlotView *plot);
 
@@ -191,7 +243,6 @@ private slots:
   void closeEvent(QCloseEvent *evt) override;
   void showTreeViewContextMenu(const QPoint &pos);
   void showTableViewContextMenu(const QPoint &pos);
-  void loadFile(const QString& alias, const QString& filename);
   // limit items that can be selected
   void onTreeViewSelectionChanged();
   // file toolbar
@@ -248,7 +299,7 @@ private slots:
   // image file saving path trac #254
   void slotUpdateLastImageSavedPath(QString &path);
   // double clicking
-  void slotTableViewDoubleClick(QTableWidgetItem *item);
+  void slotTableViewDoubleClick(const QModelIndex &index);
   void slotTreeViewDoubleClick(QTreeWidgetItem *item, int col);
 
   // trac #1182 - new flood plot and new line plot
@@ -0,0 +1,208 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_MINMAXPYRAMID_HPP
+#define RESULTSVIEWER_MINMAXPYRAMID_HPP
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+MinMaxPyramid is a level of detail structure for drawing long series into a limited number of pixels. Level k
+splits the samples into buckets of 2^k and keeps, for each bucket, the indices of its minimum and maximum in index
+order. Drawing those points instead of the raw samples keeps the visual envelope (every peak and trough) exact,
+and the number of points drawn is proportional to the pixel width rather than the number of samples. Level 0 is
+the raw data. The pyramid stores indices, so it serves any y values that are an increasing function of the ones
+it was built from (scaled curves, for example).
+*/
+class MinMaxPyramid
+{
+public:
+  MinMaxPyramid()
+  {}
+
+  MinMaxPyramid(const double *y, size_t n) : m_size(n)
+  {
+    // level 1 from the raw data, each level after that from the one before it
+    std::vector<size_t> level;
+    level.reserve(n);
+    pair(y, n, level, 0);
+    while (level.size() > 2) {
+      m_levels.push_back(level);
+      std::vector<size_t> next;
+      next.reserve(level.size() / 2 + 2);
+      coarsen(y, m_levels.back(), next, 0);
+      level.swap(next);
+    }
+  }
+
+  // Extend the pyramid to the samples y[0, n), the first size() of which must be the ones it was built over. Only
+  // the buckets that take in new samples are recomputed, so the cost is proportional to the samples added.
+  void append(const double *y, size_t n)
+  {
+    if (n <= m_size) {
+      return;
+    }
+    if (m_levels.empty()) {
+      *this = MinMaxPyramid(y, n);
+      return;
+    }
+    // first bucket of the current level that holds new samples
+    size_t bucket = m_size / 2;
+    m_size = n;
+    m_levels[0].resize(2 * bucket);
+    pair(y, n, m_levels[0], bucket);
+    for (size_t k = 1; k <= m_levels.size(); ++k) {
+      bool added = k == m_levels.size();
+      if (added) {
+        if (m_levels.back().size() <= 2) {
+          break;
+        }
+        m_levels.emplace_back();
+        bucket = 0;
+      } else {
+        bucket /= 2;
+      }
+      m_levels[k].resize(2 * bucket);
+      coarsen(y, m_levels[k - 1], m_levels[k], bucket);
+      if (added && m_levels[k].size() <= 2) {
+        m_levels.pop_back();
+        break;
+      }
+    }
+  }
+
+  // Number of samples the pyramid was built over
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  // Number of levels, including the raw data as level 0
+  size_t levelCount() const
+  {
+    return m_levels.size() + 1;
+  }
+
+  // Coarsest level that still has at least one bucket per pixel across count visible samples
+  size_t levelFor(size_t count, int pixels) const
+  {
+    if (pixels <= 0) {
+      return 0;
+    }
+    size_t level = 0;
+    while (level < m_levels.size() && (count >> (level + 1)) >= static_cast<size_t>(pixels)) {
+      ++level;
+    }
+    return level;
+  }
+
+  // Indices to draw, in increasing order, for the samples [first, last] at the given level. One extra bucket is
+  // kept on each side so the curve runs to the edges of the view.
+  std::vector<size_t> indices(size_t level, size_t first, size_t last) const
+  {
+    std::vector<size_t> result;
+    if (m_size == 0) {
+      return result;
+    }
+    last = std::min(last, m_size - 1);
+    first = std::min(first, last);
+    if (level == 0 || m_levels.empty()) {
+      size_t begin = first > 0 ? first - 1 : 0;
+      size_t end = std::min(last + 1, m_size - 1);
+      for (size_t i = begin; i <= end; ++i) {
+        result.push_back(i);
+      }
+      return result;
+    }
+    level = std::min(level, m_levels.size());
+    const std::vector<size_t> &data = m_levels[level - 1];
+    size_t buckets = data.size() / 2;
+    size_t firstBucket = first >> level;
+    size_t lastBucket = std::min(last >> level, buckets - 1);
+    firstBucket = firstBucket > 0 ? firstBucket - 1 : 0;
+    lastBucket = std::min(lastBucket + 1, buckets - 1);
+    for (size_t b = firstBucket; b <= lastBucket; ++b) {
+      size_t a = data[2 * b];
+      size_t c = data[2 * b + 1];
+      if (a == c) {
+        result.push_back(a);
+      } else {
+        result.push_back(std::min(a, c));
+        result.push_back(std::max(a, c));
+      }
+    }
+    return result;
+  }
+
+private:
+  static void push(std::vector<size_t> &level, size_t lo, size_t hi)
+  {
+    level.push_back(lo);
+    level.push_back(hi);
+  }
+
+  // Append the level 1 buckets from firstBucket on, pairing up the raw samples
+  static void pair(const double *y, size_t n, std::vector<size_t> &level, size_t firstBucket)
+  {
+    for (size_t i = 2 * firstBucket; i + 1 < n; i += 2) {
+      if (y[i] <= y[i + 1]) {
+        push(level, i, i + 1);
+      } else {
+        push(level, i + 1, i);
+      }
+    }
+    if (n % 2 == 1) {
+      push(level, n - 1, n - 1);
+    }
+  }
+
+  // Append the buckets from firstBucket on of the level above prev, merging pairs of prev's buckets
+  static void coarsen(const double *y, const std::vector<size_t> &prev, std::vector<size_t> &next, size_t firstBucket)
+  {
+    size_t buckets = prev.size() / 2;
+    for (size_t b = 2 * firstBucket; b < buckets; b += 2) {
+      size_t lo = prev[2 * b];
+      size_t hi = prev[2 * b + 1];
+      if (b + 1 < buckets) {
+        size_t lo2 = prev[2 * b + 2];
+        size_t hi2 = prev[2 * b + 3];
+        lo = y[lo2] < y[lo] ? lo2 : lo;
+        hi = y[hi2] > y[hi] ? hi2 : hi;
+      }
+      push(next, lo, hi);
+    }
+  }
+
+  size_t m_size = 0;
+  // m_levels[k - 1] holds the (min index, max index) pairs of level k
+  std::vector<std::vector<size_t>> m_levels;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_MINMAXPYRAMID_HPP
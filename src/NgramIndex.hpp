@@ -0,0 +1,266 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_NGRAMINDEX_HPP
+#define RESULTSVIEWER_NGRAMINDEX_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+NgramIndex answers case insensitive wildcard filters over a set of strings with a trigram inverted index. Each string
+is given an id (ids are added in increasing order, as a StringPool hands them out) and every trigram of its case
+folded text points to a posting list of the ids containing it. A pattern is split into the literal runs between its
+wildcards; the posting lists of their trigrams are intersected, and only the ids left are checked against the whole
+pattern. Patterns follow QRegExp::Wildcard matched with exactMatch: '*' is any run of characters, '?' any one
+character and '[...]' a character set ('!' or '^' negates it, '-' gives ranges). Folding is ASCII only.
+*/
+class NgramIndex
+{
+public:
+  typedef uint32_t Id;
+  static constexpr size_t n = 3;
+
+  // Index text under id, which must be the next id; ids already indexed are skipped
+  void add(Id id, const std::string &text)
+  {
+    if (id < m_folded.size()) {
+      return;
+    }
+    m_folded.resize(id);
+    m_folded.push_back(foldCase(text));
+    const std::string &folded = m_folded.back();
+    for (size_t i = 0; i + n <= folded.size(); ++i) {
+      std::vector<Id> &postings = m_postings[gram(folded, i)];
+      // a string with a repeated trigram is listed once
+      if (postings.empty() || postings.back() != id) {
+        postings.push_back(id);
+      }
+    }
+  }
+
+  void clear()
+  {
+    m_folded.clear();
+    m_postings.clear();
+  }
+
+  // Number of ids indexed, one more than the last id
+  size_t size() const
+  {
+    return m_folded.size();
+  }
+
+  // Ids of the strings that pattern matches, in increasing order
+  std::vector<Id> match(const std::string &pattern) const
+  {
+    std::string folded = foldCase(pattern);
+    std::vector<Id> candidates;
+    bool narrowed = false;
+    for (const std::string &literal : literals(folded)) {
+      for (size_t i = 0; i + n <= literal.size(); ++i) {
+        auto postings = m_postings.find(gram(literal, i));
+        if (postings == m_postings.end()) {
+          return std::vector<Id>();
+        }
+        if (!narrowed) {
+          candidates = postings->second;
+          narrowed = true;
+        } else {
+          std::vector<Id> both;
+          std::set_intersection(candidates.begin(), candidates.end(), postings->second.begin(), postings->second.end(),
+            std::back_inserter(both));
+          candidates.swap(both);
+        }
+        if (candidates.empty()) {
+          return candidates;
+        }
+      }
+    }
+    if (!narrowed) {
+      // no literal is long enough to look up, check every string
+      candidates.resize(m_folded.size());
+      for (size_t i = 0; i < candidates.size(); ++i) {
+        candidates[i] = static_cast<Id>(i);
+      }
+    }
+    return verify(folded, candidates);
+  }
+
+  // Ids among within (increasing) of the strings that pattern matches, for refining an earlier match
+  std::vector<Id> match(const std::string &pattern, const std::vector<Id> &within) const
+  {
+    return verify(foldCase(pattern), within);
+  }
+
+  // True if every string pattern matches is also matched by previous, so that a match can be refined from the
+  // previous one. Only decided for substring filters, "*text*", where previous text is part of the new text.
+  static bool refines(const std::string &pattern, const std::string &previous)
+  {
+    auto substring = [](const std::string &p, std::string &text) {
+      if (p.size() < 2 || p.front() != '*' || p.back() != '*') {
+        return false;
+      }
+      text = foldCase(p.substr(1, p.size() - 2));
+      return text.find_first_of("*?[") == std::string::npos;
+    };
+    std::string text, previousText;
+    return substring(pattern, text) && substring(previous, previousText) && text.find(previousText) != std::string::npos;
+  }
+
+  // Case insensitive exact match of text against a wildcard pattern
+  static bool wildcardMatch(const std::string &pattern, const std::string &text)
+  {
+    return matchFolded(foldCase(pattern), foldCase(text));
+  }
+
+  static std::string foldCase(std::string s)
+  {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+  }
+
+private:
+  static uint32_t gram(const std::string &s, size_t i)
+  {
+    return (uint32_t(uint8_t(s[i])) << 16) | (uint32_t(uint8_t(s[i + 1])) << 8) | uint32_t(uint8_t(s[i + 2]));
+  }
+
+  // End of the '[...]' set starting at i (the position of its ']'), npos if it is not closed so '[' is literal
+  static size_t setEnd(const std::string &pattern, size_t i)
+  {
+    size_t j = i + 1;
+    if (j < pattern.size() && (pattern[j] == '!' || pattern[j] == '^')) {
+      ++j;
+    }
+    if (j < pattern.size() && pattern[j] == ']') {
+      ++j; // a leading ']' is a member
+    }
+    return pattern.find(']', j);
+  }
+
+  // Literal runs of a folded pattern, split at every wildcard and set
+  static std::vector<std::string> literals(const std::string &pattern)
+  {
+    std::vector<std::string> result(1);
+    for (size_t i = 0; i < pattern.size(); ++i) {
+      char c = pattern[i];
+      size_t end = c == '[' ? setEnd(pattern, i) : std::string::npos;
+      if (c == '*' || c == '?' || end != std::string::npos) {
+        result.emplace_back();
+        if (end != std::string::npos) {
+          i = end;
+        }
+      } else {
+        result.back() += c;
+      }
+    }
+    return result;
+  }
+
+  // Match one text character at pattern[i], advancing i past the pattern element
+  static bool matchOne(const std::string &pattern, size_t &i, char c)
+  {
+    if (pattern[i] == '?') {
+      ++i;
+      return true;
+    }
+    if (pattern[i] == '[') {
+      size_t end = setEnd(pattern, i);
+      if (end != std::string::npos) {
+        size_t j = i + 1;
+        bool negate = pattern[j] == '!' || pattern[j] == '^';
+        if (negate) {
+          ++j;
+        }
+        bool member = false;
+        for (size_t k = j; k < end; ++k) {
+          if (k + 2 < end && pattern[k + 1] == '-') {
+            member = member || (uint8_t(pattern[k]) <= uint8_t(c) && uint8_t(c) <= uint8_t(pattern[k + 2]));
+            k += 2;
+          } else {
+            member = member || pattern[k] == c;
+          }
+        }
+        i = end + 1;
+        return member != negate;
+      }
+    }
+    return pattern[i++] == c;
+  }
+
+  // Glob match, backtracking only to the last '*'
+  static bool matchFolded(const std::string &pattern, const std::string &text)
+  {
+    size_t p = 0, t = 0;
+    size_t starP = std::string::npos, starT = 0;
+    while (t < text.size()) {
+      if (p < pattern.size() && pattern[p] == '*') {
+        starP = ++p;
+        starT = t;
+        continue;
+      }
+      size_t next = p;
+      if (p < pattern.size() && matchOne(pattern, next, text[t])) {
+        p = next;
+        ++t;
+      } else if (starP != std::string::npos) {
+        p = starP;
+        t = ++starT;
+      } else {
+        return false;
+      }
+    }
+    while (p < pattern.size() && pattern[p] == '*') {
+      ++p;
+    }
+    return p == pattern.size();
+  }
+
+  std::vector<Id> verify(const std::string &folded, const std::vector<Id> &candidates) const
+  {
+    std::vector<Id> result;
+    for (Id id : candidates) {
+      if (id < m_folded.size() && matchFolded(folded, m_folded[id])) {
+        result.push_back(id);
+      }
+    }
+    return result;
+  }
+
+  std::vector<std::string> m_folded; // case folded text by id
+  std::unordered_map<uint32_t, std::vector<Id>> m_postings; // trigram to increasing ids
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_NGRAMINDEX_HPP
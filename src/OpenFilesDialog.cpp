@@ -0,0 +1,123 @@
+/***********************************************************************************************************************
+ *  OpenStudio(R), Copyright (c) 2008-2017, Alliance for Sustainable Energy, LLC. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  (4) Other than as required in clauses (1) and (2), distributions in any form of modifications or other derivative
+ *  works may not use the "OpenStudio" trademark, "OS", "os", or any other confusingly similar designation without
+ *  specific prior written permission from Alliance for Sustainable Energy, LLC.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#include "OpenFilesDialog.hpp"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+
+namespace resultsviewer{
+
+OpenFilesDialog::OpenFilesDialog(std::shared_ptr<FileOpener> opener, const QStringList& names, QWidget* parent)
+  : QDialog(parent), m_opener(opener)
+{
+  m_files = new QTreeWidget;
+  m_files->setColumnCount(2);
+  m_files->setHeaderLabels(QStringList() << tr("File") << tr("Status"));
+  m_files->setRootIsDecorated(false);
+  m_files->setUniformRowHeights(true);
+  for (const QString &name : names)
+  {
+    auto item = new QTreeWidgetItem(m_files);
+    item->setText(0, name);
+    item->setToolTip(0, name);
+  }
+  m_files->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+  m_files->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+  m_files->header()->setStretchLastSection(false);
+
+  m_progress = new QProgressBar;
+  m_progress->setRange(0, static_cast<int>(m_opener->size()));
+
+  m_cancelButton = new QPushButton(tr("Cancel"));
+  connect(m_cancelButton, &QPushButton::clicked, this, &OpenFilesDialog::cancelClicked);
+
+  auto buttonLayout = new QHBoxLayout;
+  buttonLayout->addWidget(m_progress);
+  buttonLayout->addWidget(m_cancelButton);
+
+  auto mainLayout = new QVBoxLayout;
+  mainLayout->addWidget(m_files);
+  mainLayout->addLayout(buttonLayout);
+
+  setLayout(mainLayout);
+
+  setWindowTitle(tr("Opening Files"));
+  resize(600, 400);
+
+  // statuses change on the workers, a poll is cheaper than a signal for each
+  m_refreshTimer = new QTimer(this);
+  m_refreshTimer->setInterval(250);
+  connect(m_refreshTimer, &QTimer::timeout, this, &OpenFilesDialog::refresh);
+  m_refreshTimer->start();
+  refresh();
+}
+
+void OpenFilesDialog::refresh()
+{
+  std::vector<FileOpener::Status> statuses = m_opener->statuses();
+  int finished = 0;
+  for (size_t i = 0; i < statuses.size(); ++i)
+  {
+    if ((statuses[i] != FileOpener::Status::Queued) && (statuses[i] != FileOpener::Status::Opening)) ++finished;
+    // only the rows that changed
+    if ((i < m_statuses.size()) && (m_statuses[i] == statuses[i])) continue;
+    QTreeWidgetItem *item = m_files->topLevelItem(static_cast<int>(i));
+    item->setText(1, statusText(statuses[i]));
+    if (statuses[i] == FileOpener::Status::Opening) m_files->scrollToItem(item);
+  }
+  m_statuses.swap(statuses);
+  m_progress->setValue(finished);
+  m_cancelButton->setEnabled(!m_opener->isCanceled() && (finished < m_progress->maximum()));
+}
+
+void OpenFilesDialog::cancelClicked()
+{
+  m_opener->cancel();
+  refresh();
+}
+
+QString OpenFilesDialog::statusText(FileOpener::Status status)
+{
+  switch (status)
+  {
+  case FileOpener::Status::Queued:
+    return tr("Waiting");
+  case FileOpener::Status::Opening:
+    return tr("Opening");
+  case FileOpener::Status::Opened:
+    return tr("Opened");
+  case FileOpener::Status::Failed:
+    return tr("Failed");
+  case FileOpener::Status::Canceled:
+    return tr("Canceled");
+  }
+  return QString();
+}
+
+};
@@ -28,7 +28,6 @@
 
 #include "PlotView.hpp"
 #include "PlotViewProperties.hpp"
-#include "../utilities/sql/SqlFile.hpp"
 #include "../utilities/core/Assert.hpp"
 #include "../utilities/core/System.hpp"
 #include "../utilities/data/Vector.hpp"
@@ -38,21 +37,38 @@
 #include <qwt/qwt_symbol.h>
 #include <qwt/qwt_series_data.h>
 #include <qwt/qwt_scale_engine.h>
+#include <qwt/qwt_scale_widget.h>
 
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QButtonGroup>
 #include <cfloat>
+#include <algorithm>
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QMessageBox>
 #include <QCursor>
+#include <QThread>
 
 namespace resultsviewer{
 
+  // connections to the first plot source, shared with the viewer when the file is open there
+  static std::shared_ptr<SqlFilePool> plotSourceConnections(const PlotViewData &plotViewData)
+  {
+    if (!plotViewData.connections.empty() && plotViewData.connections[0]) return plotViewData.connections[0];
+    return std::make_shared<SqlFilePool>(plotViewData.plotSource[0].toStdString(), SqlFile::OpenMode::ReadOnly);
+  }
+
+  // illuminance maps are read at interactive priority on the GUI thread, where the user waits on them, and at worker
+  // priority ahead of the plot and on the frame cache's thread
+  static SqlFilePool::Priority illuminanceReadPriority()
+  {
+    return QThread::currentThread() == qApp->thread() ? SqlFilePool::Priority::Interactive : SqlFilePool::Priority::Worker;
+  }
 
   LinePlotCurve::LinePlotCurve(QString& title, TimeSeriesLinePlotData& data)
+    : m_yMin(0.0), m_yMax(1.0)
   {
     setTitle(title);
     m_yType = resultsviewer::unScaledY;
@@ -73,23 +89,140 @@ namespace resultsviewer{
       m_xValues[i] = data.sample(i).x();
       m_yUnscaled[i] = data.sample(i).y();
     }
+    m_yMin = *std::min_element(m_yUnscaled.begin(), m_yUnscaled.end());
+    m_yMax = *std::max_element(m_yUnscaled.begin(), m_yUnscaled.end());
+    m_boundingRect = QRectF(m_xValues.first(), m_yMin, m_xValues.last() - m_xValues.first(), m_yMax - m_yMin);
+    m_pyramid = MinMaxPyramid(m_yUnscaled.constData(), m_yUnscaled.size());
+    m_rangeMinMax = RangeMinMax(m_yUnscaled.constData(), m_yUnscaled.size());
+    m_visibleIndices.clear();
     setLinePlotStyle(resultsviewer::smoothLinePlot);
   }
 
+  void LinePlotCurve::appendTimeSeries(const TimeSeries& timeSeries, size_t from)
+  {
+    size_t n = timeSeries.values().size();
+    if (m_xValues.isEmpty() || from != fullSize() || from >= n) return;
+
+    // x values are days from the first report, offset to where the curve starts
+    double x0 = m_xValues.first();
+    long long firstSeconds = timeSeries.seconds()[0];
+    double yMin = m_yMin;
+    double yMax = m_yMax;
+    for (size_t i = from; i < n; ++i)
+    {
+      m_xValues.append(x0 + static_cast<double>(timeSeries.seconds()[i] - firstSeconds) / 86400.0);
+      m_yUnscaled.append(timeSeries.values()[i]);
+      yMin = std::min(yMin, timeSeries.values()[i]);
+      yMax = std::max(yMax, timeSeries.values()[i]);
+    }
+
+    if (m_yType != resultsviewer::scaledY)
+    {
+      // scaled values are only kept up to date while they are drawn, scaleCurves makes them again
+      m_yScaled.clear();
+    }
+    else if (!m_yScaled.isEmpty())
+    {
+      if (yMin < m_yMin || yMax > m_yMax)
+      {
+        // the range grew, so every sample scales differently
+        m_yScaled.resize(m_yUnscaled.size());
+        for (int i = 0; i < m_yUnscaled.size(); ++i)
+        {
+          m_yScaled[i] = (m_yUnscaled[i] - yMin) / (yMax - yMin);
+        }
+        QString label = title().text();
+        int bracket = label.lastIndexOf('[');
+        if (bracket >= 0) setTitle(label.left(bracket) + "[" + QString::number(yMin) + ", "  + QString::number(yMax) + "]");
+      }
+      else
+      {
+        for (size_t i = from; i < n; ++i)
+        {
+          m_yScaled.append((m_yUnscaled[i] - m_yMin) / (m_yMax - m_yMin));
+        }
+      }
+    }
+    m_yMin = yMin;
+    m_yMax = yMax;
+    m_boundingRect = QRectF(m_xValues.first(), m_yMin, m_xValues.last() - m_xValues.first(), m_yMax - m_yMin);
+    m_pyramid.append(m_yUnscaled.constData(), m_yUnscaled.size());
+    m_rangeMinMax.append(m_yUnscaled.constData(), m_yUnscaled.size());
+
+    // draw everything until the caller sets the visible range again
+    m_visibleIndices.clear();
+    setDataMode(m_yType);
+  }
+
+  std::pair<double, double> LinePlotCurve::yRange(double minX, double maxX) const
+  {
+    if (m_xValues.isEmpty()) return std::make_pair(DBL_MAX, -DBL_MAX);
+
+    // first sample after minX through the last sample before maxX, at least one sample
+    size_t first = std::upper_bound(m_xValues.begin(), m_xValues.end(), minX) - m_xValues.begin();
+    size_t last = std::lower_bound(m_xValues.begin(), m_xValues.end(), maxX) - m_xValues.begin();
+    first = std::min(first, fullSize() - 1);
+    last = (last > first) ? last - 1 : first;
+
+    std::pair<double, double> range = m_rangeMinMax.minmax(first, last);
+    if (m_yType == resultsviewer::scaledY && !m_yScaled.isEmpty())
+    {
+      // scaling is increasing and linear, so it maps the unscaled extremes onto the scaled ones
+      range.first = (range.first - m_yMin) / (m_yMax - m_yMin);
+      range.second = (range.second - m_yMin) / (m_yMax - m_yMin);
+    }
+    return range;
+  }
+
+  QRectF LinePlotCurve::boundingRect() const
+  {
+    // scaled values span 0 to 1 whatever the range of the data
+    if (m_yType == resultsviewer::scaledY && !m_yScaled.isEmpty())
+    {
+      return QRectF(m_boundingRect.left(), 0.0, m_boundingRect.width(), 1.0);
+    }
+    return m_boundingRect;
+  }
+
+  void LinePlotCurve::setVisibleRange(double minX, double maxX, int pixels)
+  {
+    if (m_xValues.isEmpty()) return;
+
+    // x values are in time order
+    size_t first = std::lower_bound(m_xValues.begin(), m_xValues.end(), minX) - m_xValues.begin();
+    size_t last = std::upper_bound(m_xValues.begin(), m_xValues.end(), maxX) - m_xValues.begin();
+    if (last > 0) --last;
+    if (first > last) first = last;
+
+    size_t level = m_pyramid.levelFor(last - first + 1, pixels);
+    std::vector<size_t> indices;
+    if (level > 0 || first > 0 || last + 1 < fullSize())
+    {
+      indices = m_pyramid.indices(level, first, last);
+    }
+    if (indices == m_visibleIndices) return;
+    m_visibleIndices.swap(indices);
+    setDataMode(m_yType);
+  }
+
 
   void LinePlotCurve::setDataMode(YValueType yType)
   {
-    switch (yType)
+    const QVector<double> &yValues = (yType == resultsviewer::scaledY) ? m_yScaled : m_yUnscaled;
+    m_yType = yType;
+    if (m_visibleIndices.empty())
     {
-    case resultsviewer::unScaledY:
-      setSamples(m_xValues, m_yUnscaled);
-      m_yType = yType;
-      break;
-    case resultsviewer::scaledY:
-      setSamples(m_xValues, m_yScaled);
-      m_yType = yType;
-      break;
+      setSamples(m_xValues, yValues);
+      return;
     }
+    QVector<double> x(m_visibleIndices.size());
+    QVector<double> y(m_visibleIndices.size());
+    for (size_t i = 0; i < m_visibleIndices.size(); ++i)
+    {
+      x[i] = m_xValues[m_visibleIndices[i]];
+      y[i] = yValues[m_visibleIndices[i]];
+    }
+    setSamples(x, y);
   }
 
   void LinePlotCurve::setLinePlotStyle(LinePlotStyleType lineStyle)
@@ -263,7 +396,11 @@ namespace resultsviewer{
     m_rightAxis(nullptr),
     m_spinDay(nullptr),
     m_spinHour(nullptr),
-    m_noData(nullptr)
+    m_noData(nullptr),
+    m_followAction(nullptr),
+    m_liveTimer(nullptr),
+    m_livePollPending(false),
+    m_nextLiveId(0)
   {
     init();
   }
@@ -292,20 +429,19 @@ namespace resultsviewer{
     m_rightAxis(nullptr),
     m_spinDay(nullptr),
     m_spinHour(nullptr),
-    m_noData(nullptr)
+    m_noData(nullptr),
+    m_followAction(nullptr),
+    m_liveTimer(nullptr),
+    m_livePollPending(false),
+    m_nextLiveId(0)
   {
     init();
   }
 
   PlotView::~PlotView()
   {
-    for (auto data : m_illuminanceMapData)
-    {
-      if (data)
-      {
-        delete data;
-      }
-    }
+    // finish a poll in flight while the view it reports to still exists
+    m_livePool.reset();
   }
 
   void PlotView::init()
@@ -320,6 +456,10 @@ namespace resultsviewer{
 
     createLayout();
 
+    m_liveTimer = new QTimer(this);
+    m_liveTimer->setInterval(1000);
+    connect(m_liveTimer, &QTimer::timeout, this, &PlotView::slotPollLive);
+
     m_plotViewTimeAxis = nullptr;
 
     m_leftAxisUnits = "NONE SPECIFIED";
@@ -376,7 +516,7 @@ namespace resultsviewer{
 
       
       // parented by m_plot after attach
-      m_spectrogram = new QwtPlotSpectrogram(); 
+      m_spectrogram = new FloodPlotSpectrogram(); 
       m_spectrogram->setCachePolicy(QwtPlotRasterItem::PaintCache); // default is NoCache 
       //m_spectrogram->setRenderThreadCount(renderThreadCount); // seems slower than without
 
@@ -393,7 +533,7 @@ namespace resultsviewer{
       m_floodPlotYearlyMin = 0;
 
       // parented by m_plot after attach
-      m_spectrogram = new QwtPlotSpectrogram();
+      m_spectrogram = new FloodPlotSpectrogram();
       m_spectrogram->setCachePolicy(QwtPlotRasterItem::PaintCache); // default is NoCache 
       //m_spectrogram->setRenderThreadCount(renderThreadCount); // seems slower than without
 
@@ -495,6 +635,13 @@ namespace resultsviewer{
     m_toolBar->addAction(print);
     connect(print, &QAction::triggered, this, &PlotView::slotPrint);
 
+    m_followAction = new QAction(tr("Follow File"), this);
+    m_followAction->setToolTip("Add results as the simulation writing the file reports them");
+    m_followAction->setCheckable(true);
+    m_followAction->setEnabled(false); // until a series that can be followed is plotted
+    m_toolBar->addAction(m_followAction);
+    connect(m_followAction, &QAction::toggled, this, &PlotView::slotFollowFile);
+
     QAction *properties = new QAction(QIcon(":/images/plot_preferences.png"),tr("Properties"), this);
     properties->setToolTip("Plot Properties");
     m_toolBar->addAction(properties);
@@ -506,7 +653,7 @@ namespace resultsviewer{
 
   void PlotView::createQwtPlot()
   {
-    m_plot = new QwtPlot(this);
+    m_plot = new TracedPlot(this);
 
     QFont font;
     font.setFamily("Arial");
@@ -541,6 +688,9 @@ namespace resultsviewer{
     bool isConnected = connect(m_zoomer[0], SIGNAL(zoomed(const QRectF &)), this, SLOT(slotZoomed(const QRectF &)));
     OS_ASSERT(isConnected);
 
+    // the x scale changes on every zoom, pan and span change, before the curves are drawn
+    connect(m_plot->axisWidget(QwtPlot::xBottom), &QwtScaleWidget::scaleDivChanged, this, &PlotView::slotUpdateLevelOfDetail);
+
     // deleted by canvas
     m_panner = new QwtPlotPanner(m_plot->canvas());
     m_panner->setMouseButton(Qt::LeftButton);
@@ -700,11 +850,11 @@ namespace resultsviewer{
     switch(m_plotType)
     {
     case RVPV_LINEPLOT:
-      if ((_plotViewData.ts) && (_plotViewData.ts->values.size() > 0))
+      if ((_plotViewData.ts) && (_plotViewData.ts->values().size() > 0))
         linePlotItem(_plotViewData, t_workCanceled);
       break;
     case RVPV_FLOODPLOT:
-      if ((_plotViewData.ts) && (_plotViewData.ts->values.size() > 0))
+      if ((_plotViewData.ts) && (_plotViewData.ts->values().size() > 0))
         floodPlotItem(_plotViewData);
       break;
     case RVPV_ILLUMINANCEPLOT:
@@ -714,54 +864,41 @@ namespace resultsviewer{
 
   }
 
-  void PlotView::plotViewDataDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2)
+  void PlotView::plotViewDataDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2,
+    std::shared_ptr<IlluminanceMapLoad> difference)
   {
     switch(m_plotType)
     {
     case RVPV_ILLUMINANCEPLOT:
-      illuminancePlotItemsDifference(_plotViewData1, _plotViewData2);
+      illuminancePlotItemsDifference(_plotViewData1, _plotViewData2, difference);
       break;
     }
   }
 
 
-  void PlotView::illuminancePlotItemsDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2)
+  std::shared_ptr<IlluminanceMapLoad> PlotView::readIlluminanceMapDifference(std::shared_ptr<SqlFilePool> connections1,
+    const std::string &mapName1, std::shared_ptr<SqlFilePool> connections2, const std::string &mapName2)
   {
-    // clear items as necessary
-    m_valueInfo->hide();
-    m_valueInfoMarker->hide();
-
-    m_legendName = _plotViewData1.legendName + "-" + _plotViewData2.legendName;
-    m_alias = _plotViewData1.alias;
-    m_alias.append(_plotViewData2.alias);
-    m_plotSource = _plotViewData1.plotSource;
-    m_plotSource.append(_plotViewData2.plotSource);
-    QString title = updateLabelString( m_legendName, m_alias, m_plotSource);
-    m_plot->setTitle(title);
-
-    m_plot->setAxisTitle(QwtPlot::xBottom, "x (m)");
-    m_plot->setAxisTitle(QwtPlot::yLeft, "y (m)");
-
-    openstudio::SqlFile sqlFile1(openstudio::toPath(_plotViewData1.plotSource[0]));
-    openstudio::SqlFile sqlFile2(openstudio::toPath(_plotViewData2.plotSource[0]));
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::readIlluminanceMapDifference", "plot");
+    auto load = std::make_shared<IlluminanceMapLoad>();
+    SqlFilePool::Lease sqlFile1 = connections1->acquire(illuminanceReadPriority());
+    SqlFilePool::Lease sqlFile2 = connections2->acquire(illuminanceReadPriority());
 
     // list of hourly reports for the illuminance map
-    std::vector< std::pair<int, QDateTime> > reportIndicesDates1 = sqlFile1.illuminanceMapHourlyReportIndicesDates(openstudio::toString(_plotViewData1.dbIdentifier));
+    std::vector< std::pair<int, QDateTime> > reportIndicesDates1 = sqlFile1->illuminanceMapHourlyReportIndicesDates(mapName1);
     if (reportIndicesDates1.size() <= 0)
     {
       //    LOG(Error, "no report indices for illuminance map '" << openstudio::toString(_plotViewData1.legendName) << "'");
-      return;
+      return load;
     }
-    std::vector< std::pair<int, QDateTime> > reportIndicesDates2 = sqlFile2.illuminanceMapHourlyReportIndicesDates(openstudio::toString(_plotViewData2.dbIdentifier));
+    std::vector< std::pair<int, QDateTime> > reportIndicesDates2 = sqlFile2->illuminanceMapHourlyReportIndicesDates(mapName2);
     if (reportIndicesDates2.size() <= 0)
     {
       //    LOG(Error, "no report indices for illuminance map '" << openstudio::toString(_plotViewData2.legendName) << "'");
-      return;
+      return load;
     }
 
     // use common dates
-    m_illuminanceMapDifferenceReportIndices.clear();
-
     std::vector< std::pair<int, QDateTime> >::iterator it1;
     std::vector< std::pair<int, QDateTime> >::iterator it2;
     int count=0;
@@ -780,34 +917,71 @@ namespace resultsviewer{
       if (bFound)
       {
         std::pair< int, int > pairIndices( (*it1).first,  (*it2).first );
-        m_illuminanceMapDifferenceReportIndices.push_back( pairIndices );
+        load->differenceReportIndices.push_back( pairIndices );
         std::pair< int, QDateTime > pairIndexDate( count,  (*it1).second );
-        m_illuminanceMapReportIndicesDates.push_back( pairIndexDate );
+        load->reportIndicesDates.push_back( pairIndexDate );
         count++;
       }
     }
+    if (load->differenceReportIndices.empty()) return load;
+
+    load->grid = sqlFile1->illuminanceMapGrid(load->differenceReportIndices[0].first);
+    std::vector< std::pair<int,int> > reportIndices = load->differenceReportIndices;
+    IlluminanceMapGrid grid = load->grid;
+    // the frame reader leases a connection per frame rather than holding one for the life of the plot
+    sqlFile1 = SqlFilePool::Lease();
+    sqlFile2 = SqlFilePool::Lease();
+    load->cache = std::make_shared<IlluminanceMapCache>(reportIndices.size(), [connections1, connections2, reportIndices, grid](size_t frame) {
+      std::vector<double> illuminance1 = connections1->acquire(illuminanceReadPriority())->illuminanceMap(reportIndices[frame].first, grid);
+      std::vector<double> illuminance2 = connections2->acquire(illuminanceReadPriority())->illuminanceMap(reportIndices[frame].second, grid);
+      std::vector<double> illuminanceDiff(illuminance1.size());
+      for (size_t i = 0; i < illuminance1.size(); ++i)
+      {
+        illuminanceDiff[i] = illuminance1[i] - illuminance2[i];
+      }
+      return illuminanceDiff;
+    });
+    // the first frame is shown as soon as the plot opens
+    load->cache->frame(0);
+    return load;
+  }
+
+  void PlotView::illuminancePlotItemsDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2,
+    std::shared_ptr<IlluminanceMapLoad> difference)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::illuminancePlotItemsDifference", "plot");
+    // clear items as necessary
+    m_valueInfo->hide();
+    m_valueInfoMarker->hide();
+
+    m_legendName = _plotViewData1.legendName + "-" + _plotViewData2.legendName;
+    m_alias = _plotViewData1.alias;
+    m_alias.append(_plotViewData2.alias);
+    m_plotSource = _plotViewData1.plotSource;
+    m_plotSource.append(_plotViewData2.plotSource);
+    QString title = updateLabelString( m_legendName, m_alias, m_plotSource);
+    m_plot->setTitle(title);
+
+    m_plot->setAxisTitle(QwtPlot::xBottom, "x (m)");
+    m_plot->setAxisTitle(QwtPlot::yLeft, "y (m)");
+
+    if (!difference)
+    {
+      difference = readIlluminanceMapDifference(plotSourceConnections(_plotViewData1), _plotViewData1.dbIdentifier.toStdString(),
+        plotSourceConnections(_plotViewData2), _plotViewData2.dbIdentifier.toStdString());
+    }
+    if (!difference->cache) return;
 
-    m_illuminanceMapData.resize(m_illuminanceMapReportIndicesDates.size(), nullptr);
+    m_illuminanceMapDifferenceReportIndices = difference->differenceReportIndices;
+    m_illuminanceMapReportIndicesDates = difference->reportIndicesDates;
 
     // assuming x and y the same
     m_centerSlider->setRange(0,m_illuminanceMapReportIndicesDates.size()-1);
 
-    std::vector<double> x1,x2;
-    std::vector<double> y1,y2;
-    std::vector<double> illuminance1, illuminance2,illuminanceDiff;
-    sqlFile1.illuminanceMap(m_illuminanceMapDifferenceReportIndices[0].first,x1,y1,illuminance1);
-    sqlFile2.illuminanceMap(m_illuminanceMapDifferenceReportIndices[0].second,x2,y2,illuminance2);
-    unsigned i=0;
-    while ( (i<illuminance1.size()) && (i<illuminance2.size()) )
-    {// can check if x1=x2 and y1=y2
-      illuminanceDiff.push_back(illuminance1[i]-illuminance2[i]);
-      i++;
-    }
-    bufferIlluminanceMapGridPoints(x1, y1);
-    bufferIlluminanceMapGridPoints(x2, y2);
-    auto data = new MatrixFloodPlotData(x1,y1,illuminanceDiff,openstudio::LinearInterp);
+    m_illuminanceMapGrid = difference->grid;
+    m_illuminanceMapCache = difference->cache;
 
-    m_illuminanceMapData[0] = data->copy();
+    FloodPlotData *data = illuminanceMapData(0);
 
     m_yAxisMin = data->minY();
     m_yAxisMax = data->maxY();
@@ -836,8 +1010,35 @@ namespace resultsviewer{
 
 
 
+  std::shared_ptr<IlluminanceMapLoad> PlotView::readIlluminanceMap(std::shared_ptr<SqlFilePool> connections,
+    const std::string &mapName)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::readIlluminanceMap", "plot");
+    auto load = std::make_shared<IlluminanceMapLoad>();
+    SqlFilePool::Lease sqlFile = connections->acquire(illuminanceReadPriority());
+
+    load->minMax = sqlFile->illuminanceMapMinMaxValue(mapName);
+    load->refPt1 = sqlFile->illuminanceMapRefPt(mapName, 1);
+    load->refPt2 = sqlFile->illuminanceMapRefPt(mapName, 2);
+    load->reportIndicesDates = sqlFile->illuminanceMapHourlyReportIndicesDates(mapName);
+    if (load->reportIndicesDates.empty()) return load;
+
+    // the grid is read once, frames are read by the cache as the slider moves
+    load->grid = sqlFile->illuminanceMapGrid(load->reportIndicesDates[0].first);
+    sqlFile = SqlFilePool::Lease();
+    std::vector< std::pair<int, QDateTime> > reportIndicesDates = load->reportIndicesDates;
+    IlluminanceMapGrid grid = load->grid;
+    load->cache = std::make_shared<IlluminanceMapCache>(reportIndicesDates.size(), [connections, reportIndicesDates, grid](size_t frame) {
+      return connections->acquire(illuminanceReadPriority())->illuminanceMap(reportIndicesDates[frame].first, grid);
+    });
+    // the first frame is shown as soon as the plot opens
+    load->cache->frame(0);
+    return load;
+  }
+
   void PlotView::illuminancePlotItem(resultsviewer::PlotViewData &_plotViewData)
   {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::illuminancePlotItem", "plot");
     // clear items as necessary
     m_valueInfo->hide();
     m_valueInfoMarker->hide();
@@ -853,21 +1054,26 @@ namespace resultsviewer{
     m_plot->setAxisTitle(QwtPlot::yLeft, "y (m)");
     m_plot->setAxisTitle(QwtPlot::yRight, "(lux)");
 
-    openstudio::SqlFile sqlFile(openstudio::toPath(_plotViewData.plotSource[0]));
-
+    std::shared_ptr<IlluminanceMapLoad> load = _plotViewData.illuminanceMap;
+    if (!load)
+    {
+      load = readIlluminanceMap(plotSourceConnections(_plotViewData), m_dbIdentifier.toStdString());
+    }
 
     // yearly min and max
-    sqlFile.illuminanceMapMaxValue(openstudio::toString(m_dbIdentifier),m_floodPlotYearlyMin,m_floodPlotYearlyMax);
+    if (load->minMax)
+    {
+      m_floodPlotYearlyMin = load->minMax->first;
+      m_floodPlotYearlyMax = load->minMax->second;
+    }
     m_floodPlotMin = m_floodPlotYearlyMin;
     m_floodPlotMax = m_floodPlotYearlyMax;
 
 
     // reference points
-    boost::optional<std::string> refPt;
-    refPt = sqlFile.illuminanceMapRefPt(openstudio::toString(m_dbIdentifier),1);
-    if (refPt)
+    if (load->refPt1)
     {
-      QString str = openstudio::toQString(*refPt);
+      QString str = QString::fromStdString(*load->refPt1);
       str.remove("RefPt1=");
       str.remove("(");
       str.remove(")");
@@ -878,10 +1084,9 @@ namespace resultsviewer{
         m_illuminanceMapRefPt1->show();
       }
     }
-    refPt = sqlFile.illuminanceMapRefPt(openstudio::toString(m_dbIdentifier),2);
-    if (refPt)
+    if (load->refPt2)
     {
-      QString str = openstudio::toQString(*refPt);
+      QString str = QString::fromStdString(*load->refPt2);
       str.remove("RefPt2=");
       str.remove("(");
       str.remove(")");
@@ -894,25 +1099,19 @@ namespace resultsviewer{
     }
 
     // list of hourly reports for the illuminance map
-    m_illuminanceMapReportIndicesDates = sqlFile.illuminanceMapHourlyReportIndicesDates(openstudio::toString(m_dbIdentifier));
+    m_illuminanceMapReportIndicesDates = load->reportIndicesDates;
 
-    if (m_illuminanceMapReportIndicesDates.size() <= 0)
+    if (m_illuminanceMapReportIndicesDates.size() <= 0 || !load->cache)
     {
       //    LOG(Error, "no report indices for illuminance map '" << openstudio::toString(_plotViewData.legendName) << "'");
       return;
     }
-    m_illuminanceMapData.resize(m_illuminanceMapReportIndicesDates.size(), nullptr);
-
     m_centerSlider->setRange(0,m_illuminanceMapReportIndicesDates.size()-1);
 
-    std::vector<double> x;
-    std::vector<double> y;
-    std::vector<double> illuminance;
-    sqlFile.illuminanceMap(m_illuminanceMapReportIndicesDates[0].first,x,y,illuminance);
-    bufferIlluminanceMapGridPoints(x, y);
-    auto data = new openstudio::MatrixFloodPlotData(x,y,illuminance,openstudio::LinearInterp);
+    m_illuminanceMapGrid = load->grid;
+    m_illuminanceMapCache = load->cache;
 
-    m_illuminanceMapData[0] = data->copy();
+    FloodPlotData *data = illuminanceMapData(0);
 
     m_yAxisMin = data->minY();
     m_yAxisMax = data->maxY();
@@ -941,6 +1140,7 @@ namespace resultsviewer{
 
   void PlotView::floodPlotItem(resultsviewer::PlotViewData &_plotViewData)
   {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::floodPlotItem", "plot");
     // clear items as necessary
     m_valueInfo->hide();
     m_valueInfoMarker->hide();
@@ -1018,6 +1218,7 @@ namespace resultsviewer{
 
     rightAxisTitleFromUnits(openstudio::toQString(m_floodPlotData->units()));
     m_spectrogram->setData(m_floodPlotData);
+    followSeries(_plotViewData, m_spectrogram);
 
     setDataRange();
 
@@ -1167,6 +1368,7 @@ namespace resultsviewer{
 
   void PlotView::linePlotItem(resultsviewer::PlotViewData &_plotViewData, const std::function<bool ()> &t_workCanceled)
   {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::linePlotItem", "plot");
     if (m_plotViewTimeAxis == nullptr)
     {
       m_startDateTime = _plotViewData.ts->firstReportDateTime();
@@ -1252,7 +1454,10 @@ namespace resultsviewer{
       m_zoomer[1]->setEnabled(false);
       m_plot->setAxisTitle(QwtPlot::yLeft,"Scaled");
     }
+    followSeries(_plotViewData, curve);
+
     /// update legend and replot
+    curve->setVisibleRange(m_plot->canvasMap(QwtPlot::xBottom).s1(), m_plot->canvasMap(QwtPlot::xBottom).s2(), m_plot->canvas()->width());
     showCurve(curve, true);
 
     // update zoom base rect
@@ -1353,12 +1558,12 @@ namespace resultsviewer{
         {
           plotCurve = static_cast<LinePlotCurve *>(itPlotItem);
 
-          if ((plotCurve->minYValue() != 0) || (plotCurve->maxYValue() != 1))
+          if ((plotCurve->yUnscaledMin() != 0) || (plotCurve->yUnscaledMax() != 1))
           {
 
-            //          QVector<double> xData(plotCurve->dataSize());
-            QVector<double> yData(plotCurve->dataSize());
-            for (size_t i = 0; i < plotCurve->dataSize(); ++i)
+            // scale all of the data, not just the samples currently drawn
+            QVector<double> yData(plotCurve->fullSize());
+            for (size_t i = 0; i < plotCurve->fullSize(); ++i)
             {
               if (i % 1000 == 0)
               {
@@ -1368,11 +1573,10 @@ namespace resultsviewer{
                   return;
                 }
               }
-              //        xData[i] = plotCurve->x(i);
-              yData[i] = (plotCurve->sample(i).y() - plotCurve->minYValue())/ (plotCurve->maxYValue() - plotCurve->minYValue());
+              yData[i] = (plotCurve->yUnscaled(i) - plotCurve->yUnscaledMin())/ (plotCurve->yUnscaledMax() - plotCurve->yUnscaledMin());
             }
             // reset data
-            plotCurve->setTitle(plotCurve->title().text() + "[" + QString::number(plotCurve->minYValue()) + ", "  + QString::number(plotCurve->maxYValue()) + "]");
+            plotCurve->setTitle(plotCurve->title().text() + "[" + QString::number(plotCurve->yUnscaledMin()) + ", "  + QString::number(plotCurve->yUnscaledMax()) + "]");
             plotCurve->setYScaled(yData);
             plotCurve->setDataMode(resultsviewer::scaledY);
           }
@@ -1383,6 +1587,151 @@ namespace resultsviewer{
 
   }
 
+  void PlotView::slotUpdateLevelOfDetail()
+  {
+    if (m_plotType != RVPV_LINEPLOT) return;
+    QwtScaleMap xMap = m_plot->canvasMap(QwtPlot::xBottom);
+    int pixels = m_plot->canvas()->width();
+    const QwtPlotItemList &listPlotItem = m_plot->itemList();
+    for (auto& plotItem : listPlotItem)
+    {
+      if (plotItem->rtti() == QwtPlotItem::Rtti_PlotCurve)
+      {
+        static_cast<LinePlotCurve *>(plotItem)->setVisibleRange(xMap.s1(), xMap.s2(), pixels);
+      }
+    }
+  }
+
+  void PlotView::followSeries(const PlotViewData &plotViewData, QwtPlotItem *item)
+  {
+    // an item draws one series, a flood plot given new data stops following the old
+    for (auto live = m_liveItems.begin(); live != m_liveItems.end();)
+    {
+      if (live->second.item == item)
+      {
+        if (live->second.following)
+        {
+          std::string path = live->second.request.path;
+          size_t id = live->first;
+          m_livePool->submit([this, path, id]() { m_liveTails[path]->unfollow(id); });
+        }
+        live = m_liveItems.erase(live);
+      }
+      else
+      {
+        ++live;
+      }
+    }
+    if (!plotViewData.request || !plotViewData.ts) return;
+
+    // the file is only opened for following once following is turned on
+    m_liveItems[m_nextLiveId++] = LiveItem{ *plotViewData.request, plotViewData.ts, item, false };
+    m_followAction->setEnabled(true);
+    if (m_followAction->isChecked()) startFollowing();
+  }
+
+  void PlotView::startFollowing()
+  {
+    if (!m_livePool) m_livePool.reset(new ThreadPool(1));
+    for (auto &live : m_liveItems)
+    {
+      if (live.second.following) continue;
+      size_t id = live.first;
+      TimeSeriesRequest request = live.second.request;
+      TimeSeries ts = *live.second.ts;
+      m_livePool->submit([this, id, request, ts]() {
+        std::shared_ptr<LiveTail> &tail = m_liveTails[request.path];
+        if (!tail) tail = std::make_shared<LiveTail>(request.path);
+        if (tail->isValid()) tail->follow(id, request, ts);
+      });
+      live.second.following = true;
+      live.second.ts.reset();
+    }
+  }
+
+  void PlotView::slotFollowFile(bool on)
+  {
+    if (on)
+    {
+      startFollowing();
+      m_liveTimer->start();
+      slotPollLive();
+    }
+    else
+    {
+      m_liveTimer->stop();
+    }
+  }
+
+  void PlotView::slotPollLive()
+  {
+    // one poll at a time, a slow one is not queued behind
+    if (m_livePollPending || !m_livePool || m_liveItems.empty()) return;
+    m_livePollPending = true;
+    m_livePool->submit([this]() {
+      std::vector<LiveTail::Update> updates;
+      for (const auto &tail : m_liveTails)
+      {
+        if (!tail.second->isValid()) continue;
+        std::vector<LiveTail::Update> polled = tail.second->poll();
+        updates.insert(updates.end(), polled.begin(), polled.end());
+      }
+      // the destructor waits for this, and a queued call to a deleted view is dropped
+      QMetaObject::invokeMethod(this, [this, updates]() {
+        m_livePollPending = false;
+        applyLiveUpdates(updates);
+      }, Qt::QueuedConnection);
+    });
+  }
+
+  void PlotView::applyLiveUpdates(const std::vector<LiveTail::Update> &updates)
+  {
+    if (updates.empty()) return;
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::applyLiveUpdates", "plot");
+    bool atZoomBase = m_zoomer[0]->zoomRectIndex() == 0;
+    const QwtPlotItemList &listPlotItem = m_plot->itemList();
+    for (const auto &update : updates)
+    {
+      auto live = m_liveItems.find(update.id);
+      if (live == m_liveItems.end() || !listPlotItem.contains(live->second.item)) continue;
+      if (live->second.item->rtti() == QwtPlotItem::Rtti_PlotCurve)
+      {
+        auto curve = static_cast<LinePlotCurve *>(live->second.item);
+        curve->appendTimeSeries(update.series, update.from);
+        // the bounds the curve is drawn with, 0 to 1 for a scaled curve
+        QRectF bounds = curve->boundingRect();
+        m_xAxisMax = std::max(m_xAxisMax, bounds.right());
+        m_yAxisMin = std::min(m_yAxisMin, bounds.top());
+        m_yAxisMax = std::max(m_yAxisMax, bounds.bottom());
+      }
+      else if (auto data = dynamic_cast<TimeSeriesFloodPlotData *>(m_floodPlotData))
+      {
+        double minValue = data->minValue();
+        double maxValue = data->maxValue();
+        data->append(update.series, update.from);
+        m_spectrogram->invalidateCache();
+        m_xAxisMax = data->maxX();
+        // a new color range recolors the whole grid, otherwise only the new days are colored
+        if (m_floodPlotAutoScale && (data->minValue() < minValue || data->maxValue() > maxValue)) setDataRange();
+      }
+    }
+
+    m_centerSlider->setRange(100*m_xAxisMin, 100*m_xAxisMax);
+    m_spanSlider->setRange(0, 50*(m_xAxisMax - m_xAxisMin));
+    m_centerSpinBox->setRange(m_xAxisMin, m_xAxisMax);
+    m_spanSpinBox->setRange(0, 0.5*(m_xAxisMax - m_xAxisMin));
+    if (atZoomBase)
+    {
+      // a view of the whole run keeps showing the whole run as it grows
+      double minX = m_plot->axisScaleDiv(QwtPlot::xBottom).lowerBound();
+      m_plot->setAxisScale(QwtPlot::xBottom, minX, m_xAxisMax);
+      if (m_plotType == RVPV_LINEPLOT && (m_yLeftAutoScale || m_yRightAutoScale)) AutoScaleY(minX, m_xAxisMax);
+    }
+    slotUpdateLevelOfDetail();
+    m_plot->replot();
+    if (atZoomBase) updateZoomBase(m_plot->canvas()->rect(), false);
+  }
+
   void PlotView::showCurve(QwtPlotItem *item, bool on)
   {
     /// update curve visibility
@@ -1578,7 +1927,6 @@ namespace resultsviewer{
     double yLeftMax = -DBL_MAX;
     double yRightMin = DBL_MAX;
     double yRightMax = -DBL_MAX;
-    size_t minXIndex, maxXIndex, i;
 
     for (itPlotItem = listPlotItem.begin();itPlotItem!=listPlotItem.end();++itPlotItem)
     {
@@ -1586,28 +1934,17 @@ namespace resultsviewer{
       if ( plotItem->rtti() == QwtPlotItem::Rtti_PlotCurve)
       {
         linePlotCurve = static_cast<LinePlotCurve *>(plotItem);
-        minXIndex = 0;
-        maxXIndex = linePlotCurve->dataSize()-1;
-
-        for (minXIndex=0;minXIndex<linePlotCurve->dataSize();minXIndex++)
-          if (minX < linePlotCurve->sample(minXIndex).x()) break;
-
-        for (maxXIndex=linePlotCurve->dataSize()-1;maxXIndex > minXIndex;maxXIndex--)
-          if (maxX > linePlotCurve->sample(maxXIndex).x()) break;
-
-        for(i=minXIndex;i<=maxXIndex;i++)
+        std::pair<double, double> yRange = linePlotCurve->yRange(minX, maxX);
+        switch (linePlotCurve->yAxis())
         {
-          switch (linePlotCurve->yAxis())
-          {
-          case QwtPlot::yLeft:
-            if (linePlotCurve->sample(i).y() < yLeftMin) yLeftMin = linePlotCurve->sample(i).y();
-            if (linePlotCurve->sample(i).y() > yLeftMax) yLeftMax = linePlotCurve->sample(i).y();
-            break;
-          case QwtPlot::yRight:
-            if (linePlotCurve->sample(i).y() < yRightMin) yRightMin = linePlotCurve->sample(i).y();
-            if (linePlotCurve->sample(i).y() > yRightMax) yRightMax = linePlotCurve->sample(i).y();
-            break;
-          }
+        case QwtPlot::yLeft:
+          if (yRange.first < yLeftMin) yLeftMin = yRange.first;
+          if (yRange.second > yLeftMax) yLeftMax = yRange.second;
+          break;
+        case QwtPlot::yRight:
+          if (yRange.first < yRightMin) yRightMin = yRange.first;
+          if (yRange.second > yRightMax) yRightMax = yRange.second;
+          break;
         }
       }
     }
@@ -1981,61 +2318,26 @@ namespace resultsviewer{
 
     QString centerDate(tr("Unknown"));
     centerDate.sprintf("%02d/%02d %02d:%02d:%02d", openstudio::month((m_illuminanceMapReportIndicesDates[reportIndex].second).date().monthOfYear()), (m_illuminanceMapReportIndicesDates[reportIndex].second).date().dayOfMonth(), (m_illuminanceMapReportIndicesDates[reportIndex].second).time().hours(), 0,0);
-    m_centerDate->setText(centerDate);
 
     //plotDataAvailable(true); // DLM: why is this here?
 
-    // illuminance map caching
-    if (m_illuminanceMapData[reportIndex])
+    // illuminance map caching; a frame that cannot be read leaves the one shown before
+    FloodPlotData *data = nullptr;
+    try
     {
-      m_floodPlotData = m_illuminanceMapData[reportIndex]->copy();
+      data = illuminanceMapData(reportIndex);
     }
-    else
+    catch (...)
     {
-      //  set report index and replot
-      if (m_illuminanceMapDifferenceReportIndices.size() > 0)
-      {
-        openstudio::SqlFile sqlFile1(openstudio::toPath(m_plotSource[0]));
-        openstudio::SqlFile sqlFile2(openstudio::toPath(m_plotSource[1]));
-        // assuming x and y the same
-        std::vector<double> x1,x2;
-        std::vector<double> y1,y2;
-        std::vector<double> illuminance1, illuminance2,illuminanceDiff;
-        sqlFile1.illuminanceMap(m_illuminanceMapDifferenceReportIndices[reportIndex].first,x1,y1,illuminance1);
-        sqlFile2.illuminanceMap(m_illuminanceMapDifferenceReportIndices[reportIndex].second,x2,y2,illuminance2);
-        unsigned i=0;
-        while ( (i<illuminance1.size()) && (i<illuminance2.size()) )
-        {// can check if x1=x2 and y1=y2
-          illuminanceDiff.push_back(illuminance1[i]-illuminance2[i]);
-          i++;
-        }
-        bufferIlluminanceMapGridPoints(x1, y1);
-        bufferIlluminanceMapGridPoints(x2, y2);
-        auto data = new openstudio::MatrixFloodPlotData(x1,y1,illuminanceDiff,openstudio::LinearInterp);
-
-
-        m_floodPlotData = data;
-        m_illuminanceMapData[reportIndex] = data->copy();
-      }
-      else
-      {
-        openstudio::SqlFile sqlFile(openstudio::toPath(m_plotSource[0]));
-        std::vector<double> x;
-        std::vector<double> y;
-        std::vector<double> illuminance;
-        sqlFile.illuminanceMap(m_illuminanceMapReportIndicesDates[reportIndex].first,x,y,illuminance);
-        bufferIlluminanceMapGridPoints(x, y);
-        auto data = new openstudio::MatrixFloodPlotData(x,y,illuminance,openstudio::LinearInterp);
-
-        m_floodPlotData = data;
-        m_illuminanceMapData[reportIndex] = data->copy();
-      }
+      QApplication::restoreOverrideCursor();
+      QMessageBox::warning(this, tr("Illuminance Map"), tr("The illuminance map for %1 could not be read.").arg(centerDate));
+      return;
     }
+    m_centerDate->setText(centerDate);
+    m_floodPlotData = data;
     m_spectrogram->setData(m_floodPlotData);
 
     setDataRange();
-    // replot too slow - see http://www.qtcentre.org/threads/17892-Spectrogram-too-slow
-    // test simplest "value" for raster data - a little faster than interpolation but not much - see double MatrixFloodPlotData::value(double x, double y) const
 
     if (m_valueInfo->isVisible())
     {
@@ -2168,4 +2470,12 @@ namespace resultsviewer{
 
   }
 
+  resultsviewer::FloodPlotData* PlotView::illuminanceMapData(int reportIndex)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("PlotView::illuminanceMapData", "plot");
+    // the spectrogram owns its data, so each report gets new data around the cached values
+    IlluminanceMapCache::Frame illuminance = m_illuminanceMapCache->frame(reportIndex);
+    return new MatrixFloodPlotData(m_illuminanceMapGrid.x, m_illuminanceMapGrid.y, *illuminance, InterpMethod::LinearInterp);
+  }
+
 };
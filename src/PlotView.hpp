@@ -31,6 +31,13 @@
 
 #include "FloodPlot.hpp"
 #include "LinePlot.hpp"
+#include "MinMaxPyramid.hpp"
+#include "RangeMinMax.hpp"
+#include "IlluminanceMapCache.hpp"
+#include "LiveTail.hpp"
+#include "SqlFile.hpp"
+#include "SqlFilePool.hpp"
+#include "Tracer.hpp"
 
 #include <QWidget>
 #include <QAction>
@@ -52,6 +59,7 @@
 #include <QPixmap>
 #include <QToolButton>
 #include <QMimeData>
+#include <QTimer>
 
 #include <qwt/qwt_plot.h>
 #include <qwt/qwt_plot_grid.h>
@@ -127,12 +135,25 @@ namespace resultsviewer{
     // assign data and update array members
     void setDataMode(YValueType yType);
     void setLinePlotData(const resultsviewer::LinePlotData& data);
+    // add the reports [from, end) of a series whose first from reports are the curve's samples, extending the level
+    // of detail structures rather than rebuilding them
+    void appendTimeSeries(const TimeSeries& timeSeries, size_t from);
 
     YValueType yType() {return m_yType;}
     LinePlotStyleType linePlotStyle() {return m_linePlotStyle;}
 
     void setLinePlotStyle(LinePlotStyleType lineStyle);
 
+    // level of detail - draw only the min/max envelope of the samples needed for the visible x range and pixel width
+    void setVisibleRange(double minX, double maxX, int pixels);
+    size_t fullSize() const {return m_xValues.size();}
+    double yUnscaledMin() const {return m_yMin;}
+    double yUnscaledMax() const {return m_yMax;}
+    // smallest and largest y drawn (scaled or not) for minX < x < maxX, in O(log n)
+    std::pair<double, double> yRange(double minX, double maxX) const;
+    // bounds of all the data, not just the samples currently drawn, in the y values drawn (scaled or not)
+    QRectF boundingRect() const override;
+
   private:
     QStringList m_alias;
     QStringList m_plotSource;
@@ -142,6 +163,12 @@ namespace resultsviewer{
     QVector<double> m_xValues; // mid point
     YValueType m_yType;
     LinePlotStyleType m_linePlotStyle;
+    MinMaxPyramid m_pyramid;
+    RangeMinMax m_rangeMinMax;
+    std::vector<size_t> m_visibleIndices; // empty to draw everything
+    double m_yMin;
+    double m_yMax;
+    QRectF m_boundingRect;
 
   };
 
@@ -175,6 +202,17 @@ namespace resultsviewer{
   };
 
 
+  /// IlluminanceMapLoad is what an illuminance plot reads from its files before it is drawn
+  struct IlluminanceMapLoad {
+    std::optional<std::pair<double, double> > minMax; // yearly
+    std::optional<std::string> refPt1;
+    std::optional<std::string> refPt2;
+    std::vector< std::pair<int, QDateTime> > reportIndicesDates; // hourly reports, by frame
+    std::vector< std::pair<int,int> > differenceReportIndices; // for a difference, the report of each file by frame
+    IlluminanceMapGrid grid;
+    std::shared_ptr<IlluminanceMapCache> cache; // with the first frame read, null if there are no reports
+  };
+
   /// PlotViewData is a convenience structure for holding plot data
   struct PlotViewData {
     QStringList plotSource; // most likely an eplusout.sql file
@@ -187,6 +225,9 @@ namespace resultsviewer{
     QString xAxisTitle;
     QString yAxisTitle;
     std::optional<TimeSeries> ts;
+    std::optional<TimeSeriesRequest> request; // the variable ts holds the reports of, unless ts is derived from them
+    std::vector<std::shared_ptr<SqlFilePool> > connections; // connections to plotSource files that are open in the viewer
+    std::shared_ptr<IlluminanceMapLoad> illuminanceMap; // read ahead of the plot, otherwise the plot reads it
   };
 
   /**  PlotViewMimeData supports dropping plotViewData of drag/drop operations
@@ -263,6 +304,27 @@ namespace resultsviewer{
     int m_plotType;
   };
 
+  /** TracedPlot is the plot widget of a PlotView, a QwtPlot that records its replots and canvas paints as trace spans
+  */
+  class TracedPlot : public QwtPlot
+  {
+  public:
+    explicit TracedPlot(QWidget *parent = nullptr) : QwtPlot(parent)
+    {}
+
+    void replot() override
+    {
+      RESULTSVIEWER_TRACE_SCOPE("PlotView::replot", "plot");
+      QwtPlot::replot();
+    }
+
+    void drawCanvas(QPainter *painter) override
+    {
+      RESULTSVIEWER_TRACE_SCOPE("PlotView::drawCanvas", "plot");
+      QwtPlot::drawCanvas(painter);
+    }
+  };
+
   /** Zoomer is the control used for rectangular zooming in the plot region
   */
   class Zoomer: public QwtPlotZoomer
@@ -321,8 +383,16 @@ signals:
     // plot view data handler
     void plotViewData(PlotViewData &_plotViewData, const std::function<bool ()> &t_workCanceled);
 
-    // plot view difference data handler
-    void plotViewDataDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2);
+    // plot view difference data handler, with the difference read ahead or null for the plot to read it
+    void plotViewDataDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2,
+      std::shared_ptr<IlluminanceMapLoad> difference = nullptr);
+
+    // read an illuminance map, or the difference of two over the dates they share, for a plot; no widgets are used,
+    // so these can run on a worker thread
+    static std::shared_ptr<IlluminanceMapLoad> readIlluminanceMap(std::shared_ptr<SqlFilePool> connections,
+      const std::string &mapName);
+    static std::shared_ptr<IlluminanceMapLoad> readIlluminanceMapDifference(std::shared_ptr<SqlFilePool> connections1,
+      const std::string &mapName1, std::shared_ptr<SqlFilePool> connections2, const std::string &mapName2);
 
     // access to qwtPlot widget
     QwtPlot *plot() {return m_plot;}
@@ -430,7 +500,8 @@ signals:
     // illuminance plot specific
     void illuminancePlotItem(PlotViewData &_plotViewData);
     // illuminance plot difference 1-2
-    void illuminancePlotItemsDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2);
+    void illuminancePlotItemsDifference(PlotViewData &_plotViewData1, PlotViewData &_plotViewData2,
+      std::shared_ptr<IlluminanceMapLoad> difference);
 
 
     void createToolBar();
@@ -485,7 +556,7 @@ signals:
     void showCurve(QwtPlotItem *item, bool on);
 
     QwtLinearColorMap m_colorMap;
-    QwtPlotSpectrogram* m_spectrogram;
+    FloodPlotSpectrogram* m_spectrogram;
     QwtScaleWidget* m_rightAxis;
     resultsviewer::FloodPlotData* m_floodPlotData;
     resultsviewer::FloodPlotColorMap::ColorMapList m_colorMapType;
@@ -534,7 +605,11 @@ signals:
 
     // illuminance map hourly report indices
     std::vector< std::pair<int, QDateTime> > m_illuminanceMapReportIndicesDates;
-    std::vector<resultsviewer::FloodPlotData*> m_illuminanceMapData;
+    // grid shared by all reports of the map, and the illuminance of recently viewed reports
+    IlluminanceMapGrid m_illuminanceMapGrid;
+    std::shared_ptr<IlluminanceMapCache> m_illuminanceMapCache;
+    // data for one report of the map, from the cache
+    resultsviewer::FloodPlotData* illuminanceMapData(int reportIndex);
     // difference index
     std::vector< std::pair<int,int> > m_illuminanceMapDifferenceReportIndices;
     void plotDataAvailable(bool available);
@@ -549,6 +624,25 @@ signals:
     // no data available widget
     QLabel *m_noData;
 
+    // live tail - series followed as the simulation writing their file adds reports, polled on a worker thread
+    void followSeries(const PlotViewData &plotViewData, QwtPlotItem *item);
+    void startFollowing();
+    void applyLiveUpdates(const std::vector<LiveTail::Update> &updates);
+    QAction *m_followAction;
+    QTimer *m_liveTimer;
+    bool m_livePollPending;
+    size_t m_nextLiveId;
+    struct LiveItem
+    {
+      TimeSeriesRequest request;
+      std::optional<TimeSeries> ts; // as plotted, until it is handed to a tail
+      QwtPlotItem *item; // the curve or spectrogram drawing the series
+      bool following; // handed to a tail
+    };
+    std::map<size_t, LiveItem> m_liveItems; // by the id the series is followed under
+    std::map<std::string, std::shared_ptr<LiveTail> > m_liveTails; // by path, only used on m_livePool
+    std::unique_ptr<ThreadPool> m_livePool; // one worker, which is the only user of the live tails
+
   protected:
     /// drop target support for drag/drop operations
     void dropEvent(QDropEvent *e) override;
@@ -577,6 +671,9 @@ signals:
       // signal if zoomed - hide value info if rect changes
       void slotZoomed(const QRectF& rect);
 
+      // choose the line plot level of detail for the current x axis
+      void slotUpdateLevelOfDetail();
+
       // zoom in and out in increments
       void slotZoomIn();
       void slotZoomOut();
@@ -611,6 +708,10 @@ signals:
       // docking
       void slotFloatOrDock();
 
+      // live tail
+      void slotFollowFile(bool on);
+      void slotPollLive();
+
     private:
 
       // apply proper spacing so that illuminance map data pixels are centered on data point
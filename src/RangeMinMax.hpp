@@ -0,0 +1,126 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_RANGEMINMAX_HPP
+#define RESULTSVIEWER_RANGEMINMAX_HPP
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+RangeMinMax answers "what are the smallest and largest values in [first, last]" in O(log n) for any window,
+using a bottom up segment tree with 2n entries for each of the minimum and the maximum. The tree is built with room
+for the values it holds; appending values past that room doubles it.
+*/
+class RangeMinMax
+{
+public:
+  RangeMinMax()
+  {}
+
+  RangeMinMax(const double *values, size_t n) : m_size(n)
+  {
+    build(values, n, n);
+  }
+
+  // Extend the tree to the values [0, n), the first size() of which must be the ones it holds. Only the entries
+  // above the new values are updated unless the tree has to grow.
+  void append(const double *values, size_t n)
+  {
+    if (n <= m_size) {
+      return;
+    }
+    if (n > m_capacity) {
+      m_size = n;
+      build(values, n, std::max(2 * m_capacity, n));
+      return;
+    }
+    std::copy(values + m_size, values + n, m_min.begin() + m_capacity + m_size);
+    std::copy(values + m_size, values + n, m_max.begin() + m_capacity + m_size);
+    for (size_t l = (m_capacity + m_size) / 2, r = (m_capacity + n - 1) / 2; l > 0; l /= 2, r /= 2) {
+      for (size_t i = l; i <= r; ++i) {
+        m_min[i] = std::min(m_min[2 * i], m_min[2 * i + 1]);
+        m_max[i] = std::max(m_max[2 * i], m_max[2 * i + 1]);
+      }
+    }
+    m_size = n;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  // Minimum and maximum of the values [first, last], (inf, -inf) for an empty range
+  std::pair<double, double> minmax(size_t first, size_t last) const
+  {
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    if (m_size == 0 || first > last || first >= m_size) {
+      return std::make_pair(lo, hi);
+    }
+    last = std::min(last, m_size - 1);
+    for (size_t l = first + m_capacity, r = last + m_capacity + 1; l < r; l /= 2, r /= 2) {
+      if (l & 1) {
+        lo = std::min(lo, m_min[l]);
+        hi = std::max(hi, m_max[l]);
+        ++l;
+      }
+      if (r & 1) {
+        --r;
+        lo = std::min(lo, m_min[r]);
+        hi = std::max(hi, m_max[r]);
+      }
+    }
+    return std::make_pair(lo, hi);
+  }
+
+private:
+  void build(const double *values, size_t n, size_t capacity)
+  {
+    m_capacity = capacity;
+    m_min.assign(2 * capacity, std::numeric_limits<double>::infinity());
+    m_max.assign(2 * capacity, -std::numeric_limits<double>::infinity());
+    std::copy(values, values + n, m_min.begin() + capacity);
+    std::copy(values, values + n, m_max.begin() + capacity);
+    for (size_t i = capacity; i-- > 1;) {
+      m_min[i] = std::min(m_min[2 * i], m_min[2 * i + 1]);
+      m_max[i] = std::max(m_max[2 * i], m_max[2 * i + 1]);
+    }
+  }
+
+  size_t m_size = 0;
+  size_t m_capacity = 0;
+  std::vector<double> m_min;
+  std::vector<double> m_max;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_RANGEMINMAX_HPP
@@ -28,18 +28,18 @@
 
 #include "ResultsViewerData.hpp"
 
-#include "../utilities/core/String.hpp"
-
 #include <QFileInfo>
 #include <QString>
 
-using openstudio::toString;
-using openstudio::toQString;
-using openstudio::toPath;
-
 namespace resultsviewer{
 
-  ResultsViewerData::ResultsViewerData()
+  // aliases are compared with Unicode case folding, which the registry cannot do on its own
+  static std::string foldAlias(const std::string& alias)
+  {
+    return QString::fromStdString(alias).toCaseFolded().toStdString();
+  }
+
+  ResultsViewerData::ResultsViewerData() : m_files(foldAlias), m_columnarCacheEnabled(false), m_workers(nullptr)
   {
   }
 
@@ -47,97 +47,66 @@ namespace resultsviewer{
   {
   }
 
-  int ResultsViewerData::addFile(const QString& alias, openstudio::SqlFile sqlFile)
+  int ResultsViewerData::addFile(const QString& alias, const QString& filename, SqlFile::OpenMode mode)
   {
-    if (!sqlFile.connectionOpen()) return RVD_UNSUPPORTEDFILEFORMAT;
-    if (isFileOpen(sqlFile)) return RVD_FILEALREADYOPENED;
+    if (!QFileInfo(filename).exists()) return RVD_FILEDOESNOTEXIST;
+    if (isFileOpen(filename)) return RVD_FILEALREADYOPENED;
 
-    m_sqlFileMap[sqlFile] = alias;
+    // a current cache serves the dictionary of the first connection already
+    std::string cachePath;
+    if (m_columnarCacheEnabled && mode != SqlFile::OpenMode::ReadWrite) {
+      cachePath = ColumnarCache::pathFor(filename.toStdString());
+    }
+    auto connections = std::make_shared<SqlFilePool>(filename.toStdString(), mode, SqlFilePool::defaultMaxConnections(), cachePath);
+    if (!connections->connectionOpen()) return RVD_UNSUPPORTEDFILEFORMAT;
+    // building the cache scans the whole file, so it is left to a worker and the file is read directly until then
+    if (!cachePath.empty() && m_workers && !connections->columnarCache()) {
+      m_workers->submit([connections, cachePath]() { connections->useColumnarCache(cachePath); });
+    }
 
-    if (!sqlFile.supportedVersion()) return RVD_UNSUPPORTEDVERSION;
+    m_files.add(filename.toStdString(), alias.toStdString(), connections);
 
     return RVD_SUCCESS;
   }
 
-  int ResultsViewerData::addFile(const QString& alias, const QString& filename)
+  int ResultsViewerData::addFile(const QString& alias, const QString& filename, std::shared_ptr<SqlFilePool> connections)
   {
-    if (!QFileInfo(filename).exists()) return RVD_FILEDOESNOTEXIST;
     if (isFileOpen(filename)) return RVD_FILEALREADYOPENED;
-    openstudio::path p = toPath(filename);
+    if (!connections || !connections->connectionOpen()) return RVD_UNSUPPORTEDFILEFORMAT;
 
-    return addFile(alias, openstudio::SqlFile(p));
+    m_files.add(filename.toStdString(), alias.toStdString(), connections);
 
+    return RVD_SUCCESS;
   }
 
   void ResultsViewerData::removeFile(const QString& filename)
   {
-    if (isFileOpen(filename))
-    {
-      for(auto iter=m_sqlFileMap.begin(); iter!=m_sqlFileMap.end(); ++iter) 
-      {
-        if ( toPath(filename.toUpper()) == toPath(toQString((*iter).first.energyPlusSqliteFile()).toUpper()) ) 
-        {
-          m_sqlFileMap.erase(iter);
-          break;
-        }
-      }
-    }
+    // connections still leased or held by plots close when they are done with them
+    m_files.remove(filename.toStdString());
   }
 
   bool ResultsViewerData::isFileOpen(const QString& filename)
   {
-    if (m_sqlFileMap.empty()) return false;
-
-    bool isOpen = false;
-    for (auto map : m_sqlFileMap)
-    {
-      if (toPath(filename.toUpper()) == toPath(toQString(map.first.energyPlusSqliteFile()).toUpper()) )
-      {
-        isOpen = true;
-        break;
-      }
-    }
-    return isOpen;
+    return m_files.contains(filename.toStdString());
   }
 
-  bool ResultsViewerData::isFileOpen(openstudio::SqlFile sqlFile)
+  SqlFilePool::Lease ResultsViewerData::sqlFile(const QString& filename)
   {
-    if (!sqlFile.connectionOpen()) return false;
-    if (m_sqlFileMap.empty()) return false;
-
-    bool isOpen = false;
-    for (auto map : m_sqlFileMap) {
-      if (toPath(sqlFile.energyPlusSqliteFile()) == toPath(map.first.energyPlusSqliteFile())) {
-        isOpen = true;
-        break;
-      }
-    }
-    return isOpen;
+    std::shared_ptr<SqlFilePool> connections = m_files.handle(filename.toStdString());
+    if (!connections) return SqlFilePool::Lease();
+    return connections->acquire();
   }
 
-
-  openstudio::SqlFile ResultsViewerData::sqlFile(const QString& filename)
+  std::shared_ptr<SqlFilePool> ResultsViewerData::connectionPool(const QString& filename)
   {
-    openstudio::SqlFile sqlFP;
-    for(auto map : m_sqlFileMap) {
-      if (toPath(filename) == toPath(map.first.energyPlusSqliteFile())) {
-        sqlFP = map.first;
-        break;
-      }
-    }
-    return sqlFP;
+    return m_files.handle(filename.toStdString());
   }
 
   const QString ResultsViewerData::alias(const QString& filename)
   {
-    QString aliasValue = "";
-    for (auto map : m_sqlFileMap) {
-      if (toPath(filename) == toPath(map.first.energyPlusSqliteFile()) ) {
-        aliasValue = map.second;
-        break;
-      }
-    }
-    return aliasValue;
+    std::optional<std::string> aliasValue = m_files.alias(filename.toStdString());
+    if (!aliasValue) return "";
+    return QString::fromStdString(*aliasValue);
   }
 
   const QString ResultsViewerData::defaultAlias(QString& filename)
@@ -160,33 +129,30 @@ namespace resultsviewer{
   }
 
 
+  void ResultsViewerData::setColumnarCacheEnabled(bool enabled)
+  {
+    m_columnarCacheEnabled = enabled;
+  }
+
+  bool ResultsViewerData::columnarCacheEnabled() const
+  {
+    return m_columnarCacheEnabled;
+  }
+
+  void ResultsViewerData::setWorkers(ThreadPool *workers)
+  {
+    m_workers = workers;
+  }
+
   bool ResultsViewerData::aliasExists(const QString &alias)
   {
-    bool exists = false;
-    for (auto map : m_sqlFileMap)
-    {
-      if (alias.toUpper() == map.second.toUpper() ) 
-      {
-        exists = true;
-        break;
-      }
-    }
-    return exists;
+    return m_files.aliasExists(alias.toStdString());
   }
 
 
   void ResultsViewerData::updateAlias(const QString& alias, const QString& filename)
   {
-    if (!m_sqlFileMap.empty())
-    {
-      for (auto map : m_sqlFileMap)
-      {
-        if ( toPath(filename.toUpper()) == toPath(toQString(map.first.energyPlusSqliteFile()).toUpper()) ) 
-        {
-          m_sqlFileMap[map.first] = alias;
-        }
-      }
-    }
+    m_files.setAlias(filename.toStdString(), alias.toStdString());
   }
 
 
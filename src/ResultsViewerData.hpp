@@ -32,6 +32,9 @@
 #include "LinePlot.hpp"
 #include "FloodPlot.hpp"
 #include "SqlFile.hpp"
+#include "SqlFilePool.hpp"
+#include "FileRegistry.hpp"
+#include "ThreadPool.hpp"
 
 #include <QMainWindow>
 #include <QTableWidget>
@@ -68,7 +71,8 @@ const int RVD_FILEDOESNOTEXIST = 4;
 const int RVD_TIMESERIES = 3;
 const int RVD_ILLUMINANCEMAP = 4;
 
-/** ResultsViewerData tracks open files and aliases used in ResultsViewer
+/** ResultsViewerData tracks open files and aliases used in ResultsViewer. Each open file keeps a pool of long lived
+read connections; use sqlFile to lease one for a query, or connectionPool to hand the file to another thread.
 */
 class ResultsViewerData
 {
@@ -77,10 +81,14 @@ public:
   ~ResultsViewerData();
 
   bool isFileOpen(const QString& filename);
-  bool isFileOpen(SqlFile sqlFile);
-  SqlFile sqlFile(const QString& filename);
-  int addFile(const QString& alias, SqlFile sqlFile);
-  int addFile(const QString& alias, const QString& filename);
+  // lease a connection to an open file, the lease is empty if the file is not open
+  SqlFilePool::Lease sqlFile(const QString& filename);
+  // connections to an open file, null if the file is not open
+  std::shared_ptr<SqlFilePool> connectionPool(const QString& filename);
+  // results are never written by the viewer, so files are opened read only unless told otherwise
+  int addFile(const QString& alias, const QString& filename, SqlFile::OpenMode mode = SqlFile::OpenMode::ReadOnly);
+  // add a file whose connections were opened elsewhere, as by a FileOpener
+  int addFile(const QString& alias, const QString& filename, std::shared_ptr<SqlFilePool> connections);
   void removeFile(const QString& filename);
   bool isSupportedSqlFileFormat(const QString& filename);
 
@@ -96,8 +104,16 @@ public:
   // check if alias exists
   bool aliasExists(const QString& alias);
 
+  // read files opened from now on through a columnar cache next to them, building it when needed
+  void setColumnarCacheEnabled(bool enabled);
+  bool columnarCacheEnabled() const;
+  // pool that builds columnar caches for files added by name, without one those files are never cached
+  void setWorkers(ThreadPool *workers);
+
 private:
-  std::map<SqlFile, QString> m_sqlFileMap;
+  FileRegistry<SqlFilePool> m_files;
+  bool m_columnarCacheEnabled;
+  ThreadPool *m_workers;
 };
 
 
@@ -0,0 +1,303 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_ROLLUP_HPP
+#define RESULTSVIEWER_ROLLUP_HPP
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <limits>
+#include <algorithm>
+#include <cstddef>
+#include <cctype>
+
+#include <QDateTime>
+
+namespace resultsviewer{
+
+// Calendar periods that reports can be rolled up to, finest first
+enum class RollupPeriod { Hourly, Daily, Monthly };
+
+enum class RollupStatistic { Sum, Mean, Minimum, Maximum, Integral };
+
+/**
+Rollup holds the sum, count, minimum, maximum and time integral of a series' reports in each calendar hour, day or
+month. Reports are stamped at the end of their interval, so a report at midnight belongs to the day before, and the
+integral weights each report by the time since the report before it. The accumulators of a rollup combine exactly,
+so a coarser rollup can be made from a finer one without going back to the reports.
+*/
+class Rollup
+{
+public:
+  // Roll up count reports, given as seconds from start and values, in one pass. The interval of the first report is
+  // interval if known, otherwise taken to be the same as the next.
+  Rollup(const QDateTime &start, const long long *seconds, const double *values, size_t count, RollupPeriod period,
+    std::optional<long long> interval = std::nullopt) : m_start(start), m_period(period)
+  {
+    for (size_t i = 0; i < count; ++i) {
+      long long duration;
+      if (i > 0) {
+        duration = seconds[i] - seconds[i - 1];
+      } else if (interval) {
+        duration = *interval;
+      } else {
+        duration = count > 1 ? seconds[1] - seconds[0] : seconds[0];
+      }
+      add(seconds[i], 1, values[i], values[i], values[i], values[i] * static_cast<double>(duration));
+    }
+  }
+
+  // This rollup at a coarser period, made from its buckets. Asking for a period that is not coarser returns a copy.
+  Rollup coarsen(RollupPeriod period) const
+  {
+    if (period <= m_period) {
+      return *this;
+    }
+    Rollup result(m_start, period);
+    for (size_t i = 0; i < m_seconds.size(); ++i) {
+      result.add(m_seconds[i], m_count[i], m_sum[i], m_minimum[i], m_maximum[i], m_integral[i]);
+    }
+    return result;
+  }
+
+  RollupPeriod period() const
+  {
+    return m_period;
+  }
+
+  const QDateTime &startDateTime() const
+  {
+    return m_start;
+  }
+
+  // Number of buckets that have reports
+  size_t size() const
+  {
+    return m_seconds.size();
+  }
+
+  // End of each bucket in seconds from the start
+  const std::vector<long long> &seconds() const
+  {
+    return m_seconds;
+  }
+
+  const std::vector<size_t> &count() const
+  {
+    return m_count;
+  }
+
+  double value(size_t i, RollupStatistic statistic) const
+  {
+    switch (statistic) {
+    case RollupStatistic::Sum:
+      return m_sum[i];
+    case RollupStatistic::Mean:
+      return m_sum[i] / static_cast<double>(m_count[i]);
+    case RollupStatistic::Minimum:
+      return m_minimum[i];
+    case RollupStatistic::Maximum:
+      return m_maximum[i];
+    case RollupStatistic::Integral:
+    default:
+      return m_integral[i];
+    }
+  }
+
+  std::vector<double> values(RollupStatistic statistic) const
+  {
+    std::vector<double> result(m_seconds.size());
+    for (size_t i = 0; i < result.size(); ++i) {
+      result[i] = value(i, statistic);
+    }
+    return result;
+  }
+
+  // Length of the period in seconds, months having none
+  static std::optional<long long> length(RollupPeriod period)
+  {
+    switch (period) {
+    case RollupPeriod::Hourly:
+      return 3600LL;
+    case RollupPeriod::Daily:
+      return 86400LL;
+    default:
+      return std::nullopt;
+    }
+  }
+
+  // The reporting frequency name of a period, as used for PlotViewData::interval
+  static std::string intervalName(RollupPeriod period)
+  {
+    switch (period) {
+    case RollupPeriod::Hourly:
+      return "HOURLY";
+    case RollupPeriod::Daily:
+      return "DAILY";
+    default:
+      return "MONTHLY";
+    }
+  }
+
+  static std::string periodName(RollupPeriod period)
+  {
+    switch (period) {
+    case RollupPeriod::Hourly:
+      return "Hourly";
+    case RollupPeriod::Daily:
+      return "Daily";
+    default:
+      return "Monthly";
+    }
+  }
+
+  static std::string statisticName(RollupStatistic statistic)
+  {
+    switch (statistic) {
+    case RollupStatistic::Sum:
+      return "Sum";
+    case RollupStatistic::Mean:
+      return "Mean";
+    case RollupStatistic::Minimum:
+      return "Minimum";
+    case RollupStatistic::Maximum:
+      return "Maximum";
+    default:
+      return "Integral";
+    }
+  }
+
+  // The period or statistic with a name, ignoring case
+  static std::optional<RollupPeriod> periodFromName(const std::string &name)
+  {
+    for (RollupPeriod period : { RollupPeriod::Hourly, RollupPeriod::Daily, RollupPeriod::Monthly }) {
+      if (sameName(name, periodName(period))) {
+        return period;
+      }
+    }
+    return std::nullopt;
+  }
+
+  static std::optional<RollupStatistic> statisticFromName(const std::string &name)
+  {
+    for (RollupStatistic statistic : { RollupStatistic::Sum, RollupStatistic::Mean, RollupStatistic::Minimum,
+      RollupStatistic::Maximum, RollupStatistic::Integral }) {
+      if (sameName(name, statisticName(statistic))) {
+        return statistic;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // True if reports at reportingFrequency (the names in the ReportDataDictionary) are finer than period, so rolling
+  // them up to it means something
+  static bool appliesTo(RollupPeriod period, const std::string &reportingFrequency)
+  {
+    std::string frequency;
+    for (char c : reportingFrequency) {
+      if (c != ' ') {
+        frequency += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+      }
+    }
+    int rank;
+    if (frequency.find("timestep") != std::string::npos || frequency == "detailed" || frequency == "each call") {
+      rank = -1;
+    } else if (frequency == "hourly") {
+      rank = 0;
+    } else if (frequency == "daily") {
+      rank = 1;
+    } else if (frequency == "monthly") {
+      rank = 2;
+    } else {
+      // run period and annual reports, or something unknown
+      return false;
+    }
+    return rank < static_cast<int>(period);
+  }
+
+private:
+  static bool sameName(const std::string &a, const std::string &b)
+  {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+      return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+  }
+
+  Rollup(const QDateTime &start, RollupPeriod period) : m_start(start), m_period(period)
+  {}
+
+  // Merge a report or a finer bucket ending at seconds into the bucket containing it
+  void add(long long seconds, size_t count, double sum, double minimum, double maximum, double integral)
+  {
+    if (m_seconds.empty() || seconds <= m_bucketStart || seconds > m_seconds.back()) {
+      long long end = bucketEnd(seconds);
+      m_seconds.push_back(end);
+      m_count.push_back(0);
+      m_sum.push_back(0.0);
+      m_minimum.push_back(std::numeric_limits<double>::infinity());
+      m_maximum.push_back(-std::numeric_limits<double>::infinity());
+      m_integral.push_back(0.0);
+    }
+    m_count.back() += count;
+    m_sum.back() += sum;
+    m_minimum.back() = std::min(m_minimum.back(), minimum);
+    m_maximum.back() = std::max(m_maximum.back(), maximum);
+    m_integral.back() += integral;
+  }
+
+  // End of the bucket holding a report at seconds from the start, which also sets where that bucket starts
+  long long bucketEnd(long long seconds)
+  {
+    // seconds from midnight of the start date, less one so that a report at the end of a bucket falls inside it
+    long long origin = m_start.time().msecsSinceStartOfDay() / 1000;
+    long long t = origin + seconds - 1;
+    if (std::optional<long long> period = length(m_period)) {
+      long long index = t >= 0 ? t / *period : -((-t + *period - 1) / *period);
+      m_bucketStart = index * *period - origin;
+      return m_bucketStart + *period;
+    }
+    long long day = t >= 0 ? t / 86400 : -((-t + 86399) / 86400);
+    QDate date = m_start.date().addDays(day);
+    QDate first(date.year(), date.month(), 1);
+    QDate next = date.month() == 12 ? QDate(date.year() + 1, 1, 1) : QDate(date.year(), date.month() + 1, 1);
+    long long startDay = m_start.date().toJulianDay();
+    m_bucketStart = (first.toJulianDay() - startDay) * 86400 - origin;
+    return (next.toJulianDay() - startDay) * 86400 - origin;
+  }
+
+  QDateTime m_start;
+  RollupPeriod m_period;
+  long long m_bucketStart = 0;
+  std::vector<long long> m_seconds;
+  std::vector<size_t> m_count;
+  std::vector<double> m_sum;
+  std::vector<double> m_minimum;
+  std::vector<double> m_maximum;
+  std::vector<double> m_integral;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_ROLLUP_HPP
@@ -0,0 +1,258 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+
+#ifndef RESULTSVIEWER_SNAPSHOT_HPP
+#define RESULTSVIEWER_SNAPSHOT_HPP
+
+#include "SqlFile.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+#include <sqlite3/sqlite3.h>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace resultsviewer{
+
+/**
+Snapshot makes private copies of results files as cheaply as the file system allows. A reflink clone (FICLONE) shares
+the source's blocks until one of the files is written, so it takes the same time for any size; failing that the
+kernel copies the bytes (copy_file_range, then sendfile) without passing them through user space. A database is
+copied under a read transaction, whose shared lock keeps writers from changing the file until the copy is made, so
+the copy is consistent. A database in WAL mode, whose committed pages may still be in the -wal file, is copied with
+SQLite's online backup API in one step inside a read transaction: readers do not hold up writers there, and a copy
+made in batches would start over after every commit. One the file level copies cannot handle is backed up a batch of
+pages at a time, so that a writer is held up only briefly. Nothing here is tied to a thread; callers run it on a
+worker.
+*/
+class Snapshot
+{
+public:
+  enum class Method { None, Clone, KernelCopy, Stream, Backup };
+
+  static const int defaultPagesPerStep = 1024;
+
+  // Copy a file that is not being written, replacing to; None if it could not be copied
+  static Method copyFile(const std::string &from, const std::string &to)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("Snapshot::copyFile", "load");
+    Method method = copyFileLevel(from, to);
+    if (method != Method::None) {
+      return method;
+    }
+    std::error_code error;
+    if (std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, error)) {
+      return Method::Stream;
+    }
+    return Method::None;
+  }
+
+  // Copy the SQLite database at from to a consistent snapshot at to, replacing it; None, with no file left at to, if
+  // it could not be copied or the token was canceled
+  static Method copyDatabase(const std::string &from, const std::string &to,
+    const CancellationToken &token = CancellationToken(), int pagesPerStep = defaultPagesPerStep)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("Snapshot::copyDatabase", "load");
+    Method method = Method::None;
+    sqlite3 *source = nullptr;
+    std::string uri = SqlFile::uriFromPath(from) + "?mode=ro";
+    if (sqlite3_open_v2(uri.c_str(), &source, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, NULL) == SQLITE_OK) {
+      sqlite3_busy_timeout(source, 1000);
+      bool wal = walMode(source);
+      if (!wal && beginRead(source)) {
+        method = copyFileLevel(from, to);
+        endRead(source);
+      }
+      if (method == Method::None && !token.isCanceled()) {
+        if (!wal) {
+          method = backup(source, to, token, pagesPerStep);
+        } else if (beginRead(source)) {
+          method = backup(source, to, token, -1);
+          endRead(source);
+        }
+      }
+    }
+    sqlite3_close(source);
+    if (method == Method::None) {
+      std::error_code error;
+      std::filesystem::remove(to, error);
+    }
+    return method;
+  }
+
+private:
+  static bool walMode(sqlite3 *db)
+  {
+    sqlite3_stmt *stmt = nullptr;
+    bool wal = false;
+    if (sqlite3_prepare_v2(db, "PRAGMA journal_mode", -1, &stmt, NULL) == SQLITE_OK
+      && sqlite3_step(stmt) == SQLITE_ROW) {
+      const unsigned char *mode = sqlite3_column_text(stmt, 0);
+      wal = mode && std::string(reinterpret_cast<const char *>(mode)) == "wal";
+    }
+    sqlite3_finalize(stmt);
+    return wal;
+  }
+
+  // Start a read transaction on db, which keeps its view of the database (and without WAL a shared lock) until endRead
+  static bool beginRead(sqlite3 *db)
+  {
+    if (sqlite3_exec(db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+      return false;
+    }
+    // BEGIN is deferred, the transaction only starts reading with the first statement
+    if (sqlite3_exec(db, "SELECT COUNT(*) FROM sqlite_master", NULL, NULL, NULL) != SQLITE_OK) {
+      endRead(db);
+      return false;
+    }
+    return true;
+  }
+
+  static void endRead(sqlite3 *db)
+  {
+    if (sqlite3_exec(db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+      sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+    }
+  }
+
+  // A clone or an in kernel copy, None where neither is available
+  static Method copyFileLevel(const std::string &from, const std::string &to)
+  {
+#ifdef __linux__
+    int in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) {
+      return Method::None;
+    }
+    struct stat info;
+    if (fstat(in, &info) != 0) {
+      ::close(in);
+      return Method::None;
+    }
+    int out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, info.st_mode & 0777);
+    if (out < 0) {
+      ::close(in);
+      return Method::None;
+    }
+
+    Method method = Method::None;
+#ifdef FICLONE
+    if (ioctl(out, FICLONE, in) == 0) {
+      method = Method::Clone;
+    }
+#endif
+    if (method == Method::None) {
+      // both calls advance the file offsets, so sendfile carries on where copy_file_range stopped
+      off_t remaining = info.st_size;
+      const off_t chunk = off_t(1) << 30;
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || (__GLIBC_MINOR__ >= 27))
+      while (remaining > 0) {
+        ssize_t copied = copy_file_range(in, nullptr, out, nullptr, static_cast<size_t>(std::min(remaining, chunk)), 0);
+        if (copied <= 0) {
+          break;
+        }
+        remaining -= copied;
+      }
+#endif
+      while (remaining > 0) {
+        ssize_t copied = ::sendfile(out, in, nullptr, static_cast<size_t>(std::min(remaining, chunk)));
+        if (copied <= 0) {
+          break;
+        }
+        remaining -= copied;
+      }
+      if (remaining == 0) {
+        method = Method::KernelCopy;
+      }
+    }
+    ::close(in);
+    if (::close(out) != 0) {
+      method = Method::None;
+    }
+    if (method == Method::None) {
+      ::unlink(to.c_str());
+    }
+    return method;
+#else
+    return Method::None;
+#endif
+  }
+
+  static Method backup(sqlite3 *source, const std::string &to, const CancellationToken &token, int pagesPerStep)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("Snapshot::backup", "load");
+    std::error_code error;
+    std::filesystem::remove(to, error);
+    sqlite3 *destination = nullptr;
+    if (sqlite3_open_v2(to.c_str(), &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK) {
+      sqlite3_close(destination);
+      return Method::None;
+    }
+    // the copy is private and is thrown away if anything fails, so it needs no journal or syncs until it is done
+    sqlite3_exec(destination, "PRAGMA journal_mode=OFF; PRAGMA synchronous=OFF;", NULL, NULL, NULL);
+
+    int result = SQLITE_ERROR;
+    sqlite3_backup *backup = sqlite3_backup_init(destination, "main", source, "main");
+    if (backup) {
+      // the source is locked only during a step; a write by another connection between steps restarts the copy, and
+      // a single step (-1) copies everything at once
+      do {
+        if (token.isCanceled()) {
+          result = SQLITE_INTERRUPT;
+          break;
+        }
+        result = sqlite3_backup_step(backup, pagesPerStep);
+        if (result == SQLITE_BUSY || result == SQLITE_LOCKED) {
+          sqlite3_sleep(10);
+        }
+      } while (result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED);
+      sqlite3_backup_finish(backup);
+    }
+    // a copy of a WAL database is read through immutable connections, which have no -wal file to use
+    if (result == SQLITE_DONE
+      && sqlite3_exec(destination, "PRAGMA journal_mode=DELETE;", NULL, NULL, NULL) != SQLITE_OK) {
+      result = SQLITE_ERROR;
+    }
+    sqlite3_close(destination);
+    if (result != SQLITE_DONE) {
+      std::filesystem::remove(to, error);
+      return Method::None;
+    }
+    return Method::Backup;
+  }
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_SNAPSHOT_HPP
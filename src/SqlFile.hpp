@@ -25,26 +25,237 @@
 #ifndef RESULTSVIEWER_SQLFILE_HPP
 #define RESULTSVIEWER_SQLFILE_HPP
 
-//#include "TimeSeries.hpp"
+#include "TimeSeries.hpp"
+#include "ColumnarCache.hpp"
+#include "Tracer.hpp"
 #include <sqlite3/sqlite3.h>
 #include <string>
 #include <memory>
 #include <regex>
 #include <sstream>
 #include <iostream>
+#include <map>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <atomic>
 
 namespace resultsviewer{
 
 // HVAC System Timestep, Zone Timestep, Hourly, Daily, Monthly, RunPerio
 enum class ReportingFrequency { Detailed=1, Timestep, Hourly, Daily, Monthly, RunPeriod };
 
+/**
+DataDictionaryItem is one report variable or meter for one environment period.
+*/
+struct DataDictionaryItem
+{
+  DataDictionaryItem(int index, int envPeriodIndex, const std::string &name, const std::string &keyValue,
+    const std::string &envPeriod, const std::string &reportingFrequency, const std::string &units, const std::string &table)
+    : index(index), envPeriodIndex(envPeriodIndex), name(name), keyValue(keyValue), envPeriod(envPeriod),
+    reportingFrequency(reportingFrequency), units(units), table(table)
+  {}
+
+  int index;
+  int envPeriodIndex;
+  std::string name;
+  std::string keyValue;
+  std::string envPeriod;
+  std::string reportingFrequency;
+  std::string units;
+  std::string table;
+};
+
+/**
+TimeSeriesColumns holds the report data of several dictionary entries for one environment period, read in a single
+pass over ReportData. All columns share one seconds column; a value is NaN where its variable has no report at that time.
+*/
+struct TimeSeriesColumns
+{
+  int envPeriodIndex = 0;
+  // calendar day of the first report, seconds are measured from midnight of that day
+  int startMonth = 1;
+  int startDay = 1;
+  std::vector<int> dictionaryIndices;
+  TimeSeriesArray<long long> seconds;
+  std::vector<TimeSeriesArray<double>> values;
+};
+
+/**
+TailPosition marks how far a reader has got through the report data of one environment period of a file that is still
+being written, so that the next read picks up only the rows written since.
+*/
+struct TailPosition
+{
+  int envPeriodIndex = 0;
+  // SimulationDays and calendar day of the first report of the period, as for TimeSeriesColumns
+  int firstSimulationDay = 1;
+  int startMonth = 1;
+  int startDay = 1;
+  // the last Time row that had reports, and the last ReportData row read
+  long long lastTimeIndex = 0;
+  long long lastReportDataIndex = 0;
+};
+
+/**
+IlluminanceMapInfo names a daylighting illuminance map with the environment period and zone it was reported for.
+*/
+struct IlluminanceMapInfo
+{
+  std::string name;
+  std::string envPeriod;
+  std::string zoneName;
+};
+
+/**
+IlluminanceMapGrid holds the points of a daylighting illuminance map, which are the same for every hourly report of the
+map: the distinct x and y coordinates, increasing. A report's illuminance is stored with x varying fastest.
+*/
+struct IlluminanceMapGrid
+{
+  std::vector<double> x;
+  std::vector<double> y;
+
+  size_t size() const
+  {
+    return x.size() * y.size();
+  }
+};
+
+/**
+SqlStatement is a prepared sqlite3 statement with typed parameter binding and typed column readers.
+*/
+class SqlStatement
+{
+public:
+  SqlStatement(sqlite3 *db, const std::string &sql) : m_stmt(nullptr)
+  {
+    if (db) {
+      if (sqlite3_prepare_v2(db, sql.c_str(), -1, &m_stmt, nullptr) != SQLITE_OK) {
+        sqlite3_finalize(m_stmt);
+        m_stmt = nullptr;
+      }
+    }
+  }
+
+  ~SqlStatement()
+  {
+    sqlite3_finalize(m_stmt);
+  }
+
+  SqlStatement(const SqlStatement &) = delete;
+  SqlStatement &operator=(const SqlStatement &) = delete;
+
+  bool isValid() const
+  {
+    return m_stmt != nullptr;
+  }
+
+  // Rewind the statement and clear all bound parameters
+  void reset()
+  {
+    if (m_stmt) {
+      sqlite3_reset(m_stmt);
+      sqlite3_clear_bindings(m_stmt);
+    }
+  }
+
+  // Parameter indices are 1-based, as in sqlite3_bind_*
+  void bind(int index, int value)
+  {
+    sqlite3_bind_int(m_stmt, index, value);
+  }
+
+  void bind(int index, long long value)
+  {
+    sqlite3_bind_int64(m_stmt, index, value);
+  }
+
+  void bind(int index, double value)
+  {
+    sqlite3_bind_double(m_stmt, index, value);
+  }
+
+  void bind(int index, const std::string &value)
+  {
+    sqlite3_bind_text(m_stmt, index, value.c_str(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+  }
+
+  void bind(int index, const char *value)
+  {
+    sqlite3_bind_text(m_stmt, index, value, -1, SQLITE_TRANSIENT);
+  }
+
+  // Bind the arguments to parameters 1, 2, ... in order
+  template <typename... Args> void bindAll(const Args&... args)
+  {
+    int index = 1;
+    (void)index;
+    (bind(index++, args), ...);
+  }
+
+  // Step to the next row, returns false when there are no more rows (or on error)
+  bool step()
+  {
+    return m_stmt && sqlite3_step(m_stmt) == SQLITE_ROW;
+  }
+
+  // Column indices are 0-based, as in sqlite3_column_*
+  int columnInt(int col) const
+  {
+    return sqlite3_column_int(m_stmt, col);
+  }
+
+  long long columnInt64(int col) const
+  {
+    return sqlite3_column_int64(m_stmt, col);
+  }
+
+  double columnDouble(int col) const
+  {
+    return sqlite3_column_double(m_stmt, col);
+  }
+
+  std::string columnText(int col) const
+  {
+    const unsigned char *text = sqlite3_column_text(m_stmt, col);
+    if (!text) {
+      return std::string();
+    }
+    return std::string(reinterpret_cast<const char*>(text), sqlite3_column_bytes(m_stmt, col));
+  }
+
+  bool columnIsNull(int col) const
+  {
+    return sqlite3_column_type(m_stmt, col) == SQLITE_NULL;
+  }
+
+private:
+  sqlite3_stmt *m_stmt;
+};
+
 /**
 SqlFile is a sqlite3 database interface class for E+ output.
 */
 class SqlFile
 {
 public:
-  explicit SqlFile(const std::string &path) : m_sqlite3(NULL), m_path(path), m_connected(false)
+  /**
+  OpenMode selects how the connection treats the file. ReadWrite is the historical exclusive open. ReadOnly opens
+  with query_only set and a memory-mapped page cache, but still takes shared locks so a file that E+ is writing
+  stays consistent. Immutable additionally tells sqlite that nothing will change the file, so it skips locking and
+  change detection entirely; use it only for finished results or private copies.
+  */
+  enum class OpenMode { ReadWrite, ReadOnly, Immutable };
+
+  // A columnar cache of the file, if given, supplies the data dictionary and all report data reads
+  explicit SqlFile(const std::string &path, OpenMode mode = OpenMode::ReadWrite,
+    std::shared_ptr<const ColumnarCache> columnarCache = nullptr) : m_sqlite3(NULL), m_path(path), m_mode(mode),
+    m_connected(false), m_columnarCache(columnarCache)
   {
     open(m_path);
   }
@@ -54,36 +265,565 @@ public:
     close();
   }
 
+  SqlFile(const SqlFile &) = delete;
+  SqlFile &operator=(const SqlFile &) = delete;
+
+  bool connectionOpen() const
+  {
+    return m_connected;
+  }
+
+  std::string energyPlusSqliteFile() const
+  {
+    return m_path;
+  }
+
+  OpenMode openMode() const
+  {
+    return m_mode;
+  }
+
   std::string versionString() const
   {
     std::string result;
-    if (m_sqlite3) {
-      sqlite3_stmt* sqlStmtPtr;
-      sqlite3_prepare_v2(m_sqlite3, "SELECT EnergyPlusVersion FROM Simulations", -1, &sqlStmtPtr, 0);
-      int code = sqlite3_step(sqlStmtPtr);
-      if (code == SQLITE_ROW) {
-        // in 8.1 this is 'EnergyPlus-Windows-32 8.1.0.008, YMD=2014.11.08 22:49'
-        // in 8.2 this is 'EnergyPlus, Version 8.2.0-8397c2e30b, YMD=2015.01.09 08:37'
-        // radiance script is writing 'EnergyPlus, VERSION 8.2, (OpenStudio) YMD=2015.1.9 08:35:36'
-        // in 8.8 this is 'EnergyPlus, Version 8.8.0-7c3bbe4830, YMD=2017.11.23 11:10'
-        std::regex version_regex("\\d\\.\\d[\\.\\d]*");
-        std::string version_line = columnText(sqlite3_column_text(sqlStmtPtr, 0));
-        std::smatch version_match;
-
-        if (std::regex_search(version_line, version_match, version_regex)) {
-          result = version_match[0].str();
+    auto version_line = execAndReturnFirstString("SELECT EnergyPlusVersion FROM Simulations");
+    if (version_line) {
+      // in 8.1 this is 'EnergyPlus-Windows-32 8.1.0.008, YMD=2014.11.08 22:49'
+      // in 8.2 this is 'EnergyPlus, Version 8.2.0-8397c2e30b, YMD=2015.01.09 08:37'
+      // radiance script is writing 'EnergyPlus, VERSION 8.2, (OpenStudio) YMD=2015.1.9 08:35:36'
+      // in 8.8 this is 'EnergyPlus, Version 8.8.0-7c3bbe4830, YMD=2017.11.23 11:10'
+      static const std::regex version_regex("\\d\\.\\d[\\.\\d]*");
+      std::smatch version_match;
+
+      if (std::regex_search(*version_line, version_match, version_regex)) {
+        result = version_match[0].str();
+      }
+    }
+    return result;
+  }
+
+  const std::vector<DataDictionaryItem> &dataDictionary() const
+  {
+    return m_dataDictionary;
+  }
+
+  // Serve report data reads from a cache of this file instead of ReportData. The cache must have been opened against
+  // this file (ColumnarCache::open checks that), and only suits files that are no longer being written.
+  void setColumnarCache(std::shared_ptr<const ColumnarCache> columnarCache)
+  {
+    m_columnarCache = columnarCache;
+  }
+
+  const std::shared_ptr<const ColumnarCache> &columnarCache() const
+  {
+    return m_columnarCache;
+  }
+
+  // Write a columnar cache of the whole file to path, reading ReportData once for every batch of entries of each
+  // environment period. The entries keep only the times at which they reported.
+  bool writeColumnarCache(const std::string &path) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::writeColumnarCache", "sql");
+    std::optional<ColumnarCache::SourceStamp> source = ColumnarCache::SourceStamp::of(m_path);
+    if (!m_sqlite3 || !source) {
+      return false;
+    }
+    ColumnarCacheWriter writer(path, *source);
+    if (!writer.isOpen()) {
+      return false;
+    }
+    std::map<int, std::vector<const DataDictionaryItem*>> itemsOf;
+    for (const auto &item : m_dataDictionary) {
+      itemsOf[item.envPeriodIndex].push_back(&item);
+    }
+    const size_t batchSize = 500;
+    std::vector<long long> seconds;
+    std::vector<double> values;
+    for (const auto &envPeriod : itemsOf) {
+      const std::vector<const DataDictionaryItem*> &items = envPeriod.second;
+      for (size_t first = 0; first < items.size(); first += batchSize) {
+        size_t last = std::min(first + batchSize, items.size());
+        std::vector<int> dictionaryIndices;
+        for (size_t i = first; i < last; ++i) {
+          dictionaryIndices.push_back(items[i]->index);
+        }
+        TimeSeriesColumns columns = readTimeSeriesColumns(envPeriod.first, dictionaryIndices);
+        for (size_t i = first; i < last; ++i) {
+          const DataDictionaryItem &item = *items[i];
+          const TimeSeriesArray<double> &column = columns.values[i - first];
+          seconds.clear();
+          values.clear();
+          for (size_t j = 0; j < column.size(); ++j) {
+            if (!std::isnan(column[j])) {
+              seconds.push_back(columns.seconds[j]);
+              values.push_back(column[j]);
+            }
+          }
+          ColumnarCache::Entry entry;
+          entry.index = item.index;
+          entry.envPeriodIndex = item.envPeriodIndex;
+          entry.name = item.name;
+          entry.keyValue = item.keyValue;
+          entry.envPeriod = item.envPeriod;
+          entry.reportingFrequency = item.reportingFrequency;
+          entry.units = item.units;
+          entry.table = item.table;
+          entry.startMonth = columns.startMonth;
+          entry.startDay = columns.startDay;
+          writer.add(entry, seconds.data(), values.data(), seconds.size());
         }
       }
-      sqlite3_finalize(sqlStmtPtr);
     }
+    return writer.finish();
+  }
+
+  // Abort any running query soon after the flag is set, from whichever thread sets it. Pass nullptr to remove.
+  void setInterruptFlag(const std::atomic<bool> *flag)
+  {
+    if (!m_sqlite3) {
+      return;
+    }
+    if (flag) {
+      sqlite3_progress_handler(m_sqlite3, 1000, [](void *data) -> int {
+        return static_cast<const std::atomic<bool>*>(data)->load() ? 1 : 0;
+      }, const_cast<std::atomic<bool>*>(flag));
+    } else {
+      sqlite3_progress_handler(m_sqlite3, 0, NULL, NULL);
+    }
+  }
+
+  // The frequency named by a ReportingFrequency column, ignoring case and spaces ("Run Period", "Zone Timestep")
+  static std::optional<ReportingFrequency> reportingFrequencyFromDB(const std::string &name)
+  {
+    std::string key;
+    for (char c : name) {
+      if (c != ' ') {
+        key += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+      }
+    }
+    if (key == "HVACSYSTEMTIMESTEP" || key == "DETAILED" || key == "EACHCALL") {
+      return ReportingFrequency::Detailed;
+    } else if (key == "ZONETIMESTEP" || key == "TIMESTEP") {
+      return ReportingFrequency::Timestep;
+    } else if (key == "HOURLY") {
+      return ReportingFrequency::Hourly;
+    } else if (key == "DAILY") {
+      return ReportingFrequency::Daily;
+    } else if (key == "MONTHLY") {
+      return ReportingFrequency::Monthly;
+    } else if (key == "RUNPERIOD" || key == "ENVIRONMENT" || key == "ANNUAL") {
+      return ReportingFrequency::RunPeriod;
+    }
+    return std::nullopt;
+  }
+
+  // Index of the environment period with the given name (case insensitive)
+  std::optional<int> envPeriodIndex(const std::string &envPeriod) const
+  {
+    std::string upperEnvPeriod = toUpper(envPeriod);
+    for (const auto &item : m_dataDictionary) {
+      if (item.envPeriod == upperEnvPeriod) {
+        return item.envPeriodIndex;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Dictionary entry matching the tree/table selection, nullptr if there is none
+  const DataDictionaryItem *dataDictionaryItem(const std::string &envPeriod, const std::string &reportingFrequency,
+    const std::string &name, const std::string &keyValue) const
+  {
+    std::string upperEnvPeriod = toUpper(envPeriod);
+    std::string upperFrequency = toUpper(reportingFrequency);
+    for (const auto &item : m_dataDictionary) {
+      if (item.name == name && item.keyValue == keyValue && item.envPeriod == upperEnvPeriod
+        && toUpper(item.reportingFrequency) == upperFrequency) {
+        return &item;
+      }
+    }
+    return nullptr;
+  }
+
+  // Extract the values of all the given ReportDataDictionaryIndex values for one environment period with a single
+  // sequential scan of ReportData. The Time rows of the period are decoded once and shared by every column. With a
+  // columnar cache the columns come from the cache instead, without a copy when they all reported at the same times.
+  TimeSeriesColumns timeSeriesColumns(int envPeriodIndex, const std::vector<int> &dictionaryIndices) const
+  {
+    if (m_columnarCache) {
+      return cachedTimeSeriesColumns(envPeriodIndex, dictionaryIndices);
+    }
+    return readTimeSeriesColumns(envPeriodIndex, dictionaryIndices);
+  }
+
+  // Time series for one column of a batch extraction, skipping the times at which that variable was not reported.
+  // A column that was reported at every time shares the batch's seconds and values without copying them.
+  std::optional<TimeSeries> timeSeries(const TimeSeriesColumns &columns, size_t column, const std::string &units) const
+  {
+    if (column >= columns.values.size()) {
+      return std::nullopt;
+    }
+    QDateTime start(QDate(calendarYear, columns.startMonth, columns.startDay));
+    const TimeSeriesArray<double> &columnValues = columns.values[column];
+    size_t count = std::count_if(columnValues.begin(), columnValues.end(), [](double v) { return !std::isnan(v); });
+    if (count == 0) {
+      return std::nullopt;
+    }
+    if (count == columnValues.size()) {
+      return TimeSeries(start, columns.seconds, columnValues, units);
+    }
+    TimeSeriesArray<long long>::storage_type seconds;
+    TimeSeriesArray<double>::storage_type values;
+    seconds.reserve(count);
+    values.reserve(count);
+    for (size_t i = 0; i < columnValues.size(); ++i) {
+      if (!std::isnan(columnValues[i])) {
+        seconds.push_back(columns.seconds[i]);
+        values.push_back(columnValues[i]);
+      }
+    }
+    return TimeSeries(start, TimeSeriesArray<long long>(std::move(seconds)), TimeSeriesArray<double>(std::move(values)), units);
+  }
+
+  // Time series for a single variable, a batch of one
+  std::optional<TimeSeries> timeSeries(const std::string &envPeriod, const std::string &reportingFrequency,
+    const std::string &name, const std::string &keyValue) const
+  {
+    const DataDictionaryItem *item = dataDictionaryItem(envPeriod, reportingFrequency, name, keyValue);
+    if (!item) {
+      return std::nullopt;
+    }
+    return timeSeries(timeSeriesColumns(item->envPeriodIndex, { item->index }), 0, item->units);
+  }
+
+  // Counter that changes whenever another connection commits to the file, -1 if it cannot be read. Polling it is
+  // much cheaper than querying the data.
+  long long dataVersion() const
+  {
+    SqlStatement &stmt = statement("PRAGMA data_version");
+    long long result = stmt.step() ? stmt.columnInt64(0) : -1;
+    stmt.reset(); // do not hold the read transaction open against the writer
+    return result;
+  }
+
+  // Position in an environment period just after the report at afterSeconds (seconds from midnight of the period's
+  // first day, as in TimeSeriesColumns), or at the start of the period if afterSeconds is not given. E+ writes
+  // ReportData in TimeIndex order, so the last row at or before that report is found by a binary search on the rowid.
+  std::optional<TailPosition> tailPosition(int envPeriodIndex, std::optional<long long> afterSeconds = std::nullopt) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::tailPosition", "sql");
+    if (!m_sqlite3) {
+      return std::nullopt;
+    }
+    TailPosition result;
+    result.envPeriodIndex = envPeriodIndex;
+    SqlStatement &timeStmt = statement("SELECT TimeIndex, Month, Day, Hour, Minute, SimulationDays FROM Time "
+      "WHERE EnvironmentPeriodIndex=? AND (WarmupFlag IS NULL OR WarmupFlag=0) ORDER BY TimeIndex");
+    timeStmt.bind(1, envPeriodIndex);
+    bool first = true;
+    while (timeStmt.step()) {
+      if (first) {
+        result.startMonth = timeStmt.columnInt(1);
+        result.startDay = timeStmt.columnInt(2);
+        result.firstSimulationDay = timeStmt.columnInt(5);
+        first = false;
+      }
+      if (!afterSeconds || timeSeconds(timeStmt, result.firstSimulationDay) > *afterSeconds) {
+        break;
+      }
+      result.lastTimeIndex = timeStmt.columnInt64(0);
+    }
+    timeStmt.reset();
+    if (first) {
+      return std::nullopt;
+    }
+
+    // the first rowid whose row is after lastTimeIndex, or one past the end
+    SqlStatement &rangeStmt = statement("SELECT MIN(ReportDataIndex), MAX(ReportDataIndex) FROM ReportData");
+    if (!rangeStmt.step() || rangeStmt.columnIsNull(0)) {
+      rangeStmt.reset();
+      return result;
+    }
+    long long low = rangeStmt.columnInt64(0);
+    long long high = rangeStmt.columnInt64(1) + 1;
+    rangeStmt.reset();
+    SqlStatement &rowStmt = statement("SELECT TimeIndex FROM ReportData WHERE ReportDataIndex>=? "
+      "ORDER BY ReportDataIndex LIMIT 1");
+    while (low < high) {
+      long long middle = low + (high - low) / 2;
+      rowStmt.reset();
+      rowStmt.bind(1, middle);
+      if (rowStmt.step() && rowStmt.columnInt64(0) <= result.lastTimeIndex) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    rowStmt.reset();
+    result.lastReportDataIndex = low - 1;
+    return result;
+  }
+
+  // The report data of the given variables written since position, which is advanced past it. Only the Time and
+  // ReportData rows after the position are read, by rowid range, so the cost is proportional to what was written.
+  // The columns' seconds are measured from the same day as those of timeSeriesColumns for the period.
+  TimeSeriesColumns timeSeriesColumnsAfter(TailPosition &position, const std::vector<int> &dictionaryIndices) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::timeSeriesColumnsAfter", "sql");
+    TimeSeriesColumns result;
+    result.envPeriodIndex = position.envPeriodIndex;
+    result.startMonth = position.startMonth;
+    result.startDay = position.startDay;
+    result.dictionaryIndices = dictionaryIndices;
+    result.values.resize(dictionaryIndices.size());
+    if (!m_sqlite3 || dictionaryIndices.empty()) {
+      return result;
+    }
+
+    // rows past this may be half written when they are read, so leave them for next time
+    SqlStatement &lastStmt = statement("SELECT MAX(ReportDataIndex) FROM ReportData");
+    long long lastReportDataIndex = lastStmt.step() ? lastStmt.columnInt64(0) : 0;
+    lastStmt.reset();
+    if (lastReportDataIndex <= position.lastReportDataIndex) {
+      return result;
+    }
+
+    // the last time read may still be getting reports, so it is read again
+    std::unordered_map<int, long long> secondsOf;
+    SqlStatement &timeStmt = statement("SELECT TimeIndex, Month, Day, Hour, Minute, SimulationDays FROM Time "
+      "WHERE EnvironmentPeriodIndex=? AND TimeIndex>=? AND (WarmupFlag IS NULL OR WarmupFlag=0) ORDER BY TimeIndex");
+    timeStmt.bind(1, position.envPeriodIndex);
+    timeStmt.bind(2, position.lastTimeIndex);
+    while (timeStmt.step()) {
+      secondsOf.emplace(timeStmt.columnInt(0), timeSeconds(timeStmt, position.firstSimulationDay));
+    }
+
+    std::unordered_map<int, size_t> columnOf;
+    for (size_t i = 0; i < dictionaryIndices.size(); ++i) {
+      columnOf.emplace(dictionaryIndices[i], i);
+    }
+    SqlStatement &stmt = reportDataStatement(dictionaryIndices, true);
+    int parameters = dictionaryIndices.size() <= 500 ? static_cast<int>(dictionaryIndices.size()) : 0;
+    stmt.bind(parameters + 1, position.lastReportDataIndex);
+    stmt.bind(parameters + 2, lastReportDataIndex);
+    long long lastTimeIndex = readReportData(stmt, columnOf, secondsOf, result);
+    position.lastTimeIndex = std::max(position.lastTimeIndex, lastTimeIndex);
+    position.lastReportDataIndex = lastReportDataIndex;
+    return result;
+  }
+
+  // E+ output does not record a calendar year, use a non-leap year so days of the year line up
+  static const int calendarYear = 2009;
+
+  // The illuminance maps in the file in map number order
+  std::vector<IlluminanceMapInfo> illuminanceMaps() const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::illuminanceMaps", "sql");
+    std::vector<IlluminanceMapInfo> result;
+    SqlStatement &stmt = statement("SELECT DaylightMaps.MapName, DaylightMaps.Environment, Zones.ZoneName FROM DaylightMaps "
+      "LEFT JOIN Zones ON Zones.ZoneIndex=DaylightMaps.Zone ORDER BY DaylightMaps.MapNumber");
+    while (stmt.step()) {
+      result.push_back(IlluminanceMapInfo{ stmt.columnText(0), stmt.columnText(1), stmt.columnText(2) });
+    }
+    return result;
+  }
+
+  // The hourly reports of an illuminance map in report order, with the date and time at the end of each hour
+  std::vector<std::pair<int, QDateTime>> illuminanceMapHourlyReportIndicesDates(const std::string &mapName) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::illuminanceMapHourlyReportIndicesDates", "sql");
+    std::vector<std::pair<int, QDateTime>> result;
+    SqlStatement &stmt = statement("SELECT HourlyReportIndex, Month, DayOfMonth, Hour FROM DaylightMapHourlyReports "
+      "WHERE MapNumber=(SELECT MapNumber FROM DaylightMaps WHERE MapName=?) ORDER BY HourlyReportIndex");
+    stmt.bindAll(mapName);
+    while (stmt.step()) {
+      QDateTime dateTime(QDate(calendarYear, stmt.columnInt(1), stmt.columnInt(2)));
+      result.push_back(std::make_pair(stmt.columnInt(0), dateTime.addSecs(3600LL * stmt.columnInt(3))));
+    }
+    return result;
+  }
+
+  // Smallest and largest illuminance over all hourly reports of an illuminance map
+  std::optional<std::pair<double, double>> illuminanceMapMinMaxValue(const std::string &mapName) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::illuminanceMapMinMaxValue", "sql");
+    SqlStatement &stmt = statement("SELECT MIN(Illuminance), MAX(Illuminance) FROM DaylightMapHourlyData WHERE HourlyReportIndex IN "
+      "(SELECT HourlyReportIndex FROM DaylightMapHourlyReports WHERE MapNumber=(SELECT MapNumber FROM DaylightMaps WHERE MapName=?))");
+    stmt.bindAll(mapName);
+    if (stmt.step() && !stmt.columnIsNull(0)) {
+      return std::make_pair(stmt.columnDouble(0), stmt.columnDouble(1));
+    }
+    return std::nullopt;
+  }
+
+  // Reference point 1 or 2 of an illuminance map as written by E+, e.g. "RefPt1=(2.50:2.00:0.80)"
+  std::optional<std::string> illuminanceMapRefPt(const std::string &mapName, int refPtNumber) const
+  {
+    if (refPtNumber == 1) {
+      return execAndReturnFirstString("SELECT ReferencePt1 FROM DaylightMaps WHERE MapName=?", mapName);
+    } else if (refPtNumber == 2) {
+      return execAndReturnFirstString("SELECT ReferencePt2 FROM DaylightMaps WHERE MapName=?", mapName);
+    }
+    return std::nullopt;
+  }
+
+  // The grid of the illuminance map that a report belongs to
+  IlluminanceMapGrid illuminanceMapGrid(int hourlyReportIndex) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::illuminanceMapGrid", "sql");
+    IlluminanceMapGrid grid;
+    grid.x = execAndReturnVectorOfDouble("SELECT DISTINCT X FROM DaylightMapHourlyData WHERE HourlyReportIndex=? ORDER BY X",
+      hourlyReportIndex);
+    grid.y = execAndReturnVectorOfDouble("SELECT DISTINCT Y FROM DaylightMapHourlyData WHERE HourlyReportIndex=? ORDER BY Y",
+      hourlyReportIndex);
+    return grid;
+  }
+
+  // The illuminance of one hourly report on the map's grid, x varying fastest, NaN at points the report lacks
+  std::vector<double> illuminanceMap(int hourlyReportIndex, const IlluminanceMapGrid &grid) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::illuminanceMap", "sql");
+    std::vector<double> result(grid.size(), std::numeric_limits<double>::quiet_NaN());
+    SqlStatement &stmt = statement("SELECT X, Y, Illuminance FROM DaylightMapHourlyData WHERE HourlyReportIndex=?");
+    stmt.bindAll(hourlyReportIndex);
+    while (stmt.step()) {
+      auto i = std::lower_bound(grid.x.begin(), grid.x.end(), stmt.columnDouble(0));
+      auto j = std::lower_bound(grid.y.begin(), grid.y.end(), stmt.columnDouble(1));
+      if (i != grid.x.end() && *i == stmt.columnDouble(0) && j != grid.y.end() && *j == stmt.columnDouble(1)) {
+        result[(j - grid.y.begin()) * grid.x.size() + (i - grid.x.begin())] = stmt.columnDouble(2);
+      }
+    }
+    return result;
+  }
+
+  // Prepared statement for sql, compiled on first use and cached by the SQL text (the query shape), so
+  // values should be passed as bound '?' parameters rather than formatted into the string. The statement
+  // is reset with no bindings; it is owned by this object and only valid until the next call with the
+  // same SQL text, so nested queries must use different text.
+  SqlStatement &statement(const std::string &sql) const
+  {
+    auto iter = m_statements.find(sql);
+    if (iter == m_statements.end()) {
+      RESULTSVIEWER_TRACE_SCOPE("SqlFile::prepare", "sql");
+      iter = m_statements.emplace(sql, std::unique_ptr<SqlStatement>(new SqlStatement(m_sqlite3, sql))).first;
+    } else {
+      iter->second->reset();
+    }
+    return *(iter->second);
+  }
+
+  // Number of distinct statements currently held in the cache
+  size_t preparedStatementCount() const
+  {
+    return m_statements.size();
+  }
+
+  template <typename... Args> std::optional<int> execAndReturnFirstInt(const std::string &sql, const Args&... args) const
+  {
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    std::optional<int> result;
+    if (stmt.step() && !stmt.columnIsNull(0)) {
+      result = stmt.columnInt(0);
+    }
+    // a statement left on its first row would hold a read lock against anything writing the file
+    stmt.reset();
+    return result;
+  }
+
+  template <typename... Args> std::optional<double> execAndReturnFirstDouble(const std::string &sql, const Args&... args) const
+  {
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    std::optional<double> result;
+    if (stmt.step() && !stmt.columnIsNull(0)) {
+      result = stmt.columnDouble(0);
+    }
+    stmt.reset();
+    return result;
+  }
+
+  template <typename... Args> std::optional<std::string> execAndReturnFirstString(const std::string &sql, const Args&... args) const
+  {
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    std::optional<std::string> result;
+    if (stmt.step() && !stmt.columnIsNull(0)) {
+      result = stmt.columnText(0);
+    }
+    stmt.reset();
     return result;
   }
 
+  template <typename... Args> std::vector<int> execAndReturnVectorOfInt(const std::string &sql, const Args&... args) const
+  {
+    std::vector<int> result;
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    while (stmt.step()) {
+      result.push_back(stmt.columnInt(0));
+    }
+    return result;
+  }
+
+  template <typename... Args> std::vector<double> execAndReturnVectorOfDouble(const std::string &sql, const Args&... args) const
+  {
+    std::vector<double> result;
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    while (stmt.step()) {
+      result.push_back(stmt.columnDouble(0));
+    }
+    return result;
+  }
+
+  template <typename... Args> std::vector<std::string> execAndReturnVectorOfString(const std::string &sql, const Args&... args) const
+  {
+    std::vector<std::string> result;
+    SqlStatement &stmt = statement(sql);
+    stmt.bindAll(args...);
+    while (stmt.step()) {
+      result.push_back(stmt.columnText(0));
+    }
+    return result;
+  }
+
+  // Memory map up to this many bytes of a read only file
+  static const long long readOnlyMmapSize = 1LL << 30;
+  // Page cache size for read only files in KiB (a negative cache_size is in KiB rather than pages)
+  static const int readOnlyCacheSize = 32768;
+
+  // sqlite file URI for a filesystem path, see https://www.sqlite.org/uri.html
+  static std::string uriFromPath(const std::string &path)
+  {
+    std::string uri = "file:";
+    std::string normalized = path;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+    // drive letter paths need an empty authority to stay absolute, and UNC paths one so that the server is not
+    // taken for the authority, which sqlite rejects unless it is localhost
+    if (normalized.size() > 1 && normalized[1] == ':') {
+      uri += "///";
+    } else if (normalized.compare(0, 2, "//") == 0) {
+      uri += "//";
+    }
+    const char *hex = "0123456789ABCDEF";
+    for (unsigned char c : normalized) {
+      if (c == '?' || c == '#' || c == '%' || c == '&' || c == '=' || c < 0x20) {
+        uri += '%';
+        uri += hex[c >> 4];
+        uri += hex[c & 0xF];
+      } else {
+        uri += static_cast<char>(c);
+      }
+    }
+    return uri;
+  }
+
 private:
 
-  std::string columnText(const unsigned char* column) const
+  static std::string toUpper(std::string s)
   {
-    return std::string(reinterpret_cast<const char*>(column));
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+    return s;
   }
 
   bool versionCheck()
@@ -109,13 +849,29 @@ private:
 
   bool open(const std::string &path)
   {
-
-    int result = sqlite3_open_v2(path.c_str(), &m_sqlite3, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_EXCLUSIVE, NULL);
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::open", "sql");
+    int result;
+    if (m_mode == OpenMode::ReadWrite) {
+      result = sqlite3_open_v2(path.c_str(), &m_sqlite3, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_EXCLUSIVE, NULL);
+    } else {
+      // read only opens never create the file and never need a journal
+      std::string uri = uriFromPath(path) + "?mode=ro";
+      if (m_mode == OpenMode::Immutable) {
+        uri += "&immutable=1";
+      }
+      result = sqlite3_open_v2(uri.c_str(), &m_sqlite3, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX, NULL);
+    }
 
     if (result == 0) {
+      if (m_mode != OpenMode::ReadWrite) {
+        std::stringstream pragmas;
+        pragmas << "PRAGMA query_only=1; PRAGMA mmap_size=" << readOnlyMmapSize << "; PRAGMA cache_size=-" << readOnlyCacheSize << ";";
+        sqlite3_exec(m_sqlite3, pragmas.str().c_str(), NULL, NULL, NULL);
+      }
       if (!versionCheck()) {
-        sqlite3_close(m_sqlite3);
+        close();
         //throw openstudio::Exception("OpenStudio is not compatible with this file.");
+        return false;
       }
       // Set a 1 second timeout
       result = sqlite3_busy_timeout(m_sqlite3, 1000);
@@ -124,115 +880,291 @@ private:
       //code = sqlite3_exec(m_db, "PRAGMA locking_mode=EXCLUSIVE", NULL, NULL, NULL);
 
       // retrieve DataDictionaryTable
-      //retrieveDataDictionary();
+      if (m_columnarCache) {
+        retrieveCachedDataDictionary();
+      } else {
+        retrieveDataDictionary();
+      }
       m_connected = true;
     }
     else {
+      close();
       //throw openstudio::Exception("File not successfully opened.");
     }
     return m_connected;
   }
 
-  bool SqlFile::close()
+  bool close()
   {
+    // statements must be finalized before the connection can be closed
+    m_statements.clear();
     if (m_sqlite3)
     {
       sqlite3_close(m_sqlite3);
       m_sqlite3 = NULL;
     }
+    m_connected = false;
     return true;
   }
 
   void retrieveDataDictionary()
   {
-    std::string table, name, keyValue, units, rf;
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::retrieveDataDictionary", "sql");
+    m_dataDictionary.clear();
 
     if (m_sqlite3)
     {
-      int dictionaryIndex, code;
-
-      std::stringstream s;
-      sqlite3_stmt* sqlStmtPtr;
       std::map<int, std::string> envPeriods;
-      std::map<int, std::string>::iterator envPeriodsItr;
 
-      s << "SELECT EnvironmentPeriodIndex, EnvironmentName FROM EnvironmentPeriods";
-      sqlite3_prepare_v2(m_db, s.str().c_str(), -1, &sqlStmtPtr, nullptr);
-      code = sqlite3_step(sqlStmtPtr);
-      while (code == SQLITE_ROW)
+      SqlStatement &envStmt = statement("SELECT EnvironmentPeriodIndex, EnvironmentName FROM EnvironmentPeriods");
+      while (envStmt.step())
       {
-        std::string queryEnvPeriod = boost::to_upper_copy(columnText(sqlite3_column_text(sqlStmtPtr, 1)));
-        envPeriods.insert(std::pair<int, std::string>(sqlite3_column_int(sqlStmtPtr, 0), queryEnvPeriod));
-        code = sqlite3_step(sqlStmtPtr);
+        envPeriods[envStmt.columnInt(0)] = toUpper(envStmt.columnText(1));
       }
-      sqlite3_finalize(sqlStmtPtr);
 
-      s.str("");
-      s << "SELECT ReportMeterDataDictionaryIndex, VariableName, KeyValue, ReportingFrequency, VariableUnits";
-      s << " FROM ReportMeterDataDictionary";
-      code = sqlite3_prepare_v2(m_db, s.str().c_str(), -1, &sqlStmtPtr, nullptr);
-
-      table = "ReportMeterData";
-
-      code = sqlite3_step(sqlStmtPtr);
-      while (code == SQLITE_ROW)
+      SqlStatement &stmt = statement("SELECT ReportDataDictionaryIndex, Name, KeyValue, ReportingFrequency, Units "
+        "FROM ReportDataDictionary");
+      std::string table = "ReportData";
+      while (stmt.step())
       {
-        dictionaryIndex = sqlite3_column_int(sqlStmtPtr, 0);
-        name = columnText(sqlite3_column_text(sqlStmtPtr, 1));
-        keyValue = columnText(sqlite3_column_text(sqlStmtPtr, 2));
-        rf = columnText(sqlite3_column_text(sqlStmtPtr, 3));
-        units = columnText(sqlite3_column_text(sqlStmtPtr, 4));
-
-        for (envPeriodsItr = envPeriods.begin();
-          envPeriodsItr != envPeriods.end();
-          ++envPeriodsItr)
+        int dictionaryIndex = stmt.columnInt(0);
+        std::string name = stmt.columnText(1);
+        std::string keyValue = stmt.columnText(2);
+        std::string rf = stmt.columnText(3);
+        std::string units = stmt.columnText(4);
+
+        for (const auto &envPeriod : envPeriods)
         {
-          std::string queryEnvPeriod = boost::to_upper_copy(envPeriodsItr->second);
-          m_dataDictionary.insert(DataDictionaryItem(dictionaryIndex, envPeriodsItr->first, name, keyValue, queryEnvPeriod, rf, units, table));
-          LOG(Trace, "Creating data dictionary item " << dictionaryIndex << ", " << (*envPeriodsItr).first
-            << ", " << name << ", " << keyValue << ", " << queryEnvPeriod << ", " << rf << ", "
-            << units << ", " << table << ".");
+          m_dataDictionary.emplace_back(dictionaryIndex, envPeriod.first, name, keyValue, envPeriod.second, rf, units, table);
         }
+      }
+    }
+  }
+
+  // One scan of ReportData for timeSeriesColumns
+  TimeSeriesColumns readTimeSeriesColumns(int envPeriodIndex, const std::vector<int> &dictionaryIndices) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::readTimeSeriesColumns", "sql");
+    TimeSeriesColumns result;
+    result.envPeriodIndex = envPeriodIndex;
+    result.dictionaryIndices = dictionaryIndices;
+    result.values.resize(dictionaryIndices.size());
+    if (!m_sqlite3 || dictionaryIndices.empty()) {
+      return result;
+    }
+
+    std::unordered_map<int, size_t> columnOf;
+    for (size_t i = 0; i < dictionaryIndices.size(); ++i) {
+      columnOf.emplace(dictionaryIndices[i], i);
+    }
 
-        code = sqlite3_step(sqlStmtPtr);
+    // TimeIndex -> seconds from midnight of the first day of the period
+    std::unordered_map<int, long long> secondsOf;
+    SqlStatement &timeStmt = statement("SELECT TimeIndex, Month, Day, Hour, Minute, SimulationDays FROM Time "
+      "WHERE EnvironmentPeriodIndex=? AND (WarmupFlag IS NULL OR WarmupFlag=0) ORDER BY TimeIndex");
+    timeStmt.bind(1, envPeriodIndex);
+    bool first = true;
+    int firstSimulationDay = 1;
+    while (timeStmt.step()) {
+      if (first) {
+        result.startMonth = timeStmt.columnInt(1);
+        result.startDay = timeStmt.columnInt(2);
+        firstSimulationDay = timeStmt.columnInt(5);
+        first = false;
       }
-      sqlite3_finalize(sqlStmtPtr);
+      secondsOf.emplace(timeStmt.columnInt(0), timeSeconds(timeStmt, firstSimulationDay));
+    }
+    if (secondsOf.empty()) {
+      return result;
+    }
 
-      s.str("");
-      s << "SELECT ReportVariableDatadictionaryIndex, VariableName, KeyValue, ReportingFrequency, VariableUnits";
-      s << " FROM ReportVariableDatadictionary";
-      code = sqlite3_prepare_v2(m_db, s.str().c_str(), -1, &sqlStmtPtr, nullptr);
+    SqlStatement &stmt = reportDataStatement(dictionaryIndices, false);
+    readReportData(stmt, columnOf, secondsOf, result);
+    return result;
+  }
 
-      table = "ReportVariableData";
+  // E+ writes the end of the interval, with minute 0 on the hour (hour 24 is the end of the day). The statement's
+  // columns 3 to 5 are Hour, Minute and SimulationDays.
+  static long long timeSeconds(const SqlStatement &timeStmt, int firstSimulationDay)
+  {
+    long long days = timeStmt.columnInt(5) - firstSimulationDay;
+    return 86400 * days + 3600 * timeStmt.columnInt(3) + 60 * timeStmt.columnInt(4);
+  }
 
-      code = sqlite3_step(sqlStmtPtr);
-      while (code == SQLITE_ROW)
-      {
-        dictionaryIndex = sqlite3_column_int(sqlStmtPtr, 0);
-        name = columnText(sqlite3_column_text(sqlStmtPtr, 1));
-        keyValue = columnText(sqlite3_column_text(sqlStmtPtr, 2));
-        rf = columnText(sqlite3_column_text(sqlStmtPtr, 3));
-        units = columnText(sqlite3_column_text(sqlStmtPtr, 4));
-
-        for (envPeriodsItr = envPeriods.begin();
-          envPeriodsItr != envPeriods.end();
-          ++envPeriodsItr)
-        {
-          std::string queryEnvPeriod = boost::to_upper_copy(envPeriodsItr->second);
-          m_dataDictionary.insert(DataDictionaryItem(dictionaryIndex, envPeriodsItr->first, name, keyValue, queryEnvPeriod, rf, units, table));
+  // The ReportData rows of the given variables in rowid order, optionally only those with ReportDataIndex in the
+  // range bound to the last two parameters
+  SqlStatement &reportDataStatement(const std::vector<int> &dictionaryIndices, bool range) const
+  {
+    // Large requests skip the IN list (and the parameter limit) and are filtered by readReportData instead
+    std::stringstream s;
+    s << "SELECT TimeIndex, ReportDataDictionaryIndex, Value FROM ReportData";
+    bool filterInQuery = dictionaryIndices.size() <= 500;
+    if (filterInQuery) {
+      s << " WHERE ReportDataDictionaryIndex IN (?";
+      for (size_t i = 1; i < dictionaryIndices.size(); ++i) {
+        s << ",?";
+      }
+      s << ")";
+    }
+    if (range) {
+      s << (filterInQuery ? " AND" : " WHERE") << " ReportDataIndex>? AND ReportDataIndex<=?";
+    }
+    // E+ appends rows in time order, so rowid order is TimeIndex order without a sort
+    s << " ORDER BY ReportDataIndex";
+    SqlStatement &stmt = statement(s.str());
+    if (filterInQuery) {
+      for (size_t i = 0; i < dictionaryIndices.size(); ++i) {
+        stmt.bind(static_cast<int>(i + 1), dictionaryIndices[i]);
+      }
+    }
+    return stmt;
+  }
+
+  // Add the rows of a reportDataStatement to the columns of result, one row of the columns per TimeIndex. Rows for
+  // other variables or for times not in secondsOf (another environment period or warmup) are skipped. Returns the
+  // largest TimeIndex added, or 0 if there were none.
+  long long readReportData(SqlStatement &stmt, const std::unordered_map<int, size_t> &columnOf,
+    const std::unordered_map<int, long long> &secondsOf, TimeSeriesColumns &result) const
+  {
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    std::vector<int> timeIndices;
+    TimeSeriesArray<long long>::storage_type allSeconds;
+    std::vector<TimeSeriesArray<double>::storage_type> allValues(result.values.size());
+    while (stmt.step()) {
+      auto column = columnOf.find(stmt.columnInt(1));
+      if (column == columnOf.end()) {
+        continue;
+      }
+      int timeIndex = stmt.columnInt(0);
+      auto seconds = secondsOf.find(timeIndex);
+      if (seconds == secondsOf.end()) {
+        continue;
+      }
+      size_t row;
+      if (timeIndices.empty() || timeIndex > timeIndices.back()) {
+        row = timeIndices.size();
+        timeIndices.push_back(timeIndex);
+        allSeconds.push_back(seconds->second);
+        for (auto &values : allValues) {
+          values.push_back(missing);
         }
+      } else {
+        // out of order rows are not written by E+, but handle them anyway
+        auto iter = std::lower_bound(timeIndices.begin(), timeIndices.end(), timeIndex);
+        row = iter - timeIndices.begin();
+        if (*iter != timeIndex) {
+          timeIndices.insert(iter, timeIndex);
+          allSeconds.insert(allSeconds.begin() + row, seconds->second);
+          for (auto &values : allValues) {
+            values.insert(values.begin() + row, missing);
+          }
+        }
+      }
+      allValues[column->second][row] = stmt.columnDouble(2);
+    }
+    result.seconds = TimeSeriesArray<long long>(std::move(allSeconds));
+    for (size_t i = 0; i < allValues.size(); ++i) {
+      result.values[i] = TimeSeriesArray<double>(std::move(allValues[i]));
+    }
+    return timeIndices.empty() ? 0 : timeIndices.back();
+  }
 
-        // step to next row
-        code = sqlite3_step(sqlStmtPtr);
+  // timeSeriesColumns from the cache. Columns that share a grid share its seconds, otherwise the times are merged.
+  TimeSeriesColumns cachedTimeSeriesColumns(int envPeriodIndex, const std::vector<int> &dictionaryIndices) const
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::cachedTimeSeriesColumns", "sql");
+    TimeSeriesColumns result;
+    result.envPeriodIndex = envPeriodIndex;
+    result.dictionaryIndices = dictionaryIndices;
+    result.values.resize(dictionaryIndices.size());
+
+    // the entries with data, and whether they all have the same grid
+    std::vector<std::optional<size_t>> entries;
+    std::optional<uint32_t> commonGrid;
+    bool sameGrid = true;
+    for (int dictionaryIndex : dictionaryIndices) {
+      std::optional<size_t> entry = m_columnarCache->find(dictionaryIndex, envPeriodIndex);
+      if (entry && m_columnarCache->grid(*entry) == ColumnarCache::noGrid) {
+        entry.reset();
+      }
+      if (entry) {
+        ColumnarCache::Entry info = m_columnarCache->entry(*entry);
+        result.startMonth = info.startMonth;
+        result.startDay = info.startDay;
+        uint32_t grid = m_columnarCache->grid(*entry);
+        sameGrid = sameGrid && (!commonGrid || *commonGrid == grid);
+        commonGrid = grid;
+      } else {
+        sameGrid = false;
+      }
+      entries.push_back(entry);
+    }
+    if (entries.empty()) {
+      return result;
+    }
+
+    if (sameGrid) {
+      result.seconds = m_columnarCache->seconds(*entries.front());
+      for (size_t i = 0; i < entries.size(); ++i) {
+        result.values[i] = m_columnarCache->values(*entries[i]);
+      }
+      return result;
+    }
+
+    TimeSeriesArray<long long>::storage_type allSeconds;
+    for (const auto &entry : entries) {
+      if (entry) {
+        TimeSeriesArray<long long> seconds = m_columnarCache->seconds(*entry);
+        allSeconds.insert(allSeconds.end(), seconds.begin(), seconds.end());
       }
-      sqlite3_finalize(sqlStmtPtr);
     }
-    LOG(Debug, "Dictionary Built");
+    if (allSeconds.empty()) {
+      return result;
+    }
+    std::sort(allSeconds.begin(), allSeconds.end());
+    allSeconds.erase(std::unique(allSeconds.begin(), allSeconds.end()), allSeconds.end());
+    for (size_t i = 0; i < entries.size(); ++i) {
+      TimeSeriesArray<double>::storage_type values(allSeconds.size(), std::numeric_limits<double>::quiet_NaN());
+      if (entries[i]) {
+        TimeSeriesArray<long long> seconds = m_columnarCache->seconds(*entries[i]);
+        TimeSeriesArray<double> entryValues = m_columnarCache->values(*entries[i]);
+        size_t row = 0;
+        for (size_t j = 0; j < seconds.size(); ++j) {
+          while (allSeconds[row] < seconds[j]) {
+            ++row;
+          }
+          values[row] = entryValues[j];
+        }
+      }
+      result.values[i] = TimeSeriesArray<double>(std::move(values));
+    }
+    result.seconds = TimeSeriesArray<long long>(std::move(allSeconds));
+    return result;
+  }
+
+  void retrieveCachedDataDictionary()
+  {
+    RESULTSVIEWER_TRACE_SCOPE("SqlFile::retrieveCachedDataDictionary", "sql");
+    m_dataDictionary.clear();
+    m_dataDictionary.reserve(m_columnarCache->size());
+    for (size_t i = 0; i < m_columnarCache->size(); ++i) {
+      ColumnarCache::Entry entry = m_columnarCache->entry(i);
+      m_dataDictionary.emplace_back(entry.index, entry.envPeriodIndex, std::string(entry.name), std::string(entry.keyValue),
+        std::string(entry.envPeriod), std::string(entry.reportingFrequency), std::string(entry.units), std::string(entry.table));
+    }
+    // the same order as retrieveDataDictionary, the cache is written a period at a time
+    std::sort(m_dataDictionary.begin(), m_dataDictionary.end(), [](const DataDictionaryItem &a, const DataDictionaryItem &b) {
+      return a.index < b.index || (a.index == b.index && a.envPeriodIndex < b.envPeriodIndex);
+    });
   }
 
   sqlite3* m_sqlite3;
   std::string m_path;
+  OpenMode m_mode;
   bool m_connected;
+  std::shared_ptr<const ColumnarCache> m_columnarCache;
+  std::vector<DataDictionaryItem> m_dataDictionary;
+  mutable std::map<std::string, std::unique_ptr<SqlStatement>> m_statements;
 
 };
 
@@ -0,0 +1,307 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_SQLFILEPOOL_HPP
+#define RESULTSVIEWER_SQLFILEPOOL_HPP
+
+#include "SqlFile.hpp"
+#include "ThreadPool.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/**
+SqlFilePool keeps long lived connections to one file and hands them out as leases, so that repeated queries reuse a
+connection's page cache, data dictionary and prepared statements instead of opening the file again. A SqlFile is not
+safe to share between threads, so each lease is exclusive until it is destroyed; connections are opened on demand up
+to a maximum (by default one per worker thread plus one for the GUI thread), after which acquire waits for a lease to
+be returned. Leases taken for background work leave one connection of a pool with more than one for interactive
+leases, so that the GUI thread does not wait on loads, cache builds and prefetches that hold all the others. The most
+recently returned connection is handed out first, as it has the warmest cache.
+*/
+class SqlFilePool
+{
+  struct State
+  {
+    State(const std::string &path, SqlFile::OpenMode mode, size_t maxConnections) : path(path), mode(mode),
+      maxConnections(maxConnections), openConnections(0), workerLeases(0)
+    {}
+
+    // the most leases that may be held for background work at once
+    size_t maxWorkerLeases() const
+    {
+      return maxConnections > 1 ? maxConnections - 1 : maxConnections;
+    }
+
+    std::string path;
+    SqlFile::OpenMode mode;
+    size_t maxConnections;
+    size_t openConnections;
+    size_t workerLeases;
+    std::shared_ptr<const ColumnarCache> columnarCache;
+    std::vector<std::unique_ptr<SqlFile>> idle;
+    std::mutex mutex;
+    std::condition_variable returned;
+  };
+
+public:
+  /// Who a lease is for: the GUI thread, or work in the background that must leave it a connection
+  enum class Priority { Interactive, Worker };
+
+  /// An exclusive loan of a connection, returned to the pool when the lease is destroyed
+  class Lease
+  {
+  public:
+    Lease()
+    {}
+
+    Lease(Lease &&other) = default;
+
+    Lease &operator=(Lease &&other)
+    {
+      if (this != &other) {
+        release();
+        m_state = std::move(other.m_state);
+        m_sqlFile = std::move(other.m_sqlFile);
+        m_priority = other.m_priority;
+      }
+      return *this;
+    }
+
+    ~Lease()
+    {
+      release();
+    }
+
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+
+    // False for a default constructed lease or one that was moved from
+    explicit operator bool() const
+    {
+      return m_sqlFile != nullptr;
+    }
+
+    SqlFile &operator*() const
+    {
+      return *m_sqlFile;
+    }
+
+    SqlFile *operator->() const
+    {
+      return m_sqlFile.get();
+    }
+
+  private:
+    friend class SqlFilePool;
+
+    Lease(std::shared_ptr<State> state, std::unique_ptr<SqlFile> sqlFile, Priority priority) : m_state(state),
+      m_sqlFile(std::move(sqlFile)), m_priority(priority)
+    {}
+
+    void release()
+    {
+      if (!m_sqlFile) {
+        return;
+      }
+      // a flag set for the lease must not outlive it
+      m_sqlFile->setInterruptFlag(nullptr);
+      {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        if (m_sqlFile->connectionOpen()) {
+          m_state->idle.push_back(std::move(m_sqlFile));
+        } else {
+          --m_state->openConnections;
+        }
+        if (m_priority == Priority::Worker) {
+          --m_state->workerLeases;
+        }
+      }
+      m_sqlFile.reset();
+      // waiters differ in what they may take, so wake them all
+      m_state->returned.notify_all();
+      m_state.reset();
+    }
+
+    std::shared_ptr<State> m_state;
+    std::unique_ptr<SqlFile> m_sqlFile;
+    Priority m_priority = Priority::Interactive;
+  };
+
+  /// Open the first connection now, so that connectionOpen tells whether the file can be read. A file opened
+  /// ReadWrite gets a single connection. If a columnar cache path is given and the cache there is current, every
+  /// connection, the first included, reads its data dictionary and report data from it; a cache that is missing or
+  /// stale is left for useColumnarCache to build.
+  explicit SqlFilePool(const std::string &path, SqlFile::OpenMode mode = SqlFile::OpenMode::ReadOnly,
+    size_t maxConnections = defaultMaxConnections(), const std::string &columnarCachePath = std::string())
+    : m_state(std::make_shared<State>(path, mode, mode == SqlFile::OpenMode::ReadWrite ? 1 : std::max<size_t>(maxConnections, 1)))
+  {
+    if (!columnarCachePath.empty() && mode != SqlFile::OpenMode::ReadWrite) {
+      m_state->columnarCache = ColumnarCache::open(columnarCachePath, path);
+    }
+    std::unique_ptr<SqlFile> first(new SqlFile(path, mode, m_state->columnarCache));
+    m_connectionOpen = first->connectionOpen();
+    if (m_connectionOpen) {
+      m_state->idle.push_back(std::move(first));
+      m_state->openConnections = 1;
+    }
+  }
+
+  SqlFilePool(const SqlFilePool &) = delete;
+  SqlFilePool &operator=(const SqlFilePool &) = delete;
+
+  const std::string &path() const
+  {
+    return m_state->path;
+  }
+
+  SqlFile::OpenMode openMode() const
+  {
+    return m_state->mode;
+  }
+
+  /// True if the file could be opened when the pool was made
+  bool connectionOpen() const
+  {
+    return m_connectionOpen;
+  }
+
+  /// Lease a connection, opening one if none is idle and waiting if the maximum are leased, or for a worker if the
+  /// connections left are kept for interactive leases. Code running off the GUI thread passes Priority::Worker. The
+  /// connection of the lease may fail to open (if the file went away), check connectionOpen before use.
+  Lease acquire(Priority priority = Priority::Interactive)
+  {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->returned.wait(lock, [this, priority] { return available(priority); });
+    return take(lock, priority);
+  }
+
+  /// Lease a connection if one may be had without waiting, otherwise return an empty lease
+  Lease tryAcquire(Priority priority = Priority::Interactive)
+  {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    if (!available(priority)) {
+      return Lease();
+    }
+    return take(lock, priority);
+  }
+
+  size_t maxConnections() const
+  {
+    return m_state->maxConnections;
+  }
+
+  size_t openConnections() const
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->openConnections;
+  }
+
+  size_t idleConnections() const
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->idle.size();
+  }
+
+  /// Serve the report data of every connection from the columnar cache at cachePath, building the cache first if it
+  /// is missing or was made from an older version of the file. Building scans the whole file on a worker lease, so
+  /// call this off the GUI thread. Not for a file opened ReadWrite, which may change.
+  bool useColumnarCache(const std::string &cachePath)
+  {
+    if (!m_connectionOpen || m_state->mode == SqlFile::OpenMode::ReadWrite) {
+      return false;
+    }
+    if (columnarCache()) {
+      return true;
+    }
+    std::shared_ptr<const ColumnarCache> columnarCache = ColumnarCache::open(cachePath, m_state->path);
+    if (!columnarCache) {
+      Lease lease = acquire(Priority::Worker);
+      if (!lease->connectionOpen() || !lease->writeColumnarCache(cachePath)) {
+        return false;
+      }
+      columnarCache = ColumnarCache::open(cachePath, m_state->path);
+      if (!columnarCache) {
+        return false;
+      }
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->columnarCache = columnarCache;
+    return true;
+  }
+
+  std::shared_ptr<const ColumnarCache> columnarCache() const
+  {
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->columnarCache;
+  }
+
+  /// One connection for each worker of a default ThreadPool and one for the GUI thread
+  static size_t defaultMaxConnections()
+  {
+    return ThreadPool::defaultThreadCount() + 1;
+  }
+
+private:
+  bool available(Priority priority) const
+  {
+    if (priority == Priority::Worker && m_state->workerLeases >= m_state->maxWorkerLeases()) {
+      return false;
+    }
+    return !m_state->idle.empty() || m_state->openConnections < m_state->maxConnections;
+  }
+
+  Lease take(std::unique_lock<std::mutex> &lock, Priority priority)
+  {
+    if (priority == Priority::Worker) {
+      ++m_state->workerLeases;
+    }
+    if (!m_state->idle.empty()) {
+      std::unique_ptr<SqlFile> sqlFile = std::move(m_state->idle.back());
+      m_state->idle.pop_back();
+      if (sqlFile->columnarCache() != m_state->columnarCache) {
+        sqlFile->setColumnarCache(m_state->columnarCache);
+      }
+      return Lease(m_state, std::move(sqlFile), priority);
+    }
+    // reserve the slot, then open without holding the lock
+    ++m_state->openConnections;
+    std::shared_ptr<const ColumnarCache> columnarCache = m_state->columnarCache;
+    lock.unlock();
+    return Lease(m_state, std::unique_ptr<SqlFile>(new SqlFile(m_state->path, m_state->mode, columnarCache)), priority);
+  }
+
+  std::shared_ptr<State> m_state;
+  bool m_connectionOpen;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_SQLFILEPOOL_HPP
@@ -0,0 +1,235 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_STATISTICS_HPP
+#define RESULTSVIEWER_STATISTICS_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#define RESULTSVIEWER_STATISTICS_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESULTSVIEWER_STATISTICS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace resultsviewer{
+
+/**
+Statistics holds the summary statistics of a series of values. The variance is the population variance.
+*/
+struct Statistics
+{
+  size_t count = 0;
+  double minimum = std::numeric_limits<double>::quiet_NaN();
+  double maximum = std::numeric_limits<double>::quiet_NaN();
+  double sum = 0.0;
+  double mean = std::numeric_limits<double>::quiet_NaN();
+  double variance = std::numeric_limits<double>::quiet_NaN();
+
+  double stdev() const
+  {
+    return std::sqrt(variance);
+  }
+};
+
+namespace detail{
+
+// Running statistics of one lane, combined with Chan et al.'s pairwise update
+struct StatisticsAccumulator
+{
+  double count = 0.0;
+  double minimum = std::numeric_limits<double>::infinity();
+  double maximum = -std::numeric_limits<double>::infinity();
+  double sum = 0.0;
+  double mean = 0.0;
+  double m2 = 0.0;
+
+  void add(double value)
+  {
+    count += 1.0;
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+    sum += value;
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+  }
+
+  void add(const StatisticsAccumulator &other)
+  {
+    if (other.count == 0.0) {
+      return;
+    }
+    if (count == 0.0) {
+      *this = other;
+      return;
+    }
+    double total = count + other.count;
+    double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    m2 += other.m2 + delta * delta * count * other.count / total;
+    count = total;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    sum += other.sum;
+  }
+};
+
+#if defined(RESULTSVIEWER_STATISTICS_AVX2) || defined(RESULTSVIEWER_STATISTICS_SSE2)
+
+#if defined(RESULTSVIEWER_STATISTICS_AVX2)
+const size_t statisticsLanes = 4;
+typedef __m256d StatisticsVector;
+inline StatisticsVector statisticsLoad(const double *p) { return _mm256_loadu_pd(p); }
+inline StatisticsVector statisticsSet(double v) { return _mm256_set1_pd(v); }
+inline StatisticsVector statisticsAdd(StatisticsVector a, StatisticsVector b) { return _mm256_add_pd(a, b); }
+inline StatisticsVector statisticsSub(StatisticsVector a, StatisticsVector b) { return _mm256_sub_pd(a, b); }
+inline StatisticsVector statisticsMul(StatisticsVector a, StatisticsVector b) { return _mm256_mul_pd(a, b); }
+inline StatisticsVector statisticsMin(StatisticsVector a, StatisticsVector b) { return _mm256_min_pd(a, b); }
+inline StatisticsVector statisticsMax(StatisticsVector a, StatisticsVector b) { return _mm256_max_pd(a, b); }
+inline void statisticsStore(double *p, StatisticsVector a) { _mm256_storeu_pd(p, a); }
+#else
+const size_t statisticsLanes = 2;
+typedef __m128d StatisticsVector;
+inline StatisticsVector statisticsLoad(const double *p) { return _mm_loadu_pd(p); }
+inline StatisticsVector statisticsSet(double v) { return _mm_set1_pd(v); }
+inline StatisticsVector statisticsAdd(StatisticsVector a, StatisticsVector b) { return _mm_add_pd(a, b); }
+inline StatisticsVector statisticsSub(StatisticsVector a, StatisticsVector b) { return _mm_sub_pd(a, b); }
+inline StatisticsVector statisticsMul(StatisticsVector a, StatisticsVector b) { return _mm_mul_pd(a, b); }
+inline StatisticsVector statisticsMin(StatisticsVector a, StatisticsVector b) { return _mm_min_pd(a, b); }
+inline StatisticsVector statisticsMax(StatisticsVector a, StatisticsVector b) { return _mm_max_pd(a, b); }
+inline void statisticsStore(double *p, StatisticsVector a) { _mm_storeu_pd(p, a); }
+#endif
+
+// Welford's update run in every lane at once; all lanes see the same count, so one reciprocal serves them all
+inline StatisticsAccumulator vectorStatistics(const double *values, size_t n)
+{
+  StatisticsAccumulator result;
+  size_t blocks = n / statisticsLanes;
+  if (blocks > 0) {
+    StatisticsVector vmin = statisticsLoad(values);
+    StatisticsVector vmax = vmin;
+    StatisticsVector vsum = statisticsSet(0.0);
+    StatisticsVector vmean = statisticsSet(0.0);
+    StatisticsVector vm2 = statisticsSet(0.0);
+    for (size_t k = 0; k < blocks; ++k) {
+      StatisticsVector v = statisticsLoad(values + k * statisticsLanes);
+      vmin = statisticsMin(vmin, v);
+      vmax = statisticsMax(vmax, v);
+      vsum = statisticsAdd(vsum, v);
+      StatisticsVector delta = statisticsSub(v, vmean);
+      vmean = statisticsAdd(vmean, statisticsMul(delta, statisticsSet(1.0 / static_cast<double>(k + 1))));
+      vm2 = statisticsAdd(vm2, statisticsMul(delta, statisticsSub(v, vmean)));
+    }
+    double mins[statisticsLanes], maxs[statisticsLanes], sums[statisticsLanes], means[statisticsLanes], m2s[statisticsLanes];
+    statisticsStore(mins, vmin);
+    statisticsStore(maxs, vmax);
+    statisticsStore(sums, vsum);
+    statisticsStore(means, vmean);
+    statisticsStore(m2s, vm2);
+    for (size_t lane = 0; lane < statisticsLanes; ++lane) {
+      StatisticsAccumulator laneResult;
+      laneResult.count = static_cast<double>(blocks);
+      laneResult.minimum = mins[lane];
+      laneResult.maximum = maxs[lane];
+      laneResult.sum = sums[lane];
+      laneResult.mean = means[lane];
+      laneResult.m2 = m2s[lane];
+      result.add(laneResult);
+    }
+  }
+  StatisticsAccumulator tail;
+  for (size_t i = blocks * statisticsLanes; i < n; ++i) {
+    tail.add(values[i]);
+  }
+  result.add(tail);
+  return result;
+}
+
+#endif
+
+inline StatisticsAccumulator scalarStatistics(const double *values, size_t n)
+{
+  StatisticsAccumulator result;
+  for (size_t i = 0; i < n; ++i) {
+    result.add(values[i]);
+  }
+  return result;
+}
+
+}; // detail namespace
+
+// Compute all of the summary statistics of values[0, n) in a single pass
+inline Statistics computeStatistics(const double *values, size_t n, bool forceScalar = false)
+{
+  Statistics result;
+  if (n == 0) {
+    return result;
+  }
+#if defined(RESULTSVIEWER_STATISTICS_AVX2) || defined(RESULTSVIEWER_STATISTICS_SSE2)
+  detail::StatisticsAccumulator accumulator = forceScalar ? detail::scalarStatistics(values, n) : detail::vectorStatistics(values, n);
+#else
+  (void)forceScalar;
+  detail::StatisticsAccumulator accumulator = detail::scalarStatistics(values, n);
+#endif
+  result.count = n;
+  result.minimum = accumulator.minimum;
+  result.maximum = accumulator.maximum;
+  result.sum = accumulator.sum;
+  result.mean = accumulator.mean;
+  result.variance = accumulator.m2 / static_cast<double>(n);
+  return result;
+}
+
+// The statistics of the concatenation of two series of values, from the statistics of each
+inline Statistics combineStatistics(const Statistics &a, const Statistics &b)
+{
+  if (b.count == 0) {
+    return a;
+  }
+  if (a.count == 0) {
+    return b;
+  }
+  Statistics result;
+  double na = static_cast<double>(a.count);
+  double nb = static_cast<double>(b.count);
+  double total = na + nb;
+  double delta = b.mean - a.mean;
+  result.count = a.count + b.count;
+  result.minimum = std::min(a.minimum, b.minimum);
+  result.maximum = std::max(a.maximum, b.maximum);
+  result.sum = a.sum + b.sum;
+  result.mean = a.mean + delta * nb / total;
+  result.variance = (a.variance * na + b.variance * nb + delta * delta * na * nb / total) / total;
+  return result;
+}
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_STATISTICS_HPP
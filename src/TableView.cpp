@@ -28,20 +28,190 @@
 
 #include "TableView.hpp"
 
-#include "../utilities/sql/SqlFileEnums.hpp"
-
 #include <QHeaderView>
 #include <QMouseEvent>
 
-using openstudio::toString;
-using openstudio::toQString;
-using openstudio::ReportingFrequency;
-using namespace openstudio;
+#include <algorithm>
+#include <numeric>
 
 namespace resultsviewer{
 
-  TableView::TableView( QWidget* parent):QTableWidget(0,6,parent)
+  DataDictionaryModel::DataDictionaryModel(const QStringList &headers, QObject *parent)
+    : QAbstractTableModel(parent), m_headers(headers), m_filtered(false), m_sortColumn(-1), m_sortOrder(Qt::AscendingOrder)
+  {
+  }
+
+  int DataDictionaryModel::rowCount(const QModelIndex &parent) const
+  {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+  }
+
+  int DataDictionaryModel::columnCount(const QModelIndex &parent) const
+  {
+    return parent.isValid() ? 0 : dictionaryColumnCount;
+  }
+
+  QVariant DataDictionaryModel::data(const QModelIndex &index, int role) const
+  {
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size())) return QVariant();
+    size_t row = m_rows[index.row()];
+    DictionaryColumn column = static_cast<DictionaryColumn>(index.column());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+      return QString::fromStdString(m_store.text(row, column));
+    case Qt::TextAlignmentRole:
+      return int(Qt::AlignLeft | Qt::AlignVCenter);
+    case Qt::UserRole:
+      // as the table widget items held them: the data type on File and the map name on Alias
+      if (column == DictionaryColumn::File) return m_store.dataType(row);
+      if (column == DictionaryColumn::Alias) return QString::fromStdString(m_store.dbIdentifier(row));
+      break;
+    }
+    return QVariant();
+  }
+
+  QVariant DataDictionaryModel::headerData(int section, Qt::Orientation orientation, int role) const
+  {
+    if ((orientation == Qt::Horizontal) && (role == Qt::DisplayRole) && (section >= 0) && (section < m_headers.count()))
+      return m_headers[section];
+    return QAbstractTableModel::headerData(section, orientation, role);
+  }
+
+  void DataDictionaryModel::sort(int column, Qt::SortOrder order)
+  {
+    m_sortColumn = column;
+    m_sortOrder = order;
+
+    // keep the selection and current index on the same store rows
+    emit layoutAboutToBeChanged();
+    QModelIndexList oldIndexes = persistentIndexList();
+    std::vector<size_t> oldRows;
+    for (const QModelIndex &index : oldIndexes) oldRows.push_back(m_rows[index.row()]);
+
+    updateRows();
+
+    std::vector<int> newRow(m_store.size(), -1);
+    for (size_t i = 0; i < m_rows.size(); ++i) newRow[m_rows[i]] = static_cast<int>(i);
+    QModelIndexList newIndexes;
+    for (int i = 0; i < oldIndexes.count(); ++i)
+    {
+      newIndexes << (newRow[oldRows[i]] < 0 ? QModelIndex() : index(newRow[oldRows[i]], oldIndexes[i].column()));
+    }
+    changePersistentIndexList(oldIndexes, newIndexes);
+    emit layoutChanged();
+  }
+
+  void DataDictionaryModel::updateRows()
+  {
+    if (m_filtered)
+    {
+      m_rows = m_store.matchRows(m_filter);
+    }
+    else
+    {
+      m_rows.resize(m_store.size());
+      std::iota(m_rows.begin(), m_rows.end(), 0);
+    }
+    if ((m_sortColumn >= 0) && (m_sortColumn < dictionaryColumnCount))
+    {
+      m_store.sortRows(m_rows, static_cast<DictionaryColumn>(m_sortColumn), m_sortOrder == Qt::AscendingOrder);
+    }
+  }
+
+  bool DataDictionaryModel::addFile(const QString &alias, const SqlFile &sqlFile)
+  {
+    return addFiles({ std::make_pair(alias, &sqlFile) });
+  }
+
+  bool DataDictionaryModel::addFiles(const std::vector<std::pair<QString, const SqlFile *> > &files)
   {
+    // one reset and one pass over the rows for the whole batch
+    bool added = false;
+    beginResetModel();
+    for (const auto &file : files)
+    {
+      const QString &alias = file.first;
+      const SqlFile &sqlFile = *file.second;
+      if (alias.isEmpty() || !sqlFile.connectionOpen()) continue;
+      if (!m_store.addFile(sqlFile.energyPlusSqliteFile(), alias.toStdString())) continue;
+      added = true;
+
+      for (const DataDictionaryItem &item : sqlFile.dataDictionary())
+      {
+        // skip runPeriod
+        std::optional<ReportingFrequency> frequency = SqlFile::reportingFrequencyFromDB(item.reportingFrequency);
+        if (frequency && (*frequency != ReportingFrequency::RunPeriod))
+        {
+          m_store.addRow(item.name, item.keyValue, item.reportingFrequency, item.envPeriod, RVD_TIMESERIES);
+        }
+      }
+
+      /* illuminance maps
+         update based on email from Dan 8/10/10: reporting frequency is Hourly, key value is the illuminance zone */
+      for (const IlluminanceMapInfo &map : sqlFile.illuminanceMaps())
+      {
+        m_store.addRow("Illuminance Map", map.zoneName, "Hourly", map.envPeriod, RVD_ILLUMINANCEMAP, map.name);
+      }
+    }
+
+    if (added) updateRows();
+    endResetModel();
+    return added;
+  }
+
+  void DataDictionaryModel::removeFile(const QString &filename)
+  {
+    beginResetModel();
+    m_store.removeFile(filename.toStdString());
+    updateRows();
+    endResetModel();
+  }
+
+  bool DataDictionaryModel::updateFileAlias(const QString &alias, const QString &filename)
+  {
+    // the alias may decide the sort order and the filter
+    beginResetModel();
+    bool updated = m_store.setAlias(filename.toStdString(), alias.toStdString());
+    updateRows();
+    endResetModel();
+    return updated;
+  }
+
+  void DataDictionaryModel::applyFilter(const QString &pattern)
+  {
+    beginResetModel();
+    m_filtered = true;
+    m_filter = pattern.toStdString();
+    updateRows();
+    endResetModel();
+  }
+
+  void DataDictionaryModel::clearFilter()
+  {
+    beginResetModel();
+    m_filtered = false;
+    updateRows();
+    endResetModel();
+  }
+
+  int DataDictionaryModel::firstRow(const QString &filename) const
+  {
+    for (size_t i = 0; i < m_rows.size(); ++i)
+    {
+      if (filename.compare(QString::fromStdString(m_store.text(m_rows[i], DictionaryColumn::File)), Qt::CaseInsensitive) == 0)
+        return static_cast<int>(i);
+    }
+    return -1;
+  }
+
+
+  TableView::TableView( QWidget* parent):QTableView(parent)
+  {
+    m_slHeaders  << tr("Variable Name") << tr("Key Value") << tr("Reporting Frequency") << tr("Alias") << tr("Environment Period") << tr("File");
+    m_model = new DataDictionaryModel(m_slHeaders, this);
+    setModel(m_model);
+
     setSortingEnabled(true);
     setContextMenuPolicy(Qt::CustomContextMenu);
     horizontalHeader()->setSortIndicator(0,Qt::AscendingOrder);
@@ -50,11 +220,13 @@ namespace resultsviewer{
     horizontalHeader()->setSectionsMovable(true);
     setSelectionBehavior(QAbstractItemView::SelectRows);
     setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-    m_slHeaders  << tr("Variable Name") << tr("Key Value") << tr("Reporting Frequency") << tr("Alias") << tr("Environment Period") << tr("File");
-    setHorizontalHeaderLabels( m_slHeaders );
     horizontalHeader()->setStretchLastSection(true);
+    hideColumn(m_slHeaders.indexOf("File"));
 
     verticalHeader()->hide();
+    // every row has the same height, so the view need not measure rows it does not show
+    verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 6);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setEditTriggers(QAbstractItemView::NoEditTriggers); // no editing
     setDragEnabled(true);
@@ -70,7 +242,7 @@ namespace resultsviewer{
         performResultsViewerPlotDataDrag();
       }
     }
-    QTableWidget::mouseMoveEvent(e);
+    QTableView::mouseMoveEvent(e);
   }
 
   void TableView::mousePressEvent(QMouseEvent *e)
@@ -78,207 +250,71 @@ namespace resultsviewer{
     if (e->button() == Qt::LeftButton) {
       m_startPos = e->pos();
     }
-    QTableWidget::mousePressEvent(e);
+    QTableView::mousePressEvent(e);
   }
 
   void TableView::performResultsViewerPlotDataDrag()
   {
-    std::vector<resultsviewer::ResultsViewerPlotData> rvPlotDataVec;
-    std::vector<int> selectedRows;
-    if (selectedItems().count() > 0)
-    {
-      for (QTableWidgetItem *item : selectedItems())
-      {
-        int row = item->row();
-        if ( std::find(selectedRows.begin(), selectedRows.end(), row) == selectedRows.end() )
-        {
-          selectedRows.push_back(row);
-          rvPlotDataVec.push_back(resultsViewerPlotDataFromTableItem(item));
-        }
-      }
-    }
-    emit(signalDragResultsViewerPlotData(rvPlotDataVec));
+    emit(signalDragResultsViewerPlotData(generateResultsViewerPlotData()));
   }
 
 
 
   void TableView::removeFile(const QString& filename)
   {
-    for (int row=rowCount()-1; row>-1; row--)
-    {
-      if ( item(row, m_slHeaders.indexOf(tr("File")))->text().toUpper() == filename.toUpper() ) removeRow(row);
-    }
+    m_model->removeFile(filename);
   }
 
-  bool TableView::addFile(const QString& alias, openstudio::SqlFile sqlFile)
+  bool TableView::addFile(const QString& alias, const SqlFile &sqlFile)
   {
-    if (alias.isEmpty() || !sqlFile.connectionOpen()) return false;
-
-    setSortingEnabled(false);
-
-    detail::DataDictionaryTable ddTable = sqlFile.dataDictionary();
-
-    detail::DataDictionaryTable::iterator iter;
-    for (iter=ddTable.begin();iter!=ddTable.end();++iter)
-    {
-      // skip runPeriod
-      if (sqlFile.reportingFrequencyFromDB((*iter).reportingFrequency)
-          && *(sqlFile.reportingFrequencyFromDB((*iter).reportingFrequency)) != ReportingFrequency::RunPeriod)
-      {
-
-        int row = addRow();
-        item(row, m_slHeaders.indexOf("Alias"))->setText(alias);
-        item(row, m_slHeaders.indexOf("File"))->setText(openstudio::toQString(sqlFile.energyPlusSqliteFile()));
-        item(row, m_slHeaders.indexOf("Environment Period"))->setText(openstudio::toQString((*iter).envPeriod));
-        item(row, m_slHeaders.indexOf("Reporting Frequency"))->setText(openstudio::toQString((*iter).reportingFrequency));
-        item(row, m_slHeaders.indexOf("Key Value"))->setText(openstudio::toQString((*iter).keyValue));
-        item(row, m_slHeaders.indexOf("Variable Name"))->setText(openstudio::toQString((*iter).name));
-        item(row, m_slHeaders.indexOf("File"))->setData(Qt::UserRole, RVD_TIMESERIES);
-      } // end skip runPeriod
-    }
+    return addFiles({ std::make_pair(alias, &sqlFile) });
+  }
 
-    /* illuminance maps */
-    std::vector<std::string> mapNames(sqlFile.illuminanceMapNames());
-    std::vector<std::string>::iterator nameIter;
-    for (nameIter=mapNames.begin(); nameIter!=mapNames.end(); ++nameIter)
-    {
-      // retrieve mapIndex for map name to retrieve environment period and zone name
-      QString envPeriod = "";
-      QString keyValue = "";
-      boost::optional<int> mapIndex = sqlFile.illuminanceMapIndex(*nameIter);
-      if (mapIndex)
-      {
-        boost::optional<std::string> strValue;
-        boost::optional<int> intValue;
-        std::stringstream s;
-        s << "select Environment from daylightmaps where MapNumber=" << *mapIndex;
-        strValue = sqlFile.execAndReturnFirstString(s.str());
-        if (strValue) envPeriod = openstudio::toQString(*strValue);
-        s.str("");
-        s << "select Zone from daylightmaps where MapNumber=" << *mapIndex;
-        intValue = sqlFile.execAndReturnFirstInt(s.str());
-        if (intValue)
-        {
-          s.str("");
-          s << "select ZoneName from zones where ZoneIndex=" << *intValue;
-          strValue = sqlFile.execAndReturnFirstString(s.str());
-          if (strValue) keyValue = openstudio::toQString(*strValue);
-        }
-      }
-      int row = addRow();
-      item(row, m_slHeaders.indexOf("Alias"))->setText(alias);
-      item(row, m_slHeaders.indexOf("File"))->setText(openstudio::toQString(sqlFile.energyPlusSqliteFile()));
-      item(row,  m_slHeaders.indexOf("Environment Period"))->setText(envPeriod); // environment period
-      /* update based on email from Dan 8/10/10
-         item(row, 3)->setText("Illuminance"); // reporting frequency
-         item(row, 4)->setText(keyValue); // illuminance zone?
-         item(row, 5)->setText(openstudio::toQString(*nameIter));
-         */
-      item(row, m_slHeaders.indexOf("Reporting Frequency"))->setText("Hourly"); // reporting frequency
-      item(row, m_slHeaders.indexOf("Key Value"))->setText(keyValue); // illuminance zone
-      item(row, m_slHeaders.indexOf("Variable Name"))->setText("Illuminance Map"); // Variable Name
-      item(row, m_slHeaders.indexOf("File"))->setData(Qt::UserRole, RVD_ILLUMINANCEMAP);
-      item(row, m_slHeaders.indexOf("Alias"))->setData(Qt::UserRole, openstudio::toQString(*nameIter)); // map name for retrieving from database
-    }
+  bool TableView::addFiles(const std::vector<std::pair<QString, const SqlFile *> > &files)
+  {
+    if (!m_model->addFiles(files)) return false;
 
+    // sizes from the rows in view rather than every row
     resizeColumnToContents(m_slHeaders.indexOf("Alias"));
-    hideColumn(m_slHeaders.indexOf("File"));
     resizeColumnToContents(m_slHeaders.indexOf("Variable Name"));
     resizeColumnToContents(m_slHeaders.indexOf("Key Value"));
     resizeColumnToContents(m_slHeaders.indexOf("Reporting Frequency"));
-    //  resizeColumnToContents(5);
-
-    setSortingEnabled(true);
 
     emit( fileAdded() );
 
     return true;
   }
 
-  int TableView::addRow()
-  {
-    int row = rowCount();
-    insertRow(row);
-
-    auto aliasCol = new QTableWidgetItem;
-    aliasCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("Alias"),aliasCol);
-
-    auto fileCol = new QTableWidgetItem;
-    fileCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("File"),fileCol);
-
-    auto envPerCol = new QTableWidgetItem;
-    envPerCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("Environment Period"),envPerCol);
-
-    auto timestepCol = new QTableWidgetItem;
-    timestepCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("Reporting Frequency"),timestepCol);
-
-    auto zoneNameCol = new QTableWidgetItem;
-    zoneNameCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("Key Value"),zoneNameCol);
-
-    auto varNameCol = new QTableWidgetItem;
-    varNameCol->setTextAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-    setItem(row,m_slHeaders.indexOf("Variable Name"),varNameCol);
-
-    return row;
-  }
-
   int TableView::selectedRowCount()
   {
-    std::vector<int> selectedRows;
-    if (selectedItems().count() > 0)
-    {
-      for (QTableWidgetItem *item : selectedItems())  
-      {
-        int row = item->row();
-        if ( std::find(selectedRows.begin(), selectedRows.end(), row) == selectedRows.end() )
-        {
-          selectedRows.push_back(row);
-        }
-      } // foreach
-    }
-    return selectedRows.size();
+    return selectionModel()->selectedRows().count();
   }
 
   std::vector<int> TableView::selectedRows()
   {
     std::vector<int> selectedRows;
-    if (selectedItems().count() > 0)
+    for (const QModelIndex &index : selectionModel()->selectedRows())
     {
-      for (QTableWidgetItem *item : selectedItems())  
-      {
-        int row = item->row();
-        if ( std::find(selectedRows.begin(), selectedRows.end(), row) == selectedRows.end() )
-        {
-          selectedRows.push_back(row);
-        }
-      } // foreach
+      selectedRows.push_back(index.row());
     }
+    std::sort(selectedRows.begin(), selectedRows.end());
     return selectedRows;
   }
 
+  int TableView::dataType(int row) const
+  {
+    if ((row < 0) || (row >= m_model->rowCount())) return 0;
+    return m_model->store().dataType(m_model->storeRow(row));
+  }
+
 
   std::vector<resultsviewer::ResultsViewerPlotData> TableView::generateResultsViewerPlotData()
   {
     std::vector<resultsviewer::ResultsViewerPlotData> resultsViewerPlotDataVec;
-    std::vector<int> selectedRows;
-
-
-    for (QTableWidgetItem *item : selectedItems())
+    for (int row : selectedRows())
     {
-      int row = item->row();
-      if ( std::find(selectedRows.begin(), selectedRows.end(), row) == selectedRows.end() )
-      {
-        selectedRows.push_back(row);
-        resultsviewer::ResultsViewerPlotData resultsViewerPlotData = resultsViewerPlotDataFromTableItem(item);
-        resultsViewerPlotDataVec.push_back(resultsViewerPlotData);
-      }
-    } // foreach
-
+      resultsViewerPlotDataVec.push_back(resultsViewerPlotDataFromTableRow(row));
+    }
     return resultsViewerPlotDataVec;
   }
 
@@ -343,30 +379,18 @@ namespace resultsviewer{
   resultsviewer::ResultsViewerPlotData TableView::resultsViewerPlotDataFromTableRow(int row)
   {
     resultsviewer::ResultsViewerPlotData rvPlotData;
-    if ((row > -1) && (row < rowCount()))
+    if ((row > -1) && (row < m_model->rowCount()))
     {
-      rvPlotData = resultsViewerPlotDataFromTableItem(item(row,0));
-    }
-    return rvPlotData;
-  }
-
-
-  resultsviewer::ResultsViewerPlotData TableView::resultsViewerPlotDataFromTableItem(QTableWidgetItem* tableItem)
-  {
-    //  m_slHeaders  << tr("Alias") << tr("File") << tr("Environment Period") << tr("Reporting Frequency") << tr("Key Value") << tr("Variable Name");
-    QString keyValue = "", variableName = "", envPeriod = "", filename = "", reportFreq = "", s = "";
-    resultsviewer::ResultsViewerPlotData rvPlotData;
-    if (tableItem) 
-    {
-      int row = tableItem->row();
-      rvPlotData.keyName = item(row, m_slHeaders.indexOf("Key Value") )->text();
-      rvPlotData.variableName = item(row, m_slHeaders.indexOf("Variable Name") )->text();
-      rvPlotData.reportFreq = item(row, m_slHeaders.indexOf("Reporting Frequency") )->text();
-      rvPlotData.envPeriod = item(row, m_slHeaders.indexOf("Environment Period") )->text();
-      rvPlotData.filename = item(row, m_slHeaders.indexOf("File") )->text();
-      rvPlotData.alias = item(row, m_slHeaders.indexOf("Alias") )->text();
-      rvPlotData.dataType = item(row, m_slHeaders.indexOf("File") )->data(Qt::UserRole).toInt();
-      rvPlotData.dbIdentifier = item(row, m_slHeaders.indexOf("Alias") )->data(Qt::UserRole).toString();
+      const DictionaryStore &store = m_model->store();
+      size_t storeRow = m_model->storeRow(row);
+      rvPlotData.keyName = QString::fromStdString(store.text(storeRow, DictionaryColumn::KeyValue));
+      rvPlotData.variableName = QString::fromStdString(store.text(storeRow, DictionaryColumn::VariableName));
+      rvPlotData.reportFreq = QString::fromStdString(store.text(storeRow, DictionaryColumn::ReportingFrequency));
+      rvPlotData.envPeriod = QString::fromStdString(store.text(storeRow, DictionaryColumn::EnvironmentPeriod));
+      rvPlotData.filename = QString::fromStdString(store.text(storeRow, DictionaryColumn::File));
+      rvPlotData.alias = QString::fromStdString(store.text(storeRow, DictionaryColumn::Alias));
+      rvPlotData.dataType = store.dataType(storeRow);
+      rvPlotData.dbIdentifier = QString::fromStdString(store.dbIdentifier(storeRow));
     }
     return rvPlotData;
   }
@@ -375,57 +399,29 @@ namespace resultsviewer{
 
   bool TableView::updateFileAlias(const QString& alias, const QString& filename)
   {
-    setSortingEnabled(false);
-    for (int i=0; i<rowCount();i++)
-    {
-      if (item(i,1)->text().toUpper() == filename.toUpper()) item(i,0)->setText(alias);
-    }
-    setSortingEnabled(true);
-    return true;
+    return m_model->updateFileAlias(alias, filename);
   }
 
 
   void TableView::applyFilter(QString& filterText)
   {
-    //  QRegExp regExp(filterText); //strict regular expression matching
-    QRegExp regExp(filterText, Qt::CaseInsensitive, QRegExp::Wildcard); // text wild card *, ? matching
-    std::vector<int> rowsToShow;
-
-    for (int row=0;row<rowCount();row++)
-    {
-      if (  (regExp.exactMatch(item(row,m_slHeaders.indexOf("Variable Name"))->text()))
-          || (regExp.exactMatch(item(row,m_slHeaders.indexOf("Key Value"))->text()))
-          || (regExp.exactMatch(item(row,m_slHeaders.indexOf("Reporting Frequency"))->text()))
-          || (regExp.exactMatch(item(row,m_slHeaders.indexOf("Environment Period"))->text()))
-          //       || (regExp.exactMatch(item(row,m_slHeaders.indexOf("File"))->text()))
-          || (regExp.exactMatch(item(row,m_slHeaders.indexOf("Alias"))->text())) )   rowsToShow.push_back(row);
-    }
-    for (int i=0; i<rowCount();i++)
-    {
-      if ( std::find(rowsToShow.begin(), rowsToShow.end(), i) == rowsToShow.end() )
-        hideRow(i);
-      else
-        showRow(i);
-    }
+    // text wild card *, ? matching, case insensitive
+    m_model->applyFilter(filterText);
   }
 
   void TableView::clearFilter()
   {
-    for (int i=0; i<rowCount();i++) showRow(i);
+    m_model->clearFilter();
   }
 
 
 
   void TableView::goToFile(const QString& filename)
   {
-    for (int i=0;i<rowCount();i++)
+    int row = m_model->firstRow(filename);
+    if (row > -1)
     {
-
-      if ( (!isRowHidden(i)) && (item(i,m_slHeaders.indexOf("File"))->text().toUpper() == filename.toUpper()) )
-      {
-        scrollToItem(item(i,0), QAbstractItemView::PositionAtTop);
-        break;
-      }
+      scrollTo(m_model->index(row, 0), QAbstractItemView::PositionAtTop);
     }
   }
 
@@ -34,23 +34,71 @@
 #include "ResultsViewerData.hpp"
 
 #include "SqlFile.hpp"
+#include "DictionaryStore.hpp"
 
 #include <QMainWindow>
-#include <QTableWidget>
+#include <QTableView>
+#include <QAbstractTableModel>
 #include <string>
 #include <QApplication>
 
 namespace resultsviewer{
 
+/** DataDictionaryModel presents the data dictionaries of the open files from a DictionaryStore. The view asks only
+for the cells it shows, so no per cell objects are created however many rows there are; the model itself holds one
+index per visible row, in sorted order.
+*/
+class DataDictionaryModel : public QAbstractTableModel
+{
+  Q_OBJECT
+public:
+
+  DataDictionaryModel(const QStringList &headers, QObject *parent=nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+  void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+  bool addFile(const QString &alias, const SqlFile &sqlFile);
+  // add (alias, file) pairs with a single model reset, false if none was added
+  bool addFiles(const std::vector<std::pair<QString, const SqlFile *> > &files);
+  void removeFile(const QString &filename);
+  bool updateFileAlias(const QString &alias, const QString &filename);
+  // show only rows with a column matching a case insensitive wildcard pattern
+  void applyFilter(const QString &pattern);
+  void clearFilter();
+
+  const DictionaryStore &store() const {return m_store;}
+  // store row shown at a model row
+  size_t storeRow(int row) const {return m_rows[row];}
+  // model row of the first row of a file, -1 if none is shown
+  int firstRow(const QString &filename) const;
+
+private:
+  // rebuild m_rows from the filter and the sort order
+  void updateRows();
+
+  DictionaryStore m_store;
+  QStringList m_headers;
+  std::vector<size_t> m_rows;
+  bool m_filtered;
+  std::string m_filter;
+  int m_sortColumn;
+  Qt::SortOrder m_sortOrder;
+};
+
 /** TableView is a ui widget to present EnergyPlus output in a table which can be sorted and filtered.
 */
-class TableView : public QTableWidget
+class TableView : public QTableView
 {
   Q_OBJECT
 public:
 
   TableView( QWidget* parent=nullptr);
-  bool addFile(const QString& alias, openstudio::SqlFile sqlFile);
+  bool addFile(const QString& alias, const SqlFile &sqlFile);
+  bool addFiles(const std::vector<std::pair<QString, const SqlFile *> > &files);
   void removeFile(const QString& filename);
   bool updateFileAlias(const QString& alias, const QString& filename);
   void applyFilter(QString& filterText);
@@ -59,7 +107,8 @@ public:
   int selectedRowCount();
   std::vector<int> selectedRows();
   resultsviewer::ResultsViewerPlotData resultsViewerPlotDataFromTableRow(int row);
-  // for determining illuminance maps
+  // RVD_TIMESERIES or RVD_ILLUMINANCEMAP
+  int dataType(int row) const;
   const QStringList& headerNames() const {return m_slHeaders;}
 
 public slots:
@@ -97,12 +146,9 @@ signals:
 
 private:
   QPoint m_startPos;
-  // adds row to table and sets format
-  int addRow();
-//  void adjustColumnSizes();
   QStringList m_slHeaders;
+  DataDictionaryModel *m_model;
 
-  resultsviewer::ResultsViewerPlotData resultsViewerPlotDataFromTableItem(QTableWidgetItem* tableItem);
   std::vector<resultsviewer::ResultsViewerPlotData> generateResultsViewerPlotData();
 
 };
@@ -0,0 +1,164 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_THREADPOOL_HPP
+#define RESULTSVIEWER_THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <string>
+
+#include "Tracer.hpp"
+
+namespace resultsviewer{
+
+/**
+CancellationToken is a shared flag for cooperative cancellation. Copies refer to the same flag, so the GUI can keep
+one copy to cancel with and hand the others to the work it started.
+*/
+class CancellationToken
+{
+public:
+  CancellationToken() : m_canceled(std::make_shared<std::atomic<bool>>(false))
+  {}
+
+  void cancel() const
+  {
+    m_canceled->store(true);
+  }
+
+  bool isCanceled() const
+  {
+    return m_canceled->load();
+  }
+
+  // The flag itself, for code (sqlite progress handlers) that polls it without knowing about tokens
+  const std::atomic<bool> *flag() const
+  {
+    return m_canceled.get();
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> m_canceled;
+};
+
+/**
+ThreadPool runs tasks on a fixed set of worker threads, first in first out. The destructor finishes the tasks that
+are already queued before joining the workers; cancel them through their tokens to stop early.
+*/
+class ThreadPool
+{
+public:
+  explicit ThreadPool(unsigned threadCount = defaultThreadCount()) : m_stopping(false)
+  {
+    threadCount = std::max(threadCount, 1u);
+    for (unsigned i = 0; i < threadCount; ++i) {
+      m_workers.emplace_back([this, i] {
+#ifdef RESULTSVIEWER_TRACING
+        if (Tracer::instance().enabled()) {
+          Tracer::instance().setThreadName("worker " + std::to_string(i));
+        }
+#endif
+        run();
+      });
+    }
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto &worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  // Queue a task, the future holds its result (or its exception)
+  template <typename F> auto submit(F &&f) -> std::future<decltype(f())>
+  {
+    typedef decltype(f()) result_type;
+    auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+    std::future<result_type> result = task->get_future();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_tasks.emplace_back([task] { (*task)(); });
+    }
+    m_condition.notify_one();
+    return result;
+  }
+
+  size_t threadCount() const
+  {
+    return m_workers.size();
+  }
+
+  // Leave a core for the GUI thread
+  static unsigned defaultThreadCount()
+  {
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware > 1 ? hardware - 1 : 1;
+  }
+
+private:
+  void run()
+  {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+          return;
+        }
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  bool m_stopping;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_THREADPOOL_HPP
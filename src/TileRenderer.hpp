@@ -0,0 +1,113 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_TILERENDERER_HPP
+#define RESULTSVIEWER_TILERENDERER_HPP
+
+#include "ThreadPool.hpp"
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <exception>
+#include <algorithm>
+
+namespace resultsviewer{
+
+/// A rectangle of an image, in pixels
+struct Tile
+{
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+/// Split a width by height image into tiles of at most tileSize by tileSize pixels, row by row
+inline std::vector<Tile> tiles(int width, int height, int tileSize)
+{
+  std::vector<Tile> result;
+  tileSize = std::max(tileSize, 1);
+  for (int y = 0; y < height; y += tileSize) {
+    for (int x = 0; x < width; x += tileSize) {
+      result.push_back({ x, y, std::min(tileSize, width - x), std::min(tileSize, height - y) });
+    }
+  }
+  return result;
+}
+
+/**
+renderTiles calls renderTile(index, tile) once for every tile of a width by height image, index being the position
+of the tile in tiles(width, height, tileSize), on the workers of pool and on the
+calling thread at the same time. Tiles are handed out one at a time, so a slow part of the image does not hold up
+the rest. It returns when all tiles are done, and rethrows the first exception thrown by renderTile. renderTile must
+only write to its own tile. Do not call it from a task running on the same pool.
+*/
+template <typename F> void renderTiles(ThreadPool &pool, int width, int height, int tileSize, F renderTile)
+{
+  const std::vector<Tile> all = tiles(width, height, tileSize);
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto work = [&]() {
+    for (size_t i = next++; i < all.size(); i = next++) {
+      try {
+        renderTile(i, all[i]);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::future<void>> helpers;
+  size_t helperCount = std::min(pool.threadCount(), all.size() > 0 ? all.size() - 1 : 0);
+  for (size_t i = 0; i < helperCount; ++i) {
+    helpers.push_back(pool.submit(work));
+  }
+  work();
+  for (auto &helper : helpers) {
+    helper.wait();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/// The pool shared by all plots for rendering, one worker per core since the caller waits on it. Inline rather than
+/// static so that there is one pool for the program instead of one per translation unit.
+inline ThreadPool &renderThreadPool()
+{
+  static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u));
+  return pool;
+}
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_TILERENDERER_HPP
@@ -30,142 +30,610 @@
 #include <algorithm>
 #include <optional>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <cmath>
+#include <atomic>
+#include <array>
+#include <mutex>
+
+#include "Statistics.hpp"
+#include "Rollup.hpp"
 
 #include <QDateTime>
 
 namespace resultsviewer{
 
-static std::vector<long long> fixSeconds(std::vector <long long> seconds, std::vector<double> values)
+/**
+AlignedAllocator hands out cache line aligned storage so the time series arrays can be streamed with aligned
+vector loads.
+*/
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator
 {
-  auto len = std::min(seconds.size(), values.size());
-  if (len == 0) {
-    return { 0 };
+  typedef T value_type;
+
+  template <typename U> struct rebind
+  {
+    typedef AlignedAllocator<U, Alignment> other;
+  };
+
+  AlignedAllocator() = default;
+  template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(std::size_t n)
+  {
+    return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T *p, std::size_t)
+  {
+    ::operator delete(p, std::align_val_t(Alignment));
   }
-  return std::vector<long long>(seconds.begin(), seconds.begin() + len);
-}
 
-static std::vector<double> fixValues(std::vector <long long> seconds, std::vector<double> values)
+  template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+  template <typename U> bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+/**
+TimeSeriesArray is an immutable, reference counted view of a contiguous run of a shared array. Copies and slices
+share the underlying storage, so they cost a reference count update rather than a copy of the data.
+*/
+template <typename T> class TimeSeriesArray
 {
-  auto len = std::min(seconds.size(), values.size());
-  if (len == 0) {
-    return { 0 };
+public:
+  typedef std::vector<T, AlignedAllocator<T>> storage_type;
+  typedef const T *const_iterator;
+
+  TimeSeriesArray() : m_growable(nullptr), m_begin(nullptr), m_size(0)
+  {}
+
+  // Take ownership of (or copy) the data
+  TimeSeriesArray(storage_type data) : TimeSeriesArray(std::make_shared<const storage_type>(std::move(data)))
+  {}
+
+  TimeSeriesArray(const std::vector<T> &data) : TimeSeriesArray(storage_type(data.begin(), data.end()))
+  {}
+
+  TimeSeriesArray(std::initializer_list<T> data) : TimeSeriesArray(storage_type(data))
+  {}
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+  bool empty() const
+  {
+    return m_size == 0;
+  }
+
+  const T *data() const
+  {
+    return m_begin;
+  }
+
+  const_iterator begin() const
+  {
+    return m_begin;
+  }
+
+  const_iterator end() const
+  {
+    return m_begin + m_size;
+  }
+
+  const T &operator[](size_t i) const
+  {
+    return m_begin[i];
+  }
+
+  const T &front() const
+  {
+    return m_begin[0];
+  }
+
+  const T &back() const
+  {
+    return m_begin[m_size - 1];
   }
-  return std::vector<double>(values.begin(), values.begin() + len);
-}
 
-static std::vector<long long> buildSeconds(long long interval, std::vector<double> values)
+  // View of the elements [first, last), sharing this array's storage
+  TimeSeriesArray slice(size_t first, size_t last) const
+  {
+    last = std::min(last, m_size);
+    first = std::min(first, last);
+    return TimeSeriesArray(m_storage, m_growable, m_begin + first, last - first);
+  }
+
+  // This array followed by count more elements. The elements are written into the spare room after this view when
+  // it ends where the storage's written elements end, otherwise this view is copied to new storage with room to
+  // spare, so appending costs time proportional to count in the long run. Other views of the storage never see the
+  // new elements.
+  TimeSeriesArray appended(const T *data, size_t count) const
+  {
+    if (m_growable) {
+      std::lock_guard<std::mutex> lock(m_growable->mutex);
+      T *used = m_growable->elements.data() + m_growable->used;
+      if (m_begin + m_size == used && m_growable->used + count <= m_growable->elements.size()) {
+        std::copy(data, data + count, used);
+        m_growable->used += count;
+        return TimeSeriesArray(m_storage, m_growable, m_begin, m_size + count);
+      }
+    }
+    auto growable = std::make_shared<Growable>(std::max<size_t>(2 * (m_size + count), 64));
+    T *elements = growable->elements.data();
+    std::copy(begin(), end(), elements);
+    std::copy(data, data + count, elements + m_size);
+    growable->used = m_size + count;
+    Growable *raw = growable.get();
+    return TimeSeriesArray(std::move(growable), raw, elements, m_size + count);
+  }
+
+  // True if both views refer to exactly the same elements of the same storage
+  bool sameAs(const TimeSeriesArray &other) const
+  {
+    return m_begin == other.m_begin && m_size == other.m_size;
+  }
+
+  // View of size elements at data that belong to some other owner, such as a memory mapped file. The owner is kept
+  // alive for as long as any view of the data exists.
+  static TimeSeriesArray view(std::shared_ptr<const void> owner, const T *data, size_t size)
+  {
+    return TimeSeriesArray(std::move(owner), data, size);
+  }
+
+  std::vector<T> toVector() const
+  {
+    return std::vector<T>(begin(), end());
+  }
+
+  // Number of views sharing the storage, mostly of interest to tests
+  long useCount() const
+  {
+    return m_storage.use_count();
+  }
+
+  bool operator==(const TimeSeriesArray &other) const
+  {
+    return sameAs(other) || (m_size == other.m_size && std::equal(begin(), end(), other.begin()));
+  }
+
+  bool operator!=(const TimeSeriesArray &other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  TimeSeriesArray(std::shared_ptr<const storage_type> storage) : m_storage(storage), m_growable(nullptr),
+    m_begin(storage->data()), m_size(storage->size())
+  {}
+
+  // Storage with spare room at the end for appended elements
+  struct Growable
+  {
+    Growable(size_t capacity) : elements(capacity), used(0)
+    {}
+
+    storage_type elements;
+    size_t used;
+    std::mutex mutex;
+  };
+
+  TimeSeriesArray(std::shared_ptr<const void> storage, const T *begin, size_t size) : m_storage(std::move(storage)),
+    m_growable(nullptr), m_begin(begin), m_size(size)
+  {}
+
+  TimeSeriesArray(std::shared_ptr<const void> storage, Growable *growable, const T *begin, size_t size)
+    : m_storage(std::move(storage)), m_growable(growable), m_begin(begin), m_size(size)
+  {}
+
+  // whatever owns the elements, usually a storage_type
+  std::shared_ptr<const void> m_storage;
+  // the storage when it was made by appended, owned by m_storage
+  Growable *m_growable;
+  const T *m_begin;
+  size_t m_size;
+};
+
+inline TimeSeriesArray<long long> buildSeconds(long long interval, size_t count)
 {
-  std::vector<long long> result(values.size());
-  result[0] = interval;
-  for (int i = 1; i < values.size() - 1; i++) {
-    result[i] = result[i - 1] + interval;
+  TimeSeriesArray<long long>::storage_type result(count);
+  long long current = 0;
+  for (auto &value : result) {
+    current += interval;
+    value = current;
   }
-  return result;
+  return TimeSeriesArray<long long>(std::move(result));
 }
 
 /**
-TimeSeries is an object that connects a series of times to a series of values.
+TimeSeries is an object that connects a series of times to a series of values. The times (seconds from the start
+date and time) and the values are held in separate shared arrays, so copies of a TimeSeries and slices of it do not
+copy the data, and series read together can share a single seconds array. The fields are only set on construction,
+so the statistics and rollups computed from them can be cached.
 */
 struct TimeSeries
 {
-  TimeSeries(const QDateTime start, long long interval, std::vector<double> vals) : startDateTime(start),
-    seconds(buildSeconds(interval, values)), values(values), interval(interval)
+  TimeSeries(const QDateTime start, long long interval, TimeSeriesArray<double> values, const std::string units = std::string())
+    : m_startDateTime(start), m_seconds(buildSeconds(interval, values.size())), m_values(values), m_units(units),
+    m_interval(interval)
   {}
 
-  TimeSeries(const QDateTime start, long long interval, std::vector<double> vals, const std::string units) : startDateTime(start),
-    seconds(buildSeconds(interval, values)), values(values), units(units), interval(interval)
-  {}
+  TimeSeries(const QDateTime start, TimeSeriesArray<long long> seconds, TimeSeriesArray<double> values,
+    const std::string units = std::string(), std::optional<long long> interval = std::nullopt)
+    : m_startDateTime(start), m_units(units), m_interval(interval)
+  {
+    // extra seconds or values are ignored
+    size_t len = std::min(seconds.size(), values.size());
+    m_seconds = seconds.slice(0, len);
+    m_values = values.slice(0, len);
+  }
 
-  TimeSeries(const QDateTime start, std::vector <long long> seconds, std::vector<double> values) : startDateTime(start), seconds(fixSeconds(seconds, values)),
-    values(fixValues(seconds, values))
+  TimeSeries(const QDateTime start, const std::vector<long long> &seconds, const std::vector<double> &values,
+    const std::string units = std::string(), std::optional<long long> interval = std::nullopt)
+    : TimeSeries(start, TimeSeriesArray<long long>(seconds), TimeSeriesArray<double>(values), units, interval)
   {}
 
-  TimeSeries(const QDateTime start, std::vector <long long> seconds, std::vector<double> values, const std::string units) : startDateTime(start), seconds(fixSeconds(seconds, values)),
-    values(fixValues(seconds, values)), units(units)
-  {}
+  const QDateTime &startDateTime() const
+  {
+    return m_startDateTime;
+  }
+
+  const TimeSeriesArray<long long> &seconds() const
+  {
+    return m_seconds;
+  }
+
+  const TimeSeriesArray<double> &values() const
+  {
+    return m_values;
+  }
+
+  const std::string &units() const
+  {
+    return m_units;
+  }
+
+  const std::optional<long long> &interval() const
+  {
+    return m_interval;
+  }
 
   QDateTime firstReportDateTime() const
   {
-    return startDateTime.addSecs(seconds[0]);
+    return m_startDateTime.addSecs(m_seconds[0]);
   }
 
   std::vector<double> daysFromFirstReport() const
   {
-    std::vector<double> result(seconds.size());
-    result[0] = 0.0;
+    std::vector<double> result(m_seconds.size());
     double rval = 1.0 / static_cast<double>(86400);
-    for (int i = 1; i < seconds.size(); i++) {
-      result[i] = rval*static_cast<double>(seconds[i] - seconds[0]);
+    for (size_t i = 0; i < m_seconds.size(); i++) {
+      result[i] = rval*static_cast<double>(m_seconds[i] - m_seconds[0]);
+    }
+    return result;
+  }
+
+  // The reports [first, last) as a new series that shares this series' data
+  TimeSeries slice(size_t first, size_t last) const
+  {
+    return TimeSeries(m_startDateTime, m_seconds.slice(first, last), m_values.slice(first, last), m_units, m_interval);
+  }
+
+  // The reports at or after from and before to (seconds from the start), found by binary search
+  TimeSeries sliceSeconds(long long from, long long to) const
+  {
+    size_t first = std::lower_bound(m_seconds.begin(), m_seconds.end(), from) - m_seconds.begin();
+    size_t last = std::lower_bound(m_seconds.begin(), m_seconds.end(), to) - m_seconds.begin();
+    return slice(first, std::max(first, last));
+  }
+
+  // The reports in the days [firstDay, lastDay] counted from the start date, day 0 being the start date itself
+  TimeSeries sliceDays(int firstDay, int lastDay) const
+  {
+    // reports are stamped at the end of their interval, so midnight belongs to the day before
+    return sliceSeconds(86400LL * firstDay + 1, 86400LL * (lastDay + 1) + 1);
+  }
+
+  // This series followed by count more reports, which must come after the last one. The arrays grow in place where
+  // they can (see TimeSeriesArray::appended), and statistics already computed are carried over by combining them with
+  // those of the new values, so the cost is proportional to count. Rollups are recomputed when next asked for.
+  TimeSeries appended(const long long *newSeconds, const double *newValues, size_t count) const
+  {
+    TimeSeries result(m_startDateTime, m_seconds.appended(newSeconds, count), m_values.appended(newValues, count),
+      m_units, m_interval);
+    std::shared_ptr<const Statistics> cached = std::atomic_load(&m_statistics);
+    if (cached) {
+      result.m_statistics = std::make_shared<const Statistics>(combineStatistics(*cached,
+        computeStatistics(newValues, count)));
     }
     return result;
   }
 
+  // Summary statistics of the values, computed in one pass on first use and shared by copies made afterwards
+  Statistics statistics() const
+  {
+    std::shared_ptr<const Statistics> cached = std::atomic_load(&m_statistics);
+    if (!cached) {
+      cached = std::make_shared<const Statistics>(computeStatistics(m_values.data(), m_values.size()));
+      std::atomic_store(&m_statistics, cached);
+    }
+    return *cached;
+  }
+
+  size_t count() const
+  {
+    return statistics().count;
+  }
+
   double minimum() const
   {
-    return *std::min_element(std::begin(values), std::end(values));
+    return statistics().minimum;
   }
 
   double maximum() const
   {
-    return *std::max_element(std::begin(values), std::end(values));
+    return statistics().maximum;
   }
 
   double sum() const
   {
-    return std::accumulate(std::begin(values), std::end(values), 0.0);
+    return statistics().sum;
   }
 
   double variance() const
   {
-    if (values.size() == 1) {
-      return 0.0;
-    }
-    auto n = values.size();
-    double m = values[0];
-    double s = 0;
-    unsigned k;
-    for (k = 1; k < n; k++) {
-      double temp = values[k] - m;
-      m += temp / static_cast<double>(k + 1);
-      s += temp*(values[k] - m);
-    }
-    return s / static_cast<double>(n);
+    return statistics().variance;
   }
 
   double stdev() const
   {
-    if (values.size() == 1) {
-      return 0.0;
-    }
-    auto n = values.size();
-    double m = values[0];
-    double s = 0;
-    unsigned k;
-    for (k = 1; k < n; k++) {
-      double temp = values[k] - m;
-      m += temp / static_cast<double>(k + 1);
-      s += temp*(values[k] - m);
-    }
-    return std::sqrt(s / static_cast<double>(n));
+    return statistics().stdev();
   }
 
   double mean() const
   {
-    double m = 0;
-    for (auto el : values) {
-      m += el;
+    return statistics().mean;
+  }
+
+  // The reports rolled up to a calendar period. Each period is computed once and shared by copies of the series,
+  // daily rollups being made from the hourly one and monthly rollups from the daily one.
+  std::shared_ptr<const Rollup> rollup(RollupPeriod period) const
+  {
+    std::lock_guard<std::mutex> lock(m_rollups->mutex);
+    return rollupLocked(period);
+  }
+
+  // The series of one statistic of the reports in each calendar period, stamped at the end of each period
+  TimeSeries rolledUp(RollupPeriod period, RollupStatistic statistic) const
+  {
+    std::shared_ptr<const Rollup> levels = rollup(period);
+    std::vector<double> rolled = levels->values(statistic);
+    std::string rolledUnits = m_units;
+    if (statistic == RollupStatistic::Integral) {
+      rolledUnits = m_units.empty() ? "s" : m_units + "*s";
     }
-    return m / static_cast<double>(values.size());
+    return TimeSeries(m_startDateTime, TimeSeriesArray<long long>(levels->seconds()), TimeSeriesArray<double>(rolled),
+      rolledUnits, Rollup::length(period));
   }
 
-  const QDateTime startDateTime;
-  const std::vector<long long> seconds;
-  const std::vector<double> values;
-  const std::string units;
-  const std::optional<long long> interval;
+private:
+  struct Rollups
+  {
+    std::mutex mutex;
+    std::array<std::shared_ptr<const Rollup>, 3> levels;
+  };
+
+  std::shared_ptr<const Rollup> rollupLocked(RollupPeriod period) const
+  {
+    std::shared_ptr<const Rollup> &level = m_rollups->levels[static_cast<size_t>(period)];
+    if (!level) {
+      if (period == RollupPeriod::Hourly) {
+        level = std::make_shared<const Rollup>(m_startDateTime, m_seconds.data(), m_values.data(), m_values.size(),
+          period, m_interval);
+      } else {
+        RollupPeriod finer = static_cast<RollupPeriod>(static_cast<int>(period) - 1);
+        level = std::make_shared<const Rollup>(rollupLocked(finer)->coarsen(period));
+      }
+    }
+    return level;
+  }
+
+  QDateTime m_startDateTime;
+  TimeSeriesArray<long long> m_seconds;
+  TimeSeriesArray<double> m_values;
+  std::string m_units;
+  std::optional<long long> m_interval;
+
+  // computed from the values on first use; a series is never changed after construction, so it cannot go stale
+  mutable std::shared_ptr<const Statistics> m_statistics;
+  // shared by copies rather than computed for each one, since rollups are usually asked for on a copy
+  std::shared_ptr<Rollups> m_rollups = std::make_shared<Rollups>();
 };
 
 
+/**
+SeriesOperation names the element-wise operations that combine two time series.
+*/
+enum class SeriesOperation { Add, Subtract, Multiply, Divide, Minimum, Maximum };
+
+inline std::string combinedUnits(const std::string &a, const std::string &b, SeriesOperation operation)
+{
+  if (operation == SeriesOperation::Multiply || operation == SeriesOperation::Divide) {
+    if (a.empty() || b.empty()) {
+      return a.empty() ? b : a;
+    }
+    return a + (operation == SeriesOperation::Multiply ? "*" : "/") + b;
+  }
+  return a.empty() ? b : a;
+}
+
+// Both series report at the same times, so the values are combined in one pass over contiguous arrays
+template <typename F> inline TimeSeries combineAligned(const TimeSeries &a, const TimeSeries &b, F f,
+  const std::string &units)
+{
+  size_t n = a.values().size();
+  TimeSeriesArray<double>::storage_type result(n);
+  const double *x = a.values().data();
+  const double *y = b.values().data();
+  double *z = result.data();
+  for (size_t i = 0; i < n; ++i) {
+    z[i] = f(x[i], y[i]);
+  }
+  return TimeSeries(a.startDateTime(), a.seconds(), TimeSeriesArray<double>(std::move(result)), units, a.interval());
+}
+
+// The series report at different times: walk both in step over the span they share, reporting at every time either
+// of them reports and interpolating the other linearly between its neighbouring reports. Runs of reports from one
+// series that fall between two reports of the other are combined in a tight loop along a single line segment.
+template <typename F> inline TimeSeries combineMerged(const TimeSeries &a, const TimeSeries &b, long long offset, F f,
+  const std::string &units)
+{
+  const long long *ta = a.seconds().data();
+  const long long *tb = b.seconds().data();
+  const double *va = a.values().data();
+  const double *vb = b.values().data();
+  size_t na = a.seconds().size();
+  size_t nb = b.seconds().size();
+
+  TimeSeriesArray<long long>::storage_type seconds;
+  TimeSeriesArray<double>::storage_type values;
+  if (na > 0 && nb > 0) {
+    // no extrapolation, only the overlap of the two series is reported
+    long long low = std::max(ta[0], tb[0] + offset);
+    long long high = std::min(ta[na - 1], tb[nb - 1] + offset);
+    size_t i = std::lower_bound(ta, ta + na, low) - ta;
+    size_t j = std::lower_bound(tb, tb + nb, low - offset) - tb;
+    size_t k = 0;
+    if (low <= high) {
+      seconds.resize(na - i + nb - j);
+      values.resize(na - i + nb - j);
+    }
+    // both i and j stay in range up to high, and any report after the first of the overlap has a predecessor
+    while (low <= high && i < na && j < nb && std::min(ta[i], tb[j] + offset) <= high) {
+      long long nextA = ta[i];
+      long long nextB = tb[j] + offset;
+      if (nextA < nextB) {
+        long long t0 = tb[j - 1] + offset;
+        double v0 = vb[j - 1];
+        double slope = (vb[j] - v0) / static_cast<double>(nextB - t0);
+        size_t last = std::lower_bound(ta + i, ta + na, std::min(nextB, high + 1)) - ta;
+        for (; i < last; ++i, ++k) {
+          seconds[k] = ta[i];
+          values[k] = f(va[i], v0 + slope * static_cast<double>(ta[i] - t0));
+        }
+      } else if (nextB < nextA) {
+        long long t0 = ta[i - 1];
+        double v0 = va[i - 1];
+        double slope = (va[i] - v0) / static_cast<double>(nextA - t0);
+        size_t last = std::lower_bound(tb + j, tb + nb, std::min(nextA, high + 1) - offset) - tb;
+        for (; j < last; ++j, ++k) {
+          long long time = tb[j] + offset;
+          seconds[k] = time;
+          values[k] = f(v0 + slope * static_cast<double>(time - t0), vb[j]);
+        }
+      } else {
+        seconds[k] = nextA;
+        values[k] = f(va[i], vb[j]);
+        ++i;
+        ++j;
+        ++k;
+      }
+    }
+    seconds.resize(k);
+    values.resize(k);
+  }
+
+  std::optional<long long> interval;
+  if (seconds.size() > 1) {
+    interval = seconds[1] - seconds[0];
+    for (size_t k = 2; k < seconds.size() && interval; ++k) {
+      if (seconds[k] - seconds[k - 1] != *interval) {
+        interval.reset();
+      }
+    }
+  }
+  return TimeSeries(a.startDateTime(), TimeSeriesArray<long long>(std::move(seconds)),
+    TimeSeriesArray<double>(std::move(values)), units, interval);
+}
+
+template <typename F> inline TimeSeries combineWith(const TimeSeries &a, const TimeSeries &b, F f,
+  const std::string &units)
+{
+  long long offset = 0;
+  if (a.startDateTime().isValid() && b.startDateTime().isValid()) {
+    offset = a.startDateTime().secsTo(b.startDateTime());
+  }
+  if (offset == 0 && a.seconds().size() == b.seconds().size()) {
+    bool regular = a.interval() && a.interval() == b.interval()
+      && (a.seconds().empty() || a.seconds()[0] == b.seconds()[0]);
+    if (regular || a.seconds() == b.seconds()) {
+      return combineAligned(a, b, f, units);
+    }
+  }
+  return combineMerged(a, b, offset, f, units);
+}
+
+/**
+Combines two series element by element. Series reporting at the same times are combined directly; otherwise the
+result reports at every time either series reports within the span both cover, the other series being linearly
+interpolated there, so a 10 minute series against an hourly one costs a single pass over both. The result is
+stamped from the start date and time of the first series.
+*/
+inline TimeSeries combine(const TimeSeries &a, const TimeSeries &b, SeriesOperation operation)
+{
+  std::string units = combinedUnits(a.units(), b.units(), operation);
+  switch (operation) {
+  case SeriesOperation::Add:
+    return combineWith(a, b, [](double x, double y) { return x + y; }, units);
+  case SeriesOperation::Subtract:
+    return combineWith(a, b, [](double x, double y) { return x - y; }, units);
+  case SeriesOperation::Multiply:
+    return combineWith(a, b, [](double x, double y) { return x * y; }, units);
+  case SeriesOperation::Divide:
+    return combineWith(a, b, [](double x, double y) { return x / y; }, units);
+  case SeriesOperation::Minimum:
+    return combineWith(a, b, [](double x, double y) { return y < x ? y : x; }, units);
+  case SeriesOperation::Maximum:
+  default:
+    return combineWith(a, b, [](double x, double y) { return x < y ? y : x; }, units);
+  }
+}
+
+inline TimeSeries operator+(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Add);
+}
+
+inline TimeSeries operator-(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Subtract);
+}
+
+inline TimeSeries operator*(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Multiply);
+}
+
+inline TimeSeries operator/(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Divide);
+}
+
+// The smaller of the two series at each report
+inline TimeSeries minimum(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Minimum);
+}
+
+// The larger of the two series at each report
+inline TimeSeries maximum(const TimeSeries &a, const TimeSeries &b)
+{
+  return combine(a, b, SeriesOperation::Maximum);
+}
+
+
 }; // resultsviewer namespace
 
 #endif // RESULTSVIEWER_TIMESERIES_HPP
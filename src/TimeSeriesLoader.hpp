@@ -0,0 +1,261 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_TIMESERIESLOADER_HPP
+#define RESULTSVIEWER_TIMESERIESLOADER_HPP
+
+#include "SqlFile.hpp"
+#include "SqlFilePool.hpp"
+#include "ThreadPool.hpp"
+#include "Tracer.hpp"
+#include "TimeSeries.hpp"
+#include "LruCache.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <future>
+#include <optional>
+#include <functional>
+#include <memory>
+#include <filesystem>
+
+namespace resultsviewer{
+
+/**
+TimeSeriesRequest identifies one report variable in one file, the way the tree and table views name them.
+*/
+struct TimeSeriesRequest
+{
+  std::string path;
+  std::string envPeriod;
+  std::string reportingFrequency;
+  std::string name;
+  std::string keyValue;
+};
+
+/**
+TimeSeriesLoader extracts time series on a thread pool. Requests for the same file and environment period are read
+as one batch, with one scan of ReportData, on a connection leased from the file's SqlFilePool when one is given (so
+the connection's dictionary, statements and columnar cache are reused) and on a connection of its own otherwise.
+Batches for different files or periods run in parallel. With a cache budget set, loaded series are kept and handed
+out again without reading the file, until the file changes, along with the rollups already made of them.
+*/
+class TimeSeriesLoader
+{
+public:
+  typedef std::optional<TimeSeries> result_type;
+  // Called on the worker thread as each series arrives, with the index of its request, before the series' future
+  // is ready. It must not throw.
+  typedef std::function<void(size_t, const result_type &)> Callback;
+  // The connections of an open file, or null; called by load on the calling thread
+  typedef std::function<std::shared_ptr<SqlFilePool>(const std::string &)> Connections;
+
+  explicit TimeSeriesLoader(ThreadPool &pool) : m_pool(pool)
+  {}
+
+  // Keep up to budget bytes of loaded series; zero, the default, keeps none
+  void setCacheBudget(size_t budget)
+  {
+    if (budget == 0) {
+      m_cache.reset();
+    } else if (m_cache) {
+      m_cache->setBudget(budget);
+    } else {
+      m_cache = std::make_shared<LruCache<std::string, TimeSeries>>(budget);
+    }
+  }
+
+  // Where load finds the connections of a file, which it otherwise opens for each batch
+  void setConnections(Connections connections)
+  {
+    m_connections = connections;
+  }
+
+  // Forget the cached series
+  void clearCache()
+  {
+    if (m_cache) {
+      m_cache->clear();
+    }
+  }
+
+  // Forget the cached series of the file at path, for when it is closed
+  void clearCache(const std::string &path)
+  {
+    if (m_cache) {
+      std::string prefix = path + '\n';
+      m_cache->removeIf([&prefix](const std::string &key) { return key.compare(0, prefix.size(), prefix) == 0; });
+    }
+  }
+
+  // Start loading. Every future is fulfilled, with nullopt for series that are missing or were canceled; the
+  // callback is not called once the token is canceled.
+  std::vector<std::shared_future<result_type>> load(const std::vector<TimeSeriesRequest> &requests,
+    const CancellationToken &token, Callback onLoaded = Callback()) const
+  {
+    std::vector<std::shared_ptr<std::promise<result_type>>> promises;
+    std::vector<std::shared_future<result_type>> futures;
+    std::map<std::pair<std::string, std::string>, std::vector<size_t>> groups;
+    std::vector<std::pair<size_t, TimeSeries>> cached;
+    std::vector<std::string> keys(requests.size());
+    std::map<std::string, std::string> stamps;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      promises.push_back(std::make_shared<std::promise<result_type>>());
+      futures.push_back(promises.back()->get_future().share());
+      std::optional<TimeSeries> hit;
+      if (m_cache) {
+        auto stamp = stamps.find(requests[i].path);
+        if (stamp == stamps.end()) {
+          stamp = stamps.emplace(requests[i].path, sourceStamp(requests[i].path)).first;
+        }
+        keys[i] = cacheKey(requests[i], stamp->second);
+        hit = m_cache->get(keys[i]);
+      }
+      if (hit) {
+        cached.emplace_back(i, *hit);
+      } else {
+        groups[std::make_pair(requests[i].path, requests[i].envPeriod)].push_back(i);
+      }
+    }
+
+    // cached series are still delivered on a worker, as callers expect
+    if (!cached.empty()) {
+      m_pool.submit([cached, promises, token, onLoaded]() {
+        for (const auto &hit : cached) {
+          if (onLoaded && !token.isCanceled()) {
+            onLoaded(hit.first, hit.second);
+          }
+          promises[hit.first]->set_value(token.isCanceled() ? result_type() : result_type(hit.second));
+        }
+      });
+    }
+
+    for (const auto &group : groups) {
+      std::vector<size_t> indices = group.second;
+      std::vector<TimeSeriesRequest> groupRequests;
+      std::vector<std::string> groupKeys;
+      std::vector<std::shared_ptr<std::promise<result_type>>> groupPromises;
+      for (size_t i : indices) {
+        groupRequests.push_back(requests[i]);
+        groupKeys.push_back(keys[i]);
+        groupPromises.push_back(promises[i]);
+      }
+      std::shared_ptr<SqlFilePool> connections = m_connections ? m_connections(group.first.first) : nullptr;
+      std::shared_ptr<LruCache<std::string, TimeSeries>> cache = m_cache;
+      m_pool.submit([indices, groupRequests, groupKeys, groupPromises, token, onLoaded, cache, connections]() {
+        std::vector<result_type> results;
+        if (connections) {
+          SqlFilePool::Lease sqlFile = connections->acquire(SqlFilePool::Priority::Worker);
+          results = loadBatch(*sqlFile, groupRequests, token);
+        } else {
+          SqlFile sqlFile(groupRequests.front().path, SqlFile::OpenMode::ReadOnly);
+          results = loadBatch(sqlFile, groupRequests, token);
+        }
+        for (size_t k = 0; k < results.size(); ++k) {
+          if (cache && results[k] && !token.isCanceled()) {
+            const TimeSeries &ts = *results[k];
+            cache->put(groupKeys[k], ts, ts.values().size() * sizeof(double) + ts.seconds().size() * sizeof(long long));
+          }
+          if (onLoaded && !token.isCanceled()) {
+            onLoaded(indices[k], results[k]);
+          }
+          groupPromises[k]->set_value(results[k]);
+        }
+      });
+    }
+    return futures;
+  }
+
+  // Load requests that share a file and environment period with one scan of sqlFile, on the calling thread
+  static std::vector<result_type> loadBatch(SqlFile &sqlFile, const std::vector<TimeSeriesRequest> &requests,
+    const CancellationToken &token)
+  {
+    RESULTSVIEWER_TRACE_SCOPE("TimeSeriesLoader::loadBatch", "load");
+    std::vector<result_type> results(requests.size());
+    if (requests.empty() || token.isCanceled() || !sqlFile.connectionOpen()) {
+      return results;
+    }
+    // a leased connection gives the flag up when the lease ends
+    sqlFile.setInterruptFlag(token.flag());
+
+    std::vector<size_t> found;
+    std::vector<int> dictionaryIndices;
+    std::vector<std::string> units;
+    int envPeriodIndex = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+      const DataDictionaryItem *item = sqlFile.dataDictionaryItem(requests[i].envPeriod, requests[i].reportingFrequency,
+        requests[i].name, requests[i].keyValue);
+      if (item) {
+        envPeriodIndex = item->envPeriodIndex;
+        found.push_back(i);
+        dictionaryIndices.push_back(item->index);
+        units.push_back(item->units);
+      }
+    }
+    if (found.empty()) {
+      return results;
+    }
+    TimeSeriesColumns columns = sqlFile.timeSeriesColumns(envPeriodIndex, dictionaryIndices);
+    // an interrupted scan leaves partial columns behind
+    if (token.isCanceled()) {
+      return results;
+    }
+    for (size_t column = 0; column < found.size(); ++column) {
+      results[found[column]] = sqlFile.timeSeries(columns, column, units[column]);
+    }
+    return results;
+  }
+
+private:
+  // Size and modification time of the file at path, so that series read before it changed are not handed out
+  static std::string sourceStamp(const std::string &path)
+  {
+    std::error_code ec;
+    uintmax_t size = std::filesystem::file_size(path, ec);
+    if (ec) {
+      return std::string();
+    }
+    auto modified = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    if (ec) {
+      return std::string();
+    }
+    return std::to_string(size) + ':' + std::to_string(modified);
+  }
+
+  // Keys start with the path, which clearCache(path) relies on
+  static std::string cacheKey(const TimeSeriesRequest &request, const std::string &stamp)
+  {
+    return request.path + '\n' + stamp + '\n' + request.envPeriod + '\n' + request.reportingFrequency + '\n' + request.name + '\n'
+      + request.keyValue;
+  }
+
+  ThreadPool &m_pool;
+  Connections m_connections;
+  std::shared_ptr<LruCache<std::string, TimeSeries>> m_cache;
+};
+
+}; // resultsviewer namespace
+
+#endif // RESULTSVIEWER_TIMESERIESLOADER_HPP
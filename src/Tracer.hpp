@@ -0,0 +1,296 @@
+/***********************************************************************************************************************
+ *  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+ *  following conditions are met:
+ *
+ *  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+ *  disclaimer.
+ *
+ *  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+ *  following disclaimer in the documentation and/or other materials provided with the distribution.
+ *
+ *  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+ *  products derived from this software without specific prior written permission from the respective party.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+ *  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ *  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **********************************************************************************************************************/
+
+#ifndef RESULTSVIEWER_TRACER_HPP
+#define RESULTSVIEWER_TRACER_HPP
+
+#include "Json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace resultsviewer{
+
+/// A finished span, times in nanoseconds from the start of the program's tracer
+struct TraceEvent
+{
+  const char *name;
+  const char *category;
+  uint64_t start;
+  uint64_t duration;
+};
+
+/**
+TraceBuffer is the ring of recent spans of one thread. Only its own thread records into it, so the lock is
+never contended except while the trace is being written out; when the ring is full the oldest spans are dropped.
+*/
+class TraceBuffer
+{
+public:
+  static constexpr size_t capacity = 1 << 14;
+
+  explicit TraceBuffer(uint32_t threadId) : m_threadId(threadId), m_next(0)
+  {
+    m_events.resize(capacity);
+  }
+
+  void record(const TraceEvent &event)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events[m_next % capacity] = event;
+    ++m_next;
+  }
+
+  // The spans in the ring, oldest first
+  std::vector<TraceEvent> events() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(m_next, capacity));
+    std::vector<TraceEvent> result;
+    result.reserve(count);
+    for (uint64_t i = m_next - count; i < m_next; ++i) {
+      result.push_back(m_events[i % capacity]);
+    }
+    return result;
+  }
+
+  // Spans lost because the ring was full
+  uint64_t dropped() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_next > capacity ? m_next - capacity : 0;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_next = 0;
+  }
+
+  uint32_t threadId() const
+  {
+    return m_threadId;
+  }
+
+  void setThreadName(const std::string &name)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threadName = name;
+  }
+
+  std::string threadName() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_threadName;
+  }
+
+private:
+  const uint32_t m_threadId;
+  mutable std::mutex m_mutex;
+  std::vector<TraceEvent> m_events;
+  uint64_t m_next;
+  std::string m_threadName;
+};
+
+/**
+Tracer collects the spans recorded by TraceScope on every thread and writes them out in the Chrome trace_event JSON
+format, which chrome://tracing, Perfetto and speedscope open. Recording is off until setEnabled(true); while it is
+off a span costs one relaxed atomic load. Each thread gets a buffer on its first span, kept after the thread ends so
+its spans can still be written. Names and categories are not copied and must be string literals.
+
+Everything compiles away unless RESULTSVIEWER_TRACING is defined (the ENABLE_TRACING build option); use the
+RESULTSVIEWER_TRACE_SCOPE macros rather than TraceScope directly so that the spans go with it.
+*/
+class Tracer
+{
+public:
+  static Tracer &instance()
+  {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  bool enabled() const
+  {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  void setEnabled(bool enabled)
+  {
+    m_enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Nanoseconds since the tracer was created
+  uint64_t now() const
+  {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count());
+  }
+
+  void record(const char *name, const char *category, uint64_t start, uint64_t end)
+  {
+    threadBuffer().record(TraceEvent{ name, category, start, end - start });
+  }
+
+  // Name the calling thread in the trace
+  void setThreadName(const std::string &name)
+  {
+    threadBuffer().setThreadName(name);
+  }
+
+  // All recorded spans of all threads, with the id of their thread
+  std::vector<std::pair<uint32_t, TraceEvent>> events() const
+  {
+    std::vector<std::pair<uint32_t, TraceEvent>> result;
+    for (const auto &buffer : buffers()) {
+      for (const auto &event : buffer->events()) {
+        result.emplace_back(buffer->threadId(), event);
+      }
+    }
+    return result;
+  }
+
+  uint64_t dropped() const
+  {
+    uint64_t result = 0;
+    for (const auto &buffer : buffers()) {
+      result += buffer->dropped();
+    }
+    return result;
+  }
+
+  void clear()
+  {
+    for (const auto &buffer : buffers()) {
+      buffer->clear();
+    }
+  }
+
+  void writeChromeTrace(std::ostream &out) const
+  {
+    out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << dropped() << "},\"traceEvents\":[";
+    bool first = true;
+    char number[64];
+    for (const auto &buffer : buffers()) {
+      std::string threadName = buffer->threadName();
+      if (!threadName.empty()) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId()
+          << ",\"args\":{\"name\":" << jsonString(threadName) << "}}";
+        first = false;
+      }
+      for (const auto &event : buffer->events()) {
+        // microseconds, to the nanosecond
+        std::snprintf(number, sizeof(number), "\"ts\":%.3f,\"dur\":%.3f", event.start / 1000.0, event.duration / 1000.0);
+        out << (first ? "\n" : ",\n") << "{\"name\":" << jsonString(event.name) << ",\"cat\":" << jsonString(event.category)
+          << ",\"ph\":\"X\"," << number << ",\"pid\":1,\"tid\":" << buffer->threadId() << "}";
+        first = false;
+      }
+    }
+    out << "\n]}\n";
+  }
+
+  bool writeChromeTrace(const std::string &path) const
+  {
+    std::ofstream out(path);
+    writeChromeTrace(out);
+    out.close();
+    return !out.fail();
+  }
+
+private:
+  Tracer() : m_epoch(std::chrono::steady_clock::now()), m_enabled(false)
+  {}
+
+  TraceBuffer &threadBuffer()
+  {
+    thread_local std::shared_ptr<TraceBuffer> buffer;
+    if (!buffer) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      buffer = std::make_shared<TraceBuffer>(static_cast<uint32_t>(m_buffers.size() + 1));
+      m_buffers.push_back(buffer);
+    }
+    return *buffer;
+  }
+
+  std::vector<std::shared_ptr<TraceBuffer>> buffers() const
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_buffers;
+  }
+
+  const std::chrono::steady_clock::time_point m_epoch;
+  std::atomic<bool> m_enabled;
+  mutable std::mutex m_mutex;
+  std::vector<std::shared_ptr<TraceBuffer>> m_buffers;
+};
+
+/// Records a span from construction to destruction, if the tracer was enabled at construction
+class TraceScope
+{
+public:
+  TraceScope(const char *name, const char *category) : m_name(name), m_category(category), m_active(Tracer::instance().enabled()),
+    m_start(m_active ? Tracer::instance().now() : 0)
+  {}
+
+  ~TraceScope()
+  {
+    if (m_active) {
+      Tracer &tracer = Tracer::instance();
+      tracer.record(m_name, m_category, m_start, tracer.now());
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_name;
+  const char *m_category;
+  bool m_active;
+  uint64_t m_start;
+};
+
+}; // resultsviewer namespace
+
+#define RESULTSVIEWER_TRACE_CONCAT_(a, b) a##b
+#define RESULTSVIEWER_TRACE_CONCAT(a, b) RESULTSVIEWER_TRACE_CONCAT_(a, b)
+
+#ifdef RESULTSVIEWER_TRACING
+// Trace the rest of the enclosing scope as name, in category
+#define RESULTSVIEWER_TRACE_SCOPE(name, category) \
+  ::resultsviewer::TraceScope RESULTSVIEWER_TRACE_CONCAT(resultsviewerTraceScope, __LINE__)(name, category)
+#else
+#define RESULTSVIEWER_TRACE_SCOPE(name, category) do {} while (0)
+#endif
+
+#endif // RESULTSVIEWER_TRACER_HPP
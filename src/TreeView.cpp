@@ -28,14 +28,10 @@
 
 #include "TreeView.hpp"
 
-#include "../utilities/sql/SqlFileEnums.hpp"
-
 #include <QTreeWidgetItemIterator>
 #include <QMouseEvent>
 
-using openstudio::toString;
-using openstudio::toQString;
-using openstudio::ReportingFrequency;
+#include <cmath>
 
 namespace resultsviewer{
 
@@ -44,6 +40,7 @@ TreeView::TreeView( QWidget* parent):QTreeWidget(parent)
     // The tree supports dragging 
   setDragEnabled(true);
   m_defaultDisplayMode = tvdtVariableName;
+  connect(this, &QTreeWidget::itemExpanded, this, &TreeView::onItemExpanded);
 }
 
 void TreeView::mouseMoveEvent(QMouseEvent *e)
@@ -125,38 +122,35 @@ resultsviewer::ResultsViewerPlotData TreeView::resultsViewerPlotDataFromTreeItem
 }
 
 
-openstudio::OptionalTimeSeries TreeView::timeseriesFromTreeItem(QTreeWidgetItem* treeItem)
+std::optional<TimeSeries> TreeView::timeseriesFromTreeItem(QTreeWidgetItem* treeItem, ResultsViewerData &data)
 {
-  openstudio::OptionalTimeSeries ts;
-  std::string keyValue="", variableName="", envPeriod="", filename="", reportFreq="";
+  std::optional<TimeSeries> ts;
+  std::string keyValue="", variableName="", envPeriod="", reportFreq="";
   QTreeWidgetItem *fileItem = nullptr;
   while (treeItem) {
     switch (treeItem->type()) {
       case ddtKeyValue:
-        keyValue = toString(treeItem->text(0));
+        keyValue = treeItem->text(0).toStdString();
         break;
       case ddtVariableName:
-        variableName = toString(treeItem->text(0));
+        variableName = treeItem->text(0).toStdString();
         break;
       case ddtReportingFrequency:
-        reportFreq = toString(treeItem->text(0));
+        reportFreq = treeItem->text(0).toStdString();
         break;
       case ddtEnv:
-        envPeriod = toString(treeItem->text(0));
+        envPeriod = treeItem->text(0).toStdString();
         break;
       case ddtFile:
         fileItem = treeItem;
-        filename = toString(treeItem->text(0));
         break;
     }
     treeItem = treeItem->parent();
   }
 
   if (fileItem) {
-    filename = openstudio::toString(filenameFromTopLevelItem(fileItem));
-    openstudio::path p = openstudio::toPath(filename);
-    openstudio::SqlFile sqlFile(p);
-    ts = sqlFile.timeSeries(envPeriod, reportFreq, variableName, keyValue);
+    SqlFilePool::Lease sqlFile = data.sqlFile(filenameFromTopLevelItem(fileItem));
+    if (sqlFile) ts = sqlFile->timeSeries(envPeriod, reportFreq, variableName, keyValue);
   }
 
   return ts;
@@ -263,15 +257,13 @@ QString TreeView::filenameFromTreeItem(QTreeWidgetItem *item)
 
 
 
-void TreeView::displayFile(const QString &alias, openstudio::SqlFile sqlFile, treeViewDisplayType treeViewDisplay)
+void TreeView::displayFile(const QString &alias, std::shared_ptr<SqlFilePool> connections, treeViewDisplayType treeViewDisplay)
 {
-  if (sqlFile.connectionOpen()) {
-    //    m_alias = alias;
-    //    m_filename = toQString(sqlFile.energyPlusSqliteFile());
+  if (connections && connections->connectionOpen()) {
     switch (treeViewDisplay) {
       case tvdtVariableName:
         /// file, env period, reporting freq, variable name, key value
-        displaySqlFileVariableName(alias, sqlFile);
+        displaySqlFileVariableName(alias, connections);
         break;
       case tvdtKeyValue:
         break;
@@ -282,6 +274,13 @@ void TreeView::displayFile(const QString &alias, openstudio::SqlFile sqlFile, tr
   }
 }
 
+void TreeView::displayFile(const QString &alias, std::shared_ptr<SqlFilePool> connections, std::shared_ptr<const DictionaryTree> tree)
+{
+  if (connections && connections->connectionOpen()) {
+    displaySqlFileVariableName(alias, connections, tree);
+  }
+}
+
 QString TreeView::filenameFromTopLevelItem(QTreeWidgetItem *item)
 {
 //      fileItem->setText(0,QString("(%1) - %2").arg(alias).arg(sqlFile.energyPlusSqliteFile()));
@@ -309,139 +308,145 @@ QString TreeView::aliasFromTopLevelItem(QTreeWidgetItem *item)
 }
 
 
-void TreeView::displaySqlFileVariableName(const QString& alias, openstudio::SqlFile sqlFile)
+void TreeView::displaySqlFileVariableName(const QString& alias, std::shared_ptr<SqlFilePool> connections,
+  std::shared_ptr<const DictionaryTree> tree)
 {
-  QString s;
-  if (sqlFile.connectionOpen()) {
+  QString filename = QString::fromStdString(connections->path());
+  if (!tree)
+  {
+    SqlFilePool::Lease sqlFile = connections->acquire();
+    if (!sqlFile || !sqlFile->connectionOpen()) return;
 
-    //    this->clear();
+    // the whole hierarchy from one pass over the dictionary, items are made as branches are expanded
+    tree = std::make_shared<const DictionaryTree>(sqlFile->energyPlusSqliteFile(), sqlFile->dataDictionary(), sqlFile->illuminanceMaps());
+  }
 
-    QTreeWidgetItem *parent = this->invisibleRootItem();
+  auto fileItem = createItem(this->invisibleRootItem(), *tree, 0);
+  fileItem->setText(0,QString("(%1) - %2").arg(alias).arg(filename));
+  fileItem->setData(0,Qt::UserRole, QStringList()<<alias<<filename);
+  FileTree &file = m_fileTrees[fileItem];
+  file = FileTree{ tree, connections, std::vector<bool>() };
+  if (!m_filter.empty()) filterFile(fileItem, file);
 
-    auto fileItem = new QTreeWidgetItem(parent,ddtFile);
-    //    fileItem->setText(0,QString("(%1) - %2").arg(m_alias).arg(m_filename));
-    QString filename = openstudio::toQString(sqlFile.energyPlusSqliteFile());
-    fileItem->setText(0,QString("(%1) - %2").arg(alias).arg(filename));
-    fileItem->setData(0,Qt::UserRole, QStringList()<<alias<<filename);
+  int textWidth = fontMetrics().width(fileItem->text(0))+30;
+  if (textWidth > this->columnWidth(0)) this->setColumnWidth(0,textWidth);
 
-    int textWidth = fontMetrics().width(fileItem->text(0))+30;
-    if (textWidth > this->columnWidth(0)) this->setColumnWidth(0,textWidth);
+  // open down to the reporting frequencies, which are few; variables wait to be expanded
+  fileItem->setExpanded(true);
+  for (int i = 0; i < fileItem->childCount(); ++i)
+  {
+    fileItem->child(i)->setExpanded(true);
+  }
+}
 
-    QTreeWidgetItem* reportFreqItem = nullptr;
-    QTreeWidgetItem* variableNameItem = nullptr;
-    QTreeWidgetItem* keyValueItem = nullptr;
-    QTreeWidgetItem* hourlyBranch = nullptr;
+QTreeWidgetItem *TreeView::createItem(QTreeWidgetItem *parent, const DictionaryTree &tree, size_t node)
+{
+  const DictionaryTree::Node &treeNode = tree.node(node);
+  int type = ddtFile;
+  switch (treeNode.level)
+  {
+    case DictionaryTree::Level::File:
+      type = ddtFile;
+      break;
+    case DictionaryTree::Level::EnvironmentPeriod:
+      type = ddtEnv;
+      break;
+    case DictionaryTree::Level::ReportingFrequency:
+      type = ddtReportingFrequency;
+      break;
+    case DictionaryTree::Level::VariableName:
+      type = ddtVariableName;
+      break;
+    case DictionaryTree::Level::KeyValue:
+      type = ddtKeyValue;
+      break;
+  }
 
-    // environment period branch
-    std::vector<std::string> vecEnvPeriods(sqlFile.availableEnvPeriods());
-    std::vector<std::string>::iterator iterEnv;
-    for (iterEnv=vecEnvPeriods.begin();iterEnv!=vecEnvPeriods.end();++iterEnv)
-    {
-      s = toQString(*iterEnv);
-      // add to file branch
-      auto envItem = new QTreeWidgetItem(fileItem, ddtEnv);
-      envItem->setText(0, s);
-
-      // setup reporting frequency branch
-      std::vector<std::string> vecReportFreq(sqlFile.availableReportingFrequencies(*iterEnv));
-      std::vector<std::string>::iterator iterReportFreq;
-      for (iterReportFreq=vecReportFreq.begin();iterReportFreq!=vecReportFreq.end();++iterReportFreq)
-      {
-        // skip runPeriod
-        if (sqlFile.reportingFrequencyFromDB(*iterReportFreq))
-//          if (*(sqlFile.reportingFrequencyFromDB(*iterReportFreq)) != ReportingFrequency::RunPeriod)
-        {
-          s = toQString(*iterReportFreq);
-          // add to environment branch
-          reportFreqItem = new QTreeWidgetItem(envItem, ddtReportingFrequency);
-          reportFreqItem->setText(0, s);
+  auto item = new QTreeWidgetItem(parent, type);
+  item->setText(0, QString::fromStdString(treeNode.name));
+  item->setData(0, nodeRole, qulonglong(node));
+  if (type == ddtVariableName)
+  {
+    item->setData(0, Qt::UserRole, treeNode.illuminanceMap ? RVD_ILLUMINANCEMAP : RVD_TIMESERIES);
+  }
+  else if ((type == ddtKeyValue) && !treeNode.mapName.empty())
+  {
+    item->setData(0, Qt::UserRole, QString::fromStdString(treeNode.mapName)); // map name
+  }
+  if (!treeNode.children.empty())
+  {
+    item->setChildIndicatorPolicy(QTreeWidgetItem::ShowIndicator);
+  }
+  return item;
+}
 
-          if (*(sqlFile.reportingFrequencyFromDB(*iterReportFreq)) == ReportingFrequency::Hourly){
-            hourlyBranch = reportFreqItem;
-          }
+const TreeView::FileTree *TreeView::fileTree(QTreeWidgetItem *item) const
+{
+  while (item && item->parent()) item = item->parent();
+  auto iter = m_fileTrees.find(item);
+  if (iter == m_fileTrees.end()) return nullptr;
+  return &iter->second;
+}
 
-          // setup variable name branch
-          std::vector<std::string> vecVariableName(sqlFile.availableVariableNames(*iterEnv, *iterReportFreq));
-          std::vector<std::string>::iterator iterVariableName;
-          for (iterVariableName=vecVariableName.begin();iterVariableName!=vecVariableName.end();++iterVariableName)
-          {
-            s = toQString(*iterVariableName);
-            // add to reporting frequency branch
-            variableNameItem = new QTreeWidgetItem(reportFreqItem,ddtVariableName);
-            variableNameItem->setText(0, s);
-            variableNameItem->setData(0, Qt::UserRole, RVD_TIMESERIES);
-
-            std::vector<std::string> vecKeyValue(sqlFile.availableKeyValues(*iterEnv, *iterReportFreq,*iterVariableName));
-            std::vector<std::string>::iterator iterKeyValue;
-            for (iterKeyValue=vecKeyValue.begin();iterKeyValue!=vecKeyValue.end();++iterKeyValue)
-            {
-              s = toQString(*iterKeyValue);
-              // add to variable name branch
-              if (!s.isEmpty())
-              {
-                if (sqlFile.reportingFrequencyFromDB(*iterReportFreq))
-                {
-                  if (*(sqlFile.reportingFrequencyFromDB(*iterReportFreq)) == ReportingFrequency::RunPeriod)
-                  {
-                    //                keyValueItem->setText(0, s + " = " +  QString::number(sqlFile.runPeriodValue(*iterEnv, *iterVariableName, *iterKeyValue)));
-                    // "Facility:Electricity->Cumulative" should go to "Cumulative Facility:Electricity".
-                    boost::optional<double> runPeriodValue = sqlFile.runPeriodValue(*iterEnv, *iterVariableName, *iterKeyValue);
-                    if (runPeriodValue){
-                      variableNameItem->setText(0, s + " " + variableNameItem->text(0) + " = " +  QString::number(*runPeriodValue));
-                    }
-
-                  }
-                  else
-                  {
-                    keyValueItem = new QTreeWidgetItem(variableNameItem,ddtKeyValue);
-                    keyValueItem->setText(0, s);
-                  }
-                }
-              }
-            }
-            variableNameItem->setExpanded(true);
-          }
-          reportFreqItem->setExpanded(true);
-        } // end skip runPeriod
-      }
-      // for the specified environment period retrieve all illuminance maps - if any
-      std::vector<std::string> vecIlluminanceMaps( sqlFile.illuminanceMapNames(*iterEnv) );
-      if ( vecIlluminanceMaps.size() > 0)
-      {
-        if (!hourlyBranch){
-          hourlyBranch = new QTreeWidgetItem(envItem, ddtReportingFrequency);
-        }
+bool TreeView::canFetchMore(QTreeWidgetItem *item) const
+{
+  const FileTree *file = fileTree(item);
+  if (!file) return false;
+  size_t node = item->data(0, nodeRole).toULongLong();
+  return (item->childCount() == 0) && !file->tree->node(node).children.empty();
+}
 
-        // add to hourly branch
-        variableNameItem = new QTreeWidgetItem(hourlyBranch, ddtVariableName);
-        variableNameItem->setText(0, "Illuminance Map");
-        variableNameItem->setData(0, Qt::UserRole, RVD_ILLUMINANCEMAP);
-        std::vector<std::string>::iterator iterIlluminanceMap;
-        for (iterIlluminanceMap=vecIlluminanceMaps.begin();iterIlluminanceMap!=vecIlluminanceMaps.end();++iterIlluminanceMap)
+void TreeView::fetchMore(QTreeWidgetItem *item)
+{
+  if (!canFetchMore(item)) return;
+  const FileTree *file = fileTree(item);
+  const DictionaryTree &tree = *file->tree;
+  size_t node = item->data(0, nodeRole).toULongLong();
+
+  std::vector<int> dictionaryIndices;
+  std::vector<QTreeWidgetItem *> valueItems;
+  int envPeriodIndex = -1;
+  for (size_t child : tree.node(node).children)
+  {
+    QTreeWidgetItem *childItem = createItem(item, tree, child);
+    if (!file->shown.empty()) childItem->setHidden(!file->shown[child]);
+    if (tree.node(child).dictionaryIndex >= 0)
+    {
+      dictionaryIndices.push_back(tree.node(child).dictionaryIndex);
+      valueItems.push_back(childItem);
+      envPeriodIndex = tree.node(child).envPeriodIndex;
+    }
+  }
+
+  // "Facility:Electricity->Cumulative" should go to "Cumulative Facility:Electricity" = value; all the run period
+  // values of the branch are read in one pass
+  if (!dictionaryIndices.empty())
+  {
+    SqlFilePool::Lease sqlFile = file->connections->acquire();
+    if (sqlFile)
+    {
+      TimeSeriesColumns columns = sqlFile->timeSeriesColumns(envPeriodIndex, dictionaryIndices);
+      for (size_t i = 0; i < valueItems.size(); ++i)
+      {
+        const TimeSeriesArray<double> &values = columns.values[i];
+        for (size_t j = values.size(); j-- > 0;)
         {
-          std::vector<std::string> vecKeyValue(sqlFile.illuminanceMapZoneNames(*iterIlluminanceMap));
-          std::vector<std::string>::iterator iterKeyValue;
-          for (iterKeyValue=vecKeyValue.begin();iterKeyValue!=vecKeyValue.end();++iterKeyValue)
+          if (!std::isnan(values[j]))
           {
-            s = toQString(*iterKeyValue);
-            // add to variable name branch
-            if (!s.isEmpty())
-            {
-              keyValueItem = new QTreeWidgetItem(variableNameItem,ddtKeyValue);
-              keyValueItem->setText(0, s);
-              keyValueItem->setData(0, Qt::UserRole, toQString(*iterIlluminanceMap) );// map name
-            }
+            valueItems[i]->setText(0, valueItems[i]->text(0) + " = " + QString::number(values[j]));
+            break;
           }
-          variableNameItem->setExpanded(true);
         }
-        hourlyBranch->setExpanded(true);
       }
-      envItem->setExpanded(true);
     }
-    fileItem->setExpanded(true);
   }
 }
 
+void TreeView::onItemExpanded(QTreeWidgetItem *item)
+{
+  fetchMore(item);
+}
+
 void TreeView::updateFileAlias(const QString& alias, const QString& filename)
 {
   for (int i=0;i<topLevelItemCount();i++)
@@ -470,6 +475,7 @@ void TreeView::removeFile(const QString& filename)
       QString matchingFilename = filenameFromTopLevelItem(fileItem);
       if (matchingFilename.toUpper() == filename.toUpper())
       {
+        m_fileTrees.erase(fileItem);
         removeBranch(fileItem);
         break;
       }
@@ -506,54 +512,48 @@ bool TreeView::isEmpty()
 
 void TreeView::applyFilter(QString& filterText)
 {
-//  QRegExp regExp(filterText); //strict regular expression matching
-  QRegExp regExp(filterText, Qt::CaseInsensitive, QRegExp::Wildcard); // text wild card *, ? matching
-  // hide all
-  QTreeWidgetItemIterator itAll(this);
-  while (*itAll) 
+  // text wild card *, ? matching, case insensitive, against the dictionaries so that branches which were never
+  // expanded are searched too; a pattern of only '*' matches everything and clears the filter
+  std::string pattern = filterText.toStdString();
+  if (pattern.find_first_not_of('*') == std::string::npos)
   {
-    (*itAll)->setHidden(true);
-    ++itAll;
+    clearFilter();
+    return;
   }
-  // check all leaf nodes
-  QTreeWidgetItemIterator it(this,QTreeWidgetItemIterator::NoChildren); // bottom level
-  while (*it) 
+  m_filter = pattern;
+  for (auto &file : m_fileTrees)
   {
-    QTreeWidgetItem *parent;
-    bool showBranch = false;
-    if (regExp.exactMatch((*it)->text(0)))
-    {
-      showBranch = true;
-    }
-    else
-    {
-      parent = (*it)->parent();
-      while ((parent) && (!showBranch))
-      {
-        if (regExp.exactMatch(parent->text(0)))
-        {
-          showBranch = true;
-        }
-        parent = parent->parent();
-      }
-    }
-    if (showBranch)
-    {
-      (*it)->setHidden(false);
-      parent = (*it)->parent();
-      // set branch visible
-      while(parent)
-      {
-        parent->setHidden(false);
-        parent = parent->parent();
-      }
-    }
-    ++it;
+    filterFile(file.first, file.second);
+  }
+}
+
+void TreeView::filterFile(QTreeWidgetItem *fileItem, FileTree &file)
+{
+  file.shown = file.tree->filter(m_filter);
+  // the file item shows alias and path, match it as it is displayed
+  if (NgramIndex::wildcardMatch(m_filter, fileItem->text(0).toStdString())) file.shown.assign(file.shown.size(), true);
+  applyFilter(fileItem, file.shown);
+}
+
+void TreeView::applyFilter(QTreeWidgetItem *item, const std::vector<bool> &shown)
+{
+  // a collapsed item is shown when it leads to a match, its children take the filter as fetchMore creates them
+  size_t node = item->data(0, nodeRole).toULongLong();
+  item->setHidden(!shown[node]);
+  if (!shown[node]) return;
+  for (int i = 0; i < item->childCount(); ++i)
+  {
+    applyFilter(item->child(i), shown);
   }
 }
 
 void TreeView::clearFilter()
 {
+  m_filter.clear();
+  for (auto &file : m_fileTrees)
+  {
+    file.second.shown.clear();
+  }
   QTreeWidgetItemIterator it(this);
   while (*it) 
   {
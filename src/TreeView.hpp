@@ -34,12 +34,16 @@
 #include "ResultsViewerData.hpp"
 
 #include "SqlFile.hpp"
+#include "SqlFilePool.hpp"
+#include "DictionaryTree.hpp"
 
 #include <QMainWindow>
 #include <QList>
 #include <QMenu>
 #include <QTreeWidget>
 #include <string>
+#include <map>
+#include <memory>
 #include <QApplication>
 
 
@@ -60,10 +64,17 @@ public:
 
 
   TreeView( QWidget* parent=nullptr );
-  openstudio::OptionalTimeSeries timeseriesFromTreeItem(QTreeWidgetItem* treeItem);
+  // reads the series on a connection leased from the file's pool in data
+  std::optional<TimeSeries> timeseriesFromTreeItem(QTreeWidgetItem* treeItem, ResultsViewerData &data);
   resultsviewer::ResultsViewerPlotData resultsViewerPlotDataFromTreeItem(QTreeWidgetItem* treeItem);
-  void displayFile(const QString &alias, openstudio::SqlFile sqlFile, treeViewDisplayType treeViewDisplay);
-  void displaySqlFileVariableName(const QString &alias, openstudio::SqlFile sqlFile);
+  void displayFile(const QString &alias, std::shared_ptr<SqlFilePool> connections, treeViewDisplayType treeViewDisplay);
+  // display with a dictionary tree already grouped, as by a FileOpener
+  void displayFile(const QString &alias, std::shared_ptr<SqlFilePool> connections, std::shared_ptr<const DictionaryTree> tree);
+  void displaySqlFileVariableName(const QString &alias, std::shared_ptr<SqlFilePool> connections,
+    std::shared_ptr<const DictionaryTree> tree = nullptr);
+  // branches are created when they are first expanded: true if item has children that have not been created yet
+  bool canFetchMore(QTreeWidgetItem *item) const;
+  void fetchMore(QTreeWidgetItem *item);
   void updateFileAlias(const QString& alias, const QString& filename);
   void removeFile(const QString& filename);
   bool isEmpty();
@@ -93,9 +104,32 @@ protected:
   // external resultsviewerplotdata creation with caching of timeseries
   void performResultsViewerPlotDataDrag();
 
+private slots:
+  void onItemExpanded(QTreeWidgetItem *item);
+
 private:
+  /// dictionary of an open file, shared by the items of its branch
+  struct FileTree
+  {
+    std::shared_ptr<const DictionaryTree> tree;
+    std::shared_ptr<SqlFilePool> connections;
+    // nodes shown by the active filter, empty when there is none
+    std::vector<bool> shown;
+  };
+
+  // item data role holding the DictionaryTree node of an item
+  static const int nodeRole = Qt::UserRole + 1;
+
   QPoint m_startPos;
   treeViewDisplayType m_defaultDisplayMode;
+  std::map<QTreeWidgetItem *, FileTree> m_fileTrees; // by file item
+  std::string m_filter; // active wildcard filter, empty when there is none
+  const FileTree *fileTree(QTreeWidgetItem *item) const;
+  QTreeWidgetItem *createItem(QTreeWidgetItem *parent, const DictionaryTree &tree, size_t node);
+  // match the active filter against the dictionary of a file item
+  void filterFile(QTreeWidgetItem *fileItem, FileTree &file);
+  // hide the items of a branch that are not shown, without creating any
+  void applyFilter(QTreeWidgetItem *item, const std::vector<bool> &shown);
   QString filenameFromTopLevelItem(QTreeWidgetItem *topLevelItem);
   QString aliasFromTopLevelItem(QTreeWidgetItem *topLevelItem);
   void removeBranch(QTreeWidgetItem *item);
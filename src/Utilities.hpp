@@ -26,11 +26,88 @@
 #define RESULTSVIEWER_UTILITIES_HPP
 
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstddef>
 
 namespace resultsviewer{
 
 enum class InterpMethod { LinearInterp, NearestInterp, HoldLastInterp, HoldNextInterp };
 
+enum class ExtrapMethod { NoneExtrap, NearestExtrap };
+
+namespace detail {
+
+// Find where t falls in the increasing values v: the result lies between v[index] and v[index + 1], weight of the
+// way along. Returns false if t is outside v and there is no extrapolation.
+inline bool interpIndex(const std::vector<double> &v, double t, InterpMethod interpMethod, ExtrapMethod extrapMethod,
+  size_t &index, double &weight)
+{
+  weight = 0.0;
+  if (v.empty() || std::isnan(t)) {
+    return false;
+  }
+  if (t <= v.front() || t >= v.back()) {
+    if (extrapMethod == ExtrapMethod::NoneExtrap && t != v.front() && t != v.back()) {
+      return false;
+    }
+    index = t <= v.front() ? 0 : v.size() - 1;
+    return true;
+  }
+  // v.front() < t < v.back(), so there is at least one value on each side
+  index = static_cast<size_t>(std::upper_bound(v.begin(), v.end(), t) - v.begin()) - 1;
+  double fraction = (t - v[index]) / (v[index + 1] - v[index]);
+  switch (interpMethod) {
+  case InterpMethod::LinearInterp:
+    weight = fraction;
+    break;
+  case InterpMethod::NearestInterp:
+    if (fraction >= 0.5) {
+      ++index;
+    }
+    break;
+  case InterpMethod::HoldLastInterp:
+    break;
+  case InterpMethod::HoldNextInterp:
+    if (fraction > 0.0) {
+      ++index;
+    }
+    break;
+  }
+  return true;
+}
+
+}
+
+/**
+Interpolate a matrix given at the points (x[i], y[j]), with x and y increasing and matrix(i, j) the value at
+(x[i], y[j]). Outside of the points the result is NaN, or the value at the nearest edge with NearestExtrap.
+*/
+template <typename M> double interp(const std::vector<double> &x, const std::vector<double> &y, const M &matrix,
+  double xi, double yi, InterpMethod interpMethod = InterpMethod::LinearInterp,
+  ExtrapMethod extrapMethod = ExtrapMethod::NoneExtrap)
+{
+  size_t i, j;
+  double wx, wy;
+  if (!detail::interpIndex(x, xi, interpMethod, extrapMethod, i, wx)
+    || !detail::interpIndex(y, yi, interpMethod, extrapMethod, j, wy)) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  // terms with no weight are skipped, so the neighbors past the last point are never read
+  double result = (1.0 - wx) * (1.0 - wy) * matrix(i, j);
+  if (wx > 0.0) {
+    result += wx * (1.0 - wy) * matrix(i + 1, j);
+  }
+  if (wy > 0.0) {
+    result += (1.0 - wx) * wy * matrix(i, j + 1);
+    if (wx > 0.0) {
+      result += wx * wy * matrix(i + 1, j + 1);
+    }
+  }
+  return result;
+}
+
 template <typename T> std::vector<T> intervalspace(const T start, const int count, const T interval)
 {
   std::vector<T> result{ {start} };
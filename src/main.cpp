@@ -31,6 +31,13 @@
 //#include <vld.h> 
 
 #include "MainWindow.hpp"
+#include "PlotView.hpp"
+#include "BatchJob.hpp"
+#include "FileRegistry.hpp"
+#include "SqlFilePool.hpp"
+#include "ThreadPool.hpp"
+#include "TimeSeriesLoader.hpp"
+#include "Tracer.hpp"
 
 //#include "../utilities/core/Application.hpp"
 //#include "../utilities/core/ApplicationPathHelpers.hpp"
@@ -42,9 +49,252 @@
 // Had to add these for the minimal compile
 #include <QMessageBox>
 #include <QAbstractButton>
+#include <QDir>
+#include <QFileInfo>
+
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <tuple>
+
+namespace {
+
+  // With RESULTSVIEWER_TRACE set to a file name, the whole session is traced and the trace written there at exit
+  class TraceSession
+  {
+  public:
+    TraceSession() : m_path(qgetenv("RESULTSVIEWER_TRACE").toStdString())
+    {
+      if (m_path.empty()) return;
+#ifdef RESULTSVIEWER_TRACING
+      resultsviewer::Tracer::instance().setEnabled(true);
+      resultsviewer::Tracer::instance().setThreadName("main");
+#else
+      std::cerr << "ResultsViewer: built without tracing, RESULTSVIEWER_TRACE is ignored" << std::endl;
+      m_path.clear();
+#endif
+    }
+
+    ~TraceSession()
+    {
+      if (m_path.empty()) return;
+      resultsviewer::Tracer::instance().setEnabled(false);
+      if (!resultsviewer::Tracer::instance().writeChromeTrace(m_path)) {
+        std::cerr << "ResultsViewer: cannot write the trace to " << m_path << std::endl;
+      }
+    }
+
+  private:
+    std::string m_path;
+  };
+
+  void batchUsage()
+  {
+    std::cerr << "usage: ResultsViewer --batch [options] file.sql...\n"
+      "  --select SPEC        plot|environment|frequency|variable|key, plot is line, flood or illuminance and the\n"
+      "                       rest are wildcard patterns; may be repeated\n"
+      "  --select-file FILE   one SPEC per line\n"
+      "  --output DIR         where images and statistics are written (default .)\n"
+      "  --format png|svg     image format (default png)\n"
+      "  --size WxH           image size (default 800x600)\n"
+      "  --statistics FILE    summary statistics CSV, - for standard output (default statistics.csv)\n"
+      "  --no-plots           write the statistics only\n"
+      "  --threads N          threads reading series and computing statistics (default one per core); images are\n"
+      "                       drawn one after another on the main thread\n"
+      "  --cache              read through columnar caches next to the files\n"
+      "  --rollup PERIOD[:STATISTIC]\n"
+      "                       plot hourly, daily or monthly sum, mean, minimum, maximum or integral of finer reports\n";
+  }
+
+  // Render the selected plots of every file to images and write their summary statistics, without a display. The
+  // series are read and summarized on a thread pool; widgets can only be used on this thread, so the plots are drawn
+  // one after another as their data arrives.
+  int runBatch(const resultsviewer::BatchOptions &options)
+  {
+    using namespace resultsviewer;
+    RESULTSVIEWER_TRACE_SCOPE("runBatch", "batch");
+
+    QDir output(QString::fromStdString(options.outputDirectory));
+    if (!QDir().mkpath(output.absolutePath())) {
+      std::cerr << "ResultsViewer: cannot create " << options.outputDirectory << std::endl;
+      return 1;
+    }
+
+    int failures = 0;
+    BatchNames names;
+    std::vector<BatchJob> jobs;
+    std::map<std::string, std::shared_ptr<SqlFilePool> > pools;
+    // a file given twice, under any spelling of its path, is read once
+    FileRegistry<SqlFilePool> opened;
+    for (const auto &file : options.files) {
+      if (opened.contains(file)) {
+        std::cerr << "ResultsViewer: " << file << " is already in the batch, skipped" << std::endl;
+        continue;
+      }
+      std::string cachePath = options.columnarCache ? ColumnarCache::pathFor(file) : std::string();
+      auto pool = std::make_shared<SqlFilePool>(file, SqlFile::OpenMode::ReadOnly, SqlFilePool::defaultMaxConnections(),
+        cachePath);
+      if (!pool->connectionOpen()) {
+        std::cerr << "ResultsViewer: cannot open " << file << std::endl;
+        ++failures;
+        continue;
+      }
+      if (options.columnarCache) {
+        // a cache that was current is already in use, otherwise it is built now for the reads below
+        pool->useColumnarCache(cachePath);
+      }
+      std::string fileTag = QFileInfo(QString::fromStdString(file)).completeBaseName().toStdString();
+      SqlFilePool::Lease sqlFile = pool->acquire();
+      std::vector<BatchJob> fileJobs = expandBatchSelections(options.selections, file, fileTag, *sqlFile, options.format, names);
+      if (fileJobs.empty()) {
+        std::cerr << "ResultsViewer: nothing selected in " << file << std::endl;
+      }
+      jobs.insert(jobs.end(), fileJobs.begin(), fileJobs.end());
+      pools[file] = pool;
+      opened.add(file, fileTag, pool);
+    }
+
+    // a line and a flood plot of one variable share a request
+    std::vector<TimeSeriesRequest> requests;
+    std::vector<size_t> requestJobs;
+    std::vector<size_t> jobRequests(jobs.size(), 0);
+    std::map<std::tuple<std::string, std::string, std::string, std::string, std::string>, size_t> requestOf;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      const BatchJob &job = jobs[i];
+      if (!job.isTimeSeries()) continue;
+      auto inserted = requestOf.emplace(std::make_tuple(job.path, job.envPeriod, job.reportingFrequency, job.name, job.keyValue), requests.size());
+      if (inserted.second) {
+        requests.push_back({ job.path, job.envPeriod, job.reportingFrequency, job.name, job.keyValue });
+        requestJobs.push_back(i);
+      }
+      jobRequests[i] = inserted.first->second;
+    }
+
+    ThreadPool threadPool(options.threads > 0 ? options.threads : ThreadPool::defaultThreadCount());
+    std::vector<Statistics> statistics(requests.size());
+    // series are read on the files' own connections, through their columnar caches
+    TimeSeriesLoader loader(threadPool);
+    loader.setConnections([&pools](const std::string &path) {
+      auto it = pools.find(path);
+      return it == pools.end() ? std::shared_ptr<SqlFilePool>() : it->second;
+    });
+    std::vector<std::shared_future<TimeSeriesLoader::result_type> > series = loader.load(requests,
+      CancellationToken(), [&statistics](size_t i, const TimeSeriesLoader::result_type &ts) {
+        if (ts) statistics[i] = computeStatistics(ts->values().data(), ts->values().size());
+      });
+
+    // a series is let go once the last plot of it is drawn, so a long batch does not hold every series at once
+    std::vector<size_t> plotsLeft(requests.size(), 0);
+    if (options.plots) {
+      for (size_t i = 0; i < jobs.size(); ++i) {
+        if (jobs[i].isTimeSeries()) ++plotsLeft[jobRequests[i]];
+      }
+    }
+
+    if (options.plots) {
+      QString path = output.absolutePath();
+      for (size_t i = 0; i < jobs.size(); ++i) {
+        const BatchJob &job = jobs[i];
+        QString name = QString::fromStdString(job.name);
+        QString keyValue = QString::fromStdString(job.keyValue);
+
+        PlotViewData plotViewData;
+        plotViewData.interval = QString::fromStdString(job.reportingFrequency).toUpper();
+        plotViewData.legendName = "(%1) " + name;
+        if (!keyValue.isEmpty()) plotViewData.legendName = "(%1) " + name + "," + keyValue;
+        plotViewData.plotTitle = QString::fromStdString(job.reportingFrequency) + "," + name;
+        plotViewData.windowTitle = QString::fromStdString(job.path) + " : " + name;
+        plotViewData.plotSource.append(QString::fromStdString(job.path));
+        plotViewData.alias.append(QFileInfo(QString::fromStdString(job.path)).completeBaseName());
+        plotViewData.connections.push_back(pools[job.path]);
+
+        int plotType = RVPV_ILLUMINANCEPLOT;
+        if (job.isTimeSeries()) {
+          size_t r = jobRequests[i];
+          TimeSeriesLoader::result_type ts = series[r].get();
+          if (--plotsLeft[r] == 0) {
+            series[r] = std::shared_future<TimeSeriesLoader::result_type>();
+          }
+          if (!ts || ts->values().size() == 0) {
+            std::cerr << "ResultsViewer: no data to plot for " << job.name << " " << job.keyValue << " in " << job.path << std::endl;
+            ++failures;
+            continue;
+          }
+          plotViewData.ts = ts;
+          if (options.rollupPeriod && Rollup::appliesTo(*options.rollupPeriod, job.reportingFrequency)) {
+            std::string rollupName = Rollup::periodName(*options.rollupPeriod) + " " + Rollup::statisticName(options.rollupStatistic);
+            plotViewData.ts = ts->rolledUp(*options.rollupPeriod, options.rollupStatistic);
+            plotViewData.interval = QString::fromStdString(Rollup::intervalName(*options.rollupPeriod));
+            plotViewData.plotTitle = QString::fromStdString(rollupName) + "," + name;
+            plotViewData.legendName += " [" + QString::fromStdString(rollupName) + "]";
+          }
+          plotType = job.plot == BatchPlot::Flood ? RVPV_FLOODPLOT : RVPV_LINEPLOT;
+        } else {
+          plotViewData.dbIdentifier = name;
+        }
+
+        PlotView plotView(path, plotType);
+        plotView.resize(options.width, options.height);
+        plotView.plotViewData(plotViewData, std::function<bool ()>());
+        QString image = output.filePath(QString::fromStdString(job.image));
+        {
+          RESULTSVIEWER_TRACE_SCOPE("PlotView::generateImage", "batch");
+          plotView.generateImage(image, options.width, options.height);
+        }
+        if (!QFileInfo::exists(image)) {
+          std::cerr << "ResultsViewer: could not write " << image.toStdString() << std::endl;
+          ++failures;
+        }
+      }
+    }
+
+    std::ofstream statisticsFile;
+    bool toStandardOutput = options.statisticsFile == "-";
+    if (!toStandardOutput) {
+      statisticsFile.open(output.filePath(QString::fromStdString(options.statisticsFile)).toStdString());
+      if (!statisticsFile) {
+        std::cerr << "ResultsViewer: cannot write " << options.statisticsFile << std::endl;
+        return 1;
+      }
+    }
+    std::ostream &out = toStandardOutput ? std::cout : statisticsFile;
+    out << batchStatisticsHeader() << "\n";
+    for (size_t i = 0; i < requests.size(); ++i) {
+      // the statistics are in place once the series is, and a series already plotted is done
+      if (series[i].valid()) {
+        series[i].wait();
+        series[i] = std::shared_future<TimeSeriesLoader::result_type>();
+      }
+      out << batchStatisticsRow(jobs[requestJobs[i]], statistics[i]) << "\n";
+    }
+    out.flush();
+
+    return failures == 0 ? 0 : 1;
+  }
+
+}
+
 
 int main(int argc, char *argv[])
 {
+  TraceSession traceSession;
+
+  if (resultsviewer::BatchOptions::requested(argc, argv)) {
+    std::string error;
+    std::optional<resultsviewer::BatchOptions> options = resultsviewer::BatchOptions::parse(std::vector<std::string>(argv + 2, argv + argc), error);
+    if (!options) {
+      std::cerr << "ResultsViewer: " << error << std::endl;
+      batchUsage();
+      return 2;
+    }
+    // plots are drawn offscreen, so no display server is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication qApplication(argc, argv);
+    return runBatch(*options);
+  }
+
 #if _DEBUG || (__GNUC__ && !NDEBUG)
 #ifdef _WIN32
   const char *logfilepath = "./resultsviewer.log";
@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "BatchJob.hpp"
+#include <fstream>
+
+TEST_CASE("Batch selections", "[BatchJob]")
+{
+  auto selection = resultsviewer::BatchSelection::parse("flood | chicago* | hourly | *:Electricity");
+  REQUIRE(selection);
+  REQUIRE(selection->plot == resultsviewer::BatchPlot::Flood);
+  REQUIRE(selection->envPeriod == "chicago*");
+  REQUIRE(selection->reportingFrequency == "hourly");
+  REQUIRE(selection->name == "*:Electricity");
+  REQUIRE(selection->keyValue == "*");
+
+  selection = resultsviewer::BatchSelection::parse("Illuminance||");
+  REQUIRE(selection);
+  REQUIRE(selection->plot == resultsviewer::BatchPlot::Illuminance);
+  REQUIRE(selection->envPeriod == "*");
+
+  REQUIRE(!resultsviewer::BatchSelection::parse("bar|*"));
+  REQUIRE(!resultsviewer::BatchSelection::parse("line|*|*|*|*|*"));
+}
+
+TEST_CASE("Batch command line", "[BatchJob]")
+{
+  std::string error;
+  {
+    std::ofstream file("batch_selections.txt");
+    file << "# meters\n\nline|*|Hourly|Gas:*\n  flood|*|*|Fans:*\n";
+  }
+  auto options = resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line|*|*|Heating:*", "--select-file",
+    "batch_selections.txt", "--format", "SVG", "--size", "640x480", "--threads", "3", "--no-plots", "b.sql",
+    "--output", "out", "--statistics", "-", "--cache" }, error);
+  REQUIRE(options);
+  REQUIRE(options->files == std::vector<std::string>({ "a.sql", "b.sql" }));
+  REQUIRE(options->selections.size() == 3);
+  REQUIRE(options->selections[1].name == "Gas:*");
+  REQUIRE(options->selections[2].plot == resultsviewer::BatchPlot::Flood);
+  REQUIRE(options->format == "svg");
+  REQUIRE(options->width == 640);
+  REQUIRE(options->height == 480);
+  REQUIRE(options->threads == 3);
+  REQUIRE(!options->plots);
+  REQUIRE(options->outputDirectory == "out");
+  REQUIRE(options->statisticsFile == "-");
+  REQUIRE(options->columnarCache);
+  REQUIRE(!options->rollupPeriod);
+
+  options = resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--rollup", "Daily" }, error);
+  REQUIRE(options);
+  REQUIRE(options->rollupPeriod == resultsviewer::RollupPeriod::Daily);
+  REQUIRE(options->rollupStatistic == resultsviewer::RollupStatistic::Mean);
+  options = resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--rollup", "monthly:integral" }, error);
+  REQUIRE(options);
+  REQUIRE(options->rollupPeriod == resultsviewer::RollupPeriod::Monthly);
+  REQUIRE(options->rollupStatistic == resultsviewer::RollupStatistic::Integral);
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--rollup", "daily:median" }, error));
+  REQUIRE(error == "bad rollup 'daily:median'");
+
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql" }, error));
+  REQUIRE(error == "nothing selected, use --select or --select-file");
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "--select", "line" }, error));
+  REQUIRE(error == "no input files");
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql", "--select" }, error));
+  REQUIRE(error == "--select needs a value");
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--size", "640" }, error));
+  REQUIRE(error == "bad size '640'");
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--format", "gif" }, error));
+  REQUIRE(!resultsviewer::BatchOptions::parse({ "a.sql", "--select", "line", "--frobnicate", "1" }, error));
+  REQUIRE(error == "unknown option --frobnicate");
+
+  char program[] = "ResultsViewer", batch[] = "--batch", file[] = "a.sql";
+  char *batchArgv[] = { program, batch, file };
+  char *guiArgv[] = { program, file };
+  REQUIRE(resultsviewer::BatchOptions::requested(3, batchArgv));
+  REQUIRE(!resultsviewer::BatchOptions::requested(2, guiArgv));
+}
+
+TEST_CASE("Batch jobs", "[BatchJob]")
+{
+  resultsviewer::SqlFile sf("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql", resultsviewer::SqlFile::OpenMode::ReadOnly);
+  REQUIRE(sf.connectionOpen());
+
+  resultsviewer::BatchNames names;
+  std::vector<resultsviewer::BatchSelection> selections = { *resultsviewer::BatchSelection::parse("line|*|hourly|*:electricity"),
+    *resultsviewer::BatchSelection::parse("line|*|*|interiorlights:*"), *resultsviewer::BatchSelection::parse("flood|*|*|Gas:Facility"),
+    *resultsviewer::BatchSelection::parse("illuminance") };
+  std::vector<resultsviewer::BatchJob> jobs = resultsviewer::expandBatchSelections(selections, "ref.sql", "ref", sf, "png", names);
+  // seven end use electricity meters (interior lights once), one flood plot and no maps
+  REQUIRE(jobs.size() == 8);
+  REQUIRE(jobs[0].plot == resultsviewer::BatchPlot::Line);
+  REQUIRE(jobs[0].name == "InteriorLights:Electricity");
+  REQUIRE(jobs[0].units == "J");
+  REQUIRE(jobs[0].image == "ref_line_CHICAGO_IL_USA_TMY2-94846_WMO_725300_Hourly_InteriorLights_Electricity.png");
+  REQUIRE(jobs[7].plot == resultsviewer::BatchPlot::Flood);
+  REQUIRE(jobs[7].name == "Gas:Facility");
+  REQUIRE(jobs[7].isTimeSeries());
+
+  // the same file again gets new names
+  std::vector<resultsviewer::BatchJob> again = resultsviewer::expandBatchSelections(selections, "other/ref.sql", "ref", sf, "png", names);
+  REQUIRE(again.size() == 8);
+  REQUIRE(again[0].image == "ref_line_CHICAGO_IL_USA_TMY2-94846_WMO_725300_Hourly_InteriorLights_Electricity_2.png");
+
+  resultsviewer::Statistics statistics;
+  REQUIRE(resultsviewer::batchStatisticsRow(jobs[0], statistics) == "ref.sql,CHICAGO IL USA TMY2-94846 WMO#=725300,Hourly,InteriorLights:Electricity,,J,0,,,,,");
+  std::vector<double> values = { 1.0, 2.0, 3.0 };
+  statistics = resultsviewer::computeStatistics(values.data(), values.size());
+  jobs[0].keyValue = "ZONE \"1\", WEST";
+  REQUIRE(resultsviewer::batchStatisticsRow(jobs[0], statistics) == "ref.sql,CHICAGO IL USA TMY2-94846 WMO#=725300,Hourly,InteriorLights:Electricity,"
+    "\"ZONE \"\"1\"\", WEST\",J,3,1,3,2,0.81649658092772603,6");
+}
@@ -0,0 +1,176 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "ColumnarCache.hpp"
+#include "SqlFilePool.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+TEST_CASE("Columnar cache", "[ColumnarCache]")
+{
+  // a private copy, the stale cache check writes to it
+  {
+    std::ifstream source("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql", std::ios::binary);
+    std::ofstream copy("columnar_cache.sql", std::ios::binary);
+    copy << source.rdbuf();
+  }
+  const std::string path("columnar_cache.sql");
+  const std::string cachePath = resultsviewer::ColumnarCache::pathFor(path);
+  REQUIRE(cachePath == "columnar_cache.sql.rvcache");
+  std::remove(cachePath.c_str());
+  REQUIRE(!resultsviewer::ColumnarCache::open(cachePath, path));
+
+  {
+    resultsviewer::SqlFile sf(path, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    REQUIRE(sf.connectionOpen());
+    REQUIRE(sf.writeColumnarCache(cachePath));
+  }
+  auto cache = resultsviewer::ColumnarCache::open(cachePath, path);
+  REQUIRE(cache);
+  REQUIRE(cache->source() == *resultsviewer::ColumnarCache::SourceStamp::of(path));
+
+  SECTION("Entries")
+  {
+    resultsviewer::SqlFile sf(path, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    REQUIRE(cache->size() == sf.dataDictionary().size());
+    std::set<uint32_t> grids;
+    for (const auto &item : sf.dataDictionary()) {
+      auto entry = cache->find(item.index, item.envPeriodIndex);
+      REQUIRE(entry);
+      resultsviewer::ColumnarCache::Entry info = cache->entry(*entry);
+      REQUIRE(info.index == item.index);
+      REQUIRE(info.name == item.name);
+      REQUIRE(info.keyValue == item.keyValue);
+      REQUIRE(info.envPeriod == item.envPeriod);
+      REQUIRE(info.reportingFrequency == item.reportingFrequency);
+      REQUIRE(info.units == item.units);
+      REQUIRE(info.table == item.table);
+      REQUIRE(cache->values(*entry).size() == cache->seconds(*entry).size());
+      grids.insert(cache->grid(*entry));
+    }
+    REQUIRE(!cache->find(9999, 3));
+    // every variable is hourly over the one period, so they all share one seconds column
+    REQUIRE(grids.size() == 1);
+    REQUIRE(*grids.begin() != resultsviewer::ColumnarCache::noGrid);
+  }
+
+  SECTION("Reads from the cache")
+  {
+    resultsviewer::SqlFile sf(path, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    resultsviewer::SqlFile cached(path, resultsviewer::SqlFile::OpenMode::ReadOnly, cache);
+    REQUIRE(cached.connectionOpen());
+    REQUIRE(cached.columnarCache() == cache);
+    REQUIRE(cached.dataDictionary().size() == sf.dataDictionary().size());
+    for (size_t i = 0; i < sf.dataDictionary().size(); ++i) {
+      REQUIRE(cached.dataDictionary()[i].index == sf.dataDictionary()[i].index);
+      REQUIRE(cached.dataDictionary()[i].envPeriodIndex == sf.dataDictionary()[i].envPeriodIndex);
+      REQUIRE(cached.dataDictionary()[i].name == sf.dataDictionary()[i].name);
+    }
+
+    resultsviewer::TimeSeriesColumns direct = sf.timeSeriesColumns(3, { 8, 38 });
+    resultsviewer::TimeSeriesColumns columns = cached.timeSeriesColumns(3, { 8, 38 });
+    REQUIRE(columns.startMonth == direct.startMonth);
+    REQUIRE(columns.startDay == direct.startDay);
+    REQUIRE(columns.seconds == direct.seconds);
+    REQUIRE(columns.values[0] == direct.values[0]);
+    REQUIRE(columns.values[1] == direct.values[1]);
+
+    // the arrays point into the mapping, so reading again does not copy
+    resultsviewer::TimeSeriesColumns again = cached.timeSeriesColumns(3, { 38 });
+    REQUIRE(again.seconds.sameAs(columns.seconds));
+    REQUIRE(again.values[0].sameAs(columns.values[1]));
+    auto ts = cached.timeSeries("CHICAGO IL USA TMY2-94846 WMO#=725300", "Hourly", "InteriorLights:Electricity", "");
+    REQUIRE(ts);
+    REQUIRE(ts->values().sameAs(columns.values[1]));
+
+    // and the mapping outlives the cache and the connection
+    cached.setColumnarCache(nullptr);
+    cache.reset();
+    REQUIRE(again.values[0] == direct.values[1]);
+
+    // an index with no data is a column of NaN on the times of the others, as without the cache
+    cached.setColumnarCache(resultsviewer::ColumnarCache::open(cachePath, path));
+    resultsviewer::TimeSeriesColumns merged = cached.timeSeriesColumns(3, { 9999, 38 });
+    direct = sf.timeSeriesColumns(3, { 9999, 38 });
+    REQUIRE(merged.seconds == direct.seconds);
+    REQUIRE(merged.values[0].size() == 8760);
+    REQUIRE(std::isnan(merged.values[0][0]));
+    REQUIRE(merged.values[1] == direct.values[1]);
+    REQUIRE(cached.timeSeriesColumns(1, { 38 }).seconds.empty());
+  }
+
+  SECTION("Connection pool")
+  {
+    resultsviewer::SqlFilePool pool(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 2);
+    REQUIRE(pool.useColumnarCache(cachePath));
+    REQUIRE(pool.columnarCache());
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    REQUIRE(first->columnarCache() == pool.columnarCache());
+    REQUIRE(second->columnarCache() == pool.columnarCache());
+
+    // a pool given the cache when it is made reads even its first connection's dictionary from it
+    resultsviewer::SqlFilePool reopened(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 2, cachePath);
+    REQUIRE(reopened.columnarCache());
+    REQUIRE(reopened.openConnections() == 1);
+    auto reopenedLease = reopened.acquire();
+    REQUIRE(reopenedLease->columnarCache() == reopened.columnarCache());
+    REQUIRE(reopenedLease->dataDictionary().size() == first->dataDictionary().size());
+
+    resultsviewer::SqlFilePool exclusive("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql",
+      resultsviewer::SqlFile::OpenMode::ReadWrite);
+    REQUIRE(!exclusive.useColumnarCache("exclusive.rvcache"));
+  }
+
+  SECTION("Damaged cache")
+  {
+    {
+      std::ifstream source(cachePath, std::ios::binary);
+      std::string bytes((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+      std::ofstream truncated("truncated.rvcache", std::ios::binary);
+      truncated.write(bytes.data(), bytes.size() / 2);
+    }
+    REQUIRE(!resultsviewer::ColumnarCache::open("truncated.rvcache", path));
+    REQUIRE(!resultsviewer::ColumnarCache::open(path, path));
+  }
+
+  SECTION("Stale cache")
+  {
+    resultsviewer::SqlFile writer(path);
+    REQUIRE(writer.connectionOpen());
+    REQUIRE(!writer.statement("DELETE FROM ReportData WHERE ReportDataDictionaryIndex=8").step());
+    REQUIRE(*writer.execAndReturnFirstInt("SELECT COUNT(*) FROM ReportData WHERE ReportDataDictionaryIndex=8") == 0);
+    REQUIRE(!resultsviewer::ColumnarCache::open(cachePath, path));
+
+    // a pool rebuilds it
+    resultsviewer::SqlFilePool pool(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 2);
+    REQUIRE(pool.useColumnarCache(cachePath));
+    auto lease = pool.acquire();
+    REQUIRE(lease->timeSeriesColumns(3, { 8 }).seconds.empty());
+    REQUIRE(lease->timeSeriesColumns(3, { 38 }).seconds.size() == 8760);
+  }
+}
@@ -0,0 +1,111 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+#include "catch.hpp"
+#include "DictionaryStore.hpp"
+#include <string>
+#include <vector>
+
+TEST_CASE("StringPool interns strings", "[DictionaryStore]")
+{
+  resultsviewer::StringPool pool;
+  REQUIRE(pool.size() == 1);
+  REQUIRE(pool.intern("") == 0);
+  auto zone = pool.intern("Zone Air Temperature");
+  REQUIRE(zone != 0);
+  REQUIRE(pool.intern(std::string("Zone Air ") + "Temperature") == zone);
+  REQUIRE(pool.intern("Site Outdoor Air Drybulb Temperature") != zone);
+  REQUIRE(pool.str(zone) == "Zone Air Temperature");
+  REQUIRE(pool.size() == 3);
+  // earlier strings survive growth
+  for (int i = 0; i < 1000; ++i) {
+    pool.intern(std::to_string(i));
+  }
+  REQUIRE(pool.intern("Zone Air Temperature") == zone);
+  pool.clear();
+  REQUIRE(pool.size() == 1);
+}
+
+TEST_CASE("DictionaryStore holds rows by column", "[DictionaryStore]")
+{
+  using resultsviewer::DictionaryColumn;
+  resultsviewer::DictionaryStore store;
+  REQUIRE(store.addFile("/runs/a/eplusout.sql", "a"));
+  store.addRow("Zone Air Temperature", "CORE_BOTTOM", "Hourly", "RUN PERIOD 1", 3);
+  store.addRow("Zone Air Temperature", "CORE_MID", "Hourly", "RUN PERIOD 1", 3);
+  REQUIRE(store.addFile("/runs/b/eplusout.sql", "b"));
+  REQUIRE_FALSE(store.addFile("/RUNS/B/EPLUSOUT.SQL", "again"));
+  store.addRow("Zone Air Temperature", "CORE_BOTTOM", "Hourly", "RUN PERIOD 1", 3);
+  store.addRow("Illuminance Map", "CORE_BOTTOM", "Hourly", "RUN PERIOD 1", 4, "MAP A");
+
+  REQUIRE(store.size() == 4);
+  REQUIRE(store.fileCount() == 2);
+  // every distinct string is held once
+  REQUIRE(store.strings().size() == 12);
+  REQUIRE(store.id(0, DictionaryColumn::VariableName) == store.id(2, DictionaryColumn::VariableName));
+  REQUIRE(store.text(1, DictionaryColumn::KeyValue) == "CORE_MID");
+  REQUIRE(store.text(2, DictionaryColumn::Alias) == "b");
+  REQUIRE(store.text(2, DictionaryColumn::File) == "/runs/b/eplusout.sql");
+  REQUIRE(store.dataType(3) == 4);
+  REQUIRE(store.dbIdentifier(3) == "MAP A");
+  REQUIRE(store.dbIdentifier(0).empty());
+  REQUIRE(store.firstRow("/runs/b/eplusout.sql") == 2);
+  REQUIRE(store.firstRow("/runs/c/eplusout.sql") == resultsviewer::DictionaryStore::npos);
+
+  REQUIRE(store.setAlias("/runs/a/eplusout.sql", "baseline"));
+  REQUIRE(store.text(0, DictionaryColumn::Alias) == "baseline");
+  REQUIRE(store.text(1, DictionaryColumn::Alias) == "baseline");
+  REQUIRE_FALSE(store.setAlias("/runs/c/eplusout.sql", "c"));
+
+  std::vector<size_t> rows = { 0, 1, 2, 3 };
+  store.sortRows(rows, DictionaryColumn::KeyValue, true);
+  REQUIRE(rows == std::vector<size_t>({ 0, 2, 3, 1 }));
+  store.sortRows(rows, DictionaryColumn::VariableName, false);
+  REQUIRE(rows == std::vector<size_t>({ 0, 2, 1, 3 }));
+  store.sortRows(rows, DictionaryColumn::Alias, true);
+  REQUIRE(rows == std::vector<size_t>({ 2, 3, 0, 1 }));
+
+  // filters match any column but File
+  REQUIRE(store.matchRows("*mid*") == std::vector<size_t>({ 1 }));
+  REQUIRE(store.matchRows("B") == std::vector<size_t>({ 2, 3 }));
+  REQUIRE(store.matchRows("*map*") == std::vector<size_t>({ 3 }));
+  REQUIRE(store.matchRows("*runs*").empty());
+  REQUIRE(store.matchRows("*").size() == 4);
+  // typing more of a substring narrows the previous match
+  REQUIRE(store.matchRows("*core*") == std::vector<size_t>({ 0, 1, 2, 3 }));
+  REQUIRE(store.matchRows("*core_b*") == std::vector<size_t>({ 0, 2, 3 }));
+  REQUIRE(store.matchRows("*core_bo*") == std::vector<size_t>({ 0, 2, 3 }));
+  REQUIRE(store.matchRows("*core_m*") == std::vector<size_t>({ 1 }));
+
+  REQUIRE(store.removeFile("/RUNS/A/EPLUSOUT.SQL") == 2);
+  REQUIRE(store.size() == 2);
+  REQUIRE(store.fileCount() == 1);
+  REQUIRE(store.text(0, DictionaryColumn::File) == "/runs/b/eplusout.sql");
+  REQUIRE(store.text(1, DictionaryColumn::VariableName) == "Illuminance Map");
+  REQUIRE(store.firstRow("/runs/b/eplusout.sql") == 0);
+  REQUIRE(store.removeFile("/runs/a/eplusout.sql") == 0);
+
+  REQUIRE(store.removeFile("/runs/b/eplusout.sql") == 2);
+  REQUIRE(store.size() == 0);
+  REQUIRE(store.strings().size() == 1);
+}
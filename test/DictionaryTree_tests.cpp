@@ -0,0 +1,155 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+#include "catch.hpp"
+#include "DictionaryTree.hpp"
+#include <string>
+#include <vector>
+
+using resultsviewer::DataDictionaryItem;
+using resultsviewer::DictionaryTree;
+
+static std::vector<std::string> childNames(const DictionaryTree &tree, size_t index)
+{
+  std::vector<std::string> names;
+  for (size_t child : tree.node(index).children) {
+    names.push_back(tree.node(child).name);
+  }
+  return names;
+}
+
+TEST_CASE("DictionaryTree groups the dictionary by level", "[DictionaryTree]")
+{
+  std::vector<DataDictionaryItem> dictionary = {
+    DataDictionaryItem(1, 3, "Zone Air Temperature", "CORE_MID", "RUN PERIOD 1", "Hourly", "C", "ReportData"),
+    DataDictionaryItem(2, 3, "Zone Air Temperature", "CORE_BOTTOM", "RUN PERIOD 1", "Hourly", "C", "ReportData"),
+    DataDictionaryItem(3, 3, "Electricity:Facility", "", "RUN PERIOD 1", "Run Period", "J", "ReportData"),
+    DataDictionaryItem(4, 3, "Zone Lights Energy", "CORE_MID", "RUN PERIOD 1", "Run Period", "J", "ReportData"),
+    DataDictionaryItem(5, 3, "Site Outdoor Air Drybulb Temperature", "Environment", "RUN PERIOD 1", "Zone Timestep", "C", "ReportData"),
+    DataDictionaryItem(6, 1, "Zone Air Temperature", "CORE_MID", "WINTER DESIGN DAY", "Hourly", "C", "ReportData"),
+  };
+  std::vector<resultsviewer::IlluminanceMapInfo> maps = {
+    { "MAP A", "Winter Design Day", "CORE_MID" },
+    { "MAP B", "SUMMER DESIGN DAY", "CORE_TOP" },
+  };
+  DictionaryTree tree("eplusout.sql", dictionary, maps);
+
+  REQUIRE(tree.node(0).level == DictionaryTree::Level::File);
+  REQUIRE(tree.node(0).name == "eplusout.sql");
+  // environment periods in index order, a period with only maps last
+  REQUIRE(childNames(tree, 0) == std::vector<std::string>({ "WINTER DESIGN DAY", "RUN PERIOD 1", "SUMMER DESIGN DAY" }));
+
+  size_t winter = tree.node(0).children[0];
+  size_t runPeriod = tree.node(0).children[1];
+  size_t summer = tree.node(0).children[2];
+  REQUIRE(childNames(tree, runPeriod) == std::vector<std::string>({ "Zone Timestep", "Hourly", "Run Period" }));
+
+  size_t hourly = tree.node(runPeriod).children[1];
+  REQUIRE(childNames(tree, hourly) == std::vector<std::string>({ "Zone Air Temperature" }));
+  size_t temperature = tree.node(hourly).children[0];
+  REQUIRE(tree.node(temperature).level == DictionaryTree::Level::VariableName);
+  REQUIRE(childNames(tree, temperature) == std::vector<std::string>({ "CORE_BOTTOM", "CORE_MID" }));
+  REQUIRE(tree.node(tree.node(temperature).children[0]).level == DictionaryTree::Level::KeyValue);
+  REQUIRE(tree.node(tree.node(temperature).children[0]).parent == temperature);
+
+  // run period keys fold into the variable and keep the index of their value
+  size_t runPeriodFrequency = tree.node(runPeriod).children[2];
+  REQUIRE(childNames(tree, runPeriodFrequency) == std::vector<std::string>({ "Electricity:Facility", "CORE_MID Zone Lights Energy" }));
+  const DictionaryTree::Node &lights = tree.node(tree.node(runPeriodFrequency).children[1]);
+  REQUIRE(lights.children.empty());
+  REQUIRE(lights.dictionaryIndex == 4);
+  REQUIRE(lights.envPeriodIndex == 3);
+  REQUIRE(tree.node(temperature).dictionaryIndex == -1);
+
+  // maps join the hourly branch of their period, or make one
+  REQUIRE(childNames(tree, winter) == std::vector<std::string>({ "Hourly" }));
+  size_t winterHourly = tree.node(winter).children[0];
+  REQUIRE(childNames(tree, winterHourly) == std::vector<std::string>({ "Zone Air Temperature", "Illuminance Map" }));
+  const DictionaryTree::Node &map = tree.node(tree.node(winterHourly).children[1]);
+  REQUIRE(map.illuminanceMap);
+  REQUIRE(childNames(tree, tree.node(winterHourly).children[1]) == std::vector<std::string>({ "CORE_MID" }));
+  REQUIRE(tree.node(map.children[0]).mapName == "MAP A");
+  REQUIRE(childNames(tree, summer) == std::vector<std::string>({ "Hourly" }));
+
+  // a match shows its branch and everything below it
+  std::vector<bool> shown = tree.filter("*bottom");
+  REQUIRE(shown[0]);
+  REQUIRE(shown[runPeriod]);
+  REQUIRE(shown[hourly]);
+  REQUIRE(shown[temperature]);
+  REQUIRE(shown[tree.node(temperature).children[0]]);
+  REQUIRE_FALSE(shown[tree.node(temperature).children[1]]);
+  REQUIRE_FALSE(shown[tree.node(runPeriod).children[0]]);
+  REQUIRE_FALSE(shown[runPeriodFrequency]);
+  REQUIRE_FALSE(shown[winter]);
+  REQUIRE_FALSE(shown[summer]);
+
+  shown = tree.filter("zone t*");
+  REQUIRE(shown[runPeriod]);
+  REQUIRE(shown[tree.node(runPeriod).children[0]]);
+  REQUIRE(shown[tree.node(tree.node(runPeriod).children[0]).children[0]]);
+  REQUIRE_FALSE(shown[hourly]);
+
+  shown = tree.filter("*design day*");
+  REQUIRE(shown[winter]);
+  REQUIRE(shown[summer]);
+  REQUIRE(shown[map.children[0]]);
+  REQUIRE_FALSE(shown[runPeriod]);
+}
+
+TEST_CASE("DictionaryTree matches map periods whatever their case", "[DictionaryTree]")
+{
+  std::vector<DataDictionaryItem> dictionary = {
+    DataDictionaryItem(1, 3, "Zone Air Temperature", "CORE_MID", "Run Period 1", "Hourly", "C", "ReportData"),
+  };
+  std::vector<resultsviewer::IlluminanceMapInfo> maps = {
+    { "MAP A", "RUN PERIOD 1", "CORE_MID" },
+  };
+  DictionaryTree tree("eplusout.sql", dictionary, maps);
+
+  // one period, named as the dictionary names it
+  REQUIRE(childNames(tree, 0) == std::vector<std::string>({ "Run Period 1" }));
+  size_t runPeriod = tree.node(0).children[0];
+  REQUIRE(childNames(tree, runPeriod) == std::vector<std::string>({ "Hourly" }));
+  REQUIRE(childNames(tree, tree.node(runPeriod).children[0]) == std::vector<std::string>({ "Zone Air Temperature", "Illuminance Map" }));
+  REQUIRE(tree.node(0).mapName.empty());
+}
+
+TEST_CASE("DictionaryTree of an output file", "[DictionaryTree]")
+{
+  resultsviewer::SqlFile sf("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+  REQUIRE(sf.connectionOpen());
+  DictionaryTree tree(sf.energyPlusSqliteFile(), sf.dataDictionary(), sf.illuminanceMaps());
+  REQUIRE(tree.node(0).children.size() == 1);
+  size_t env = tree.node(0).children[0];
+  REQUIRE(childNames(tree, env) == std::vector<std::string>({ "Hourly" }));
+  size_t leaves = 0;
+  for (size_t i = 0; i < tree.size(); ++i) {
+    if (tree.node(i).level == DictionaryTree::Level::KeyValue) ++leaves;
+  }
+  size_t keyed = 0;
+  for (const auto &item : sf.dataDictionary()) {
+    if (!item.keyValue.empty()) ++keyed;
+  }
+  REQUIRE(leaves == keyed);
+}
@@ -0,0 +1,212 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "FileOpener.hpp"
+#include <condition_variable>
+#include <future>
+#include <fstream>
+#include <cstdio>
+
+namespace {
+  const std::string refFile("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+
+  // Take from opener each time it notifies until every file has finished
+  std::vector<resultsviewer::FileOpener::Result> takeAll(resultsviewer::FileOpener &opener, std::mutex &mutex,
+    std::condition_variable &notified, size_t &notifications)
+  {
+    std::vector<resultsviewer::FileOpener::Result> results;
+    size_t taken = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        notified.wait(lock, [&] { return notifications > taken; });
+        taken = notifications;
+      }
+      bool done = opener.done();
+      for (auto &result : opener.take()) {
+        results.push_back(result);
+      }
+      if (done) {
+        return results;
+      }
+    }
+  }
+}
+
+TEST_CASE("Open files on a pool", "[FileOpener]")
+{
+  std::remove("FileOpener_tests.sql");
+  std::remove("FileOpener_tests_copy.htm");
+  {
+    std::ofstream html("FileOpener_tests.htm");
+    html << "<html></html>";
+  }
+  resultsviewer::ThreadPool pool(3);
+  std::vector<resultsviewer::FileOpener::Request> requests(3);
+  requests[0].path = refFile;
+  requests[0].report = "does_not_exist.htm";
+  requests[1].path = "does_not_exist.sql";
+  requests[2].path = "FileOpener_tests.sql";
+  requests[2].mode = resultsviewer::SqlFile::OpenMode::Immutable;
+  requests[2].snapshotOf = refFile;
+  requests[2].copies.emplace_back("FileOpener_tests.htm", "FileOpener_tests_copy.htm");
+  requests[2].report = "FileOpener_tests_copy.htm";
+
+  std::mutex mutex;
+  std::condition_variable notified;
+  size_t notifications = 0;
+  resultsviewer::FileOpener opener(pool, requests, [&]() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++notifications;
+    notified.notify_all();
+  });
+  REQUIRE(opener.size() == 3);
+
+  std::vector<resultsviewer::FileOpener::Result> results = takeAll(opener, mutex, notified, notifications);
+  REQUIRE(results.size() == 3);
+  std::sort(results.begin(), results.end(), [](const resultsviewer::FileOpener::Result &a,
+    const resultsviewer::FileOpener::Result &b) { return a.index < b.index; });
+  REQUIRE(opener.finished() == 3);
+  std::vector<resultsviewer::FileOpener::Status> statuses{ resultsviewer::FileOpener::Status::Opened,
+    resultsviewer::FileOpener::Status::Failed, resultsviewer::FileOpener::Status::Opened };
+  REQUIRE(opener.statuses() == statuses);
+
+  for (size_t i : { 0, 2 }) {
+    REQUIRE(results[i].status == resultsviewer::FileOpener::Status::Opened);
+    REQUIRE(results[i].connections);
+    REQUIRE(results[i].connections->connectionOpen());
+    REQUIRE(results[i].connections->path() == requests[i].path);
+    REQUIRE(results[i].tree);
+    REQUIRE(results[i].tree->node(0).level == resultsviewer::DictionaryTree::Level::File);
+    REQUIRE(!results[i].tree->node(0).children.empty());
+  }
+  REQUIRE(results[2].connections->openMode() == resultsviewer::SqlFile::OpenMode::Immutable);
+  REQUIRE(results[0].snapshot == resultsviewer::Snapshot::Method::None);
+  REQUIRE(results[2].snapshot != resultsviewer::Snapshot::Method::None);
+  REQUIRE(std::filesystem::exists("FileOpener_tests_copy.htm"));
+  // the report is read from the copy, once it is made
+  REQUIRE(!results[0].report);
+  REQUIRE(results[2].report == std::string("<html></html>"));
+  REQUIRE(results[1].status == resultsviewer::FileOpener::Status::Failed);
+  REQUIRE(!results[1].connections);
+  REQUIRE(!results[1].tree);
+
+  // the snapshot has the same dictionary as the original
+  REQUIRE(results[0].tree->size() == results[2].tree->size());
+
+  // nothing is left to take
+  REQUIRE(opener.take().empty());
+}
+
+TEST_CASE("Canceled opens deliver nothing", "[FileOpener]")
+{
+  resultsviewer::ThreadPool pool(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  pool.submit([released]() { released.wait(); });
+
+  std::vector<resultsviewer::FileOpener::Request> requests(2);
+  requests[0].path = refFile;
+  requests[1].path = refFile;
+  std::atomic<int> notifications(0);
+  resultsviewer::FileOpener opener(pool, requests, [&]() { ++notifications; });
+  std::vector<resultsviewer::FileOpener::Status> queued(2, resultsviewer::FileOpener::Status::Queued);
+  REQUIRE(opener.statuses() == queued);
+  REQUIRE(!opener.done());
+
+  opener.cancel();
+  REQUIRE(opener.isCanceled());
+  REQUIRE(opener.done());
+  std::vector<resultsviewer::FileOpener::Status> canceled(2, resultsviewer::FileOpener::Status::Canceled);
+  REQUIRE(opener.statuses() == canceled);
+  REQUIRE(notifications == 1);
+  release.set_value();
+
+  // the queued tasks run and find nothing to do
+  pool.submit([]() {}).wait();
+  REQUIRE(opener.take().empty());
+  REQUIRE(notifications == 1);
+}
+
+TEST_CASE("A file finishing after a take is taken next time", "[FileOpener]")
+{
+  resultsviewer::ThreadPool pool(1);
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  pool.submit([released]() { released.wait(); });
+
+  std::vector<resultsviewer::FileOpener::Request> requests(1);
+  requests[0].path = refFile;
+  std::promise<void> finish;
+  resultsviewer::FileOpener opener(pool, requests, [&]() { finish.set_value(); });
+
+  // done, read before the take, does not hold yet, so whoever takes keeps waiting for results
+  bool done = opener.done();
+  REQUIRE(opener.take().empty());
+  REQUIRE(!done);
+
+  // the file finishes between that take and a later look at done
+  release.set_value();
+  finish.get_future().wait();
+  REQUIRE(opener.done());
+  std::vector<resultsviewer::FileOpener::Result> results = opener.take();
+  REQUIRE(results.size() == 1);
+  REQUIRE(results[0].status == resultsviewer::FileOpener::Status::Opened);
+}
+
+TEST_CASE("Columnar caches are built after the file is handed over", "[FileOpener]")
+{
+  std::remove("FileOpener_cache_tests.sql");
+  std::remove(resultsviewer::ColumnarCache::pathFor("FileOpener_cache_tests.sql").c_str());
+  resultsviewer::Snapshot::copyFile(refFile, "FileOpener_cache_tests.sql");
+  resultsviewer::ThreadPool pool(1);
+  std::vector<resultsviewer::FileOpener::Request> requests(1);
+  requests[0].path = "FileOpener_cache_tests.sql";
+  requests[0].columnarCache = true;
+
+  std::vector<resultsviewer::FileOpener::Result> first;
+  {
+    std::promise<void> finish;
+    resultsviewer::FileOpener opener(pool, requests, [&]() { finish.set_value(); });
+    finish.get_future().wait();
+    first = opener.take();
+  }
+  REQUIRE(first.size() == 1);
+  REQUIRE(first[0].status == resultsviewer::FileOpener::Status::Opened);
+  // the build is queued by the open task after the file is out, so it runs after the first of these and before the
+  // second, and then serves the file's connections
+  pool.submit([]() {}).wait();
+  pool.submit([]() {}).wait();
+  REQUIRE(first[0].connections->columnarCache());
+
+  // opened again, the file reads its dictionary from the cache straight away
+  std::promise<void> finish;
+  resultsviewer::FileOpener opener(pool, requests, [&]() { finish.set_value(); });
+  finish.get_future().wait();
+  std::vector<resultsviewer::FileOpener::Result> second = opener.take();
+  REQUIRE(second.size() == 1);
+  REQUIRE(second[0].connections->columnarCache());
+  REQUIRE(second[0].tree->size() == first[0].tree->size());
+}
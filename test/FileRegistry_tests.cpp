@@ -0,0 +1,115 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+#include "catch.hpp"
+#include "FileRegistry.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+TEST_CASE("FileRegistry indexes files by path and alias", "[FileRegistry]")
+{
+  std::filesystem::create_directories("registry/runs");
+  std::ofstream("registry/runs/eplusout.sql") << "x";
+
+  resultsviewer::FileRegistry<int> registry;
+  auto handle = std::make_shared<int>(42);
+  REQUIRE(registry.add("registry/runs/eplusout.sql", "Baseline", handle));
+  REQUIRE(registry.size() == 1);
+
+  // the same file through another spelling of its path
+  REQUIRE(registry.contains("registry/runs/../runs/./eplusout.sql"));
+  REQUIRE(registry.contains((std::filesystem::current_path() / "registry/runs/eplusout.sql").string()));
+  REQUIRE(registry.contains("REGISTRY/RUNS/EPLUSOUT.SQL"));
+  REQUIRE_FALSE(registry.add("registry/runs/../runs/eplusout.sql", "Again", handle));
+  REQUIRE(registry.handle("registry/runs/eplusout.sql") == handle);
+  REQUIRE_FALSE(registry.contains("registry/runs/other.sql"));
+  REQUIRE_FALSE(registry.handle("registry/runs/other.sql"));
+
+  REQUIRE(*registry.alias("registry/runs/eplusout.sql") == "Baseline");
+  REQUIRE_FALSE(registry.alias("registry/runs/other.sql"));
+  REQUIRE(registry.aliasExists("baseline"));
+  REQUIRE(registry.aliasExists("BASELINE"));
+  REQUIRE_FALSE(registry.aliasExists("Again"));
+
+  // aliases are counted, so one file giving up a shared alias leaves it for the other
+  REQUIRE(registry.add("registry/runs/other.sql", "baseline", std::make_shared<int>(7)));
+  REQUIRE(registry.setAlias("registry/runs/eplusout.sql", "Proposed"));
+  REQUIRE(registry.aliasExists("Baseline"));
+  REQUIRE(registry.aliasExists("proposed"));
+  REQUIRE(registry.remove("registry/runs/other.sql"));
+  REQUIRE_FALSE(registry.aliasExists("Baseline"));
+  REQUIRE_FALSE(registry.remove("registry/runs/other.sql"));
+  REQUIRE_FALSE(registry.setAlias("registry/runs/other.sql", "Baseline"));
+
+  registry.clear();
+  REQUIRE(registry.size() == 0);
+  REQUIRE_FALSE(registry.aliasExists("Proposed"));
+
+  std::filesystem::remove_all("registry");
+}
+
+TEST_CASE("FileRegistry matches added paths without resolving them again", "[FileRegistry]")
+{
+  std::filesystem::create_directories("registry/runs");
+  std::ofstream("registry/runs/eplusout.sql") << "x";
+  std::filesystem::path target = std::filesystem::absolute("registry/runs/eplusout.sql");
+  std::filesystem::path link = std::filesystem::absolute("registry/latest.sql");
+  std::error_code ec;
+  std::filesystem::create_symlink(target, link, ec);
+  if (!ec) {
+    resultsviewer::FileRegistry<int> registry;
+    REQUIRE(registry.add(link.string(), "Latest", std::make_shared<int>(1)));
+    REQUIRE(registry.contains(target.string()));
+    // the link no longer resolves to the file, but the spelling it was added with still finds it
+    std::filesystem::remove(link);
+    REQUIRE(registry.contains(link.string()));
+    REQUIRE(registry.contains((link.parent_path() / "runs" / ".." / "latest.sql").string()));
+    REQUIRE(registry.remove(link.string()));
+    REQUIRE_FALSE(registry.contains(link.string()));
+    REQUIRE(registry.size() == 0);
+  }
+  std::filesystem::remove_all("registry");
+}
+
+TEST_CASE("FileRegistry folds aliases with the fold it is given", "[FileRegistry]")
+{
+  // an ASCII only fold leaves other letters as they are
+  resultsviewer::FileRegistry<int> ascii;
+  REQUIRE(ascii.add("registry/runs/eplusout.sql", "\xC3\x89t\xC3\xA9", std::make_shared<int>(1)));
+  REQUIRE(ascii.aliasExists("\xC3\x89T\xC3\xA9"));
+  REQUIRE_FALSE(ascii.aliasExists("\xC3\xA9t\xC3\xA9"));
+
+  // a fold that knows more letters finds them
+  resultsviewer::FileRegistry<int> folded([](const std::string &alias) {
+    std::string key = resultsviewer::FileRegistry<int>::foldCase(alias);
+    for (size_t i = 0; i + 1 < key.size(); ++i) {
+      if (key[i] == '\xC3' && key[i + 1] == '\x89') key[i + 1] = '\xA9'; // E acute to e acute
+    }
+    return key;
+  });
+  REQUIRE(folded.add("registry/runs/eplusout.sql", "\xC3\x89t\xC3\xA9", std::make_shared<int>(1)));
+  REQUIRE(folded.aliasExists("\xC3\xA9T\xC3\xA9"));
+  REQUIRE(folded.setAlias("registry/runs/eplusout.sql", "Other"));
+  REQUIRE_FALSE(folded.aliasExists("\xC3\xA9t\xC3\xA9"));
+}
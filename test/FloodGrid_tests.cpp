@@ -0,0 +1,164 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "FloodGrid.hpp"
+#include <vector>
+#include <cmath>
+
+TEST_CASE("Hourly FloodGrid", "[FloodGrid]")
+{
+  // two days of hourly reports starting January 2, each stamped at the end of its hour
+  std::vector<double> values(48);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<double>(i);
+  }
+  resultsviewer::TimeSeries ts(QDateTime(QDate(2009, 1, 2), QTime(0, 0)), 3600, values, "J");
+  resultsviewer::FloodGrid grid(ts);
+
+  REQUIRE(grid.intervalsPerDay() == 24);
+  REQUIRE(grid.days() == 2);
+  REQUIRE(grid.firstDay() == 2);
+  for (size_t day = 0; day < 2; ++day) {
+    for (size_t hour = 0; hour < 24; ++hour) {
+      REQUIRE(grid.at(day, hour) == values[24 * day + hour]);
+      REQUIRE(grid.row(hour)[day] == values[24 * day + hour]);
+      REQUIRE(grid.value(2.0 + day + 0.5, hour + 0.5) == values[24 * day + hour]);
+    }
+  }
+  // the end of the day belongs to the last hour
+  REQUIRE(grid.value(2.25, 24.0) == 23.0);
+  // outside the grid
+  REQUIRE(std::isnan(grid.value(1.5, 12.0)));
+  REQUIRE(std::isnan(grid.value(4.0, 12.0)));
+  REQUIRE(std::isnan(grid.value(2.5, -1.0)));
+}
+
+TEST_CASE("FloodGrid with gaps and long intervals", "[FloodGrid]")
+{
+  SECTION("Missing reports are NaN")
+  {
+    std::vector<long long> seconds = { 900, 1800, 3600 };
+    std::vector<double> values = { 1.0, 2.0, 4.0 };
+    resultsviewer::TimeSeries ts(QDateTime(QDate(2009, 3, 1), QTime(0, 0)), seconds, values, "", 900);
+    resultsviewer::FloodGrid grid(ts);
+    REQUIRE(grid.intervalsPerDay() == 96);
+    REQUIRE(grid.days() == 1);
+    REQUIRE(grid.firstDay() == 60);
+    REQUIRE(grid.at(0, 0) == 1.0);
+    REQUIRE(grid.at(0, 1) == 2.0);
+    REQUIRE(std::isnan(grid.at(0, 2)));
+    REQUIRE(grid.at(0, 3) == 4.0);
+    REQUIRE(std::isnan(grid.at(0, 4)));
+  }
+
+  SECTION("Daily reports fill the whole day and variable intervals fill the days between reports")
+  {
+    std::vector<long long> seconds = { 86400, 3 * 86400 };
+    std::vector<double> values = { 5.0, 7.0 };
+    resultsviewer::TimeSeries ts(QDateTime(QDate(2009, 1, 1), QTime(0, 0)), seconds, values);
+    resultsviewer::FloodGrid grid(ts);
+    REQUIRE(grid.intervalsPerDay() == 1);
+    REQUIRE(grid.days() == 3);
+    REQUIRE(grid.value(1.5, 0.0) == 5.0);
+    REQUIRE(grid.value(2.5, 12.0) == 7.0);
+    REQUIRE(grid.value(3.5, 23.0) == 7.0);
+  }
+
+  SECTION("Empty series")
+  {
+    resultsviewer::TimeSeries ts(QDateTime(QDate(2009, 1, 1), QTime(0, 0)), 3600, std::vector<double>());
+    resultsviewer::FloodGrid grid(ts);
+    REQUIRE(grid.empty());
+    REQUIRE(std::isnan(grid.value(1.0, 1.0)));
+  }
+}
+
+static bool sameCells(const resultsviewer::FloodGrid &a, const resultsviewer::FloodGrid &b)
+{
+  if (a.days() != b.days() || a.intervalsPerDay() != b.intervalsPerDay() || a.firstDay() != b.firstDay()) {
+    return false;
+  }
+  for (size_t day = 0; day < a.days(); ++day) {
+    for (size_t interval = 0; interval < a.intervalsPerDay(); ++interval) {
+      float x = a.at(day, interval);
+      float y = b.at(day, interval);
+      if (!(x == y || (std::isnan(x) && std::isnan(y)))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST_CASE("FloodGrid append", "[FloodGrid]")
+{
+  SECTION("Appended reports fill the same cells as rasterizing the whole series")
+  {
+    // ten days of 15 minute reports starting mid morning, arriving in uneven batches
+    std::vector<long long> seconds;
+    std::vector<double> values;
+    for (int i = 1; i <= 960; ++i) {
+      seconds.push_back(900 * i);
+      values.push_back(static_cast<double>(i % 37));
+    }
+    QDateTime start(QDate(2009, 6, 1), QTime(10, 0));
+    resultsviewer::TimeSeries ts(start, std::vector<long long>(seconds.begin(), seconds.begin() + 5),
+      std::vector<double>(values.begin(), values.begin() + 5), "", 900);
+    resultsviewer::FloodGrid grid(ts);
+    size_t from = 5;
+    for (size_t batch : { 1, 20, 100, 3, 250, 581 }) {
+      ts = ts.appended(seconds.data() + from, values.data() + from, batch);
+      unsigned generation = grid.generation();
+      resultsviewer::FloodGrid before(grid);
+      grid.append(ts, from);
+      REQUIRE(grid.generation() == generation + 1);
+      REQUIRE(sameCells(grid, resultsviewer::FloodGrid(ts)));
+      // only the last column of the grid before the append and the columns after it changed
+      for (size_t day = 0; day + 1 < before.days(); ++day) {
+        for (size_t interval = 0; interval < grid.intervalsPerDay(); ++interval) {
+          float x = before.at(day, interval);
+          REQUIRE((x == grid.at(day, interval) || (std::isnan(x) && std::isnan(grid.at(day, interval)))));
+        }
+      }
+      from += batch;
+    }
+    REQUIRE(grid.days() == 11);
+  }
+
+  SECTION("Reports closer than the cells rasterize the grid again")
+  {
+    std::vector<long long> seconds = { 3600, 7200, 8100, 9000 };
+    std::vector<double> values = { 1.0, 2.0, 3.0, 4.0 };
+    resultsviewer::TimeSeries ts(QDateTime(QDate(2009, 1, 1), QTime(0, 0)), std::vector<long long>(seconds.begin(),
+      seconds.begin() + 2), std::vector<double>(values.begin(), values.begin() + 2));
+    resultsviewer::FloodGrid grid(ts);
+    REQUIRE(grid.intervalsPerDay() == 24);
+    ts = ts.appended(seconds.data() + 2, values.data() + 2, 2);
+    grid.append(ts, 2);
+    REQUIRE(grid.intervalsPerDay() == 96);
+    REQUIRE(grid.generation() == 1);
+    REQUIRE(sameCells(grid, resultsviewer::FloodGrid(ts)));
+  }
+}
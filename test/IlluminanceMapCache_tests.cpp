@@ -0,0 +1,81 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "IlluminanceMapCache.hpp"
+#include <vector>
+#include <atomic>
+
+TEST_CASE("Prefetch order", "[IlluminanceMapCache]")
+{
+  typedef std::vector<size_t> Order;
+  REQUIRE(resultsviewer::IlluminanceMapCache::prefetchOrder(5, 100, 3, 2, 100) == Order({ 6, 4, 7, 3, 8 }));
+  REQUIRE(resultsviewer::IlluminanceMapCache::prefetchOrder(0, 100, 2, 2, 100) == Order({ 1, 2 }));
+  REQUIRE(resultsviewer::IlluminanceMapCache::prefetchOrder(9, 10, 2, 2, 100) == Order({ 8, 7 }));
+  REQUIRE(resultsviewer::IlluminanceMapCache::prefetchOrder(5, 100, 3, 2, 3) == Order({ 6, 4, 7 }));
+  REQUIRE(resultsviewer::IlluminanceMapCache::prefetchOrder(5, 100, 3, 2, 0).empty());
+}
+
+TEST_CASE("Illuminance frames are cached and read ahead", "[IlluminanceMapCache]")
+{
+  const size_t points = 100;
+  std::atomic<int> reads(0);
+  auto reader = [&reads](size_t frame) {
+    ++reads;
+    return std::vector<double>(points, static_cast<double>(frame));
+  };
+  const size_t frameBytes = sizeof(std::vector<double>) + points * sizeof(double);
+
+  SECTION("Read ahead and behind")
+  {
+    resultsviewer::IlluminanceMapCache cache(50, reader, 100 * frameBytes, 4, 2);
+    auto frame = cache.frame(10);
+    REQUIRE(frame->size() == points);
+    REQUIRE(frame->front() == 10.0);
+    cache.waitForPrefetch();
+    for (size_t index : { 8, 9, 10, 11, 12, 13, 14 }) {
+      REQUIRE(cache.isCached(index));
+    }
+    REQUIRE_FALSE(cache.isCached(7));
+    REQUIRE_FALSE(cache.isCached(15));
+    REQUIRE(reads == 7);
+
+    // cached frames are not read again
+    REQUIRE(cache.frame(12)->front() == 12.0);
+    cache.waitForPrefetch();
+    REQUIRE(reads == 9); // 15 and 16
+  }
+
+  SECTION("The byte budget bounds the cache")
+  {
+    resultsviewer::IlluminanceMapCache cache(1000, reader, 5 * frameBytes, 24, 8);
+    for (size_t index = 0; index < 200; index += 3) {
+      REQUIRE(cache.frame(index)->front() == static_cast<double>(index));
+      REQUIRE(cache.cachedBytes() <= 5 * frameBytes);
+    }
+    cache.waitForPrefetch();
+    REQUIRE(cache.cachedBytes() <= 5 * frameBytes);
+    REQUIRE(cache.isCached(198));
+  }
+}
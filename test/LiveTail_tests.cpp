@@ -0,0 +1,137 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+#include "catch.hpp"
+#include "LiveTail.hpp"
+#include <sqlite3/sqlite3.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const std::string liveTailSource("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+static const std::string liveTailPath("LiveTail_tests.sql");
+
+static bool liveTailExec(sqlite3 *db, const std::string &sql)
+{
+  return sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+TEST_CASE("LiveTail appends the rows a simulation writes", "[LiveTail]")
+{
+  const std::string envPeriod("CHICAGO IL USA TMY2-94846 WMO#=725300");
+  const std::vector<std::string> names{ "Electricity:Facility", "Gas:Facility", "Fans:Electricity" };
+
+  std::vector<resultsviewer::TimeSeries> expected;
+  {
+    resultsviewer::SqlFile reference(liveTailSource, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    for (const auto &name : names) {
+      expected.push_back(*reference.timeSeries(envPeriod, "Hourly", name, ""));
+    }
+  }
+
+  // a copy of the file as it was part way through the run, with the rest of the rows held back
+  std::filesystem::copy_file(liveTailSource, liveTailPath, std::filesystem::copy_options::overwrite_existing);
+  sqlite3 *writer = nullptr;
+  REQUIRE(sqlite3_open(liveTailPath.c_str(), &writer) == SQLITE_OK);
+  REQUIRE(liveTailExec(writer, "CREATE TABLE HeldTime AS SELECT * FROM Time WHERE TimeIndex>1000;"
+    "CREATE TABLE HeldData AS SELECT * FROM ReportData WHERE TimeIndex>1000;"
+    "DELETE FROM ReportData WHERE TimeIndex>1000; DELETE FROM Time WHERE TimeIndex>1000;"));
+
+  std::vector<resultsviewer::TimeSeries> partial;
+  {
+    resultsviewer::SqlFile file(liveTailPath, resultsviewer::SqlFile::OpenMode::ReadOnly);
+    for (const auto &name : names) {
+      partial.push_back(*file.timeSeries(envPeriod, "Hourly", name, ""));
+      REQUIRE(partial.back().values().size() == 1000);
+    }
+  }
+
+  resultsviewer::LiveTail tail(liveTailPath);
+  REQUIRE(tail.isValid());
+  for (size_t i = 0; i < names.size(); ++i) {
+    REQUIRE(tail.follow(i, { liveTailPath, envPeriod, "Hourly", names[i], "" }, partial[i]));
+  }
+  REQUIRE(!tail.follow(99, { liveTailPath, envPeriod, "Hourly", "No Such Variable", "" }, partial[0]));
+  REQUIRE(tail.size() == names.size());
+
+  // nothing new yet
+  REQUIRE(tail.poll().empty());
+  REQUIRE(tail.poll().empty());
+
+  // the simulation writes the rest of the year in uneven steps, some of them in the middle of a time step
+  std::vector<resultsviewer::TimeSeries> followed(partial);
+  std::vector<int> steps{ 1001, 1002, 1500, 4000, 8760 };
+  for (int last : steps) {
+    std::string bound = std::to_string(last);
+    REQUIRE(liveTailExec(writer, "BEGIN; INSERT INTO Time SELECT * FROM HeldTime WHERE TimeIndex<=" + bound + ";"
+      "INSERT INTO ReportData SELECT * FROM HeldData WHERE TimeIndex<=" + bound + ";"
+      "DELETE FROM HeldTime WHERE TimeIndex<=" + bound + "; DELETE FROM HeldData WHERE TimeIndex<=" + bound + "; COMMIT;"));
+    std::vector<resultsviewer::LiveTail::Update> updates = tail.poll();
+    REQUIRE(updates.size() == names.size());
+    for (const auto &update : updates) {
+      REQUIRE(update.id < names.size());
+      REQUIRE(update.from == followed[update.id].values().size());
+      REQUIRE(update.series.values().size() == static_cast<size_t>(last));
+      followed[update.id] = update.series;
+    }
+    REQUIRE(tail.poll().empty());
+  }
+  sqlite3_close(writer);
+
+  for (size_t i = 0; i < names.size(); ++i) {
+    REQUIRE(followed[i].seconds() == expected[i].seconds());
+    REQUIRE(followed[i].values() == expected[i].values());
+    REQUIRE(followed[i].startDateTime() == expected[i].startDateTime());
+    REQUIRE(followed[i].sum() == Approx(expected[i].sum()));
+  }
+
+  tail.unfollow(1);
+  REQUIRE(tail.size() == names.size() - 1);
+}
+
+TEST_CASE("SqlFile tail positions", "[LiveTail]")
+{
+  resultsviewer::SqlFile file(liveTailSource, resultsviewer::SqlFile::OpenMode::ReadOnly);
+  REQUIRE(file.dataVersion() >= 0);
+  REQUIRE(!file.tailPosition(12345));
+
+  // from the start of the period, everything is new
+  std::optional<resultsviewer::TailPosition> start = file.tailPosition(3);
+  REQUIRE(start);
+  REQUIRE(start->lastTimeIndex == 0);
+  REQUIRE(start->lastReportDataIndex == 0);
+  resultsviewer::TimeSeriesColumns all = file.timeSeriesColumnsAfter(*start, { 8, 600 });
+  REQUIRE(all.seconds.size() == 8760);
+  REQUIRE(all.values[0] == file.timeSeriesColumns(3, { 8 }).values[0]);
+  REQUIRE(start->lastTimeIndex == 8760);
+  REQUIRE(file.timeSeriesColumnsAfter(*start, { 8, 600 }).seconds.empty());
+
+  // after the report at the end of the first day
+  std::optional<resultsviewer::TailPosition> day = file.tailPosition(3, 86400);
+  REQUIRE(day);
+  REQUIRE(day->lastTimeIndex == 24);
+  REQUIRE(day->lastReportDataIndex == 24 * 11);
+  resultsviewer::TimeSeriesColumns rest = file.timeSeriesColumnsAfter(*day, { 8 });
+  REQUIRE(rest.seconds.size() == 8760 - 24);
+  REQUIRE(rest.seconds.front() == 86400 + 3600);
+}
@@ -0,0 +1,77 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "LruCache.hpp"
+#include <string>
+
+TEST_CASE("LruCache evicts the least recently used", "[LruCache]")
+{
+  resultsviewer::LruCache<int, std::string> cache(30);
+  cache.put(1, "one", 10);
+  cache.put(2, "two", 10);
+  cache.put(3, "three", 10);
+  REQUIRE(cache.size() == 3);
+  REQUIRE(cache.bytes() == 30);
+
+  // using 1 makes 2 the oldest
+  REQUIRE(*cache.get(1) == "one");
+  cache.put(4, "four", 10);
+  REQUIRE(cache.size() == 3);
+  REQUIRE_FALSE(cache.contains(2));
+  REQUIRE(cache.contains(1));
+  REQUIRE(cache.contains(3));
+  REQUIRE(cache.contains(4));
+  REQUIRE_FALSE(cache.get(2));
+
+  // replacing a value updates its size
+  cache.put(3, "THREE", 5);
+  REQUIRE(cache.bytes() == 25);
+  REQUIRE(*cache.get(3) == "THREE");
+
+  // the newest value stays even when it is over the budget alone
+  cache.put(5, "five", 100);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(*cache.get(5) == "five");
+
+  cache.setBudget(1000);
+  cache.put(6, "six", 10);
+  REQUIRE(cache.size() == 2);
+  cache.setBudget(10);
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.contains(6));
+
+  // removing by key leaves the rest
+  cache.put(7, "seven", 1);
+  cache.put(8, "eight", 1);
+  cache.setBudget(1000);
+  cache.removeIf([](int key) { return key % 2 == 0; });
+  REQUIRE(cache.size() == 1);
+  REQUIRE(cache.bytes() == 1);
+  REQUIRE(cache.contains(7));
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.bytes() == 0);
+}
@@ -0,0 +1,117 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "MinMaxPyramid.hpp"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+TEST_CASE("MinMaxPyramid levels", "[MinMaxPyramid]")
+{
+  // a year of one minute data
+  std::mt19937 generator(525600);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> y(525600);
+  for (auto &value : y) {
+    value = distribution(generator);
+  }
+  y[123457] = 10.0;
+  y[400001] = -10.0;
+
+  resultsviewer::MinMaxPyramid pyramid(y.data(), y.size());
+  REQUIRE(pyramid.size() == y.size());
+  REQUIRE(pyramid.levelCount() == 20);
+
+  size_t level = pyramid.levelFor(y.size(), 800);
+  REQUIRE(level == 9);
+  std::vector<size_t> indices = pyramid.indices(level, 0, y.size() - 1);
+  // two points per bucket, about two buckets per pixel at most
+  REQUIRE(indices.size() <= 2 * 4 * 800);
+  REQUIRE(indices.size() >= 2 * 800);
+  REQUIRE(std::is_sorted(indices.begin(), indices.end()));
+  REQUIRE(std::adjacent_find(indices.begin(), indices.end()) == indices.end());
+  REQUIRE(std::find(indices.begin(), indices.end(), 123457) != indices.end());
+  REQUIRE(std::find(indices.begin(), indices.end(), 400001) != indices.end());
+
+  // the envelope of every bucket is exact
+  size_t bucket = size_t(1) << level;
+  for (size_t b = 0; b * bucket < y.size(); ++b) {
+    size_t first = b * bucket;
+    size_t last = std::min(first + bucket, y.size());
+    double trueMin = *std::min_element(y.begin() + first, y.begin() + last);
+    double trueMax = *std::max_element(y.begin() + first, y.begin() + last);
+    double drawnMin = 1e9;
+    double drawnMax = -1e9;
+    for (size_t i : indices) {
+      if (i >= first && i < last) {
+        drawnMin = std::min(drawnMin, y[i]);
+        drawnMax = std::max(drawnMax, y[i]);
+      }
+    }
+    REQUIRE(drawnMin == trueMin);
+    REQUIRE(drawnMax == trueMax);
+  }
+}
+
+TEST_CASE("MinMaxPyramid visible ranges", "[MinMaxPyramid]")
+{
+  std::vector<double> y{ 1, 5, 2, 8, 3, 0, 4, 7, 6 };
+  resultsviewer::MinMaxPyramid pyramid(y.data(), y.size());
+
+  // narrow views draw the raw samples plus a neighbor on each side
+  REQUIRE(pyramid.levelFor(3, 800) == 0);
+  std::vector<size_t> raw = pyramid.indices(0, 2, 4);
+  REQUIRE(raw == std::vector<size_t>({ 1, 2, 3, 4, 5 }));
+
+  std::vector<size_t> level1 = pyramid.indices(1, 0, 8);
+  REQUIRE(level1 == std::vector<size_t>({ 0, 1, 2, 3, 4, 5, 6, 7, 8 }));
+  std::vector<size_t> level2 = pyramid.indices(2, 0, 8);
+  REQUIRE(level2 == std::vector<size_t>({ 0, 3, 5, 7, 8 }));
+
+  resultsviewer::MinMaxPyramid empty(nullptr, 0);
+  REQUIRE(empty.indices(0, 0, 10).empty());
+}
+
+TEST_CASE("MinMaxPyramid append", "[MinMaxPyramid]")
+{
+  std::mt19937 generator(2021);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> y(5000);
+  for (auto &value : y) {
+    value = distribution(generator);
+  }
+  // grow from nothing in uneven steps, checking every level against a pyramid built in one go
+  resultsviewer::MinMaxPyramid pyramid(y.data(), 0);
+  std::uniform_int_distribution<size_t> step(1, 300);
+  for (size_t n = 1; n < y.size(); n = std::min(n + step(generator), y.size())) {
+    pyramid.append(y.data(), n);
+    resultsviewer::MinMaxPyramid built(y.data(), n);
+    REQUIRE(pyramid.size() == n);
+    REQUIRE(pyramid.levelCount() == built.levelCount());
+    for (size_t level = 0; level < built.levelCount(); ++level) {
+      REQUIRE(pyramid.indices(level, 0, n - 1) == built.indices(level, 0, n - 1));
+    }
+  }
+}
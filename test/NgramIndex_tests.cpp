@@ -0,0 +1,97 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+#include "catch.hpp"
+#include "NgramIndex.hpp"
+#include <string>
+#include <vector>
+
+using resultsviewer::NgramIndex;
+
+TEST_CASE("Wildcard matching", "[NgramIndex]")
+{
+  REQUIRE(NgramIndex::wildcardMatch("*zone*", "Zone Air Temperature"));
+  REQUIRE(NgramIndex::wildcardMatch("zone*temperature", "Zone Air Temperature"));
+  REQUIRE_FALSE(NgramIndex::wildcardMatch("zone", "Zone Air Temperature"));
+  REQUIRE(NgramIndex::wildcardMatch("core_?id", "CORE_MID"));
+  REQUIRE_FALSE(NgramIndex::wildcardMatch("core_?id", "CORE_BOTTOM"));
+  REQUIRE(NgramIndex::wildcardMatch("*[mt]*", "CORE_TOP"));
+  REQUIRE(NgramIndex::wildcardMatch("core_[!b]*", "CORE_MID"));
+  REQUIRE_FALSE(NgramIndex::wildcardMatch("core_[!b]*", "CORE_BOTTOM"));
+  REQUIRE(NgramIndex::wildcardMatch("zone [a-c]ir*", "Zone Air Temperature"));
+  REQUIRE(NgramIndex::wildcardMatch("*[*", "a[b"));
+  REQUIRE(NgramIndex::wildcardMatch("*a*a*a*b", "aaaaaaab"));
+  REQUIRE_FALSE(NgramIndex::wildcardMatch("*a*a*a*b", "aaaaaaa"));
+  REQUIRE(NgramIndex::wildcardMatch("**", ""));
+  REQUIRE(NgramIndex::wildcardMatch("", ""));
+  REQUIRE_FALSE(NgramIndex::wildcardMatch("?", ""));
+
+  REQUIRE(NgramIndex::refines("*zone a*", "*zone*"));
+  REQUIRE(NgramIndex::refines("*ZONE*", "*zone*"));
+  REQUIRE_FALSE(NgramIndex::refines("*zone*", "*zone a*"));
+  REQUIRE_FALSE(NgramIndex::refines("zone a*", "*zone*"));
+  REQUIRE_FALSE(NgramIndex::refines("*zone?a*", "*zone*"));
+}
+
+TEST_CASE("NgramIndex answers filters from posting lists", "[NgramIndex]")
+{
+  std::vector<std::string> strings = { "", "Zone Air Temperature", "Zone Mean Air Temperature", "CORE_BOTTOM", "CORE_MID",
+    "Hourly", "Site Outdoor Air Drybulb Temperature", "ab" };
+  NgramIndex index;
+  for (size_t i = 0; i < strings.size(); ++i) {
+    index.add(static_cast<NgramIndex::Id>(i), strings[i]);
+  }
+  index.add(1, "ignored");
+  REQUIRE(index.size() == strings.size());
+
+  REQUIRE(index.match("*air temp*") == std::vector<NgramIndex::Id>({ 1, 2 }));
+  REQUIRE(index.match("*AIR*") == std::vector<NgramIndex::Id>({ 1, 2, 6 }));
+  REQUIRE(index.match("*temperature") == std::vector<NgramIndex::Id>({ 1, 2, 6 }));
+  REQUIRE(index.match("core_*") == std::vector<NgramIndex::Id>({ 3, 4 }));
+  REQUIRE(index.match("*xyz*").empty());
+  // literals too short to look up fall back to checking every string
+  REQUIRE(index.match("*ab*") == std::vector<NgramIndex::Id>({ 7 }));
+  REQUIRE(index.match("*") == std::vector<NgramIndex::Id>({ 0, 1, 2, 3, 4, 5, 6, 7 }));
+  REQUIRE(index.match("") == std::vector<NgramIndex::Id>({ 0 }));
+  REQUIRE(index.match("?ourly") == std::vector<NgramIndex::Id>({ 5 }));
+
+  // refining checks only the earlier matches
+  std::vector<NgramIndex::Id> air = index.match("*air*");
+  REQUIRE(index.match("*air t*", air) == std::vector<NgramIndex::Id>({ 1, 2 }));
+  REQUIRE(index.match("*mean air t*", air) == std::vector<NgramIndex::Id>({ 2 }));
+
+  // brute force agrees on a larger set
+  NgramIndex large;
+  std::vector<std::string> names;
+  for (int i = 0; i < 2000; ++i) {
+    names.push_back("Zone " + std::to_string(i) + (i % 3 ? " Air Temperature" : " Lights Energy"));
+    large.add(static_cast<NgramIndex::Id>(i), names.back());
+  }
+  for (const std::string &pattern : std::vector<std::string>({ "*17*", "*1?3 air*", "zone 2*energy", "*[5-7]0 l*", "*ai*" })) {
+    std::vector<NgramIndex::Id> expected;
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (NgramIndex::wildcardMatch(pattern, names[i])) expected.push_back(static_cast<NgramIndex::Id>(i));
+    }
+    REQUIRE(large.match(pattern) == expected);
+  }
+}
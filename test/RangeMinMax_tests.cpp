@@ -0,0 +1,97 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "RangeMinMax.hpp"
+#include <vector>
+#include <random>
+#include <algorithm>
+
+TEST_CASE("RangeMinMax matches a scan", "[RangeMinMax]")
+{
+  std::mt19937 generator(346);
+  std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+  for (size_t n : { 1, 2, 3, 7, 8, 9, 100, 1001 }) {
+    std::vector<double> values(n);
+    for (auto &value : values) {
+      value = distribution(generator);
+    }
+    resultsviewer::RangeMinMax tree(values.data(), n);
+    REQUIRE(tree.size() == n);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    for (int trial = 0; trial < 200; ++trial) {
+      size_t first = index(generator);
+      size_t last = index(generator);
+      if (first > last) {
+        std::swap(first, last);
+      }
+      auto result = tree.minmax(first, last);
+      REQUIRE(result.first == *std::min_element(values.begin() + first, values.begin() + last + 1));
+      REQUIRE(result.second == *std::max_element(values.begin() + first, values.begin() + last + 1));
+    }
+    // the last index is clamped
+    auto all = tree.minmax(0, n + 10);
+    REQUIRE(all.first == *std::min_element(values.begin(), values.end()));
+    REQUIRE(all.second == *std::max_element(values.begin(), values.end()));
+  }
+}
+
+TEST_CASE("RangeMinMax empty ranges", "[RangeMinMax]")
+{
+  std::vector<double> values{ 3, 1, 2 };
+  resultsviewer::RangeMinMax tree(values.data(), values.size());
+  REQUIRE(tree.minmax(2, 1).first > tree.minmax(2, 1).second);
+  REQUIRE(tree.minmax(5, 6).first > tree.minmax(5, 6).second);
+  resultsviewer::RangeMinMax empty;
+  REQUIRE(empty.minmax(0, 0).first > empty.minmax(0, 0).second);
+  resultsviewer::RangeMinMax none(values.data(), 0);
+  REQUIRE(none.minmax(0, 0).first > none.minmax(0, 0).second);
+}
+
+TEST_CASE("RangeMinMax append", "[RangeMinMax]")
+{
+  std::mt19937 generator(347);
+  std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+  std::vector<double> values(3000);
+  for (auto &value : values) {
+    value = distribution(generator);
+  }
+  resultsviewer::RangeMinMax tree(values.data(), 5);
+  std::uniform_int_distribution<size_t> step(1, 200);
+  for (size_t n = 6; n <= values.size(); n += step(generator)) {
+    tree.append(values.data(), n);
+    REQUIRE(tree.size() == n);
+    std::uniform_int_distribution<size_t> index(0, n - 1);
+    for (int trial = 0; trial < 50; ++trial) {
+      size_t first = index(generator);
+      size_t last = index(generator);
+      if (first > last) {
+        std::swap(first, last);
+      }
+      auto result = tree.minmax(first, last);
+      REQUIRE(result.first == *std::min_element(values.begin() + first, values.begin() + last + 1));
+      REQUIRE(result.second == *std::max_element(values.begin() + first, values.begin() + last + 1));
+    }
+  }
+}
@@ -0,0 +1,126 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "TimeSeries.hpp"
+#include <cstdint>
+
+TEST_CASE("Rollup", "[Rollup]")
+{
+  // a leap year of ten minute reports, value i at report i
+  QDateTime start(QDate(2016, 1, 1));
+  const size_t count = 366 * 24 * 6;
+  std::vector<double> values(count);
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = static_cast<double>(i);
+  }
+  resultsviewer::TimeSeries ts(start, 600, resultsviewer::TimeSeriesArray<double>(values), "W");
+
+  SECTION("Hourly")
+  {
+    std::shared_ptr<const resultsviewer::Rollup> hourly = ts.rollup(resultsviewer::RollupPeriod::Hourly);
+    REQUIRE(hourly->size() == 366 * 24);
+    REQUIRE(hourly->seconds()[0] == 3600);
+    REQUIRE(hourly->count()[0] == 6);
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Sum) == 15);
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Mean) == 2.5);
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Minimum) == 0);
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Maximum) == 5);
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Integral) == 15 * 600);
+    REQUIRE(hourly->value(1, resultsviewer::RollupStatistic::Minimum) == 6);
+
+    // the same rollup is handed out again, also to copies
+    resultsviewer::TimeSeries copy = ts;
+    REQUIRE(copy.rollup(resultsviewer::RollupPeriod::Hourly) == hourly);
+  }
+
+  SECTION("Daily and monthly from the finer levels")
+  {
+    resultsviewer::TimeSeries daily = ts.rolledUp(resultsviewer::RollupPeriod::Daily, resultsviewer::RollupStatistic::Maximum);
+    REQUIRE(daily.values().size() == 366);
+    REQUIRE(daily.seconds()[0] == 86400);
+    REQUIRE(daily.values()[0] == 143);
+    REQUIRE(daily.interval().value() == 86400);
+    REQUIRE(daily.units() == "W");
+
+    resultsviewer::TimeSeries monthly = ts.rolledUp(resultsviewer::RollupPeriod::Monthly, resultsviewer::RollupStatistic::Sum);
+    REQUIRE(monthly.values().size() == 12);
+    REQUIRE(!monthly.interval().has_value());
+    // January, February of a leap year, then December
+    REQUIRE(monthly.seconds()[0] == 31 * 86400);
+    REQUIRE(monthly.seconds()[1] == 60 * 86400);
+    REQUIRE(monthly.seconds()[11] == 366 * 86400);
+    double january = 0.0;
+    for (size_t i = 0; i < 31 * 144; ++i) {
+      january += values[i];
+    }
+    REQUIRE(monthly.values()[0] == january);
+    REQUIRE(std::accumulate(monthly.values().begin(), monthly.values().end(), 0.0) == ts.sum());
+
+    // rolling the reports straight up to months gives the same buckets
+    resultsviewer::Rollup direct(start, ts.seconds().data(), ts.values().data(), count, resultsviewer::RollupPeriod::Monthly);
+    REQUIRE(direct.seconds() == ts.rollup(resultsviewer::RollupPeriod::Monthly)->seconds());
+    REQUIRE(direct.values(resultsviewer::RollupStatistic::Mean) ==
+      ts.rollup(resultsviewer::RollupPeriod::Monthly)->values(resultsviewer::RollupStatistic::Mean));
+
+    resultsviewer::TimeSeries energy = ts.rolledUp(resultsviewer::RollupPeriod::Monthly, resultsviewer::RollupStatistic::Integral);
+    REQUIRE(energy.units() == "W*s");
+    REQUIRE(energy.values()[0] == january * 600);
+  }
+
+  SECTION("Start times off midnight and irregular reports")
+  {
+    // reports at 6:30 and 7:00 on the start date belong to the hour ending at 7:00
+    QDateTime morning(QDate(2016, 3, 1), QTime(6, 0));
+    std::vector<long long> seconds{ { 1800, 3600, 5400, 86400 } };
+    std::vector<double> reported{ { 1, 3, 5, 7 } };
+    resultsviewer::TimeSeries irregular(morning, seconds, reported);
+    std::shared_ptr<const resultsviewer::Rollup> hourly = irregular.rollup(resultsviewer::RollupPeriod::Hourly);
+    REQUIRE(hourly->seconds() == std::vector<long long>({ 3600, 7200, 86400 }));
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Mean) == 2);
+    // the first report is taken to cover as long as the next one does
+    REQUIRE(hourly->value(0, resultsviewer::RollupStatistic::Integral) == 1 * 1800 + 3 * 1800);
+    REQUIRE(hourly->value(2, resultsviewer::RollupStatistic::Integral) == 7.0 * (86400 - 5400));
+
+    std::shared_ptr<const resultsviewer::Rollup> daily = irregular.rollup(resultsviewer::RollupPeriod::Daily);
+    REQUIRE(daily->seconds() == std::vector<long long>({ 18 * 3600, 42 * 3600 }));
+    REQUIRE(daily->count() == std::vector<size_t>({ 3, 1 }));
+
+    std::shared_ptr<const resultsviewer::Rollup> monthly = irregular.rollup(resultsviewer::RollupPeriod::Monthly);
+    REQUIRE(monthly->size() == 1);
+    REQUIRE(monthly->seconds()[0] == 31 * 86400 - 6 * 3600);
+  }
+
+  SECTION("Reporting frequencies")
+  {
+    REQUIRE(resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Hourly, "Zone Timestep"));
+    REQUIRE(resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Hourly, "HVAC System Timestep"));
+    REQUIRE(!resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Hourly, "Hourly"));
+    REQUIRE(resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Daily, "Hourly"));
+    REQUIRE(resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Monthly, "Daily"));
+    REQUIRE(!resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Monthly, "Monthly"));
+    REQUIRE(!resultsviewer::Rollup::appliesTo(resultsviewer::RollupPeriod::Monthly, "Run Period"));
+    REQUIRE(resultsviewer::Rollup::intervalName(resultsviewer::RollupPeriod::Daily) == "DAILY");
+  }
+}
@@ -0,0 +1,143 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "Snapshot.hpp"
+#include <fstream>
+#include <cstdio>
+
+namespace {
+  const std::string refFile("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+
+  // A database of one table with count rows, in the given journal mode
+  sqlite3 *makeDatabase(const std::string &path, const std::string &journalMode, int count)
+  {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+    sqlite3 *db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    std::string sql = "PRAGMA journal_mode=" + journalMode + "; PRAGMA wal_autocheckpoint=0;"
+      + " CREATE TABLE Data(Value REAL);"
+      + " WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i+1 FROM n WHERE i<" + std::to_string(count) + ")"
+      + " INSERT INTO Data SELECT i FROM n;";
+    sqlite3_exec(db, sql.c_str(), NULL, NULL, NULL);
+    return db;
+  }
+
+  // Rows in the Data table of a private copy, -1 if it cannot be read
+  int rowCount(const std::string &path)
+  {
+    sqlite3 *db = nullptr;
+    std::string uri = resultsviewer::SqlFile::uriFromPath(path) + "?mode=ro&immutable=1";
+    int count = -1;
+    if (sqlite3_open_v2(uri.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_URI, NULL) == SQLITE_OK) {
+      sqlite3_stmt *stmt = nullptr;
+      if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM Data", -1, &stmt, NULL) == SQLITE_OK
+        && sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+      }
+      sqlite3_finalize(stmt);
+    }
+    sqlite3_close(db);
+    return count;
+  }
+}
+
+TEST_CASE("Snapshot a results file", "[Snapshot]")
+{
+  std::remove("Snapshot_tests.sql");
+  resultsviewer::Snapshot::Method method = resultsviewer::Snapshot::copyDatabase(refFile, "Snapshot_tests.sql");
+  // which of the file level copies works depends on the file system
+  REQUIRE((method == resultsviewer::Snapshot::Method::Clone || method == resultsviewer::Snapshot::Method::KernelCopy));
+  REQUIRE(std::filesystem::file_size("Snapshot_tests.sql") == std::filesystem::file_size(refFile));
+
+  resultsviewer::SqlFile original(refFile, resultsviewer::SqlFile::OpenMode::ReadOnly);
+  resultsviewer::SqlFile copy("Snapshot_tests.sql", resultsviewer::SqlFile::OpenMode::Immutable);
+  REQUIRE(copy.connectionOpen());
+  REQUIRE(copy.dataDictionary().size() == original.dataDictionary().size());
+  REQUIRE(copy.versionString() == original.versionString());
+}
+
+TEST_CASE("Snapshots leave out uncommitted writes", "[Snapshot]")
+{
+  sqlite3 *writer = makeDatabase("Snapshot_tests_delete.sql", "DELETE", 1000);
+  REQUIRE(sqlite3_exec(writer, "BEGIN IMMEDIATE; INSERT INTO Data SELECT Value FROM Data;", NULL, NULL, NULL)
+    == SQLITE_OK);
+
+  resultsviewer::Snapshot::Method method = resultsviewer::Snapshot::copyDatabase("Snapshot_tests_delete.sql",
+    "Snapshot_tests_copy.sql");
+  REQUIRE(method != resultsviewer::Snapshot::Method::None);
+  REQUIRE(method != resultsviewer::Snapshot::Method::Backup);
+  REQUIRE(rowCount("Snapshot_tests_copy.sql") == 1000);
+
+  // the writer can commit once the copy is made
+  REQUIRE(sqlite3_exec(writer, "COMMIT", NULL, NULL, NULL) == SQLITE_OK);
+  sqlite3_close(writer);
+  REQUIRE(rowCount("Snapshot_tests_copy.sql") == 1000);
+}
+
+TEST_CASE("Snapshots of WAL databases use the backup API", "[Snapshot]")
+{
+  // the rows are committed to the -wal file only
+  sqlite3 *writer = makeDatabase("Snapshot_tests_wal.sql", "WAL", 5000);
+
+  SECTION("Copied in one step, whatever the batch size")
+  {
+    resultsviewer::Snapshot::Method method = resultsviewer::Snapshot::copyDatabase("Snapshot_tests_wal.sql",
+      "Snapshot_tests_copy.sql", resultsviewer::CancellationToken(), 4);
+    REQUIRE(method == resultsviewer::Snapshot::Method::Backup);
+    REQUIRE(rowCount("Snapshot_tests_copy.sql") == 5000);
+  }
+
+  SECTION("Canceled")
+  {
+    resultsviewer::CancellationToken token;
+    token.cancel();
+    resultsviewer::Snapshot::Method method = resultsviewer::Snapshot::copyDatabase("Snapshot_tests_wal.sql",
+      "Snapshot_tests_copy.sql", token);
+    REQUIRE(method == resultsviewer::Snapshot::Method::None);
+    REQUIRE(!std::filesystem::exists("Snapshot_tests_copy.sql"));
+  }
+
+  sqlite3_close(writer);
+}
+
+TEST_CASE("Snapshot other files", "[Snapshot]")
+{
+  {
+    std::ofstream file("Snapshot_tests.htm");
+    file << "<html><body>Annual Building Utility Performance Summary</body></html>";
+  }
+  REQUIRE(resultsviewer::Snapshot::copyFile("Snapshot_tests.htm", "Snapshot_tests_copy.htm")
+    != resultsviewer::Snapshot::Method::None);
+  std::ifstream copy("Snapshot_tests_copy.htm");
+  std::string text((std::istreambuf_iterator<char>(copy)), std::istreambuf_iterator<char>());
+  REQUIRE(text == "<html><body>Annual Building Utility Performance Summary</body></html>");
+
+  REQUIRE(resultsviewer::Snapshot::copyFile("does_not_exist.htm", "Snapshot_tests_copy.htm")
+    == resultsviewer::Snapshot::Method::None);
+  REQUIRE(resultsviewer::Snapshot::copyDatabase("does_not_exist.sql", "Snapshot_tests_copy.sql")
+    == resultsviewer::Snapshot::Method::None);
+}
@@ -0,0 +1,147 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "SqlFilePool.hpp"
+#include <thread>
+#include <vector>
+#include <atomic>
+
+TEST_CASE("SqlFile connection pool", "[SqlFilePool]")
+{
+  const std::string path("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+
+  SECTION("Leases are reused")
+  {
+    resultsviewer::SqlFilePool pool(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 2);
+    REQUIRE(pool.connectionOpen());
+    REQUIRE(pool.openConnections() == 1);
+    REQUIRE(pool.idleConnections() == 1);
+
+    const resultsviewer::SqlFile *first;
+    {
+      auto lease = pool.acquire();
+      REQUIRE(lease);
+      REQUIRE(lease->connectionOpen());
+      REQUIRE(lease->versionString() == "8.8.0");
+      REQUIRE(pool.idleConnections() == 0);
+      first = &*lease;
+    }
+    REQUIRE(pool.idleConnections() == 1);
+    // the connection keeps its prepared statements between leases
+    {
+      auto lease = pool.acquire();
+      REQUIRE(&*lease == first);
+      size_t statements = lease->preparedStatementCount();
+      lease->execAndReturnFirstInt("SELECT COUNT(*) FROM Time");
+      REQUIRE(lease->preparedStatementCount() == statements + 1);
+    }
+    {
+      auto lease = pool.acquire();
+      REQUIRE(&*lease == first);
+      size_t statements = lease->preparedStatementCount();
+      lease->execAndReturnFirstInt("SELECT COUNT(*) FROM Time");
+      REQUIRE(lease->preparedStatementCount() == statements);
+
+      // a second connection is opened while the first is leased, then the maximum is reached
+      auto second = pool.acquire();
+      REQUIRE(second);
+      REQUIRE(&*second != first);
+      REQUIRE(pool.openConnections() == 2);
+      REQUIRE(!pool.tryAcquire());
+
+      // moving a lease does not return it
+      resultsviewer::SqlFilePool::Lease moved(std::move(second));
+      REQUIRE(!second);
+      REQUIRE(moved);
+      REQUIRE(pool.idleConnections() == 0);
+    }
+    REQUIRE(pool.idleConnections() == 2);
+  }
+
+  SECTION("Threads share the connections")
+  {
+    resultsviewer::SqlFilePool pool(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 3);
+    std::atomic<int> rows(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+      threads.emplace_back([&pool, &rows]() {
+        for (int i = 0; i < 10; ++i) {
+          auto lease = pool.acquire();
+          auto count = lease->execAndReturnFirstInt("SELECT COUNT(*) FROM Time");
+          if (count) {
+            rows += *count;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    REQUIRE(rows == 80 * 8760);
+    REQUIRE(pool.openConnections() <= 3);
+    REQUIRE(pool.idleConnections() == pool.openConnections());
+  }
+
+  SECTION("Worker leases leave a connection for interactive ones")
+  {
+    resultsviewer::SqlFilePool pool(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 3);
+    auto first = pool.acquire(resultsviewer::SqlFilePool::Priority::Worker);
+    auto second = pool.acquire(resultsviewer::SqlFilePool::Priority::Worker);
+    REQUIRE(first);
+    REQUIRE(second);
+    REQUIRE(!pool.tryAcquire(resultsviewer::SqlFilePool::Priority::Worker));
+
+    // a worker waiting for a connection does not take the one kept back
+    std::atomic<bool> leased(false);
+    std::thread worker([&pool, &leased]() {
+      auto lease = pool.acquire(resultsviewer::SqlFilePool::Priority::Worker);
+      leased = true;
+    });
+    auto interactive = pool.acquire();
+    REQUIRE(interactive);
+    REQUIRE(interactive->connectionOpen());
+    REQUIRE(!leased);
+    interactive = resultsviewer::SqlFilePool::Lease();
+    REQUIRE(!leased);
+    first = resultsviewer::SqlFilePool::Lease();
+    worker.join();
+    REQUIRE(leased);
+    REQUIRE(pool.openConnections() == 3);
+
+    // a pool of one connection is shared by everyone
+    resultsviewer::SqlFilePool single(path, resultsviewer::SqlFile::OpenMode::ReadOnly, 1);
+    REQUIRE(single.tryAcquire(resultsviewer::SqlFilePool::Priority::Worker));
+  }
+
+  SECTION("Missing files")
+  {
+    resultsviewer::SqlFilePool pool("does_not_exist.sql");
+    REQUIRE(!pool.connectionOpen());
+    REQUIRE(pool.openConnections() == 0);
+    auto lease = pool.acquire();
+    REQUIRE(lease);
+    REQUIRE(!lease->connectionOpen());
+  }
+}
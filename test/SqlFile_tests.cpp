@@ -25,6 +25,9 @@
 #include "catch.hpp"
 #include "SqlFile.hpp"
 #include <iostream>
+#include <filesystem>
+#include <fstream>
+#include <cmath>
 
 TEST_CASE("Basic SQL", "[SqlFile]")
 {
@@ -37,3 +40,172 @@ TEST_CASE("Basic SQL", "[SqlFile]")
   //REQUIRE(time.seconds == 0);
 }
 
+TEST_CASE("Prepared statements", "[SqlFile]")
+{
+  resultsviewer::SqlFile sf("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+  REQUIRE(sf.connectionOpen());
+  REQUIRE(sf.versionString() == "8.8.0");
+  REQUIRE(sf.dataDictionary().size() == 11);
+
+  auto count = sf.execAndReturnFirstInt("SELECT COUNT(*) FROM ReportData WHERE ReportDataDictionaryIndex=?", 8);
+  REQUIRE(count);
+  REQUIRE(*count == 8760);
+  size_t cached = sf.preparedStatementCount();
+  // same shape, different parameter: no new statement
+  count = sf.execAndReturnFirstInt("SELECT COUNT(*) FROM ReportData WHERE ReportDataDictionaryIndex=?", 38);
+  REQUIRE(*count == 8760);
+  REQUIRE(sf.preparedStatementCount() == cached);
+
+  auto name = sf.execAndReturnFirstString("SELECT Name FROM ReportDataDictionary WHERE ReportDataDictionaryIndex=?", 8);
+  REQUIRE(name);
+  REQUIRE(*name == "Electricity:Facility");
+  REQUIRE(!sf.execAndReturnFirstString("SELECT Name FROM ReportDataDictionary WHERE ReportDataDictionaryIndex=?", -1));
+
+  std::vector<std::string> units = sf.execAndReturnVectorOfString("SELECT DISTINCT Units FROM ReportDataDictionary WHERE ReportingFrequency=?",
+    std::string("Hourly"));
+  REQUIRE(units.size() == 1);
+  REQUIRE(units[0] == "J");
+
+  resultsviewer::SqlStatement &stmt = sf.statement("SELECT TimeIndex, Value FROM ReportData WHERE ReportDataDictionaryIndex=? ORDER BY TimeIndex");
+  stmt.bind(1, 8);
+  int rows = 0;
+  int lastTimeIndex = 0;
+  while (stmt.step()) {
+    REQUIRE(stmt.columnInt(0) > lastTimeIndex);
+    lastTimeIndex = stmt.columnInt(0);
+    ++rows;
+  }
+  REQUIRE(rows == 8760);
+}
+
+TEST_CASE("Batch time series extraction", "[SqlFile]")
+{
+  resultsviewer::SqlFile sf("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+  REQUIRE(sf.connectionOpen());
+
+  auto env = sf.envPeriodIndex("chicago il usa tmy2-94846 wmo#=725300");
+  REQUIRE(env);
+  REQUIRE(*env == 3);
+
+  resultsviewer::TimeSeriesColumns columns = sf.timeSeriesColumns(*env, { 8, 38 });
+  REQUIRE(columns.startMonth == 1);
+  REQUIRE(columns.startDay == 1);
+  REQUIRE(columns.seconds.size() == 8760);
+  REQUIRE(columns.values.size() == 2);
+  REQUIRE(columns.values[0].size() == 8760);
+  REQUIRE(columns.values[1].size() == 8760);
+  REQUIRE(columns.seconds[0] == 3600);
+  REQUIRE(columns.seconds.back() == 365 * 86400);
+  for (size_t i = 1; i < columns.seconds.size(); ++i) {
+    REQUIRE(columns.seconds[i] - columns.seconds[i - 1] == 3600);
+  }
+
+  auto first = sf.execAndReturnFirstDouble("SELECT Value FROM ReportData WHERE ReportDataDictionaryIndex=? ORDER BY TimeIndex", 38);
+  REQUIRE(first);
+  REQUIRE(columns.values[1][0] == *first);
+
+  // the single variable path is a batch of one
+  auto ts = sf.timeSeries("CHICAGO IL USA TMY2-94846 WMO#=725300", "Hourly", "InteriorLights:Electricity", "");
+  REQUIRE(ts);
+  REQUIRE(ts->values().size() == 8760);
+  REQUIRE(ts->values() == columns.values[1]);
+  REQUIRE(ts->units() == "J");
+  REQUIRE(!sf.timeSeries("CHICAGO IL USA TMY2-94846 WMO#=725300", "Hourly", "NotAVariable", ""));
+}
+
+TEST_CASE("Read only open modes", "[SqlFile]")
+{
+  REQUIRE(resultsviewer::SqlFile::uriFromPath("/data/run 1/eplusout.sql") == "file:/data/run 1/eplusout.sql");
+  REQUIRE(resultsviewer::SqlFile::uriFromPath("C:\\runs\\a#1?.sql") == "file:///C:/runs/a%231%3F.sql");
+  REQUIRE(resultsviewer::SqlFile::uriFromPath("\\\\server\\share\\run.sql") == "file:////server/share/run.sql");
+  REQUIRE(resultsviewer::SqlFile::uriFromPath("//server/share/run.sql") == "file:////server/share/run.sql");
+
+  for (auto mode : { resultsviewer::SqlFile::OpenMode::ReadOnly, resultsviewer::SqlFile::OpenMode::Immutable }) {
+    resultsviewer::SqlFile sf("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql", mode);
+    REQUIRE(sf.connectionOpen());
+    REQUIRE(sf.openMode() == mode);
+    REQUIRE(sf.versionString() == "8.8.0");
+    REQUIRE(sf.dataDictionary().size() == 11);
+    auto queryOnly = sf.execAndReturnFirstInt("PRAGMA query_only");
+    REQUIRE(queryOnly);
+    REQUIRE(*queryOnly == 1);
+    // writes are refused
+    REQUIRE(!sf.statement("CREATE TABLE Scratch (Value REAL)").step());
+    REQUIRE(!sf.execAndReturnFirstInt("SELECT COUNT(*) FROM Scratch"));
+  }
+
+  // a path with two leading separators, which is a UNC path on Windows and the root on POSIX, keeps an empty authority
+  std::string doubleSlash = "/" + std::filesystem::absolute("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql").generic_string();
+  for (auto mode : { resultsviewer::SqlFile::OpenMode::ReadOnly, resultsviewer::SqlFile::OpenMode::Immutable }) {
+    resultsviewer::SqlFile sf(doubleSlash, mode);
+    REQUIRE(sf.connectionOpen());
+  }
+
+  // read only never creates a file
+  resultsviewer::SqlFile missing("does_not_exist.sql", resultsviewer::SqlFile::OpenMode::ReadOnly);
+  REQUIRE(!missing.connectionOpen());
+  REQUIRE(!std::ifstream("does_not_exist.sql").good());
+}
+
+TEST_CASE("Illuminance maps", "[SqlFile]")
+{
+  {
+    std::ifstream source("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql", std::ios::binary);
+    std::ofstream copy("illuminance_map.sql", std::ios::binary);
+    copy << source.rdbuf();
+  }
+  resultsviewer::SqlFile sf("illuminance_map.sql");
+  REQUIRE(sf.connectionOpen());
+  REQUIRE(!sf.statement("INSERT INTO DaylightMaps (MapNumber, MapName, Environment, Zone, ReferencePt1) VALUES "
+    "(1, 'MAP A', 'RUN PERIOD 1', 1, 'RefPt1=(1.00:2.00:0.80)'), (2, 'MAP B', NULL, NULL, NULL)").step());
+  REQUIRE(!sf.statement("INSERT INTO DaylightMapHourlyReports VALUES (1, 1, 1, 1, 9), (2, 2, 1, 1, 9), (3, 1, 1, 1, 24)").step());
+  // two by three grid, x varying fastest in the result; report 3 is missing a point
+  REQUIRE(!sf.statement("INSERT INTO DaylightMapHourlyData (HourlyReportIndex, X, Y, Illuminance) VALUES "
+    "(1, 0.0, 0.0, 1.0), (1, 2.0, 0.0, 2.0), (1, 0.0, 1.0, 3.0), (1, 2.0, 1.0, 4.0), (1, 0.0, 2.0, 5.0), (1, 2.0, 2.0, 6.0), "
+    "(3, 2.0, 2.0, 16.0), (3, 0.0, 0.0, 11.0), (3, 2.0, 0.0, 12.0), (3, 0.0, 1.0, 13.0), (3, 2.0, 1.0, 14.0)").step());
+
+  std::vector<resultsviewer::IlluminanceMapInfo> maps = sf.illuminanceMaps();
+  REQUIRE(maps.size() == 2);
+  REQUIRE(maps[0].name == "MAP A");
+  REQUIRE(maps[0].envPeriod == "RUN PERIOD 1");
+  REQUIRE(maps[0].zoneName == "CORE_BOTTOM");
+  REQUIRE(maps[1].name == "MAP B");
+  REQUIRE(maps[1].zoneName.empty());
+
+  auto reports = sf.illuminanceMapHourlyReportIndicesDates("MAP A");
+  REQUIRE(reports.size() == 2);
+  REQUIRE(reports[0].first == 1);
+  REQUIRE(reports[0].second == QDateTime(QDate(2009, 1, 1), QTime(9, 0)));
+  REQUIRE(reports[1].first == 3);
+  REQUIRE(reports[1].second == QDateTime(QDate(2009, 1, 2), QTime(0, 0)));
+  REQUIRE(sf.illuminanceMapHourlyReportIndicesDates("NO MAP").empty());
+
+  resultsviewer::IlluminanceMapGrid grid = sf.illuminanceMapGrid(1);
+  REQUIRE(grid.x == std::vector<double>({ 0.0, 2.0 }));
+  REQUIRE(grid.y == std::vector<double>({ 0.0, 1.0, 2.0 }));
+  REQUIRE(sf.illuminanceMap(1, grid) == std::vector<double>({ 1.0, 2.0, 3.0, 4.0, 5.0, 6.0 }));
+  std::vector<double> partial = sf.illuminanceMap(3, grid);
+  REQUIRE(partial.size() == 6);
+  REQUIRE(std::isnan(partial[4]));
+  REQUIRE(partial[5] == 16.0);
+
+  auto minMax = sf.illuminanceMapMinMaxValue("MAP A");
+  REQUIRE(minMax);
+  REQUIRE(minMax->first == 1.0);
+  REQUIRE(minMax->second == 16.0);
+  REQUIRE(!sf.illuminanceMapMinMaxValue("MAP B"));
+  REQUIRE(sf.illuminanceMapRefPt("MAP A", 1) == std::string("RefPt1=(1.00:2.00:0.80)"));
+  REQUIRE(!sf.illuminanceMapRefPt("MAP A", 2));
+  REQUIRE(!sf.illuminanceMapRefPt("MAP B", 1));
+}
+
+TEST_CASE("Reporting frequencies", "[SqlFile]")
+{
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("Hourly") == resultsviewer::ReportingFrequency::Hourly);
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("Run Period") == resultsviewer::ReportingFrequency::RunPeriod);
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("RUNPERIOD") == resultsviewer::ReportingFrequency::RunPeriod);
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("Zone Timestep") == resultsviewer::ReportingFrequency::Timestep);
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("HVAC System Timestep") == resultsviewer::ReportingFrequency::Detailed);
+  REQUIRE(resultsviewer::SqlFile::reportingFrequencyFromDB("monthly") == resultsviewer::ReportingFrequency::Monthly);
+  REQUIRE(!resultsviewer::SqlFile::reportingFrequencyFromDB("Fortnightly"));
+}
@@ -0,0 +1,86 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "Statistics.hpp"
+#include "TimeSeries.hpp"
+#include <vector>
+#include <random>
+
+TEST_CASE("Statistics of small series", "[Statistics]")
+{
+  resultsviewer::Statistics empty = resultsviewer::computeStatistics(nullptr, 0);
+  REQUIRE(empty.count == 0);
+  REQUIRE(std::isnan(empty.mean));
+
+  // lengths that exercise the vector blocks and the scalar tail
+  for (size_t n = 1; n <= 11; ++n) {
+    std::vector<double> values;
+    for (size_t i = 0; i < n; ++i) {
+      values.push_back(10.0 * static_cast<double>((i * (n - 1)) % n + 1));
+    }
+    resultsviewer::Statistics stats = resultsviewer::computeStatistics(values.data(), n);
+    double mean = 5.0 * static_cast<double>(n + 1);
+    double variance = 100.0 * static_cast<double>(n * n - 1) / 12.0;
+    REQUIRE(stats.count == n);
+    REQUIRE(stats.minimum == 10.0);
+    REQUIRE(stats.maximum == 10.0 * n);
+    REQUIRE(stats.sum == Approx(mean * n));
+    REQUIRE(stats.mean == Approx(mean));
+    REQUIRE(stats.variance == Approx(variance).margin(1e-9));
+  }
+}
+
+TEST_CASE("Vector and scalar statistics agree", "[Statistics]")
+{
+  std::mt19937 generator(8760);
+  // hourly energy in J is large, and the variance must not cancel away
+  std::normal_distribution<double> distribution(5.0e9, 1.0e3);
+  std::vector<double> values(8760 * 4 + 3);
+  for (auto &value : values) {
+    value = distribution(generator);
+  }
+  resultsviewer::Statistics fast = resultsviewer::computeStatistics(values.data(), values.size());
+  resultsviewer::Statistics scalar = resultsviewer::computeStatistics(values.data(), values.size(), true);
+  REQUIRE(fast.count == scalar.count);
+  REQUIRE(fast.minimum == scalar.minimum);
+  REQUIRE(fast.maximum == scalar.maximum);
+  REQUIRE(fast.sum == Approx(scalar.sum));
+  REQUIRE(fast.mean == Approx(scalar.mean));
+  REQUIRE(fast.variance == Approx(scalar.variance).epsilon(1e-6));
+  REQUIRE(fast.stdev() == Approx(1.0e3).epsilon(0.05));
+}
+
+TEST_CASE("TimeSeries statistics are memoized", "[Statistics]")
+{
+  QDateTime start(QDate(2017, 1, 1));
+  resultsviewer::TimeSeries ts(start, 3600, { 10, 20, 30, 40, 50 });
+  resultsviewer::TimeSeries before(ts);
+  REQUIRE(ts.maximum() == 50);
+  resultsviewer::TimeSeries after(ts);
+  REQUIRE(after.statistics().variance == 200.0);
+  REQUIRE(before.mean() == 30.0);
+  REQUIRE(ts.slice(3, 5).minimum() == 40);
+  REQUIRE(ts.slice(3, 5).count() == 2);
+}
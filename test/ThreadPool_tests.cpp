@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "ThreadPool.hpp"
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+TEST_CASE("ThreadPool runs tasks", "[ThreadPool]")
+{
+  resultsviewer::ThreadPool pool(4);
+  REQUIRE(pool.threadCount() == 4);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.submit([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(results[i].get() == i * i);
+  }
+
+  auto failed = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+  REQUIRE_THROWS_AS(failed.get(), const std::runtime_error &);
+}
+
+TEST_CASE("ThreadPool finishes queued tasks on destruction", "[ThreadPool]")
+{
+  std::atomic<int> count(0);
+  {
+    resultsviewer::ThreadPool pool(2);
+    for (int i = 0; i < 50; ++i) {
+      pool.submit([&count]() { ++count; });
+    }
+  }
+  REQUIRE(count == 50);
+}
+
+TEST_CASE("CancellationToken copies share a flag", "[ThreadPool]")
+{
+  resultsviewer::CancellationToken token;
+  resultsviewer::CancellationToken copy(token);
+  REQUIRE(!copy.isCanceled());
+
+  resultsviewer::ThreadPool pool(1);
+  auto spins = pool.submit([copy]() {
+    int n = 0;
+    while (!copy.isCanceled()) {
+      ++n;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return n;
+  });
+  token.cancel();
+  REQUIRE(spins.get() >= 0);
+  REQUIRE(copy.isCanceled());
+  REQUIRE(copy.flag() == token.flag());
+}
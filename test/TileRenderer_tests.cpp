@@ -0,0 +1,63 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "TileRenderer.hpp"
+#include <vector>
+#include <stdexcept>
+
+TEST_CASE("Tiles cover the image once", "[TileRenderer]")
+{
+  resultsviewer::ThreadPool pool(3);
+  for (int width : { 0, 1, 100, 128, 300 }) {
+    for (int height : { 1, 127, 129 }) {
+      std::vector<int> pixels(width * height, 0);
+      std::vector<int> seen(resultsviewer::tiles(width, height, 64).size(), 0);
+      resultsviewer::renderTiles(pool, width, height, 64, [&](size_t index, const resultsviewer::Tile &tile) {
+        ++seen[index];
+        for (int y = tile.y; y < tile.y + tile.height; ++y) {
+          for (int x = tile.x; x < tile.x + tile.width; ++x) {
+            pixels[y * width + x] += 1;
+          }
+        }
+      });
+      for (int count : pixels) {
+        REQUIRE(count == 1);
+      }
+      for (int count : seen) {
+        REQUIRE(count == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("Tile exceptions reach the caller", "[TileRenderer]")
+{
+  resultsviewer::ThreadPool pool(2);
+  REQUIRE_THROWS_AS(resultsviewer::renderTiles(pool, 256, 256, 16, [](size_t index, const resultsviewer::Tile &) {
+    if (index == 7) {
+      throw std::runtime_error("tile failed");
+    }
+  }), const std::runtime_error &);
+}
@@ -0,0 +1,194 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "TimeSeriesLoader.hpp"
+#include <mutex>
+#include <set>
+#include <cstdio>
+#include <filesystem>
+
+namespace {
+  const std::string refFile("RefBldgMediumOfficeNew2004_v1.4_8.8_5A_USA_IL_CHICAGO-OHARE.sql");
+  const std::string refEnv("CHICAGO IL USA TMY2-94846 WMO#=725300");
+}
+
+TEST_CASE("Load time series on a pool", "[TimeSeriesLoader]")
+{
+  resultsviewer::ThreadPool pool(3);
+  resultsviewer::TimeSeriesLoader loader(pool);
+  std::vector<resultsviewer::TimeSeriesRequest> requests{
+    { refFile, refEnv, "Hourly", "Electricity:Facility", "" },
+    { refFile, refEnv, "Hourly", "InteriorLights:Electricity", "" },
+    { refFile, refEnv, "Hourly", "NotAVariable", "" },
+    { "does_not_exist.sql", refEnv, "Hourly", "Electricity:Facility", "" }
+  };
+
+  std::mutex mutex;
+  std::set<size_t> arrived;
+  resultsviewer::CancellationToken token;
+  auto futures = loader.load(requests, token, [&](size_t index, const std::optional<resultsviewer::TimeSeries> &) {
+    std::lock_guard<std::mutex> lock(mutex);
+    arrived.insert(index);
+  });
+  REQUIRE(futures.size() == 4);
+  auto facility = futures[0].get();
+  auto lights = futures[1].get();
+  REQUIRE(facility);
+  REQUIRE(lights);
+  REQUIRE(facility->values().size() == 8760);
+  REQUIRE(lights->values().size() == 8760);
+  REQUIRE(facility->units() == "J");
+  REQUIRE(!futures[2].get());
+  REQUIRE(!futures[3].get());
+
+  // the facility meter is at least the lights
+  REQUIRE(facility->sum() > lights->sum());
+
+  // callbacks run before the futures are ready
+  std::lock_guard<std::mutex> lock(mutex);
+  REQUIRE(arrived.size() == 4);
+}
+
+TEST_CASE("Load time series on pooled connections", "[TimeSeriesLoader]")
+{
+  resultsviewer::ThreadPool pool(3);
+  resultsviewer::TimeSeriesLoader loader(pool);
+  auto connections = std::make_shared<resultsviewer::SqlFilePool>(refFile, resultsviewer::SqlFile::OpenMode::ReadOnly, 4);
+  std::atomic<int> lookups(0);
+  loader.setConnections([&](const std::string &path) {
+    ++lookups;
+    return path == refFile ? connections : std::shared_ptr<resultsviewer::SqlFilePool>();
+  });
+  std::vector<resultsviewer::TimeSeriesRequest> requests{
+    { refFile, refEnv, "Hourly", "Electricity:Facility", "" },
+    { refFile, refEnv, "Hourly", "InteriorLights:Electricity", "" },
+    { refFile, refEnv, "Hourly", "Gas:Facility", "" }
+  };
+  resultsviewer::CancellationToken token;
+  auto futures = loader.load(requests, token);
+  for (auto &future : futures) {
+    REQUIRE(future.get());
+    REQUIRE(future.get()->values().size() == 8760);
+  }
+  // one batch for the file and period, read with one scan on the connection the pool already had
+  REQUIRE(lookups == 1);
+  REQUIRE(connections->openConnections() == 1);
+  REQUIRE(connections->idleConnections() == 1);
+
+  // and through the columnar cache the pool carries
+  std::remove("TimeSeriesLoader_tests.rvcache");
+  REQUIRE(connections->useColumnarCache("TimeSeriesLoader_tests.rvcache"));
+  auto cached = loader.load(requests, token);
+  for (size_t i = 0; i < requests.size(); ++i) {
+    REQUIRE(cached[i].get());
+    REQUIRE(cached[i].get()->values().size() == 8760);
+    REQUIRE(cached[i].get()->sum() == Approx(futures[i].get()->sum()));
+  }
+}
+
+TEST_CASE("Canceled loads deliver nothing", "[TimeSeriesLoader]")
+{
+  resultsviewer::ThreadPool pool(2);
+  resultsviewer::TimeSeriesLoader loader(pool);
+  resultsviewer::CancellationToken token;
+  token.cancel();
+  std::atomic<int> callbacks(0);
+  auto futures = loader.load({ { refFile, refEnv, "Hourly", "Electricity:Facility", "" } }, token,
+    [&](size_t, const std::optional<resultsviewer::TimeSeries> &) { ++callbacks; });
+  REQUIRE(!futures[0].get());
+  REQUIRE(callbacks == 0);
+
+  // an interrupted scan is discarded
+  resultsviewer::SqlFile sf(refFile, resultsviewer::SqlFile::OpenMode::ReadOnly);
+  std::atomic<bool> stop(true);
+  sf.setInterruptFlag(&stop);
+  resultsviewer::TimeSeriesColumns columns = sf.timeSeriesColumns(3, { 8 });
+  REQUIRE(columns.seconds.size() < 8760);
+  sf.setInterruptFlag(nullptr);
+  columns = sf.timeSeriesColumns(3, { 8 });
+  REQUIRE(columns.seconds.size() == 8760);
+}
+
+TEST_CASE("Cached series are not read again", "[TimeSeriesLoader]")
+{
+  resultsviewer::ThreadPool pool(2);
+  resultsviewer::TimeSeriesLoader loader(pool);
+  loader.setCacheBudget(64 * 1024 * 1024);
+  std::vector<resultsviewer::TimeSeriesRequest> requests{
+    { refFile, refEnv, "Hourly", "Electricity:Facility", "" },
+    { refFile, refEnv, "Hourly", "NotAVariable", "" }
+  };
+  resultsviewer::CancellationToken token;
+  auto first = loader.load(requests, token);
+  REQUIRE(first[0].get());
+  REQUIRE(!first[1].get());
+  std::shared_ptr<const resultsviewer::Rollup> daily = first[0].get()->rollup(resultsviewer::RollupPeriod::Daily);
+  REQUIRE(daily->size() == 365);
+
+  std::atomic<int> callbacks(0);
+  auto second = loader.load(requests, token, [&](size_t, const std::optional<resultsviewer::TimeSeries> &) { ++callbacks; });
+  REQUIRE(second[0].get());
+  REQUIRE(second[0].get()->values().sameAs(first[0].get()->values()));
+  // and the rollups made of it come along
+  REQUIRE(second[0].get()->rollup(resultsviewer::RollupPeriod::Daily) == daily);
+  REQUIRE(!second[1].get());
+  REQUIRE(callbacks == 2);
+
+  loader.clearCache();
+  auto third = loader.load(requests, token);
+  REQUIRE(third[0].get());
+  REQUIRE(!third[0].get()->values().sameAs(first[0].get()->values()));
+}
+
+TEST_CASE("Cached series follow their file", "[TimeSeriesLoader]")
+{
+  std::filesystem::copy_file(refFile, "TimeSeriesLoader_tests.sql", std::filesystem::copy_options::overwrite_existing);
+  resultsviewer::ThreadPool pool(2);
+  resultsviewer::TimeSeriesLoader loader(pool);
+  loader.setCacheBudget(64 * 1024 * 1024);
+  resultsviewer::CancellationToken token;
+  std::vector<resultsviewer::TimeSeriesRequest> requests{
+    { refFile, refEnv, "Hourly", "Electricity:Facility", "" },
+    { "TimeSeriesLoader_tests.sql", refEnv, "Hourly", "Electricity:Facility", "" }
+  };
+  auto first = loader.load(requests, token);
+  REQUIRE(first[0].get());
+  REQUIRE(first[1].get());
+
+  // a file that changed is read again
+  auto modified = std::filesystem::last_write_time("TimeSeriesLoader_tests.sql");
+  std::filesystem::last_write_time("TimeSeriesLoader_tests.sql", modified + std::chrono::seconds(10));
+  auto second = loader.load(requests, token);
+  REQUIRE(second[0].get()->values().sameAs(first[0].get()->values()));
+  REQUIRE(!second[1].get()->values().sameAs(first[1].get()->values()));
+
+  // and closing one file keeps the series of the others
+  loader.clearCache("TimeSeriesLoader_tests.sql");
+  auto third = loader.load(requests, token);
+  REQUIRE(third[0].get()->values().sameAs(first[0].get()->values()));
+  REQUIRE(!third[1].get()->values().sameAs(second[1].get()->values()));
+
+  std::remove("TimeSeriesLoader_tests.sql");
+}
@@ -25,6 +25,7 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 #include "TimeSeries.hpp"
+#include <cstdint>
 
 TEST_CASE("Basic TimeSeries Tests", "[timeseries]")
 {
@@ -32,9 +33,9 @@ TEST_CASE("Basic TimeSeries Tests", "[timeseries]")
   std::vector<long long> seconds{ {3600, 7200, 10800, 14400, 18000} };
   std::vector<double> values{ {10, 20, 30, 40, 50} };
   resultsviewer::TimeSeries ts(start, seconds, values);
-  REQUIRE(ts.values.size() == 5);
-  REQUIRE(ts.seconds.size() == 5);
-  REQUIRE(!ts.interval.has_value());
+  REQUIRE(ts.values().size() == 5);
+  REQUIRE(ts.seconds().size() == 5);
+  REQUIRE(!ts.interval().has_value());
   auto first = ts.firstReportDateTime();
   auto date = first.date();
   REQUIRE(date.day() == 1);
@@ -56,3 +57,224 @@ TEST_CASE("Basic TimeSeries Tests", "[timeseries]")
   REQUIRE(days[4] * 24.0 == 4);
 }
 
+
+TEST_CASE("Interval TimeSeries", "[timeseries]")
+{
+  QDateTime start(QDate(2017, 1, 1));
+  resultsviewer::TimeSeries ts(start, 900, { 1, 2, 3, 4 }, "W");
+  REQUIRE(ts.interval().has_value());
+  REQUIRE(*ts.interval() == 900);
+  REQUIRE(ts.seconds().size() == 4);
+  REQUIRE(ts.seconds()[0] == 900);
+  REQUIRE(ts.seconds()[3] == 3600);
+  REQUIRE(ts.units() == "W");
+}
+
+TEST_CASE("Shared TimeSeries data", "[timeseries]")
+{
+  QDateTime start(QDate(2017, 1, 1));
+  std::vector<long long> seconds;
+  std::vector<double> values;
+  for (int i = 1; i <= 48; ++i) {
+    seconds.push_back(3600 * i);
+    values.push_back(i);
+  }
+  resultsviewer::TimeSeries ts(start, seconds, values);
+  REQUIRE(ts.values().useCount() == 1);
+  REQUIRE(reinterpret_cast<std::uintptr_t>(ts.values().data()) % 64 == 0);
+
+  // copies share the arrays
+  std::vector<resultsviewer::TimeSeries> copies(10, ts);
+  REQUIRE(ts.values().useCount() == 11);
+  REQUIRE(copies[9].values().data() == ts.values().data());
+  REQUIRE(copies[9].seconds().data() == ts.seconds().data());
+
+  // slices are views of the same arrays
+  resultsviewer::TimeSeries second = ts.sliceDays(1, 1);
+  REQUIRE(second.values().size() == 24);
+  REQUIRE(second.values().data() == ts.values().data() + 24);
+  REQUIRE(second.seconds().front() == 86400 + 3600);
+  REQUIRE(second.seconds().back() == 2 * 86400);
+  REQUIRE(second.firstReportDateTime().date().day() == 2);
+  REQUIRE(second.minimum() == 25);
+  REQUIRE(second.maximum() == 48);
+
+  resultsviewer::TimeSeries first = ts.sliceDays(0, 0);
+  REQUIRE(first.values().size() == 24);
+  REQUIRE(first.values().back() == 24);
+
+  resultsviewer::TimeSeries middle = ts.slice(10, 20);
+  REQUIRE(middle.values().size() == 10);
+  REQUIRE(middle.values()[0] == 11);
+  REQUIRE(middle.sum() == 155);
+  REQUIRE(ts.slice(40, 100).values().size() == 8);
+  REQUIRE(ts.sliceSeconds(10 * 86400, 11 * 86400).values().empty());
+
+  // series sharing a seconds array keep sharing it
+  resultsviewer::TimeSeries other(start, ts.seconds(), resultsviewer::TimeSeriesArray<double>(values));
+  REQUIRE(other.seconds().sameAs(ts.seconds()));
+  REQUIRE(!other.values().sameAs(ts.values()));
+  REQUIRE(other.values() == ts.values());
+}
+
+TEST_CASE("Appending to a TimeSeries", "[timeseries]")
+{
+  QDateTime start(QDate(2017, 1, 1));
+  std::vector<long long> seconds;
+  std::vector<double> values;
+  for (int i = 1; i <= 100; ++i) {
+    seconds.push_back(3600 * i);
+    values.push_back(std::sin(0.1 * i));
+  }
+  resultsviewer::TimeSeries ts(start, std::vector<long long>(seconds.begin(), seconds.begin() + 10),
+    std::vector<double>(values.begin(), values.begin() + 10), "W", 3600);
+  REQUIRE(ts.maximum() == values[9]);
+
+  resultsviewer::TimeSeries grown = ts.appended(seconds.data() + 10, values.data() + 10, 20);
+  REQUIRE(grown.values().size() == 30);
+  REQUIRE(grown.units() == "W");
+  REQUIRE(grown.interval() == ts.interval());
+  REQUIRE(ts.values().size() == 10);
+  REQUIRE(grown.values().toVector() == std::vector<double>(values.begin(), values.begin() + 30));
+
+  // the next append writes into the room left by the first one
+  resultsviewer::TimeSeries more = grown.appended(seconds.data() + 30, values.data() + 30, 20);
+  REQUIRE(more.values().data() == grown.values().data());
+  REQUIRE(more.seconds().data() == grown.seconds().data());
+  REQUIRE(grown.values().size() == 30);
+  REQUIRE(more.seconds().toVector() == std::vector<long long>(seconds.begin(), seconds.begin() + 50));
+
+  // appending to a view that no longer ends the storage copies it rather than overwriting the later reports
+  resultsviewer::TimeSeries branch = grown.appended(seconds.data() + 30, values.data() + 30, 1);
+  REQUIRE(branch.values().data() != grown.values().data());
+  REQUIRE(more.values()[30] == values[30]);
+
+  // statistics carried over agree with computing them afresh
+  resultsviewer::TimeSeries fresh(start, std::vector<long long>(seconds.begin(), seconds.begin() + 50),
+    std::vector<double>(values.begin(), values.begin() + 50));
+  REQUIRE(more.count() == 50);
+  REQUIRE(more.minimum() == fresh.minimum());
+  REQUIRE(more.maximum() == fresh.maximum());
+  REQUIRE(more.sum() == Approx(fresh.sum()));
+  REQUIRE(more.mean() == Approx(fresh.mean()));
+  REQUIRE(more.variance() == Approx(fresh.variance()));
+}
+TEST_CASE("TimeSeries arithmetic", "[timeseries]")
+{
+  QDateTime start(QDate(2017, 1, 1));
+  std::vector<double> hourlyValues;
+  for (int i = 1; i <= 24; ++i) {
+    hourlyValues.push_back(10.0 * i);
+  }
+  resultsviewer::TimeSeries hourly(start, 3600, resultsviewer::TimeSeriesArray<double>(hourlyValues), "W");
+
+  SECTION("Identical grids")
+  {
+    std::vector<double> ones(24, 1.0);
+    resultsviewer::TimeSeries other(start, hourly.seconds(), resultsviewer::TimeSeriesArray<double>(ones), "W");
+    resultsviewer::TimeSeries difference = hourly - other;
+    REQUIRE(difference.seconds().sameAs(hourly.seconds()));
+    REQUIRE(difference.values().size() == 24);
+    REQUIRE(difference.values()[0] == 9);
+    REQUIRE(difference.values()[23] == 239);
+    REQUIRE(difference.interval().value() == 3600);
+    REQUIRE(difference.units() == "W");
+
+    REQUIRE((hourly + other).values()[5] == 61);
+    REQUIRE((hourly * other).values()[5] == 60);
+    REQUIRE((hourly / other).values()[5] == 60);
+    REQUIRE(resultsviewer::minimum(hourly, other).values()[5] == 1);
+    REQUIRE(resultsviewer::maximum(hourly, other).values()[5] == 60);
+    REQUIRE((hourly * other).units() == "W*W");
+
+    // regular series built separately are still on the same grid
+    resultsviewer::TimeSeries rebuilt(start, 3600, resultsviewer::TimeSeriesArray<double>(ones));
+    REQUIRE((hourly - rebuilt).seconds().sameAs(hourly.seconds()));
+  }
+
+  SECTION("Ten minute series against an hourly one")
+  {
+    std::vector<double> fine;
+    for (int i = 1; i <= 24 * 6; ++i) {
+      fine.push_back(i * 10.0 / 6.0);
+    }
+    resultsviewer::TimeSeries tenMinute(start, 600, resultsviewer::TimeSeriesArray<double>(fine), "W");
+    resultsviewer::TimeSeries difference = tenMinute - hourly;
+    // the hourly series starts at 1:00, so the first five ten minute reports are not covered
+    REQUIRE(difference.values().size() == 24 * 6 - 5);
+    REQUIRE(difference.seconds().front() == 3600);
+    REQUIRE(difference.seconds().back() == 86400);
+    REQUIRE(difference.interval().value() == 600);
+    // both series rise linearly at the same rate, so the interpolated difference is zero everywhere
+    for (size_t i = 0; i < difference.values().size(); ++i) {
+      REQUIRE(difference.values()[i] == Approx(0.0).margin(1e-9));
+    }
+
+    // the operation is symmetric in how the grids are merged
+    resultsviewer::TimeSeries reversed = hourly - tenMinute;
+    REQUIRE(reversed.seconds() == difference.seconds());
+  }
+
+  SECTION("Mismatched times and start dates")
+  {
+    std::vector<long long> seconds{ { 1800, 5400, 9000 } };
+    std::vector<double> values{ { 1, 2, 3 } };
+    resultsviewer::TimeSeries halfHours(start, seconds, values);
+    resultsviewer::TimeSeries sum = hourly + halfHours;
+    REQUIRE(sum.seconds().toVector() == std::vector<long long>({ 3600, 5400, 7200, 9000 }));
+    REQUIRE(sum.values()[0] == Approx(10 + 1.5));
+    REQUIRE(sum.values()[1] == Approx(15 + 2));
+    REQUIRE(sum.values()[2] == Approx(20 + 2.5));
+    REQUIRE(sum.values()[3] == Approx(25 + 3));
+    REQUIRE(sum.interval().value() == 1800);
+
+    // the same series starting an hour later lines up with the second hour onwards
+    resultsviewer::TimeSeries later(start.addSecs(3600), 3600, resultsviewer::TimeSeriesArray<double>(hourlyValues));
+    resultsviewer::TimeSeries shifted = hourly - later;
+    REQUIRE(shifted.values().size() == 23);
+    REQUIRE(shifted.seconds().front() == 7200);
+    REQUIRE(shifted.values()[0] == 10);
+    REQUIRE(shifted.startDateTime() == start);
+
+    // irregular series agree with interpolating each of them at every report time
+    std::vector<long long> t1, t2;
+    std::vector<double> v1, v2;
+    uint32_t state = 7;
+    long long time1 = 0, time2 = 0;
+    for (int i = 0; i < 500; ++i) {
+      state = state * 1664525u + 1013904223u;
+      time1 += 1 + (state >> 24) % 7;
+      time2 += 1 + (state >> 16) % 11;
+      t1.push_back(time1);
+      t2.push_back(time2);
+      v1.push_back((state >> 8) % 100);
+      v2.push_back((state >> 12) % 100);
+    }
+    resultsviewer::TimeSeries irregular1(start, t1, v1);
+    resultsviewer::TimeSeries irregular2(start, t2, v2);
+    resultsviewer::TimeSeries merged = resultsviewer::maximum(irregular1, irregular2);
+    auto interpolate = [](const std::vector<long long> &t, const std::vector<double> &v, long long time) {
+      size_t k = std::lower_bound(t.begin(), t.end(), time) - t.begin();
+      if (t[k] == time) return v[k];
+      return v[k - 1] + (v[k] - v[k - 1]) * static_cast<double>(time - t[k - 1]) / static_cast<double>(t[k] - t[k - 1]);
+    };
+    std::vector<long long> times;
+    for (long long time : t1) {
+      if (time >= t2.front() && time <= t2.back()) times.push_back(time);
+    }
+    for (long long time : t2) {
+      if (time >= t1.front() && time <= t1.back()) times.push_back(time);
+    }
+    std::sort(times.begin(), times.end());
+    times.erase(std::unique(times.begin(), times.end()), times.end());
+    REQUIRE(merged.seconds().toVector() == times);
+    for (size_t i = 0; i < times.size(); ++i) {
+      double expected = std::max(interpolate(t1, v1, times[i]), interpolate(t2, v2, times[i]));
+      REQUIRE(merged.values()[i] == Approx(expected));
+    }
+
+    // series that do not overlap have nothing to report
+    resultsviewer::TimeSeries nextWeek(start.addSecs(7 * 86400), 3600, resultsviewer::TimeSeriesArray<double>(hourlyValues));
+    REQUIRE((hourly - nextWeek).values().empty());
+  }
+}
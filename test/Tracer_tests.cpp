@@ -0,0 +1,128 @@
+/***********************************************************************************************************************
+*  Copyright (c) 2017, Jason W. DeGraw. All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without modification, are permitted provided that the
+*  following conditions are met:
+*
+*  (1) Redistributions of source code must retain the above copyright notice, this list of conditions and the following
+*  disclaimer.
+*
+*  (2) Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the
+*  following disclaimer in the documentation and/or other materials provided with the distribution.
+*
+*  (3) Neither the name of the copyright holder nor the names of any contributors may be used to endorse or promote
+*  products derived from this software without specific prior written permission from the respective party.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+*  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+*  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, THE UNITED STATES GOVERNMENT, OR ANY CONTRIBUTORS BE LIABLE FOR
+*  ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+*  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+*  AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**********************************************************************************************************************/
+
+#include "catch.hpp"
+#include "Tracer.hpp"
+#include <sstream>
+#include <thread>
+
+TEST_CASE("Tracer", "[Tracer]")
+{
+  resultsviewer::Tracer &tracer = resultsviewer::Tracer::instance();
+  tracer.setEnabled(false);
+  tracer.clear();
+
+  SECTION("Nothing is recorded while disabled")
+  {
+    {
+      resultsviewer::TraceScope scope("off", "test");
+    }
+    REQUIRE(tracer.events().empty());
+  }
+
+  SECTION("Nested spans")
+  {
+    tracer.setEnabled(true);
+    {
+      resultsviewer::TraceScope outer("outer", "test");
+      {
+        resultsviewer::TraceScope inner("inner", "test");
+      }
+    }
+    tracer.setEnabled(false);
+    auto events = tracer.events();
+    REQUIRE(events.size() == 2);
+    // spans are recorded as they end
+    REQUIRE(std::string(events[0].second.name) == "inner");
+    REQUIRE(std::string(events[1].second.name) == "outer");
+    REQUIRE(std::string(events[1].second.category) == "test");
+    REQUIRE(events[1].second.start <= events[0].second.start);
+    REQUIRE(events[1].second.start + events[1].second.duration >= events[0].second.start + events[0].second.duration);
+  }
+
+  SECTION("Threads have buffers of their own")
+  {
+    tracer.setEnabled(true);
+    {
+      resultsviewer::TraceScope scope("main", "test");
+    }
+    std::thread worker([&tracer] {
+      tracer.setThreadName("worker \"1\"");
+      resultsviewer::TraceScope scope("worker", "test");
+    });
+    worker.join();
+    tracer.setEnabled(false);
+    auto events = tracer.events();
+    REQUIRE(events.size() == 2);
+    REQUIRE(events[0].first != events[1].first);
+
+    // the buffer outlives its thread
+    std::ostringstream out;
+    tracer.writeChromeTrace(out);
+    std::string json = out.str();
+    REQUIRE(json.find("\"traceEvents\":[") != std::string::npos);
+    REQUIRE(json.find("{\"name\":\"worker\",\"cat\":\"test\",\"ph\":\"X\",\"ts\":") != std::string::npos);
+    REQUIRE(json.find("\"ph\":\"M\"") != std::string::npos);
+    REQUIRE(json.find("{\"name\":\"worker \\\"1\\\"\"}") != std::string::npos);
+  }
+
+  SECTION("The ring keeps the latest spans")
+  {
+    for (size_t i = 0; i < resultsviewer::TraceBuffer::capacity + 10; ++i) {
+      tracer.record(i < 10 ? "old" : "new", "test", i, i + 1);
+    }
+    auto events = tracer.events();
+    REQUIRE(events.size() == resultsviewer::TraceBuffer::capacity);
+    REQUIRE(tracer.dropped() == 10);
+    REQUIRE(std::string(events.front().second.name) == "new");
+    REQUIRE(events.front().second.start == 10);
+    REQUIRE(events.front().second.duration == 1);
+  }
+
+  SECTION("The macro follows the build option")
+  {
+    tracer.setEnabled(true);
+    {
+      RESULTSVIEWER_TRACE_SCOPE("macro", "test");
+    }
+    tracer.setEnabled(false);
+#ifdef RESULTSVIEWER_TRACING
+    REQUIRE(tracer.events().size() == 1);
+#else
+    REQUIRE(tracer.events().empty());
+#endif
+  }
+
+  tracer.setEnabled(false);
+  tracer.clear();
+}
+
+TEST_CASE("jsonString", "[Tracer]")
+{
+  REQUIRE(resultsviewer::jsonString("") == "\"\"");
+  REQUIRE(resultsviewer::jsonString("Zone 1") == "\"Zone 1\"");
+  REQUIRE(resultsviewer::jsonString("a \"b\" \\c") == "\"a \\\"b\\\" \\\\c\"");
+  REQUIRE(resultsviewer::jsonString("line\nbreak\t") == "\"line\\u000abreak\\u0009\"");
+  REQUIRE(resultsviewer::jsonString("\xc2\xb0" "C") == "\"\xc2\xb0" "C\"");
+}
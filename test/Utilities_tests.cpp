@@ -24,6 +24,8 @@
 
 #include "catch.hpp"
 #include "Utilities.hpp"
+#include "Matrix.hpp"
+#include <cmath>
 
 TEST_CASE("intervalspace", "[utilities]")
 {
@@ -43,3 +45,30 @@ TEST_CASE("linspace", "[utilities]")
     REQUIRE(vec[2] == 4);
 }
 
+TEST_CASE("interp", "[utilities]")
+{
+    std::vector<double> x = { 0.0, 1.0, 3.0 };
+    std::vector<double> y = { 0.0, 2.0 };
+    resultsviewer::Matrix m(3, 2);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 2; j++) {
+            m(i, j) = x[i] + 10.0 * y[j];
+        }
+    }
+    using resultsviewer::InterpMethod;
+    using resultsviewer::ExtrapMethod;
+
+    // a plane is reproduced exactly by linear interpolation
+    REQUIRE(resultsviewer::interp(x, y, m, 0.5, 1.0) == Approx(10.5));
+    REQUIRE(resultsviewer::interp(x, y, m, 2.0, 0.5) == Approx(7.0));
+    REQUIRE(resultsviewer::interp(x, y, m, 3.0, 2.0) == Approx(23.0));
+
+    REQUIRE(resultsviewer::interp(x, y, m, 2.5, 0.5, InterpMethod::NearestInterp) == Approx(3.0));
+    REQUIRE(resultsviewer::interp(x, y, m, 2.5, 1.5, InterpMethod::HoldLastInterp) == Approx(1.0));
+    REQUIRE(resultsviewer::interp(x, y, m, 1.5, 0.5, InterpMethod::HoldNextInterp) == Approx(23.0));
+
+    REQUIRE(std::isnan(resultsviewer::interp(x, y, m, -1.0, 1.0)));
+    REQUIRE(std::isnan(resultsviewer::interp(x, y, m, 1.0, 3.0)));
+    REQUIRE(resultsviewer::interp(x, y, m, -1.0, 3.0, InterpMethod::LinearInterp, ExtrapMethod::NearestExtrap) == Approx(20.0));
+    REQUIRE(resultsviewer::interp(x, y, m, 5.0, 1.0, InterpMethod::LinearInterp, ExtrapMethod::NearestExtrap) == Approx(13.0));
+}